@@ -365,6 +365,140 @@ int epicsShareAPI ca_create_channel (
     return ECA_NORMAL;
 }
 
+/*
+ *  ca_create_channels ()
+ */
+// extern "C"
+int epicsShareAPI ca_create_channels (
+     unsigned count, const char * const * ppChanNames,
+     caChBatch * pConnFunc, void * pUserArg,
+     void * const * ppUserPrivate, capri priority, chid * pChanIDs )
+{
+    ca_client_context * pcac;
+    int caStatus = fetchClientContext ( & pcac );
+    if ( caStatus != ECA_NORMAL ) {
+        return caStatus;
+    }
+
+    {
+        CAFDHANDLER * pFunc = 0;
+        void * pArg = 0;
+        {
+            epicsGuard < epicsMutex >
+                guard ( pcac->mutex );
+            if ( pcac->fdRegFuncNeedsToBeCalled ) {
+                pFunc = pcac->fdRegFunc;
+                pArg = pcac->fdRegArg;
+                pcac->fdRegFuncNeedsToBeCalled = false;
+            }
+        }
+        if ( pFunc ) {
+            ( *pFunc ) ( pArg, pcac->sock, true );
+        }
+    }
+
+    for ( unsigned i = 0u; i < count; i++ ) {
+        pChanIDs[i] = 0;
+    }
+    if ( count == 0u ) {
+        return ECA_NORMAL;
+    }
+
+    epicsGuard < epicsMutex > guard ( pcac->mutex );
+
+    oldChannelBatch * pBatch = 0;
+    if ( pConnFunc ) {
+        try {
+            pBatch = & pcac->createConnectionBatch (
+                guard, pConnFunc, pUserArg, count );
+        }
+        catch ( std::bad_alloc & ) {
+            return ECA_ALLOCMEM;
+        }
+    }
+    try {
+        pcac->reserveChannels ( guard, count );
+    }
+    catch ( std::bad_alloc & ) {
+        // the table just grows later on
+    }
+
+    //
+    // all of the channels are installed in the search timer before
+    // the lock is released, so that the search requests go out in
+    // full datagrams
+    //
+    for ( unsigned i = 0u; i < count; i++ ) {
+        void * puser = ppUserPrivate ? ppUserPrivate[i] : 0;
+        int status = ECA_NORMAL;
+        try {
+            oldChannelNotify * pChanNotify;
+            if ( pBatch ) {
+                pChanNotify = new ( pcac->oldChannelNotifyFreeList )
+                    oldChannelNotify ( guard, *pcac, ppChanNames[i],
+                        *pBatch, puser, priority );
+            }
+            else {
+                pChanNotify = new ( pcac->oldChannelNotifyFreeList )
+                    oldChannelNotify ( guard, *pcac, ppChanNames[i],
+                        0, puser, priority );
+            }
+            pChanIDs[i] = pChanNotify;
+        }
+        catch ( cacChannel::badString & ) {
+            status = ECA_BADSTR;
+        }
+        catch ( std::bad_alloc & ) {
+            status = ECA_ALLOCMEM;
+        }
+        catch ( cacChannel::badPriority & ) {
+            status = ECA_BADPRIORITY;
+        }
+        catch ( cacChannel::unsupportedByService & ) {
+            status = ECA_UNAVAILINSERV;
+        }
+        catch ( std :: exception & except ) {
+            pcac->printFormated (
+                "ca_create_channels: "
+                "unexpected exception was \"%s\"",
+                except.what () );
+            status = ECA_INTERNAL;
+        }
+        catch ( ... ) {
+            status = ECA_INTERNAL;
+        }
+        if ( status != ECA_NORMAL && caStatus == ECA_NORMAL ) {
+            caStatus = status;
+        }
+    }
+
+    // they all have their chan pointer set prior to any
+    // connection call backs
+    try {
+        for ( unsigned i = 0u; i < count; i++ ) {
+            if ( pChanIDs[i] ) {
+                pChanIDs[i]->initiateConnect ( guard );
+            }
+        }
+    }
+    catch ( std::bad_alloc & ) {
+        caStatus = ECA_ALLOCMEM;
+    }
+    catch ( ... ) {
+        caStatus = ECA_INTERNAL;
+    }
+
+    if ( pBatch && pBatch->unused () ) {
+        pcac->connBatchIdle.remove ( *pBatch );
+        delete pBatch;
+    }
+
+    // channels hosted in this process connect immediately
+    pcac->connectionBatchNotify ( guard );
+
+    return caStatus;
+}
+
 /*
  *  ca_clear_channel ()
  *
@@ -729,6 +863,19 @@ int epicsShareAPI ca_context_status ( ca_client_context * pcac, unsigned level )
     return ECA_NORMAL;
 }
 
+int epicsShareAPI ca_context_backlog ( ca_client_context * pcac,
+    struct ca_backlog * pReport )
+{
+    if ( ! pcac ) {
+        int caStatus = fetchClientContext ( &pcac );
+        if ( caStatus != ECA_NORMAL ) {
+            return caStatus;
+        }
+    }
+    pcac->backlog ( *pReport );
+    return ECA_NORMAL;
+}
+
 /*
  * ca_current_context ()
  *
@@ -32,6 +32,28 @@ epicsShareFunc void epicsShareAPI printChannelAccessAddressList
 epicsShareFunc void epicsShareAPI removeDuplicateAddresses
     ( struct ELLLIST *pDestList, ELLLIST *pSrcList, int silent);
 
+/*
+ * Multicast name resolution, see EPICS_CA_NAME_MCAST_ADDR.  A name is
+ * searched for in the group selected by a hash of its prefix, which is
+ * the part before the first ':' or '.'
+ */
+typedef struct caNameMcastConfig {
+    struct sockaddr_in base;    /* first group, and the port of all */
+    struct sockaddr_in intf;    /* interface to send on, or INADDR_ANY */
+    unsigned nGroups;           /* zero when disabled */
+} caNameMcastConfig;
+
+epicsShareFunc int epicsShareAPI caNameMcastConfigure
+    ( caNameMcastConfig *pConfig, unsigned short serverPort );
+
+epicsShareFunc unsigned epicsShareAPI caNameMcastIndex
+    ( const caNameMcastConfig *pConfig, const char *pName, 
+    unsigned nameLength );
+
+epicsShareFunc void epicsShareAPI caNameMcastGroup
+    ( const caNameMcastConfig *pConfig, unsigned index, 
+    struct sockaddr_in *pAddr );
+
 #ifdef __cplusplus
 }
 #endif
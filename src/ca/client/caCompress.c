@@ -0,0 +1,344 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Compression of the value arrays in CA_PROTO_COMPRESSED responses,
+ *  see caCompress.h.
+ *
+ *  A block is a sequence of a token byte, literal bytes and a match
+ *  with a 16 bit little endian distance, as defined for LZ4 blocks.
+ *  The encoder is the simple greedy one with a single hash table.
+ */
+
+#include <string.h>
+
+#include "epicsTypes.h"
+
+#define epicsExportSharedSymbols
+#include "db_access.h"
+#include "caProto.h"
+#include "caCompress.h"
+
+#define HASH_LOG        12u
+#define HASH_SIZE       ( 1u << HASH_LOG )
+#define MIN_MATCH       4u
+#define LAST_LITERALS   5u      /* a block ends with at least this many */
+#define MATCH_MARGIN    12u     /* no match starts closer to the end */
+#define MAX_DISTANCE    65535u
+#define SKIP_TRIGGER    6u      /* move faster through data that doesn't match */
+
+static epicsUInt32 read32 ( const epicsUInt8 *p )
+{
+    epicsUInt32 v;
+    memcpy ( &v, p, sizeof ( v ) );
+    return v;
+}
+
+static unsigned hash32 ( epicsUInt32 v )
+{
+    return ( v * 2654435761u ) >> ( 32u - HASH_LOG );
+}
+
+static epicsUInt8 * putLength ( epicsUInt8 *op, unsigned length )
+{
+    while ( length >= 255u ) {
+        *op++ = 255u;
+        length -= 255u;
+    }
+    *op++ = (epicsUInt8) length;
+    return op;
+}
+
+/*
+ * Writes one sequence, the last one of a block has no match.
+ * Returns NULL if it doesn't fit.
+ */
+static epicsUInt8 * putSequence ( epicsUInt8 *op, const epicsUInt8 *oend,
+    const epicsUInt8 *pLiteral, unsigned nLiteral, unsigned distance,
+    unsigned matchLength )
+{
+    unsigned need = 1u + nLiteral / 255u + 1u + nLiteral;
+    epicsUInt8 *pToken;
+
+    if ( matchLength ) {
+        need += 2u + ( matchLength - MIN_MATCH ) / 255u + 1u;
+    }
+    if ( need > (unsigned) ( oend - op ) ) {
+        return NULL;
+    }
+
+    pToken = op++;
+    if ( nLiteral >= 15u ) {
+        *pToken = 15u << 4;
+        op = putLength ( op, nLiteral - 15u );
+    }
+    else {
+        *pToken = (epicsUInt8) ( nLiteral << 4 );
+    }
+    memcpy ( op, pLiteral, nLiteral );
+    op += nLiteral;
+
+    if ( matchLength ) {
+        unsigned length = matchLength - MIN_MATCH;
+        *op++ = (epicsUInt8) distance;
+        *op++ = (epicsUInt8) ( distance >> 8 );
+        if ( length >= 15u ) {
+            *pToken |= 15u;
+            op = putLength ( op, length - 15u );
+        }
+        else {
+            *pToken |= (epicsUInt8) length;
+        }
+    }
+    return op;
+}
+
+static unsigned blockCompress ( const epicsUInt8 *src, unsigned srcSize,
+    epicsUInt8 *dst, unsigned dstSize, epicsUInt32 *table )
+{
+    const epicsUInt8 *ip = src;
+    const epicsUInt8 *anchor = src;
+    const epicsUInt8 * const iend = src + srcSize;
+    const epicsUInt8 * const oend = dst + dstSize;
+    epicsUInt8 *op = dst;
+
+    memset ( table, 0, HASH_SIZE * sizeof ( *table ) );
+
+    if ( srcSize > MATCH_MARGIN ) {
+        const epicsUInt8 * const mflimit = iend - MATCH_MARGIN;
+        const epicsUInt8 * const matchlimit = iend - LAST_LITERALS;
+        unsigned misses = 1u << SKIP_TRIGGER;
+
+        ip++;
+        while ( ip < mflimit ) {
+            epicsUInt32 sequence = read32 ( ip );
+            unsigned h = hash32 ( sequence );
+            const epicsUInt8 *ref = src + table[h];
+            unsigned length;
+
+            table[h] = (epicsUInt32) ( ip - src );
+            if ( (unsigned) ( ip - ref ) > MAX_DISTANCE ||
+                    read32 ( ref ) != sequence ) {
+                ip += misses++ >> SKIP_TRIGGER;
+                continue;
+            }
+            misses = 1u << SKIP_TRIGGER;
+
+            while ( ip > anchor && ref > src && ip[-1] == ref[-1] ) {
+                ip--;
+                ref--;
+            }
+            length = MIN_MATCH;
+            while ( ip + length < matchlimit && ip[length] == ref[length] ) {
+                length++;
+            }
+
+            op = putSequence ( op, oend, anchor, (unsigned) ( ip - anchor ),
+                (unsigned) ( ip - ref ), length );
+            if ( ! op ) {
+                return 0u;
+            }
+            ip += length;
+            anchor = ip;
+            if ( ip < mflimit ) {
+                table[hash32 ( read32 ( ip - 2 ) )] =
+                    (epicsUInt32) ( ip - 2 - src );
+            }
+        }
+    }
+
+    op = putSequence ( op, oend, anchor, (unsigned) ( iend - anchor ),
+        0u, 0u );
+    if ( ! op ) {
+        return 0u;
+    }
+    return (unsigned) ( op - dst );
+}
+
+static int getLength ( const epicsUInt8 **pip, const epicsUInt8 *iend,
+    unsigned *pLength )
+{
+    const epicsUInt8 *ip = *pip;
+    unsigned b;
+
+    do {
+        if ( ip >= iend || *pLength > 0x7fffffffu ) {
+            return -1;
+        }
+        b = *ip++;
+        *pLength += b;
+    } while ( b == 255u );
+    *pip = ip;
+    return 0;
+}
+
+static int blockExpand ( const epicsUInt8 *src, unsigned srcSize,
+    epicsUInt8 *dst, unsigned dstSize )
+{
+    const epicsUInt8 *ip = src;
+    const epicsUInt8 * const iend = src + srcSize;
+    epicsUInt8 *op = dst;
+    epicsUInt8 * const oend = dst + dstSize;
+
+    while ( ip < iend ) {
+        unsigned token = *ip++;
+        unsigned length = token >> 4;
+        unsigned distance;
+        const epicsUInt8 *ref;
+
+        if ( length == 15u && getLength ( &ip, iend, &length ) ) {
+            return -1;
+        }
+        if ( length > (unsigned) ( iend - ip ) ||
+             length > (unsigned) ( oend - op ) ) {
+            return -1;
+        }
+        memcpy ( op, ip, length );
+        op += length;
+        ip += length;
+        if ( ip == iend ) {
+            break;
+        }
+
+        if ( iend - ip < 2 ) {
+            return -1;
+        }
+        distance = ip[0] | ( (unsigned) ip[1] << 8 );
+        ip += 2;
+        if ( distance == 0u || distance > (unsigned) ( op - dst ) ) {
+            return -1;
+        }
+        length = token & 15u;
+        if ( length == 15u && getLength ( &ip, iend, &length ) ) {
+            return -1;
+        }
+        length += MIN_MATCH;
+        if ( length > (unsigned) ( oend - op ) ) {
+            return -1;
+        }
+        ref = op - distance;
+        if ( distance >= length ) {
+            memcpy ( op, ref, length );
+            op += length;
+        }
+        else {
+            while ( length-- ) {
+                *op++ = *ref++;
+            }
+        }
+    }
+    return (int) ( op - dst );
+}
+
+/*
+ * Element size of the integer types that are delta encoded, else zero
+ */
+static unsigned deltaSize ( unsigned dbrType )
+{
+    if ( dbrType > LAST_BUFFER_TYPE ||
+         dbr_value_class[dbrType] != dbr_class_int ||
+         dbr_value_size[dbrType] > sizeof ( epicsUInt32 ) ) {
+        return 0u;
+    }
+    return dbr_value_size[dbrType];
+}
+
+static void deltaEncode ( const epicsUInt8 *pSrc, epicsUInt8 *pDst,
+    unsigned elemSize, unsigned count )
+{
+    epicsUInt32 prev = 0u;
+    unsigned i, j;
+
+    for ( i = 0u; i < count; i++ ) {
+        epicsUInt32 v = 0u, d;
+        for ( j = 0u; j < elemSize; j++ ) {
+            v = ( v << 8 ) | *pSrc++;
+        }
+        d = v - prev;
+        prev = v;
+        for ( j = elemSize; j-- > 0u; ) {
+            pDst[j] = (epicsUInt8) d;
+            d >>= 8;
+        }
+        pDst += elemSize;
+    }
+}
+
+static void deltaDecode ( epicsUInt8 *pBuf, unsigned elemSize,
+    unsigned count )
+{
+    epicsUInt32 prev = 0u;
+    unsigned i, j;
+
+    for ( i = 0u; i < count; i++ ) {
+        epicsUInt32 v = 0u;
+        for ( j = 0u; j < elemSize; j++ ) {
+            v = ( v << 8 ) | pBuf[j];
+        }
+        prev += v;
+        v = prev;
+        for ( j = elemSize; j-- > 0u; ) {
+            pBuf[j] = (epicsUInt8) v;
+            v >>= 8;
+        }
+        pBuf += elemSize;
+    }
+}
+
+unsigned caCompressWorkSize ( unsigned valueBytes )
+{
+    return HASH_SIZE * sizeof ( epicsUInt32 ) + valueBytes;
+}
+
+unsigned caCompressArray ( unsigned dbrType, const void *pValue,
+    unsigned valueBytes, void *pDst, unsigned dstSize, void *pWork,
+    unsigned *pEncoding )
+{
+    epicsUInt32 *pTable = (epicsUInt32 *) pWork;
+    const epicsUInt8 *pSrc = (const epicsUInt8 *) pValue;
+    unsigned elemSize = deltaSize ( dbrType );
+
+    if ( elemSize ) {
+        epicsUInt8 *pDelta = (epicsUInt8 *) ( pTable + HASH_SIZE );
+        unsigned count = valueBytes / elemSize;
+
+        deltaEncode ( pSrc, pDelta, elemSize, count );
+        memcpy ( pDelta + count * elemSize, pSrc + count * elemSize,
+            valueBytes - count * elemSize );
+        pSrc = pDelta;
+        *pEncoding = CA_COMPRESS_DELTA_LZ4;
+    }
+    else {
+        *pEncoding = CA_COMPRESS_LZ4;
+    }
+    return blockCompress ( pSrc, valueBytes, (epicsUInt8 *) pDst, dstSize,
+        pTable );
+}
+
+int caExpandArray ( unsigned encoding, unsigned dbrType,
+    const void *pSrc, unsigned srcSize, void *pValue, unsigned valueBytes )
+{
+    unsigned elemSize = 0u;
+    int n;
+
+    if ( encoding == CA_COMPRESS_DELTA_LZ4 ) {
+        elemSize = deltaSize ( dbrType );
+        if ( ! elemSize ) {
+            return -1;
+        }
+    }
+    else if ( encoding != CA_COMPRESS_LZ4 ) {
+        return -1;
+    }
+
+    n = blockExpand ( (const epicsUInt8 *) pSrc, srcSize,
+        (epicsUInt8 *) pValue, valueBytes );
+    if ( n > 0 && elemSize ) {
+        deltaDecode ( (epicsUInt8 *) pValue, elemSize,
+            (unsigned) n / elemSize );
+    }
+    return n;
+}
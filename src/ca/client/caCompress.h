@@ -0,0 +1,50 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Compression of the value arrays in CA_PROTO_COMPRESSED responses.
+ *
+ *  The encoder writes the LZ4 block format, so no external library is
+ *  needed.  Integer arrays are replaced by the differences between
+ *  neighbouring elements first, which makes slowly changing waveforms
+ *  and detector images compress much better.  Values are in network
+ *  byte order on both sides.
+ */
+
+#ifndef INCcaCompressh
+#define INCcaCompressh
+
+#include "shareLib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* size of the scratch space needed to compress valueBytes */
+epicsShareFunc unsigned caCompressWorkSize ( unsigned valueBytes );
+
+/*
+ * Compresses the valueBytes long value array of a dbrType response
+ * into pDst.  Returns the number of bytes written and the encoding,
+ * or zero if the result doesn't fit into dstSize bytes.
+ */
+epicsShareFunc unsigned caCompressArray ( unsigned dbrType,
+    const void *pValue, unsigned valueBytes, void *pDst, unsigned dstSize,
+    void *pWork, unsigned *pEncoding );
+
+/*
+ * Expands srcSize bytes from pSrc into the value array of a dbrType
+ * response, which is at most valueBytes long.  Returns the number
+ * of bytes written, or -1 if the data is corrupt.
+ */
+epicsShareFunc int caExpandArray ( unsigned encoding, unsigned dbrType,
+    const void *pSrc, unsigned srcSize, void *pValue, unsigned valueBytes );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCcaCompressh */
@@ -0,0 +1,137 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measures how many channels per second the client library connects,
+ * starting from a fresh context each time so that every channel has
+ * to be found by the UDP search. In bulk mode the channels are created
+ * with one ca_create_channels() call.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cadef.h"
+#include "dbDefs.h"
+#include "epicsEvent.h"
+#include "epicsTime.h"
+
+#include "caDiagnostics.h"
+
+static unsigned connCount;
+static unsigned channelCount;
+static epicsTime firstConnect;
+static epicsEvent allConnected;
+
+extern "C" void caConnRateConnHandler ( struct connection_handler_args args )
+{
+    if ( args.op == CA_OP_CONN_UP ) {
+        if ( connCount++ == 0u ) {
+            firstConnect = epicsTime::getCurrent ();
+        }
+        if ( connCount == channelCount ) {
+            allConnected.signal ();
+        }
+    }
+}
+
+extern "C" void caConnRateBatchHandler ( struct connection_batch_args args )
+{
+    for ( unsigned i = 0u; i < args.count; i++ ) {
+        if ( args.pOps[i] == CA_OP_CONN_UP ) {
+            if ( connCount++ == 0u ) {
+                firstConnect = epicsTime::getCurrent ();
+            }
+            if ( connCount == channelCount ) {
+                allConnected.signal ();
+            }
+        }
+    }
+}
+
+int caConnRate ( const char *pName, unsigned channelCountIn,
+    unsigned iterations, enum appendNumberFlag appNF, double timeout,
+    int bulk )
+{
+    const unsigned nameSize = 128u;
+    char * pNames = new char [ channelCountIn * nameSize ];
+    const char ** ppNames = new const char * [ channelCountIn ];
+    chid * pChans = new chid [ channelCountIn ];
+    double rateSum = 0.0;
+    unsigned nComplete = 0u;
+
+    for ( unsigned i = 0u; i < channelCountIn; i++ ) {
+        char * pCur = & pNames[ i * nameSize ];
+        if ( appNF == appendNumber ) {
+            sprintf ( pCur, "%.*s%.6u", (int) ( nameSize - 15u ), pName, i );
+        }
+        else {
+            strncpy ( pCur, pName, nameSize );
+            pCur[ nameSize - 1u ] = '\0';
+        }
+        ppNames[i] = pCur;
+    }
+
+    printf ( "Connecting %u channels named %s%s %u times%s\n",
+        channelCountIn, pName, appNF == appendNumber ? "nnnnnn" : "",
+        iterations, bulk ? " with ca_create_channels()" : "" );
+
+    channelCount = channelCountIn;
+    for ( unsigned j = 0u; j < iterations; j++ ) {
+        int status = ca_context_create ( ca_enable_preemptive_callback );
+        SEVCHK ( status, "CA init failed" );
+
+        connCount = 0u;
+        epicsTime begin = epicsTime::getCurrent ();
+        if ( bulk ) {
+            status = ca_create_channels ( channelCountIn, ppNames,
+                caConnRateBatchHandler, 0, 0, CA_PRIORITY_DEFAULT, pChans );
+            SEVCHK ( status, "ca_create_channels() problems" );
+        }
+        else {
+            for ( unsigned i = 0u; i < channelCountIn; i++ ) {
+                status = ca_create_channel ( ppNames[i],
+                    caConnRateConnHandler, 0, CA_PRIORITY_DEFAULT,
+                    & pChans[i] );
+                SEVCHK ( status, "ca_create_channel() problems" );
+            }
+        }
+        status = ca_flush_io ();
+        SEVCHK ( status, "ca_flush_io() problems" );
+        epicsTime created = epicsTime::getCurrent ();
+
+        bool done = allConnected.wait ( timeout );
+        epicsTime end = epicsTime::getCurrent ();
+
+        if ( done ) {
+            double delay = end - begin;
+            double rate = channelCountIn / delay;
+            printf ( "%u: created in %f sec, first connected after %f sec, "
+                "all after %f sec: %.0f channels per sec\n",
+                j, created - begin, firstConnect - begin, delay, rate );
+            rateSum += rate;
+            nComplete++;
+        }
+        else {
+            printf ( "%u: only %u of %u channels connected within %f sec\n",
+                j, connCount, channelCountIn, timeout );
+        }
+
+        ca_context_destroy ();
+    }
+
+    if ( nComplete ) {
+        printf ( "Average %.0f channels connected per sec\n",
+            rateSum / nComplete );
+    }
+
+    delete [] pChans;
+    delete [] ppNames;
+    delete [] pNames;
+
+    return nComplete == iterations ? CATIME_OK : CATIME_ERROR;
+}
@@ -0,0 +1,53 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#include <stdio.h>
+#include <epicsStdlib.h>
+
+#include "caDiagnostics.h"
+
+int main ( int argc, char **argv )
+{
+    unsigned count = 10000u;
+    unsigned iterations = 5u;
+    unsigned appendNumberBool = 1u;
+    double timeout = 30.0;
+    unsigned bulkBool = 0u;
+
+    if ( argc < 2 || argc > 7 ) {
+        printf ( "usage: %s < PV name > [ < channel count > [ < iterations > "
+            "[ < append number to pv name if true > [ < timeout sec > "
+            "[ < create all channels in one call if true > ]]]]]\n",
+            argv[0] );
+        return -1;
+    }
+
+    if ( argc >= 3 && sscanf ( argv[2], "%u", &count ) != 1 ) {
+        printf ( "conversion failed, changing channel count arg \"%s\" to %u\n",
+            argv[2], count );
+    }
+    if ( argc >= 4 && sscanf ( argv[3], "%u", &iterations ) != 1 ) {
+        printf ( "conversion failed, changing iterations arg \"%s\" to %u\n",
+            argv[3], iterations );
+    }
+    if ( argc >= 5 && sscanf ( argv[4], "%u", &appendNumberBool ) != 1 ) {
+        printf ( "conversion failed, changing append number arg \"%s\" to %u\n",
+            argv[4], appendNumberBool );
+    }
+    if ( argc >= 6 && epicsScanDouble ( argv[5], &timeout ) != 1 ) {
+        printf ( "conversion failed, changing timeout arg \"%s\" to %f\n",
+            argv[5], timeout );
+    }
+    if ( argc >= 7 && sscanf ( argv[6], "%u", &bulkBool ) != 1 ) {
+        printf ( "conversion failed, changing bulk arg \"%s\" to %u\n",
+            argv[6], bulkBool );
+    }
+
+    return caConnRate ( argv[1], count, iterations,
+        appendNumberBool ? appendNumber : dontAppendNumber, timeout,
+        bulkBool != 0u );
+}
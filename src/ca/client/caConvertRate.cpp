@@ -0,0 +1,122 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measures the throughput of caNetConvert() for large arrays, which
+ * the client library and the IOC's server use for every response.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cadef.h"
+#include "dbDefs.h"
+#include "epicsTime.h"
+#include "net_convert.h"
+
+static const unsigned convertTypes[] = {
+    DBR_SHORT, DBR_LONG, DBR_FLOAT, DBR_DOUBLE, DBR_TIME_DOUBLE
+};
+
+/*
+ * Checks that the network format is big endian, and that converting
+ * it back restores the original
+ */
+static bool convertCheck ( chtype type, const epicsUInt8 *pHost,
+    epicsUInt8 *pNet, epicsUInt8 *pBack, arrayElementCount count )
+{
+    unsigned size = dbr_value_size[type];
+    unsigned offset = dbr_value_offset[type];
+    unsigned total = dbr_size_n ( type, count );
+
+    caNetConvert ( type, pHost, pNet, true, count );
+    memcpy ( pBack, pNet, total );
+    caNetConvert ( type, pBack, pBack, false, count );
+    if ( memcmp ( pHost + offset, pBack + offset, total - offset ) ) {
+        return false;
+    }
+
+    static const epicsUInt16 one = 1u;
+    bool littleEndian = *reinterpret_cast < const epicsUInt8 * > ( &one );
+    for ( arrayElementCount i = 0u; i < count; i++ ) {
+        const epicsUInt8 *pH = pHost + offset + i * size;
+        const epicsUInt8 *pN = pNet + offset + i * size;
+        for ( unsigned j = 0u; j < size; j++ ) {
+            if ( pN[j] != pH[littleEndian ? size - 1u - j : j] ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static double convertRate ( chtype type, const epicsUInt8 *pSrc,
+    epicsUInt8 *pDest, int hton, arrayElementCount count,
+    unsigned iterations )
+{
+    epicsTime begin = epicsTime::getCurrent ();
+    for ( unsigned i = 0u; i < iterations; i++ ) {
+        caNetConvert ( type, pSrc, pDest, hton, count );
+    }
+    double delay = epicsTime::getCurrent () - begin;
+    return delay > 0.0 ? 
+        dbr_size_n ( type, count ) * iterations / delay / 1e6 : 0.0;
+}
+
+static double copyRate ( const epicsUInt8 *pSrc, epicsUInt8 *pDest,
+    unsigned nBytes, unsigned iterations )
+{
+    epicsTime begin = epicsTime::getCurrent ();
+    for ( unsigned i = 0u; i < iterations; i++ ) {
+        memcpy ( pDest, pSrc, nBytes );
+    }
+    double delay = epicsTime::getCurrent () - begin;
+    return delay > 0.0 ? 
+        static_cast < double > ( nBytes ) * iterations / delay / 1e6 : 0.0;
+}
+
+/*
+ * caConvertRate ()
+ */
+int caConvertRate ( unsigned count, unsigned iterations )
+{
+    unsigned maxBytes = dbr_size_n ( DBR_TIME_DOUBLE, count );
+    epicsUInt8 * pHost = new epicsUInt8 [ maxBytes ];
+    epicsUInt8 * pNet = new epicsUInt8 [ maxBytes ];
+    epicsUInt8 * pBack = new epicsUInt8 [ maxBytes ];
+    int status = 0;
+
+    for ( unsigned i = 0u; i < maxBytes; i++ ) {
+        pHost[i] = static_cast < epicsUInt8 > ( i * 7u + ( i >> 8 ) );
+    }
+
+    printf ( "Converting arrays of %u elements %u times (MB/s)\n",
+        count, iterations );
+    printf ( "%-16s %12s %12s %12s\n", "Type", "in place", "to network",
+        "memcpy" );
+    for ( unsigned i = 0u; i < NELEMENTS ( convertTypes ); i++ ) {
+        chtype type = static_cast < chtype > ( convertTypes[i] );
+        if ( ! convertCheck ( type, pHost, pNet, pBack, count ) ) {
+            printf ( "%-16s conversion is wrong\n", dbr_type_to_text ( type ) );
+            status = -1;
+            continue;
+        }
+        double inPlace = convertRate ( type, pBack, pBack, false,
+            count, iterations );
+        double toNet = convertRate ( type, pHost, pNet, true,
+            count, iterations );
+        double copy = copyRate ( pHost, pNet, dbr_size_n ( type, count ),
+            iterations );
+        printf ( "%-16s %12.1f %12.1f %12.1f\n", dbr_type_to_text ( type ),
+            inPlace, toNet, copy );
+    }
+
+    delete [] pHost;
+    delete [] pNet;
+    delete [] pBack;
+    return status;
+}
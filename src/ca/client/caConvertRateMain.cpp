@@ -0,0 +1,32 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int caConvertRate ( unsigned count, unsigned iterations );
+
+int main ( int argc, char **argv )
+{
+    unsigned count = 1000000u;
+    unsigned iterations = 100u;
+
+    if ( argc > 3 ) {
+        fprintf ( stderr, "usage: %s [element count] [iterations]\n", argv[0] );
+        return 0;
+    }
+    if ( argc >= 2 && sscanf ( argv[1], " %u ", & count ) != 1 ) {
+        fprintf ( stderr, "expected unsigned integer 1st argument\n" );
+        return 0;
+    }
+    if ( argc == 3 && sscanf ( argv[2], " %u ", & iterations ) != 1 ) {
+        fprintf ( stderr, "expected unsigned integer 2nd argument\n" );
+        return 0;
+    }
+
+    return caConvertRate ( count, iterations ) ? 1 : 0;
+}
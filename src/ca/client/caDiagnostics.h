@@ -18,12 +18,17 @@ extern "C" {
 #endif
 
 enum appendNumberFlag {appendNumber, dontAppendNumber};
-int catime ( const char *channelName, unsigned channelCount, enum appendNumberFlag appNF );
+int catime ( const char *channelName, unsigned channelCount, 
+            enum appendNumberFlag appNF, unsigned threadCount );
 
 int acctst ( const char *pname, unsigned logggingInterestLevel, 
             unsigned channelCount, unsigned repetitionCount, 
             enum ca_preemptive_callback_select select );
 
+int caConnRate ( const char *pName, unsigned channelCount, 
+            unsigned iterations, enum appendNumberFlag appNF, 
+            double timeout, int bulk );
+
 #define CATIME_OK 0
 #define CATIME_ERROR -1
 
@@ -0,0 +1,185 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Compares monitor updates per second and their latency through the
+ * local transport with those through the loopback TCP circuit.  The
+ * process variable is written as fast as its updates come back, with
+ * a sequence number in its first element, and the latency is measured
+ * from the time stamp of the record, which is set by the IOC on the
+ * same host.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cadef.h"
+#include "dbDefs.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsTime.h"
+#include "envDefs.h"
+
+struct localRateState {
+    epicsMutexId lock;
+    epicsEventId update;
+    double lastSequence;
+    unsigned long updateCount;
+    double latencySum;
+    double latencyMax;
+};
+
+extern "C" void localRateCallBack ( struct event_handler_args args )
+{
+    localRateState *pState = static_cast < localRateState * > ( args.usr );
+    if ( args.status != ECA_NORMAL ) {
+        return;
+    }
+    const struct dbr_time_double *pValue =
+        static_cast < const struct dbr_time_double * > ( args.dbr );
+    double latency = epicsTime::getCurrent () - epicsTime ( pValue->stamp );
+
+    epicsMutexMustLock ( pState->lock );
+    pState->lastSequence = pValue->value;
+    pState->updateCount++;
+    pState->latencySum += latency;
+    if ( latency > pState->latencyMax ) {
+        pState->latencyMax = latency;
+    }
+    epicsMutexUnlock ( pState->lock );
+    epicsEventSignal ( pState->update );
+}
+
+static double localRateSequence ( localRateState & state )
+{
+    epicsMutexMustLock ( state.lock );
+    double sequence = state.lastSequence;
+    epicsMutexUnlock ( state.lock );
+    return sequence;
+}
+
+static bool localRateMeasure ( const char *pName, unsigned count,
+    double seconds, unsigned window, bool local )
+{
+    const char *pTransport = local ? "local" : "TCP";
+    epicsEnvSet ( EPICS_CA_LOCAL_TRANSPORT.name, local ? "YES" : "NO" );
+
+    int status = ca_context_create ( ca_enable_preemptive_callback );
+    SEVCHK ( status, NULL );
+
+    chid chan;
+    status = ca_create_channel ( pName, 0, 0, CA_PRIORITY_DEFAULT, & chan );
+    SEVCHK ( status, NULL );
+    status = ca_pend_io ( 10.0 );
+    if ( status != ECA_NORMAL ) {
+        fprintf ( stderr, "Channel \"%s\" not found.\n", pName );
+        ca_context_destroy ();
+        return false;
+    }
+
+    unsigned long nElem = ca_element_count ( chan );
+    if ( count > 0u && count < nElem ) {
+        nElem = count;
+    }
+    double *pValues = static_cast < double * >
+        ( calloc ( nElem, sizeof ( double ) ) );
+
+    localRateState state;
+    state.lock = epicsMutexMustCreate ();
+    state.update = epicsEventMustCreate ( epicsEventEmpty );
+    state.lastSequence = -1.0;
+    state.updateCount = 0u;
+    state.latencySum = 0.0;
+    state.latencyMax = 0.0;
+
+    evid id;
+    status = ca_create_subscription ( DBR_TIME_DOUBLE, nElem, chan,
+        DBE_VALUE, localRateCallBack, & state, & id );
+    SEVCHK ( status, NULL );
+    status = ca_flush_io ();
+    SEVCHK ( status, NULL );
+
+    // let the initial value go by
+    while ( localRateSequence ( state ) < 0.0 ) {
+        if ( epicsEventWaitWithTimeout ( state.update, 10.0 ) != epicsEventWaitOK ) {
+            fprintf ( stderr, "No initial value for \"%s\".\n", pName );
+            break;
+        }
+    }
+
+    epicsMutexMustLock ( state.lock );
+    state.updateCount = 0u;
+    state.latencySum = 0.0;
+    state.latencyMax = 0.0;
+    epicsMutexUnlock ( state.lock );
+
+    // keep up to window writes in flight, flushing them in halves
+    unsigned burst = window > 1u ? window / 2u : 1u;
+    double sequence = 0.0;
+    epicsTime begin = epicsTime::getCurrent ();
+    while ( epicsTime::getCurrent () - begin < seconds ) {
+        if ( sequence - localRateSequence ( state ) > window - burst ) {
+            epicsEventWaitWithTimeout ( state.update, 1.0 );
+            continue;
+        }
+        for ( unsigned i = 0u; i < burst; i++ ) {
+            pValues[0] = ++sequence;
+            status = ca_array_put ( DBR_DOUBLE, nElem, chan, pValues );
+            SEVCHK ( status, NULL );
+        }
+        status = ca_flush_io ();
+        SEVCHK ( status, NULL );
+    }
+    while ( localRateSequence ( state ) < sequence ) {
+        if ( epicsEventWaitWithTimeout ( state.update, 5.0 ) != epicsEventWaitOK ) {
+            break;
+        }
+    }
+    epicsTime end = epicsTime::getCurrent ();
+
+    status = ca_clear_subscription ( id );
+    SEVCHK ( status, NULL );
+
+    epicsMutexMustLock ( state.lock );
+    unsigned long updates = state.updateCount;
+    double latencySum = state.latencySum;
+    double latencyMax = state.latencyMax;
+    epicsMutexUnlock ( state.lock );
+
+    double period = end - begin;
+    printf ( "%-5s %9.0f writes %9lu updates of %lu elements in %.3f sec\n",
+        pTransport, sequence, updates, nElem, period );
+    printf ( "      %9.0f updates/sec, latency mean %.1f max %.1f usec\n",
+        updates / period,
+        updates ? 1e6 * latencySum / updates : 0.0, 1e6 * latencyMax );
+
+    ca_context_destroy ();
+    epicsEventDestroy ( state.update );
+    epicsMutexDestroy ( state.lock );
+    free ( pValues );
+    return true;
+}
+
+/*
+ * caLocalRate ()
+ */
+int caLocalRate ( const char *pName, unsigned count, double seconds,
+    unsigned window )
+{
+    if ( window == 0u ) {
+        window = 1u;
+    }
+    printf ( "Writing \"%s\" with %u writes in flight for %g sec "
+        "through each transport.\n", pName, window, seconds );
+    if ( ! localRateMeasure ( pName, count, seconds, window, false ) ) {
+        return -1;
+    }
+    if ( ! localRateMeasure ( pName, count, seconds, window, true ) ) {
+        return -1;
+    }
+    return 0;
+}
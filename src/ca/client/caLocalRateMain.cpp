@@ -0,0 +1,39 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int caLocalRate ( const char *pName, unsigned count, double seconds,
+    unsigned window );
+
+int main ( int argc, char **argv )
+{
+    unsigned count = 0u;
+    double seconds = 5.0;
+    unsigned window = 64u;
+
+    if ( argc < 2 || argc > 5 ) {
+        fprintf ( stderr, "usage: %s < PV name > [element count] "
+            "[seconds] [writes in flight]\n", argv[0] );
+        return 0;
+    }
+    if ( argc >= 3 && sscanf ( argv[2], " %u ", & count ) != 1 ) {
+        fprintf ( stderr, "expected unsigned integer 2nd argument\n" );
+        return 0;
+    }
+    if ( argc >= 4 && sscanf ( argv[3], " %lf ", & seconds ) != 1 ) {
+        fprintf ( stderr, "expected floating point 3rd argument\n" );
+        return 0;
+    }
+    if ( argc == 5 && sscanf ( argv[4], " %u ", & window ) != 1 ) {
+        fprintf ( stderr, "expected unsigned integer 4th argument\n" );
+        return 0;
+    }
+
+    return caLocalRate ( argv[1], count, seconds, window ) ? 1 : 0;
+}
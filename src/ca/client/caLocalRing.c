@@ -0,0 +1,379 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Shared memory byte ring of the CA local transport, see caLocalRing.h.
+ *
+ *  Both ends keep their own position privately and only read the
+ *  position of the other end from the shared page, so a damaged ring
+ *  can garble the data but never make either end access memory
+ *  outside of it.  The positions are free running byte counts, the
+ *  size of the ring is a power of two.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+#   include <unistd.h>
+#   include <fcntl.h>
+#   include <time.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/syscall.h>
+#   include <linux/futex.h>
+#   if defined(SYS_memfd_create) && defined(MFD_ALLOW_SEALING) && \
+        defined(F_ADD_SEALS) && defined(SYS_futex)
+#       define CA_HAVE_LOCAL_RING
+#   endif
+#endif
+
+#include "epicsAtomic.h"
+
+#define epicsExportSharedSymbols
+#include "caLocalRing.h"
+
+#ifdef CA_HAVE_LOCAL_RING
+
+#define RING_MAGIC      0x43414c52u     /* "CALR" */
+#define RING_MIN_SIZE   0x1000u
+#define RING_MAX_SIZE   0x40000000u
+#define CACHE_LINE      64
+
+/*
+ * The page in front of the data.  The fields written by each
+ * end are on a cache line of their own.
+ */
+typedef struct ringShared {
+    epicsUInt32 magic;
+    epicsUInt32 size;
+    epicsUInt32 cookie[2];
+    char        padId[CACHE_LINE - 4 * sizeof ( epicsUInt32 )];
+    size_t      head;           /* bytes put, written by the writer */
+    int         readerIdle;     /* set by the reader, cleared by the writer */
+    char        padPut[CACHE_LINE - sizeof ( size_t ) - sizeof ( int )];
+    size_t      tail;           /* bytes got, written by the reader */
+    int         writerWaiting;  /* futex, set by the writer */
+    char        padGet[CACHE_LINE - sizeof ( size_t ) - sizeof ( int )];
+} ringShared;
+
+struct caLocalRing {
+    ringShared      *pShared;
+    char            *pData;
+    size_t          mapSize;
+    size_t          pos;        /* head for the writer, tail for the reader */
+    unsigned        size;
+    int             fd;
+    int             writer;
+};
+
+static caLocalRing * ringMap ( int fd, size_t mapSize, int writer )
+{
+    caLocalRing *pRing = calloc ( 1, sizeof ( *pRing ) );
+    void *pMap;
+
+    if ( ! pRing ) {
+        return NULL;
+    }
+    pMap = mmap ( NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if ( pMap == MAP_FAILED ) {
+        free ( pRing );
+        return NULL;
+    }
+    pRing->pShared = ( ringShared * ) pMap;
+    pRing->pData = ( char * ) pMap + sizeof ( ringShared );
+    pRing->mapSize = mapSize;
+    pRing->fd = fd;
+    pRing->writer = writer;
+    return pRing;
+}
+
+caLocalRing * caLocalRingCreate ( unsigned nbytes,
+    const epicsUInt32 cookie[2] )
+{
+    caLocalRing *pRing;
+    ringShared *pShared;
+    unsigned size = RING_MIN_SIZE;
+    size_t mapSize;
+    int fd;
+
+    if ( nbytes > RING_MAX_SIZE ) {
+        nbytes = RING_MAX_SIZE;
+    }
+    while ( size < nbytes ) {
+        size <<= 1;
+    }
+    mapSize = sizeof ( ringShared ) + size;
+
+    fd = ( int ) syscall ( SYS_memfd_create, "CA local ring",
+        MFD_CLOEXEC | MFD_ALLOW_SEALING );
+    if ( fd < 0 ) {
+        return NULL;
+    }
+    /* the client mustn't be able to shrink it under our feet */
+    if ( ftruncate ( fd, ( off_t ) mapSize ) < 0 ||
+         fcntl ( fd, F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL ) < 0 ) {
+        close ( fd );
+        return NULL;
+    }
+    pRing = ringMap ( fd, mapSize, 1 );
+    if ( ! pRing ) {
+        close ( fd );
+        return NULL;
+    }
+    pRing->size = size;
+
+    pShared = pRing->pShared;
+    pShared->size = size;
+    pShared->cookie[0] = cookie[0];
+    pShared->cookie[1] = cookie[1];
+    pShared->head = 0u;
+    pShared->tail = 0u;
+    /* so that the first put wakes up the reader */
+    pShared->readerIdle = 1;
+    pShared->writerWaiting = 0;
+    epicsAtomicWriteMemoryBarrier ();
+    pShared->magic = RING_MAGIC;
+    return pRing;
+}
+
+void caLocalRingLocation ( const caLocalRing *pRing,
+    unsigned long *pPid, int *pFd )
+{
+    *pPid = ( unsigned long ) getpid ();
+    *pFd = pRing->fd;
+}
+
+caLocalRing * caLocalRingAttach ( unsigned long pid, int fd,
+    const epicsUInt32 cookie[2] )
+{
+    caLocalRing *pRing;
+    ringShared *pShared;
+    struct stat st;
+    char path[64];
+    int myFd, seals;
+
+    sprintf ( path, "/proc/%lu/fd/%d", pid, fd );
+    myFd = open ( path, O_RDWR | O_CLOEXEC );
+    if ( myFd < 0 ) {
+        return NULL;
+    }
+    seals = fcntl ( myFd, F_GET_SEALS );
+    if ( seals < 0 || ! ( seals & F_SEAL_SHRINK ) ||
+         fstat ( myFd, &st ) < 0 ||
+         st.st_size < ( off_t ) ( sizeof ( ringShared ) + RING_MIN_SIZE ) ) {
+        close ( myFd );
+        return NULL;
+    }
+    pRing = ringMap ( myFd, ( size_t ) st.st_size, 0 );
+    if ( ! pRing ) {
+        close ( myFd );
+        return NULL;
+    }
+
+    pShared = pRing->pShared;
+    pRing->size = pShared->size;
+    pRing->pos = epicsAtomicGetSizeT ( &pShared->tail );
+    if ( pShared->magic != RING_MAGIC ||
+         pShared->cookie[0] != cookie[0] ||
+         pShared->cookie[1] != cookie[1] ||
+         pRing->size < RING_MIN_SIZE ||
+         ( pRing->size & ( pRing->size - 1u ) ) ||
+         pRing->size > pRing->mapSize - sizeof ( ringShared ) ) {
+        caLocalRingDelete ( pRing );
+        return NULL;
+    }
+    return pRing;
+}
+
+void caLocalRingDelete ( caLocalRing *pRing )
+{
+    if ( pRing ) {
+        munmap ( ( void * ) pRing->pShared, pRing->mapSize );
+        close ( pRing->fd );
+        free ( pRing );
+    }
+}
+
+unsigned caLocalRingPut ( caLocalRing *pRing,
+    const void *pBuf, unsigned nbytes )
+{
+    ringShared *pShared = pRing->pShared;
+    size_t used = pRing->pos - epicsAtomicGetSizeT ( &pShared->tail );
+    unsigned offset, first;
+
+    if ( used >= pRing->size ) {
+        return 0u;
+    }
+    /* the reader is done with the bytes before the tail */
+    epicsAtomicReadMemoryBarrier ();
+    if ( nbytes > pRing->size - used ) {
+        nbytes = ( unsigned ) ( pRing->size - used );
+    }
+    offset = ( unsigned ) ( pRing->pos & ( pRing->size - 1u ) );
+    first = pRing->size - offset;
+    if ( first > nbytes ) {
+        first = nbytes;
+    }
+    memcpy ( pRing->pData + offset, pBuf, first );
+    memcpy ( pRing->pData, ( const char * ) pBuf + first, nbytes - first );
+    pRing->pos += nbytes;
+    epicsAtomicWriteMemoryBarrier ();
+    epicsAtomicSetSizeT ( &pShared->head, pRing->pos );
+    return nbytes;
+}
+
+int caLocalRingWakeupNeeded ( caLocalRing *pRing )
+{
+    return epicsAtomicCmpAndSwapIntT ( &pRing->pShared->readerIdle, 1, 0 ) == 1;
+}
+
+void caLocalRingWaitForSpace ( caLocalRing *pRing, double delay )
+{
+    ringShared *pShared = pRing->pShared;
+    struct timespec ts;
+
+    epicsAtomicSetIntT ( &pShared->writerWaiting, 1 );
+    epicsAtomicWriteMemoryBarrier ();
+    if ( pRing->pos - epicsAtomicGetSizeT ( &pShared->tail ) < pRing->size ) {
+        return;
+    }
+    ts.tv_sec = ( time_t ) delay;
+    ts.tv_nsec = ( long ) ( ( delay - ts.tv_sec ) * 1e9 );
+    syscall ( SYS_futex, &pShared->writerWaiting, FUTEX_WAIT, 1, &ts, NULL, 0 );
+}
+
+unsigned caLocalRingGet ( caLocalRing *pRing, void *pBuf, unsigned nbytes )
+{
+    ringShared *pShared = pRing->pShared;
+    size_t used = epicsAtomicGetSizeT ( &pShared->head ) - pRing->pos;
+    unsigned offset, first;
+
+    if ( used == 0u ) {
+        return 0u;
+    }
+    epicsAtomicReadMemoryBarrier ();
+    if ( used > pRing->size ) {
+        used = pRing->size;
+    }
+    if ( nbytes > used ) {
+        nbytes = ( unsigned ) used;
+    }
+    offset = ( unsigned ) ( pRing->pos & ( pRing->size - 1u ) );
+    first = pRing->size - offset;
+    if ( first > nbytes ) {
+        first = nbytes;
+    }
+    memcpy ( pBuf, pRing->pData + offset, first );
+    memcpy ( ( char * ) pBuf + first, pRing->pData, nbytes - first );
+    pRing->pos += nbytes;
+    epicsAtomicWriteMemoryBarrier ();
+    epicsAtomicSetSizeT ( &pShared->tail, pRing->pos );
+
+    if ( epicsAtomicCmpAndSwapIntT ( &pShared->writerWaiting, 1, 0 ) == 1 ) {
+        syscall ( SYS_futex, &pShared->writerWaiting, FUTEX_WAKE, 1,
+            NULL, NULL, 0 );
+    }
+    return nbytes;
+}
+
+int caLocalRingIdle ( caLocalRing *pRing )
+{
+    ringShared *pShared = pRing->pShared;
+
+    epicsAtomicSetIntT ( &pShared->readerIdle, 1 );
+    epicsAtomicWriteMemoryBarrier ();
+    if ( epicsAtomicGetSizeT ( &pShared->head ) != pRing->pos ) {
+        /* if this fails the wakeup is already on its way */
+        epicsAtomicCmpAndSwapIntT ( &pShared->readerIdle, 1, 0 );
+        return 0;
+    }
+    return 1;
+}
+
+unsigned caLocalRingUsedBytes ( const caLocalRing *pRing )
+{
+    const ringShared *pShared = pRing->pShared;
+    size_t used;
+
+    if ( pRing->writer ) {
+        used = pRing->pos - epicsAtomicGetSizeT ( &pShared->tail );
+    }
+    else {
+        used = epicsAtomicGetSizeT ( &pShared->head ) - pRing->pos;
+    }
+    return used > pRing->size ? pRing->size : ( unsigned ) used;
+}
+
+unsigned caLocalRingSize ( const caLocalRing *pRing )
+{
+    return pRing->size;
+}
+
+#else /* CA_HAVE_LOCAL_RING */
+
+caLocalRing * caLocalRingCreate ( unsigned nbytes,
+    const epicsUInt32 cookie[2] )
+{
+    return NULL;
+}
+
+void caLocalRingLocation ( const caLocalRing *pRing,
+    unsigned long *pPid, int *pFd )
+{
+    *pPid = 0u;
+    *pFd = -1;
+}
+
+caLocalRing * caLocalRingAttach ( unsigned long pid, int fd,
+    const epicsUInt32 cookie[2] )
+{
+    return NULL;
+}
+
+void caLocalRingDelete ( caLocalRing *pRing )
+{
+}
+
+unsigned caLocalRingPut ( caLocalRing *pRing,
+    const void *pBuf, unsigned nbytes )
+{
+    return 0u;
+}
+
+int caLocalRingWakeupNeeded ( caLocalRing *pRing )
+{
+    return 0;
+}
+
+void caLocalRingWaitForSpace ( caLocalRing *pRing, double delay )
+{
+}
+
+unsigned caLocalRingGet ( caLocalRing *pRing, void *pBuf, unsigned nbytes )
+{
+    return 0u;
+}
+
+int caLocalRingIdle ( caLocalRing *pRing )
+{
+    return 1;
+}
+
+unsigned caLocalRingUsedBytes ( const caLocalRing *pRing )
+{
+    return 0u;
+}
+
+unsigned caLocalRingSize ( const caLocalRing *pRing )
+{
+    return 0u;
+}
+
+#endif /* CA_HAVE_LOCAL_RING */
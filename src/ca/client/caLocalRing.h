@@ -0,0 +1,85 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/*
+ *  Shared memory byte ring of the CA local transport.
+ *
+ *  A server writes the responses of one circuit into the ring, and a
+ *  client on the same host reads them from there instead of from the
+ *  TCP socket.  As with epicsRingBytes there is a single writer and a
+ *  single reader, so no lock is needed.  The ring lives in a sealed
+ *  memory file of the server that the client opens through /proc, so
+ *  this is only available on Linux.
+ *
+ *  The reader marks the ring idle before it blocks, and the writer
+ *  then has to tell it that bytes were put.  A writer that finds the
+ *  ring full can block until the reader has made space.
+ */
+
+#ifndef INCcaLocalRingh
+#define INCcaLocalRingh
+
+#include "shareLib.h"
+#include "epicsTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct caLocalRing caLocalRing;
+
+/*
+ * Creates a ring with nbytes (rounded up to a power of two) of space,
+ * tagged with the cookie.  Returns NULL if this isn't supported here.
+ */
+epicsShareFunc caLocalRing * caLocalRingCreate ( unsigned nbytes,
+    const epicsUInt32 cookie[2] );
+
+/* the process id and descriptor for the client to open the ring with */
+epicsShareFunc void caLocalRingLocation ( const caLocalRing *pRing,
+    unsigned long *pPid, int *pFd );
+
+/*
+ * Opens the ring behind file descriptor fd of process pid, and checks
+ * that it is the one tagged with cookie.  Returns NULL otherwise.
+ */
+epicsShareFunc caLocalRing * caLocalRingAttach ( unsigned long pid,
+    int fd, const epicsUInt32 cookie[2] );
+
+epicsShareFunc void caLocalRingDelete ( caLocalRing *pRing );
+
+/* writer: copies as much as fits, returns the number of bytes put */
+epicsShareFunc unsigned caLocalRingPut ( caLocalRing *pRing,
+    const void *pBuf, unsigned nbytes );
+
+/*
+ * writer: true if the reader marked the ring idle, it is then
+ * unmarked and the caller must wake up the reader
+ */
+epicsShareFunc int caLocalRingWakeupNeeded ( caLocalRing *pRing );
+
+/* writer: waits up to delay seconds for space in a full ring */
+epicsShareFunc void caLocalRingWaitForSpace ( caLocalRing *pRing,
+    double delay );
+
+/* reader: copies out up to nbytes, returns the number of bytes got */
+epicsShareFunc unsigned caLocalRingGet ( caLocalRing *pRing,
+    void *pBuf, unsigned nbytes );
+
+/*
+ * reader: marks the ring idle, returns true if it is still empty
+ * so that the reader may block until the writer wakes it up
+ */
+epicsShareFunc int caLocalRingIdle ( caLocalRing *pRing );
+
+epicsShareFunc unsigned caLocalRingUsedBytes ( const caLocalRing *pRing );
+epicsShareFunc unsigned caLocalRingSize ( const caLocalRing *pRing );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCcaLocalRingh */
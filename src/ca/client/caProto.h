@@ -43,6 +43,8 @@
 #   define CA_V411(MINOR) ((MINOR)>=11u)  /* sequence numbers in UDP version command */
 #   define CA_V412(MINOR) ((MINOR)>=12u)  /* TCP-based search requests */
 #   define CA_V413(MINOR) ((MINOR)>=13u)  /* Allow zero length in requests. */
+#   define CA_V414(MINOR) ((MINOR)>=14u)  /* compressed array responses */
+#   define CA_V415(MINOR) ((MINOR)>=15u)  /* shared memory local transport */
 
 /*
  * These port numbers are only used if the CA repeater and 
@@ -109,8 +111,42 @@ typedef ca_uint32_t     caResId;
 #define CA_PROTO_SIGNAL         25u /* knock the server out of select */
 #define CA_PROTO_CREATE_CH_FAIL 26u /* unable to create chan resource in server */
 #define CA_PROTO_SERVER_DISCONN 27u /* server deletes PV (or channel) */
+#define CA_PROTO_COMPRESSED     28u /* CA V4.14 compressed read or event response */
+#define CA_PROTO_LOCAL          29u /* CA V4.15 shared memory local transport */
 
-#define CA_PROTO_LAST_CMMD CA_PROTO_SERVER_DISCONN
+#define CA_PROTO_LAST_CMMD CA_PROTO_LOCAL
+
+/*
+ * Capabilities requested by the client in the m_cid field
+ * of its CA_PROTO_VERSION message (CA V4.14)
+ */
+#define CA_PROTO_VERSION_COMPRESS (1u<<0u)
+#define CA_PROTO_VERSION_LOCAL    (1u<<1u) /* CA V4.15 */
+
+/*
+ * A CA_PROTO_COMPRESSED message carries the encoding in m_dataType and
+ * the number of compressed bytes in m_cid.  Its payload is the header
+ * of the original response, the part of the original payload in front
+ * of the value array, and then the compressed value array.
+ */
+#define CA_COMPRESS_LZ4         1u /* LZ4 block */
+#define CA_COMPRESS_DELTA_LZ4   2u /* integer deltas, then LZ4 block */
+
+/*
+ * The step of the local transport setup is in m_dataType of a
+ * CA_PROTO_LOCAL message.  A server on the same host as a client that
+ * asked for it offers a shared memory ring, with its process id in
+ * m_cid, the descriptor of the ring in m_available and the 8 byte
+ * cookie of the ring as the payload.  Once the client has attached,
+ * the server sends the switch message over TCP, and all its later
+ * responses through the ring.  From then on it only sends the wakeup
+ * message over TCP, when the client waits for an empty ring.
+ */
+#define CA_LOCAL_OFFER          1u /* server offers a ring */
+#define CA_LOCAL_ATTACH         2u /* client uses the ring */
+#define CA_LOCAL_DECLINE        3u /* client can't use the ring */
+#define CA_LOCAL_SWITCH         4u /* server now sends through the ring */
+#define CA_LOCAL_WAKEUP         5u /* server has put bytes into the ring */
 
 /*
  * for use with search and not_found (if search fails and
@@ -29,6 +29,7 @@
 #include <stdexcept>
 #include <string> // vxWorks 6.0 requires this include
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "epicsExit.h"
 #include "errlog.h"
@@ -67,6 +68,8 @@ cacService * ca_client_context::pDefaultService = 0;
 epicsMutex * ca_client_context::pDefaultServiceInstallMutex;
 
 ca_client_context::ca_client_context ( bool enablePreemptiveCallback ) :
+    pLatestDelivering ( 0 ), pLatestOrphan ( 0 ), latestDelivered ( 0.0 ),
+    latestReplaced ( 0.0 ), latestMaxDelay ( 0.0 ), latestOnlyCount ( 0u ),
     createdByThread ( epicsThreadGetIdSelf () ),
     ca_exception_func ( 0 ), ca_exception_arg ( 0 ),
     pVPrintfFunc ( errlogVprintf ), fdRegFunc ( 0 ), fdRegArg ( 0 ),
@@ -190,6 +193,13 @@ ca_client_context::~ca_client_context ()
     else {
         this->pServiceContext.reset ( 0 );
     }
+
+    while ( oldChannelBatch * pBatch = this->connBatchPending.get () ) {
+        delete pBatch;
+    }
+    while ( oldChannelBatch * pBatch = this->connBatchIdle.get () ) {
+        delete pBatch;
+    }
 }
 
 void ca_client_context::destroyGetCopy (
@@ -220,6 +230,17 @@ void ca_client_context::destroySubscription (
     epicsGuard < epicsMutex > & guard, oldSubscription & os )
 {
     guard.assertIdenticalMutex ( this->mutex );
+    if ( os.latestQueued () ) {
+        this->latestPending.remove ( os );
+    }
+    if ( & os == this->pLatestDelivering ) {
+        // canceled by its own callback, which is still using the value
+        this->pLatestOrphan = os.latestRelease ();
+        this->pLatestDelivering = 0;
+    }
+    if ( os.latestOnly () ) {
+        this->latestOnlyCount--;
+    }
     os.~oldSubscription ();
     this->subscriptionFreeList.release ( & os );
 }
@@ -430,6 +451,13 @@ void ca_client_context::show ( unsigned level ) const
                 this->pndRecvCnt );
         ::printf ( "\tthe current io sequence number is %u\n",
                 this->ioSeqNo );
+        if ( this->latestOnlyCount ) {
+            ::printf ( "\t%u latest value only subscriptions, %u updates "
+                "pending, %.0f delivered, %.0f replaced, max delay %f sec\n",
+                this->latestOnlyCount, this->latestPending.count (),
+                this->latestDelivered, this->latestReplaced,
+                this->latestMaxDelay );
+        }
         ::printf ( "IO done event:\n");
         this->ioDone.show ( level - 1u );
         ::printf ( "Synchronous group identifier hash table:\n" );
@@ -673,6 +701,170 @@ void ca_client_context::flush ( epicsGuard < epicsMutex > & guard )
     this->pServiceContext->flush ( guard );
 }
 
+void ca_client_context::reserveChannels (
+    epicsGuard < epicsMutex > & guard, unsigned count )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    this->pServiceContext->reserveChannels ( guard, count );
+}
+
+oldChannelBatch & ca_client_context::createConnectionBatch (
+    epicsGuard < epicsMutex > & guard, caChBatch * pFunc,
+    void * pPrivate, unsigned count )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    oldChannelBatch * pBatch = new oldChannelBatch ( pFunc, pPrivate, count );
+    this->connBatchIdle.add ( *pBatch );
+    return *pBatch;
+}
+
+void ca_client_context::connectionBatchPost (
+    epicsGuard < epicsMutex > & guard, oldChannelBatch & batch,
+    oldChannelNotify & chan, long op )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    if ( batch.post ( chan, op ) && ! batch.queued && ! batch.delivering ) {
+        this->connBatchIdle.remove ( batch );
+        this->connBatchPending.add ( batch );
+        batch.queued = true;
+    }
+}
+
+void ca_client_context::connectionBatchLeave (
+    epicsGuard < epicsMutex > & guard, oldChannelBatch & batch,
+    oldChannelNotify & chan )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    batch.leave ( chan );
+    if ( batch.unused () ) {
+        if ( batch.queued ) {
+            this->connBatchPending.remove ( batch );
+        }
+        else {
+            this->connBatchIdle.remove ( batch );
+        }
+        delete & batch;
+    }
+}
+
+//
+// called by the threads that change the connection state after they
+// have processed a burst of messages, so that each batch callback
+// sees all of the channels that changed state in that burst
+//
+void ca_client_context::connectionBatchNotify (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    while ( oldChannelBatch * pBatch = this->connBatchPending.get () ) {
+        pBatch->queued = false;
+        this->connBatchIdle.add ( *pBatch );
+        pBatch->deliver ( guard );
+        if ( pBatch->unused () ) {
+            this->connBatchIdle.remove ( *pBatch );
+            delete pBatch;
+        }
+    }
+}
+
+void ca_client_context::latestOnlyChange (
+    epicsGuard < epicsMutex > & guard, bool latestOnly )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    if ( latestOnly ) {
+        this->latestOnlyCount++;
+    }
+    else {
+        this->latestOnlyCount--;
+    }
+}
+
+void ca_client_context::latestPost ( epicsGuard < epicsMutex > & guard,
+    oldSubscription & os, bool replaced )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    if ( replaced ) {
+        this->latestReplaced++;
+    }
+    else {
+        this->latestPending.add ( os );
+    }
+}
+
+void ca_client_context::latestDrop ( epicsGuard < epicsMutex > & guard,
+    oldSubscription & os )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    this->latestPending.remove ( os );
+}
+
+bool ca_client_context::subscriptionBatchPending (
+    epicsGuard < epicsMutex > & guard ) const
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    return this->latestPending.count () > 0u;
+}
+
+//
+// called with the callback lock held by the receive threads once they
+// have no more responses waiting, so that each latest value only
+// subscription sees one update for all that arrived meanwhile
+//
+void ca_client_context::subscriptionBatchNotify (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    if ( this->latestPending.count () == 0u ) {
+        return;
+    }
+    epicsTime current = epicsTime::getCurrent ();
+    while ( oldSubscription * pSub = this->latestPending.get () ) {
+        this->latestDeliver ( guard, *pSub, current );
+    }
+}
+
+void ca_client_context::latestDeliver ( epicsGuard < epicsMutex > & guard,
+    oldSubscription & os, const epicsTime & current )
+{
+    double delay = current - os.latestArrival ();
+    if ( delay > this->latestMaxDelay ) {
+        this->latestMaxDelay = delay;
+    }
+    this->latestDelivered++;
+    this->pLatestDelivering = & os;
+    os.latestDeliver ( guard );
+    this->pLatestDelivering = 0;
+    if ( this->pLatestOrphan ) {
+        free ( this->pLatestOrphan );
+        this->pLatestOrphan = 0;
+    }
+}
+
+//
+// called with the callback lock held, a value still waiting is
+// delivered ahead of the updates that now go straight to the callback
+//
+void ca_client_context::latestOnlyOff (
+    epicsGuard < epicsMutex > & guard, oldSubscription & os )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    os.latestOnly ( guard, false );
+    if ( os.latestQueued () ) {
+        this->latestPending.remove ( os );
+        this->latestDeliver ( guard, os, epicsTime::getCurrent () );
+    }
+}
+
+void ca_client_context::backlog ( struct ca_backlog & report ) const
+{
+    epicsGuard < epicsMutex > guard ( this->mutex );
+    report.latestOnly = this->latestOnlyCount;
+    report.pending = this->latestPending.count ();
+    report.delivered = this->latestDelivered;
+    report.replaced = this->latestReplaced;
+    report.maxDelay = this->latestMaxDelay;
+}
+
 unsigned ca_client_context::circuitCount () const
 {
     epicsGuard < epicsMutex > guard ( this->mutex );
@@ -785,6 +977,27 @@ epicsShareFunc int epicsShareAPI ca_clear_subscription ( evid pMon )
     return ECA_NORMAL;
 }
 
+epicsShareFunc int epicsShareAPI ca_subscription_latest_only (
+    evid pMon, int latestOnly )
+{
+    ca_client_context & cac = pMon->channel ().getClientCtx ();
+    if ( latestOnly ) {
+        epicsGuard < epicsMutex > guard ( cac.mutex );
+        pMon->latestOnly ( guard, true );
+    }
+    else if ( cac.pCallbackGuard.get() &&
+        cac.createdByThread == epicsThreadGetIdSelf () ) {
+        epicsGuard < epicsMutex > guard ( cac.mutex );
+        cac.latestOnlyOff ( guard, *pMon );
+    }
+    else {
+        CallbackGuard cbGuard ( cac.cbMutex );
+        epicsGuard < epicsMutex > guard ( cac.mutex );
+        cac.latestOnlyOff ( guard, *pMon );
+    }
+    return ECA_NORMAL;
+}
+
 void ca_client_context :: eliminateExcessiveSendBacklog (
     epicsGuard < epicsMutex > & guard, cacChannel & chan )
 {
@@ -86,7 +86,10 @@ const cac::pProtoStubTCP cac::tcpJumpTableCAC [] =
     &cac::badTCPRespAction,
     &cac::badTCPRespAction,
     &cac::verifyAndDisconnectChan,
-    &cac::verifyAndDisconnectChan
+    &cac::verifyAndDisconnectChan,
+    // CA_PROTO_COMPRESSED is expanded before it gets here
+    &cac::badTCPRespAction,
+    &cac::localTransportAction
 };
 
 // TCP exception dispatch table
@@ -148,7 +151,9 @@ cac::cac (
     maxContigFrames ( contiguousMsgCountWhichTriggersFlowControl ),
     beaconAnomalyCount ( 0u ),
     iiuExistenceCount ( 0u ),
-    cacShutdownInProgress ( false )
+    cacShutdownInProgress ( false ),
+    compressArrays ( false ),
+    localTransport ( false )
 {
     if ( ! osiSockAttach () ) {
         throwWithLocation ( udpiiu :: noSocket () );
@@ -229,6 +234,15 @@ cac::cac (
                 throw std::bad_alloc ();
             }
         }
+        int compress;
+        if ( envGetBoolConfigParam ( &EPICS_CA_COMPRESS_ARRAYS, &compress ) == 0 ) {
+            this->compressArrays = compress != 0;
+        }
+        int local;
+        if ( envGetBoolConfigParam ( &EPICS_CA_LOCAL_TRANSPORT, &local ) == 0 ) {
+            this->localTransport = local != 0;
+        }
+
         unsigned bufsPerArray = this->maxRecvBytesTCP / comBuf::capacityBytes ();
         if ( bufsPerArray > 1u ) {
             maxContigFrames = bufsPerArray *
@@ -495,7 +509,7 @@ void cac::beaconNotify ( const inetAddrID & addr, const epicsTime & currentTime,
 
     this->beaconAnomalyCount++;
 
-    this->pudpiiu->beaconAnomalyNotify ( guard );
+    this->pudpiiu->beaconAnomalyNotify ( guard, addr );
 
 #   ifdef DEBUG
     {
@@ -533,6 +547,18 @@ cacChannel & cac::createChannel (
     return *pNetChan;
 }
 
+//
+// grow the channel table once, rather than many times while
+// the channels are installed
+//
+void cac::reserveChannels (
+    epicsGuard < epicsMutex > & guard, unsigned count )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    this->chanTable.setTableSize (
+        this->chanTable.numEntriesInstalled () + count );
+}
+
 bool cac::findOrCreateVirtCircuit (
     epicsGuard < epicsMutex > & guard, const osiSockAddr & addr,
     unsigned priority, tcpiiu *& piiu, unsigned minorVersionNumber,
@@ -589,7 +615,7 @@ void cac::transferChanToVirtCircuit (
     unsigned cid, unsigned sid,
     ca_uint16_t typeCode, arrayElementCount count,
     unsigned minorVersionNumber, const osiSockAddr & addr,
-    const epicsTime & currentTime )
+    const osiSockAddr & searchSource, const epicsTime & currentTime )
 {
     if ( addr.sa.sa_family != AF_INET ) {
         return;
@@ -650,6 +676,7 @@ void cac::transferChanToVirtCircuit (
     if ( piiu ) {
         piiu->installChannel (
             guard, *pChan, sid, typeCode, count );
+        pChan->setSearchHint ( guard, searchSource );
 
         if ( newIIU ) {
             piiu->start ( guard );
@@ -834,6 +861,12 @@ bool cac::versionAction ( callbackManager &, tcpiiu & iiu,
     return true;
 }
 
+bool cac::localTransportAction ( callbackManager &, tcpiiu & iiu,
+    const epicsTime &, const caHdrLargeArray & msg, void * pMsgBdy )
+{
+    return iiu.localTransportNotify ( msg, pMsgBdy );
+}
+
 bool cac::echoRespAction (
     callbackManager & mgr, tcpiiu & iiu,
     const epicsTime & /* current */, const caHdrLargeArray &, void * )
@@ -863,6 +896,14 @@ bool cac::writeNotifyRespAction (
 bool cac::readNotifyRespAction ( callbackManager &, tcpiiu & iiu,
     const epicsTime &, const caHdrLargeArray & hdr, void * pMsgBdy )
 {
+    /*
+     * convert the data buffer from net format to host format
+     * before taking the lock, it belongs to this thread and the
+     * other threads shouldn't wait while a large array is swapped
+     */
+    int convertStatus = caNetConvert (
+        hdr.m_dataType, pMsgBdy, pMsgBdy, false, hdr.m_count );
+
     epicsGuard < epicsMutex > guard ( this->mutex );
 
     /*
@@ -893,12 +934,7 @@ bool cac::readNotifyRespAction ( callbackManager &, tcpiiu & iiu,
             this->ioTable.add ( *pmiu );
         }
         if ( caStatus == ECA_NORMAL ) {
-            /*
-             * convert the data buffer from net
-             * format to host format
-             */
-            caStatus = caNetConvert (
-                hdr.m_dataType, pMsgBdy, pMsgBdy, false, hdr.m_count );
+            caStatus = convertStatus;
         }
         if ( caStatus == ECA_NORMAL ) {
             pmiu->completion ( guard, *this,
@@ -935,6 +971,13 @@ bool cac::eventRespAction ( callbackManager &, tcpiiu &iiu,
         return true;
     }
 
+    /*
+     * convert the data buffer from net format to host format
+     * before taking the lock, as for read responses
+     */
+    int convertStatus = caNetConvert (
+        hdr.m_dataType, pMsgBdy, pMsgBdy, false, hdr.m_count );
+
     epicsGuard < epicsMutex > guard ( this->mutex );
 
     /*
@@ -956,12 +999,8 @@ bool cac::eventRespAction ( callbackManager &, tcpiiu &iiu,
     //
     baseNMIU * pmiu = this->ioTable.lookup ( hdr.m_available );
     if ( pmiu ) {
-        /*
-         * convert the data buffer from net format to host format
-         */
         if ( caStatus == ECA_NORMAL ) {
-            caStatus = caNetConvert (
-                hdr.m_dataType, pMsgBdy, pMsgBdy, false, hdr.m_count );
+            caStatus = convertStatus;
         }
         if ( caStatus == ECA_NORMAL ) {
             pmiu->completion ( guard, *this,
@@ -1247,6 +1286,7 @@ void cac::destroyIIU ( tcpiiu & iiu )
 
         assert ( this->pudpiiu );
         iiu.disconnectAllChannels ( mgr.cbGuard, guard, *this->pudpiiu );
+        this->connectionNotifyFlush ( guard );
 
         this->serverTable.remove ( iiu );
         this->circuitList.remove ( iiu );
@@ -131,12 +131,20 @@ public:
         unsigned cid, unsigned sid,
         ca_uint16_t typeCode, arrayElementCount count,
         unsigned minorVersionNumber, const osiSockAddr &,
-        const epicsTime & currentTime );
+        const osiSockAddr & searchSource, const epicsTime & currentTime );
     cacChannel & createChannel (
         epicsGuard < epicsMutex > & guard, const char * pChannelName,
         cacChannelNotify &, cacChannel::priLev );
     void destroyChannel (
         epicsGuard < epicsMutex > &, nciu & );
+    void reserveChannels (
+        epicsGuard < epicsMutex > &, unsigned count );
+    void connectionNotifyFlush (
+        epicsGuard < epicsMutex > & );
+    bool subscriptionNotifyPending (
+        epicsGuard < epicsMutex > & ) const;
+    void subscriptionNotifyFlush (
+        epicsGuard < epicsMutex > & );
     void initiateConnect (
         epicsGuard < epicsMutex > &, nciu &, netiiu * & );
     nciu * lookupChannel (
@@ -276,6 +284,8 @@ private:
     unsigned short _serverPort;
     unsigned iiuExistenceCount;
     bool cacShutdownInProgress;
+    bool compressArrays;
+    bool localTransport;
 
     void recycleReadNotifyIO (
         epicsGuard < epicsMutex > &, netReadNotifyIO &io );
@@ -321,6 +331,8 @@ private:
         const epicsTime & currentTime, const caHdrLargeArray &, void *pMsgBdy );
     bool verifyAndDisconnectChan ( callbackManager &, tcpiiu &,
         const epicsTime & currentTime, const caHdrLargeArray &, void *pMsgBdy );
+    bool localTransportAction ( callbackManager &, tcpiiu &,
+        const epicsTime & currentTime, const caHdrLargeArray &, void *pMsgBdy );
     bool badTCPRespAction ( callbackManager &, tcpiiu &,
         const epicsTime & currentTime, const caHdrLargeArray &, void *pMsgBdy );
 
@@ -377,6 +389,27 @@ inline int cac :: varArgsPrintFormated (
     return this->notify.varArgsPrintFormated ( pformat, args );
 }
 
+inline void cac::connectionNotifyFlush (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    this->notify.connectionBatchNotify ( guard );
+}
+
+inline bool cac::subscriptionNotifyPending (
+    epicsGuard < epicsMutex > & guard ) const
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    return this->notify.subscriptionBatchPending ( guard );
+}
+
+inline void cac::subscriptionNotifyFlush (
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    this->notify.subscriptionBatchNotify ( guard );
+}
+
 inline void cac::attachToClientCtx ()
 {
     this->notify.attachToClientCtx ();
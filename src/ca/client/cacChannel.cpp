@@ -140,6 +140,10 @@ const char * cacChannel::pHostName (
 
 cacContext::~cacContext () {}
 
+void cacContext::reserveChannels ( epicsGuard < epicsMutex > &, unsigned )
+{
+}
+
 cacService::~cacService () {}
 
 
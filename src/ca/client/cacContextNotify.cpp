@@ -39,5 +39,19 @@ void cacContextNotify::callbackProcessingCompleteNotify ()
 {
 }
 
+void cacContextNotify::connectionBatchNotify ( epicsGuard < epicsMutex > & )
+{
+}
+
+bool cacContextNotify::subscriptionBatchPending (
+    epicsGuard < epicsMutex > & ) const
+{
+    return false;
+}
+
+void cacContextNotify::subscriptionBatchNotify ( epicsGuard < epicsMutex > & )
+{
+}
+
 
 
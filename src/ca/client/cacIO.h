@@ -294,6 +294,9 @@ public:
         epicsGuard < epicsMutex > & ) const = 0;
     virtual void show (
         epicsGuard < epicsMutex > &, unsigned level ) const = 0;
+    // about to create count channels
+    virtual void reserveChannels (
+        epicsGuard < epicsMutex > &, unsigned count );
 };
 
 class epicsShareClass cacContextNotify {
@@ -311,6 +314,11 @@ public:
     virtual void attachToClientCtx () = 0;
     virtual void callbackProcessingInitiateNotify () = 0;
     virtual void callbackProcessingCompleteNotify () = 0;
+    // deliver the connection state changes collected so far
+    virtual void connectionBatchNotify ( epicsGuard < epicsMutex > & );
+    // subscription updates held back to be delivered later, if any
+    virtual bool subscriptionBatchPending ( epicsGuard < epicsMutex > & ) const;
+    virtual void subscriptionBatchNotify ( epicsGuard < epicsMutex > & );
 };
 
 // **** Lock Hierarchy ****
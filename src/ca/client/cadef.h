@@ -67,6 +67,16 @@ struct  connection_handler_args {
 
 typedef void caCh (struct connection_handler_args args);
 
+/* arguments passed to user connection batch handlers */
+struct  connection_batch_args {
+    void            *usr;       /* user argument given to ca_create_channels */
+    unsigned        count;      /* number of channels below */
+    const chanId    *pChids;    /* channels whose connection state changed */
+    const long      *pOps;      /* CA_OP_CONN_UP or CA_OP_CONN_DOWN for each */
+};
+
+typedef void caChBatch (struct connection_batch_args args);
+
 typedef struct ca_access_rights {
     unsigned    read_access:1;
     unsigned    write_access:1;
@@ -227,6 +237,41 @@ epicsShareFunc int epicsShareAPI ca_create_channel
      chid           *pChanID
 );
 
+/*
+ * ca_create_channels ()
+ *
+ * Creates count channels in one call, and starts searching for all
+ * of them together. Connection state changes of these channels are
+ * passed to pConnStateCallback in batches, rather than one call per
+ * channel. A batch lists each channel whose state changed since the
+ * previous batch once, with its new state. If the callback is NULL
+ * then the channels can be waited for with ca_pend_io().
+ *
+ * If a channel can't be created its channel id is set to NULL, the
+ * others are still created, and the status of the first failure is
+ * returned.
+ *
+ * count                R   number of channels
+ * ppChanNames          R   array of count channel name strings
+ * pConnStateCallback   R   address of connection state change
+ *                          batch callback function, or NULL
+ * pUserArg             R   passed to *pConnStateCallback
+ * ppUserPrivate        R   array of count values placed in the channels'
+ *                          user private fields, or NULL
+ * priority             R   priority level in the server 0 - 100
+ * pChanIDs             RW  array of count channel ids written here
+ */
+epicsShareFunc int epicsShareAPI ca_create_channels
+(
+     unsigned           count,
+     const char * const *ppChanNames,
+     caChBatch          *pConnStateCallback,
+     void               *pUserArg,
+     void * const       *ppUserPrivate,
+     capri              priority,
+     chid               *pChanIDs
+);
+
 /*
  * ca_change_connection_event()
  *
@@ -519,6 +564,28 @@ epicsShareFunc int epicsShareAPI ca_clear_subscription
 
 epicsShareFunc chid epicsShareAPI ca_evid_to_chid ( evid id );
 
+/*
+ * ca_subscription_latest_only()
+ *
+ * In latest value only mode, updates of a subscription that arrive
+ * while earlier ones are still waiting replace them, and the callback
+ * receives only the latest value once the client library has caught
+ * up with what the server sent. This keeps a slow callback current
+ * instead of falling further behind. Such updates may be delivered
+ * later than those of other subscriptions, and a value that wasn't
+ * delivered before its channel disconnects is dropped. The mode
+ * applies to the updates that arrive after this call, and switching
+ * it off delivers a value that is still waiting.
+ *
+ * eventID      R   event id
+ * latestOnly   R   true to deliver only the latest value
+ */
+epicsShareFunc int epicsShareAPI ca_subscription_latest_only
+(
+     evid eventID,
+     int latestOnly
+);
+
 
 /************************************************************************/
 /*                                                                      */
@@ -857,6 +924,24 @@ epicsShareFunc int epicsShareAPI ca_attach_context ( struct ca_client_context *
 epicsShareFunc int epicsShareAPI ca_client_status ( unsigned level );
 epicsShareFunc int epicsShareAPI ca_context_status ( struct ca_client_context *, unsigned level );
 
+/* latest value only subscription statistics of a client context */
+struct ca_backlog {
+    unsigned    latestOnly;     /* subscriptions in latest value only mode */
+    unsigned    pending;        /* of these, those with an update waiting */
+    double      delivered;      /* updates delivered since context creation */
+    double      replaced;       /* updates replaced by a newer one */
+    double      maxDelay;       /* longest wait of a delivered update (sec) */
+};
+
+/*
+ * ca_context_backlog()
+ *
+ * context  R   client context, or NULL for the current one
+ * pReport  W   statistics written here
+ */
+epicsShareFunc int epicsShareAPI ca_context_backlog
+    ( struct ca_client_context * context, struct ca_backlog * pReport );
+
 /*
  * deprecated
  */
@@ -29,6 +29,9 @@
 
 #include "epicsAssert.h"
 #include "epicsTime.h"
+#include "epicsThread.h"
+#include "epicsEvent.h"
+#include "epicsAtomic.h"
 #include "cadef.h"
 #include "caProto.h"
 
@@ -352,6 +355,111 @@ unsigned    *pInlineIter
     *pInlineIter = 1;
 }
 
+/*
+ * A thread of the multi-threaded get test, which gets all of the
+ * channels and waits for their values a number of times
+ */
+typedef struct getThreadItem {
+    ti                          *pItems;
+    unsigned                    nItems;
+    unsigned                    rounds;
+    struct ca_client_context    *pContext;
+    epicsEventId                replies;
+    size_t                      outstanding;
+} gti;
+
+static size_t getThreadsDone;
+
+static void getThreadCallback ( struct event_handler_args args )
+{
+    gti *pThread = ( gti * ) args.usr;
+    if ( epicsAtomicDecrSizeT ( &pThread->outstanding ) == 0u ) {
+        epicsEventSignal ( pThread->replies );
+    }
+}
+
+static void getThread ( void *pArg )
+{
+    gti *pThread = ( gti * ) pArg;
+    unsigned i, j;
+    int status;
+
+    status = ca_attach_context ( pThread->pContext );
+    SEVCHK ( status, NULL );
+    for ( i = 0u; i < pThread->rounds; i++ ) {
+        epicsAtomicSetSizeT ( &pThread->outstanding, pThread->nItems );
+        for ( j = 0u; j < pThread->nItems; j++ ) {
+            status = ca_array_get_callback (
+                pThread->pItems[j].type,
+                pThread->pItems[j].count,
+                pThread->pItems[j].chix,
+                getThreadCallback, pThread );
+            SEVCHK ( status, NULL );
+        }
+        status = ca_flush_io ();
+        SEVCHK ( status, NULL );
+        epicsEventMustWait ( pThread->replies );
+    }
+    ca_detach_context ();
+    epicsAtomicIncrSizeT ( &getThreadsDone );
+}
+
+/*
+ * test_get_threads ()
+ *
+ * The callbacks are run while this thread waits in ca_pend_event(),
+ * as the context doesn't have preemptive callback enabled.
+ */
+static void test_get_threads ( ti *pItems, unsigned iterations,
+    unsigned nThreads )
+{
+    static const unsigned getsPerTest = 100000u;
+    epicsTimeStamp end_time;
+    epicsTimeStamp start_time;
+    double delay;
+    unsigned rounds;
+    unsigned i;
+    gti *pThreads;
+    int status;
+
+    pThreads = calloc ( nThreads, sizeof ( gti ) );
+    assert ( pThreads );
+    rounds = ( getsPerTest + iterations * nThreads - 1u ) /
+        ( iterations * nThreads );
+
+    epicsAtomicSetSizeT ( &getThreadsDone, 0u );
+    epicsTimeGetCurrent ( &start_time );
+    for ( i = 0u; i < nThreads; i++ ) {
+        pThreads[i].pItems = pItems;
+        pThreads[i].nItems = iterations;
+        pThreads[i].rounds = rounds;
+        pThreads[i].pContext = ca_current_context ();
+        pThreads[i].replies = epicsEventMustCreate ( epicsEventEmpty );
+        epicsThreadMustCreate ( "catimeGet", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize ( epicsThreadStackMedium ),
+            getThread, &pThreads[i] );
+    }
+    while ( epicsAtomicGetSizeT ( &getThreadsDone ) < nThreads ) {
+        status = ca_pend_event ( 1e-3 );
+        if ( status != ECA_TIMEOUT && status != ECA_NORMAL ) {
+            SEVCHK ( status, NULL );
+        }
+    }
+    epicsTimeGetCurrent ( &end_time );
+
+    delay = epicsTimeDiffInSeconds ( &end_time, &start_time );
+    if ( delay > 0.0 ) {
+        double freq = ( (double) rounds * iterations * nThreads ) / delay;
+        printf ( "%3u threads, Per Op, %8.4f uS ( %8.4f MHz )\n",
+            nThreads, 1e6 / freq, freq / 1e6 );
+    }
+
+    for ( i = 0u; i < nThreads; i++ ) {
+        epicsEventDestroy ( pThreads[i].replies );
+    }
+    free ( pThreads );
+}
+
 /*
  * measure_get_latency
  */
@@ -529,7 +637,8 @@ static void test ( ti *pItems, unsigned iterations )
  * catime ()
  */
 int catime ( const char * channelName, 
-    unsigned channelCount, enum appendNumberFlag appNF )
+    unsigned channelCount, enum appendNumberFlag appNF,
+    unsigned threadCount )
 {
     unsigned i;
     int j;
@@ -665,6 +774,22 @@ int catime ( const char * channelName,
     }   
     measure_get_latency ( pItemList, channelCount );
 
+    if ( threadCount > 1u ) {
+        unsigned nThreads = 1u;
+        printf ( "Multi-threaded Async Get Test\n" );
+        printf ( "-----------------------------\n" );
+        while ( 1 ) {
+            test_get_threads ( pItemList, channelCount, nThreads );
+            if ( nThreads >= threadCount ) {
+                break;
+            }
+            nThreads *= 2u;
+            if ( nThreads > threadCount ) {
+                nThreads = threadCount;
+            }
+        }
+    }
+
     printf ( "Free Channel Test\n" );
     printf ( "-----------------\n" );
     timeIt ( test_free, pItemList, channelCount, 0, 0 );
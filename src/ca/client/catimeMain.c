@@ -17,37 +17,33 @@ static const unsigned defaultIterations = 10000u;
 
 int main ( int argc, char **argv )
 {
-    const char *pUsage = "<PV name> [<channel count> [<append number to pv name if true>]]";
+    const char *pUsage = "<PV name> [<channel count> "
+        "[<append number to pv name if true> [<max get thread count>]]]";
+    unsigned iterations = defaultIterations;
+    unsigned appendNumberBool = 0u;
+    unsigned threadCount = 1u;
 
-    if ( argc > 1 ) {
-        char *pname = argv[1];
-        if ( argc > 2 ) {
-            int  iterations = atoi (argv[2]);
-            if ( iterations > 0) {
-                if ( argc > 3 ) {
-                    if ( argc == 4 ) {
-                        int status;
-                        unsigned appendNumberBool;
-                        status = sscanf ( argv[3], " %u ", &appendNumberBool );
-                        if ( status == 1 ) {
-                            if ( appendNumberBool ) {
-                                return catime ( pname, (unsigned) iterations, appendNumber );
-                            }
-                            else {
-                                return catime ( pname, (unsigned) iterations, dontAppendNumber );
-                            }
-                        }
-                    }
-                }
-                else {
-                    return catime ( pname, (unsigned) iterations, dontAppendNumber );
-                }
-            }
-        }
-        else {
-            return catime ( pname, defaultIterations, dontAppendNumber );
+    if ( argc < 2 || argc > 5 ) {
+        printf ( "usage: %s %s\n", argv[0], pUsage);
+        return -1;
+    }
+    if ( argc > 2 ) {
+        int count = atoi ( argv[2] );
+        if ( count <= 0 ) {
+            printf ( "usage: %s %s\n", argv[0], pUsage);
+            return -1;
         }
+        iterations = (unsigned) count;
+    }
+    if ( argc > 3 && sscanf ( argv[3], " %u ", &appendNumberBool ) != 1 ) {
+        printf ( "usage: %s %s\n", argv[0], pUsage);
+        return -1;
     }
-    printf ( "usage: %s %s\n", argv[0], pUsage);
-    return -1;
+    if ( argc > 4 && sscanf ( argv[4], " %u ", &threadCount ) != 1 ) {
+        printf ( "usage: %s %s\n", argv[0], pUsage);
+        return -1;
+    }
+
+    return catime ( argv[1], iterations,
+        appendNumberBool ? appendNumber : dontAppendNumber, threadCount );
 }
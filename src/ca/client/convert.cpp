@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "dbDefs.h"
+#include "epicsTypes.h"
 #include "osiSock.h"
 #include "osiWireFormat.h"
 
@@ -98,6 +99,183 @@ inline epicsUInt32 dbr_htonl ( const epicsUInt32 & host )
     return tmp;
 }
 
+/*
+ * Bulk byte swapping of long value arrays.
+ *
+ * On x86 the network format differs from the host format only in
+ * byte order, also for float and double, so arrays are converted
+ * in place with SSE2, which every x86_64 has, or with AVX2 when the
+ * CPU supports it.  The same kernel serves both directions.  Short
+ * arrays, and other architectures, use the element loops below.
+ */
+#if defined ( __GNUC__ ) && defined ( __SSE2__ ) && \
+        ( defined ( __x86_64__ ) || defined ( __i386__ ) )
+#   define CA_VECTOR_SWAP
+#   include <emmintrin.h>
+#   if defined ( __clang__ ) || __GNUC__ > 4 || \
+        ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 )
+#       define CA_VECTOR_SWAP_AVX2
+#       include <immintrin.h>
+#   endif
+#endif
+
+#ifdef CA_VECTOR_SWAP
+
+/* below this many elements the loops are as fast */
+static const arrayElementCount vectorSwapMinCount = 16u;
+
+typedef void ( * SWAPFUNCPTR ) ( 
+    const void *pSrc, void *pDest, arrayElementCount count );
+
+/* the elements left over by the vector loops */
+static void swapTail ( const epicsUInt8 *pSrc, epicsUInt8 *pDest,
+    unsigned size, arrayElementCount count )
+{
+    while ( count-- ) {
+        epicsUInt8 tmp[8];
+        for ( unsigned i = 0u; i < size; i++ ) {
+            tmp[i] = pSrc[size - 1u - i];
+        }
+        memcpy ( pDest, tmp, size );
+        pSrc += size;
+        pDest += size;
+    }
+}
+
+static inline __m128i swapBytes16 ( __m128i v )
+{
+    return _mm_or_si128 ( _mm_slli_epi16 ( v, 8 ), _mm_srli_epi16 ( v, 8 ) );
+}
+
+static inline __m128i swapBytes32 ( __m128i v )
+{
+    v = swapBytes16 ( v );
+    v = _mm_shufflelo_epi16 ( v, _MM_SHUFFLE ( 2, 3, 0, 1 ) );
+    return _mm_shufflehi_epi16 ( v, _MM_SHUFFLE ( 2, 3, 0, 1 ) );
+}
+
+static inline __m128i swapBytes64 ( __m128i v )
+{
+    v = swapBytes16 ( v );
+    v = _mm_shufflelo_epi16 ( v, _MM_SHUFFLE ( 0, 1, 2, 3 ) );
+    return _mm_shufflehi_epi16 ( v, _MM_SHUFFLE ( 0, 1, 2, 3 ) );
+}
+
+#define SSE2_SWAP_KERNEL(NAME, SIZE, SWAP) \
+static void NAME ( const void *s, void *d, arrayElementCount count ) \
+{ \
+    const epicsUInt8 *pSrc = static_cast < const epicsUInt8 * > ( s ); \
+    epicsUInt8 *pDest = static_cast < epicsUInt8 * > ( d ); \
+    const arrayElementCount perVector = 16u / SIZE; \
+    arrayElementCount n = count / ( 2u * perVector ); \
+    while ( n-- ) { \
+        __m128i v0 = _mm_loadu_si128 ( (const __m128i *) pSrc ); \
+        __m128i v1 = _mm_loadu_si128 ( (const __m128i *) ( pSrc + 16 ) ); \
+        _mm_storeu_si128 ( (__m128i *) pDest, SWAP ( v0 ) ); \
+        _mm_storeu_si128 ( (__m128i *) ( pDest + 16 ), SWAP ( v1 ) ); \
+        pSrc += 32; \
+        pDest += 32; \
+    } \
+    swapTail ( pSrc, pDest, SIZE, count % ( 2u * perVector ) ); \
+}
+
+SSE2_SWAP_KERNEL ( swap16SSE2, 2u, swapBytes16 )
+SSE2_SWAP_KERNEL ( swap32SSE2, 4u, swapBytes32 )
+SSE2_SWAP_KERNEL ( swap64SSE2, 8u, swapBytes64 )
+
+#ifdef CA_VECTOR_SWAP_AVX2
+
+__attribute__ (( target ( "avx2" ) ))
+static void swapAVX2 ( const void *s, void *d, arrayElementCount count,
+    unsigned size, __m256i mask )
+{
+    const epicsUInt8 *pSrc = static_cast < const epicsUInt8 * > ( s );
+    epicsUInt8 *pDest = static_cast < epicsUInt8 * > ( d );
+    const arrayElementCount perVector = 32u / size;
+    arrayElementCount n = count / ( 2u * perVector );
+    while ( n-- ) {
+        __m256i v0 = _mm256_loadu_si256 ( (const __m256i *) pSrc );
+        __m256i v1 = _mm256_loadu_si256 ( (const __m256i *) ( pSrc + 32 ) );
+        _mm256_storeu_si256 ( (__m256i *) pDest,
+            _mm256_shuffle_epi8 ( v0, mask ) );
+        _mm256_storeu_si256 ( (__m256i *) ( pDest + 32 ),
+            _mm256_shuffle_epi8 ( v1, mask ) );
+        pSrc += 64;
+        pDest += 64;
+    }
+    swapTail ( pSrc, pDest, size, count % ( 2u * perVector ) );
+}
+
+__attribute__ (( target ( "avx2" ) ))
+static void swap16AVX2 ( const void *s, void *d, arrayElementCount count )
+{
+    swapAVX2 ( s, d, count, 2u, _mm256_setr_epi8 (
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 ) );
+}
+
+__attribute__ (( target ( "avx2" ) ))
+static void swap32AVX2 ( const void *s, void *d, arrayElementCount count )
+{
+    swapAVX2 ( s, d, count, 4u, _mm256_setr_epi8 (
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 ) );
+}
+
+__attribute__ (( target ( "avx2" ) ))
+static void swap64AVX2 ( const void *s, void *d, arrayElementCount count )
+{
+    swapAVX2 ( s, d, count, 8u, _mm256_setr_epi8 (
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 ) );
+}
+
+#endif /* CA_VECTOR_SWAP_AVX2 */
+
+struct swapKernels {
+    SWAPFUNCPTR swap16;
+    SWAPFUNCPTR swap32;
+    SWAPFUNCPTR swap64;
+};
+
+static swapKernels selectSwapKernels ()
+{
+    swapKernels kernels = { swap16SSE2, swap32SSE2, swap64SSE2 };
+#   ifdef CA_VECTOR_SWAP_AVX2
+        // may run before the constructors that would otherwise do this
+        __builtin_cpu_init ();
+        if ( __builtin_cpu_supports ( "avx2" ) ) {
+            kernels.swap16 = swap16AVX2;
+            kernels.swap32 = swap32AVX2;
+            kernels.swap64 = swap64AVX2;
+        }
+#   endif
+    return kernels;
+}
+
+// chosen once when the library is loaded
+static const swapKernels vectorSwap = selectSwapKernels ();
+
+#endif /* CA_VECTOR_SWAP */
+
+/*
+ * Returns true if the array was converted by a vector kernel
+ */
+static inline bool swapArray ( unsigned size, const void *pSrc,
+    void *pDest, arrayElementCount num )
+{
+#   ifdef CA_VECTOR_SWAP
+        SWAPFUNCPTR pFunc = size == 2u ? vectorSwap.swap16 :
+            size == 4u ? vectorSwap.swap32 : vectorSwap.swap64;
+        // null until the library's static initialization has run
+        if ( num >= vectorSwapMinCount && pFunc ) {
+            ( *pFunc ) ( pSrc, pDest, num );
+            return true;
+        }
+#   endif
+    return false;
+}
+
 /*
  * if hton is true then it is a host to network conversion
  * otherwise vise-versa
@@ -138,6 +316,10 @@ arrayElementCount   num         /* number of values     */
     dbr_short_t         *pSrc = (dbr_short_t *) s;
     dbr_short_t         *pDest = (dbr_short_t *) d;
 
+    if ( swapArray ( sizeof ( dbr_short_t ), pSrc, pDest, num ) ) {
+        return;
+    }
+
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htons( pSrc[i] );
@@ -188,6 +370,10 @@ arrayElementCount   num         /* number of values     */
     dbr_long_t          *pSrc = (dbr_long_t *) s;
     dbr_long_t          *pDest = (dbr_long_t *) d;
 
+    if ( swapArray ( sizeof ( dbr_long_t ), pSrc, pDest, num ) ) {
+        return;
+    }
+
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htonl( pSrc[i] );
@@ -217,6 +403,10 @@ arrayElementCount   num         /* number of values     */
     dbr_enum_t          *pSrc = (dbr_enum_t *) s;
     dbr_enum_t          *pDest = (dbr_enum_t *) d;
 
+    if ( swapArray ( sizeof ( dbr_enum_t ), pSrc, pDest, num ) ) {
+        return;
+    }
+
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htons ( pSrc[i] );
@@ -248,6 +438,10 @@ arrayElementCount   num         /* number of values     */
     const dbr_float_t   *pSrc = (const dbr_float_t *) s;
     dbr_float_t         *pDest = (dbr_float_t *) d;
 
+    if ( swapArray ( sizeof ( dbr_float_t ), pSrc, pDest, num ) ) {
+        return;
+    }
+
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             dbr_htonf ( &pSrc[i], &pDest[i] );
@@ -273,6 +467,10 @@ arrayElementCount   num         /* number of values     */
     dbr_double_t        *pSrc = (dbr_double_t *) s;
     dbr_double_t        *pDest = (dbr_double_t *) d;
 
+    if ( swapArray ( sizeof ( dbr_double_t ), pSrc, pDest, num ) ) {
+        return;
+    }
+
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             dbr_htond ( &pSrc[i], &pDest[i] );
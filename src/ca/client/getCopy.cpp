@@ -35,6 +35,9 @@
 #include "oldAccess.h"
 #include "cac.h"
 
+// responses at least this large are copied without the context's lock
+static const unsigned getCopyUnlockedBytes = 0x4000u;
+
 getCopy::getCopy ( 
     epicsGuard < epicsMutex > & guard, ca_client_context & cacCtxIn, 
     oldChannelNotify & chanIn, unsigned typeIn, 
@@ -62,7 +65,16 @@ void getCopy::completion (
 {
     if ( this->type == typeIn ) {
         unsigned size = dbr_size_n ( typeIn, countIn );
-        memcpy ( this->pValue, pDataIn, size );
+        if ( size >= getCopyUnlockedBytes ) {
+            // The callback lock held by our caller keeps this object
+            // and the user's buffer from going away, so other threads
+            // may use the context while a large array is copied.
+            epicsGuardRelease < epicsMutex > unguard ( guard );
+            memcpy ( this->pValue, pDataIn, size );
+        }
+        else {
+            memcpy ( this->pValue, pDataIn, size );
+        }
         this->cacCtx.decrementOutstandingIO ( guard, this->ioSeqNo );
         this->cacCtx.destroyGetCopy ( guard, *this );
         // this object destroyed by preceding function call
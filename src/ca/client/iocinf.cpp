@@ -28,6 +28,7 @@
 #include "envDefs.h"
 #include "epicsAssert.h"
 #include "epicsStdioRedirect.h"
+#include "epicsString.h"
 #include "errlog.h"
 #include "osiWireFormat.h"
 
@@ -263,3 +264,98 @@ extern "C" void epicsShareAPI printChannelAccessAddressList ( const ELLLIST *pLi
         pNode = (osiSockAddrNode *) ellNext ( &pNode->node );
     }
 }
+
+static bool isMulticast ( epicsUInt32 hostOrderAddr )
+{
+    epicsUInt32 top = hostOrderAddr >> 24;
+    return top >= 224 && top <= 239;
+}
+
+/*
+ * caNameMcastConfigure ()
+ *
+ * returns zero if multicast name resolution is enabled
+ */
+extern "C" int epicsShareAPI caNameMcastConfigure
+    ( caNameMcastConfig *pConfig, unsigned short serverPort )
+{
+    static const unsigned maxGroups = 4096u;
+    const char *pStr;
+    long nGroups;
+
+    memset ( pConfig, 0, sizeof ( *pConfig ) );
+
+    pStr = envGetConfigParamPtr ( &EPICS_CA_NAME_MCAST_ADDR );
+    if ( ! pStr ) {
+        return -1;
+    }
+
+    if ( aToIPAddr ( pStr, 
+            static_cast < unsigned short > ( serverPort + 2u ), 
+            &pConfig->base ) < 0 ||
+            ! isMulticast ( ntohl ( pConfig->base.sin_addr.s_addr ) ) ) {
+        fprintf ( stderr, "%s: Parsing '%s'\n", __FILE__, 
+            EPICS_CA_NAME_MCAST_ADDR.name );
+        fprintf ( stderr, "\tBad multicast address: '%s'\n", pStr );
+        return -1;
+    }
+
+    if ( envGetLongConfigParam ( &EPICS_CA_NAME_MCAST_GROUPS, &nGroups ) ||
+            nGroups < 1 || nGroups > (long) maxGroups ) {
+        fprintf ( stderr, "%s: %s must be between 1 and %u\n", 
+            __FILE__, EPICS_CA_NAME_MCAST_GROUPS.name, maxGroups );
+        return -1;
+    }
+
+    /* the last group must not wrap out of the multicast range */
+    if ( ! isMulticast ( ntohl ( pConfig->base.sin_addr.s_addr ) + 
+            static_cast < unsigned > ( nGroups - 1 ) ) ) {
+        fprintf ( stderr, "%s: %ld groups starting at '%s' are not all multicast\n", 
+            __FILE__, nGroups, pStr );
+        return -1;
+    }
+
+    pConfig->intf.sin_family = AF_INET;
+    pConfig->intf.sin_addr.s_addr = htonl ( INADDR_ANY );
+    pStr = envGetConfigParamPtr ( &EPICS_CA_NAME_MCAST_INTF );
+    if ( pStr && aToIPAddr ( pStr, 0u, &pConfig->intf ) < 0 ) {
+        fprintf ( stderr, "%s: Parsing '%s'\n", __FILE__, 
+            EPICS_CA_NAME_MCAST_INTF.name );
+        fprintf ( stderr, "\tBad internet address or host name: '%s'\n", pStr );
+        return -1;
+    }
+
+    pConfig->nGroups = static_cast < unsigned > ( nGroups );
+    return 0;
+}
+
+/*
+ * caNameMcastIndex ()
+ */
+extern "C" unsigned epicsShareAPI caNameMcastIndex
+    ( const caNameMcastConfig *pConfig, const char *pName, 
+    unsigned nameLength )
+{
+    unsigned prefixLength = 0u;
+
+    while ( prefixLength < nameLength ) {
+        char c = pName[prefixLength];
+        if ( c == '\0' || c == ':' || c == '.' ) {
+            break;
+        }
+        prefixLength++;
+    }
+    return epicsMemHash ( pName, prefixLength, 0u ) % pConfig->nGroups;
+}
+
+/*
+ * caNameMcastGroup ()
+ */
+extern "C" void epicsShareAPI caNameMcastGroup
+    ( const caNameMcastConfig *pConfig, unsigned index, 
+    struct sockaddr_in *pAddr )
+{
+    *pAddr = pConfig->base;
+    pAddr->sin_addr.s_addr = 
+        htonl ( ntohl ( pConfig->base.sin_addr.s_addr ) + index );
+}
@@ -38,6 +38,11 @@
 #include "cadef.h"
 #include "db_access.h" // for INVALID_DB_REQ
 #include "noopiiu.h"
+#include "inetAddrID.h"
+
+// searches after a disconnect that go only to the server
+// that last hosted the channel
+static const unsigned serverHintSearchTries = 8u;
 
 nciu::nciu ( cac & cacIn, netiiu & iiuIn, cacChannelNotify & chanIn,
             const char *pNameIn, cacChannel::priLev pri ) :
@@ -63,6 +68,8 @@ nciu::nciu ( cac & cacIn, netiiu & iiuIn, cacChannelNotify & chanIn,
     }
 
 	this->nameLength = static_cast <unsigned short> ( nameLengthTmp );
+    this->serverHint.sa.sa_family = AF_UNSPEC;
+    this->searchHint.sa.sa_family = AF_UNSPEC;
 
     this->pNameStr = new char [ this->nameLength ];
     strcpy ( this->pNameStr, pNameIn );
@@ -212,11 +219,19 @@ void nciu::accessRightsStateChange (
 
 /*
  * nciu::searchMsg ()
+ *
+ * The first few searches after a disconnect go only to the
+ * server that last hosted the channel
  */
 bool nciu::searchMsg ( epicsGuard < epicsMutex > & guard )
 {
+   const osiSockAddr * pServer = 0;
+   if ( this->searchHint.sa.sa_family == AF_INET &&
+            this->retry < serverHintSearchTries ) {
+        pServer = & this->searchHint;
+   }
    bool success = this->piiu->searchMsg (
-        guard, this->getId (), this->pNameStr, this->nameLength );
+        guard, this->getId (), this->pNameStr, this->nameLength, pServer );
    if ( success ) {
         if ( this->retry < UINT_MAX ) {
             this->retry++;
@@ -225,6 +240,48 @@ bool nciu::searchMsg ( epicsGuard < epicsMutex > & guard )
    return success;
 }
 
+//
+// The hint is the server's circuit address, which is what beacons
+// carry. Searches go to its UDP port, which is where the server
+// answered them from, or the configured server port on its host
+// when the channel was found through a name server.
+//
+void nciu::setServerHint ( epicsGuard < epicsMutex > & guard,
+    const osiSockAddr & server, unsigned short serverPort )
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    this->serverHint = server;
+    if ( this->searchHint.sa.sa_family != AF_INET ||
+            this->searchHint.ia.sin_addr.s_addr !=
+                server.ia.sin_addr.s_addr ) {
+        this->searchHint = server;
+        this->searchHint.ia.sin_port = htons ( serverPort );
+    }
+}
+
+void nciu::setSearchHint (
+    epicsGuard < epicsMutex > & guard, const osiSockAddr & source )
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    this->searchHint = source;
+}
+
+//
+// Start over with searches sent only to the server, if it is
+// the one that last hosted this channel
+//
+bool nciu::serverHintRestart (
+    epicsGuard < epicsMutex > & guard, const inetAddrID & server )
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    if ( this->serverHint.sa.sa_family != AF_INET ||
+            ! ( inetAddrID ( this->serverHint.ia ) == server ) ) {
+        return false;
+    }
+    this->retry = 0u;
+    return true;
+}
+
 const char *nciu::pName (
     epicsGuard < epicsMutex > & guard ) const throw ()
 {
@@ -35,13 +35,14 @@
 #include "tsFreeList.h"
 #include "epicsMutex.h"
 #include "compilerDependencies.h"
+#include "osiSock.h"
 
 #ifdef nciuh_restore_epicsExportSharedSymbols
 #   define epicsExportSharedSymbols
 #   include "shareLib.h"
 #endif
 
-#define CA_MINOR_PROTOCOL_REVISION 13
+#define CA_MINOR_PROTOCOL_REVISION 15
 #include "caProto.h"
 
 #include "cacIO.h"
@@ -158,6 +159,12 @@ public:
         netiiu & newiiu, epicsGuard < epicsMutex > & guard );
     bool searchMsg (
         epicsGuard < epicsMutex > & );
+    void setServerHint ( epicsGuard < epicsMutex > &,
+        const osiSockAddr & server, unsigned short serverPort );
+    void setSearchHint (
+        epicsGuard < epicsMutex > &, const osiSockAddr & );
+    bool serverHintRestart (
+        epicsGuard < epicsMutex > &, const class inetAddrID & server );
     void serviceShutdownNotify (
         epicsGuard < epicsMutex > & callbackControlGuard,
         epicsGuard < epicsMutex > & mutualExclusionGuard );
@@ -214,6 +221,8 @@ private:
     cac & cacCtx;
     char * pNameStr;
     netiiu * piiu;
+    osiSockAddr serverHint; // server that last hosted the channel
+    osiSockAddr searchHint; // where that server answered searches
     ca_uint32_t sid; // server id
     unsigned count;
     unsigned retry; // search retry number
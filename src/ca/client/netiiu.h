@@ -91,7 +91,8 @@ public:
         epicsGuard < epicsMutex > & ) const = 0;
     virtual bool searchMsg (
         epicsGuard < epicsMutex > &, ca_uint32_t id, 
-            const char * pName, unsigned nameLength ) = 0;
+            const char * pName, unsigned nameLength,
+            const osiSockAddr * pServer ) = 0;
 };
 
 #endif // netiiuh
@@ -162,9 +162,10 @@ void noopiiu::uninstallChanDueToSuccessfulSearchResponse (
 
 bool noopiiu::searchMsg (
     epicsGuard < epicsMutex > & guard, ca_uint32_t id, 
-        const char * pName, unsigned nameLength )
+        const char * pName, unsigned nameLength,
+        const osiSockAddr * pServer )
 {
     return netiiu::searchMsg (
-        guard, id, pName, nameLength );
+        guard, id, pName, nameLength, pServer );
 }
 
@@ -34,6 +34,7 @@
 #endif
 
 #include "tsFreeList.h"
+#include "epicsTime.h"
 #include "compilerDependencies.h"
 #include "osiSock.h"
 
@@ -47,12 +48,18 @@
 #include "cadef.h"
 #include "syncGroup.h"
 
+class oldChannelBatch;
+
 struct oldChannelNotify : private cacChannelNotify {
 public:
     oldChannelNotify (
         epicsGuard < epicsMutex > &, struct ca_client_context &,
         const char * pName, caCh * pConnCallBackIn,
         void * pPrivateIn, capri priority );
+    oldChannelNotify (
+        epicsGuard < epicsMutex > &, struct ca_client_context &,
+        const char * pName, oldChannelBatch & batch,
+        void * pPrivateIn, capri priority );
     void destructor (
         CallbackGuard & cbGuard,
         epicsGuard < epicsMutex > & mutexGuard );
@@ -146,6 +153,8 @@ private:
     caCh * pConnCallBack;
     void * pPrivate;
     caArh * pAccessRightsFunc;
+    oldChannelBatch * pBatch;
+    unsigned batchIndex; // of a pending state change in pBatch
     unsigned ioSeqNo;
     bool currentlyConnected;
     bool prevConnected;
@@ -166,6 +175,39 @@ private:
     oldChannelNotify ( const oldChannelNotify & );
     oldChannelNotify & operator = ( const oldChannelNotify & );
     void operator delete ( void * );
+    friend class oldChannelBatch;
+};
+
+/*
+ * The channels created by one ca_create_channels() call. Their
+ * connection state changes are collected here until the client
+ * context passes them to the user's callback all at once.
+ */
+class oldChannelBatch : public tsDLNode < oldChannelBatch > {
+public:
+    oldChannelBatch ( caChBatch * pFunc, void * pPrivate,
+        unsigned maxMembers );
+    ~oldChannelBatch ();
+    void join ( oldChannelNotify & );
+    void leave ( oldChannelNotify & );
+    bool post ( oldChannelNotify &, long op );
+    void deliver ( epicsGuard < epicsMutex > & );
+    bool unused () const;
+    bool queued; // on the client context's pending list
+    bool delivering;
+private:
+    caChBatch * pConnCallBack;
+    void * pPrivate;
+    chid * pPendingChids;
+    long * pPendingOps;
+    chid * pDeliveredChids;
+    long * pDeliveredOps;
+    unsigned nPending;
+    unsigned nMembers;
+    unsigned maxMembers;
+    void removePending ( unsigned index );
+    oldChannelBatch ( const oldChannelBatch & );
+    oldChannelBatch & operator = ( const oldChannelBatch & );
 };
 
 class getCopy : public cacReadNotify {
@@ -248,7 +290,8 @@ private:
     void operator delete ( void * );
 };
 
-struct oldSubscription : private cacStateNotify {
+struct oldSubscription : public tsDLNode < oldSubscription >,
+        private cacStateNotify {
 public:
     oldSubscription (
         epicsGuard < epicsMutex > & guard,
@@ -268,6 +311,16 @@ public:
     void cancel (
         CallbackGuard & callbackGuard,
         epicsGuard < epicsMutex > & mutualExclusionGuard );
+    // In latest value only mode an update is kept here, replacing
+    // any that wasn't delivered yet, until the client context
+    // passes it to the user's callback.
+    void latestOnly ( epicsGuard < epicsMutex > &, bool );
+    bool latestOnly () const;
+    bool latestQueued () const;
+    const epicsTime & latestArrival () const;
+    void latestDrop ( epicsGuard < epicsMutex > & );
+    void latestDeliver ( epicsGuard < epicsMutex > & );
+    void * latestRelease ();
     void * operator new ( size_t size,
         tsFreeList < struct oldSubscription, 1024, epicsMutexNOOP > & );
     epicsPlacementDeleteOperator (( void *,
@@ -277,6 +330,13 @@ private:
     cacChannel::ioid id;
     caEventCallBackFunc * pFunc;
     void * pPrivate;
+    void * pLatest;
+    size_t latestSize;
+    epicsTime latestTime;
+    arrayElementCount latestCount;
+    unsigned latestType;
+    bool latestOnlyMode;
+    bool latestIsQueued;
     void current (
         epicsGuard < epicsMutex > &, unsigned type,
         arrayElementCount count, const void *pData );
@@ -346,6 +406,22 @@ public:
     void destroyPutCallback ( epicsGuard < epicsMutex > &, putCallback & );
     void destroySubscription ( epicsGuard < epicsMutex > &, oldSubscription & );
     epicsMutex & mutexRef () const;
+    oldChannelBatch & createConnectionBatch (
+        epicsGuard < epicsMutex > &, caChBatch * pFunc, void * pPrivate,
+        unsigned count );
+    void connectionBatchPost ( epicsGuard < epicsMutex > &,
+        oldChannelBatch &, oldChannelNotify &, long op );
+    void connectionBatchLeave ( epicsGuard < epicsMutex > &,
+        oldChannelBatch &, oldChannelNotify & );
+    void connectionBatchNotify ( epicsGuard < epicsMutex > & );
+    void latestOnlyChange ( epicsGuard < epicsMutex > &, bool );
+    void latestPost ( epicsGuard < epicsMutex > &,
+        oldSubscription &, bool replaced );
+    void latestDrop ( epicsGuard < epicsMutex > &, oldSubscription & );
+    bool subscriptionBatchPending ( epicsGuard < epicsMutex > & ) const;
+    void subscriptionBatchNotify ( epicsGuard < epicsMutex > & );
+    void backlog ( struct ca_backlog & ) const;
+    void reserveChannels ( epicsGuard < epicsMutex > &, unsigned count );
 
     template < class T >
     void whenThereIsAnExceptionDestroySyncGroupIO ( epicsGuard < epicsMutex > &, T & );
@@ -354,6 +430,10 @@ public:
     friend int epicsShareAPI ca_create_channel (
         const char * name_str, caCh * conn_func, void * puser,
         capri priority, chid * chanptr );
+    friend int epicsShareAPI ca_create_channels (
+        unsigned count, const char * const * ppChanNames,
+        caChBatch * pConnFunc, void * pUserArg,
+        void * const * ppUserPrivate, capri priority, chid * pChanIDs );
     friend int epicsShareAPI ca_clear_channel ( chid pChan );
     friend int epicsShareAPI ca_array_get ( chtype type,
         arrayElementCount count, chid pChan, void * pValue );
@@ -371,6 +451,8 @@ public:
         evid *monixptr );
     friend int epicsShareAPI ca_flush_io ();
     friend int epicsShareAPI ca_clear_subscription ( evid pMon );
+    friend int epicsShareAPI ca_subscription_latest_only (
+        evid pMon, int latestOnly );
     friend int epicsShareAPI ca_sg_create ( CA_SYNC_GID * pgid );
     friend int epicsShareAPI ca_sg_delete ( const CA_SYNC_GID gid );
     friend int epicsShareAPI ca_sg_block ( const CA_SYNC_GID gid, ca_real timeout );
@@ -398,6 +480,15 @@ private:
     tsFreeList < class putCallback, 1024, epicsMutexNOOP > putCallbackFreeList;
     tsFreeList < struct oldSubscription, 1024, epicsMutexNOOP > subscriptionFreeList;
     tsFreeList < struct CASG, 128, epicsMutexNOOP > casgFreeList;
+    tsDLList < oldChannelBatch > connBatchPending;
+    tsDLList < oldChannelBatch > connBatchIdle;
+    tsDLList < oldSubscription > latestPending;
+    oldSubscription * pLatestDelivering;
+    void * pLatestOrphan;
+    double latestDelivered;
+    double latestReplaced;
+    double latestMaxDelay;
+    unsigned latestOnlyCount;
     mutable epicsMutex mutex;
     mutable epicsMutex cbMutex;
     epicsEvent ioDone;
@@ -424,6 +515,9 @@ private:
     cacContext & createNetworkContext (
         epicsMutex & mutualExclusion, epicsMutex & callbackControl );
     void _sendWakeupMsg ();
+    void latestDeliver ( epicsGuard < epicsMutex > &,
+        oldSubscription &, const epicsTime & current );
+    void latestOnlyOff ( epicsGuard < epicsMutex > &, oldSubscription & );
 
     ca_client_context ( const ca_client_context & );
     ca_client_context & operator = ( const ca_client_context & );
@@ -523,6 +617,21 @@ inline oldChannelNotify & oldSubscription::channel () const
     return this->chan;
 }
 
+inline bool oldSubscription::latestOnly () const
+{
+    return this->latestOnlyMode;
+}
+
+inline bool oldSubscription::latestQueued () const
+{
+    return this->latestIsQueued;
+}
+
+inline const epicsTime & oldSubscription::latestArrival () const
+{
+    return this->latestTime;
+}
+
 inline void * getCopy::operator new ( size_t size,
     tsFreeList < class getCopy, 1024, epicsMutexNOOP > & freeList )
 {
@@ -25,6 +25,8 @@
 #include <string>
 #include <stdexcept>
 
+#include <limits.h>
+
 #ifdef _MSC_VER
 #   pragma warning(disable:4355)
 #endif
@@ -51,6 +53,7 @@ oldChannelNotify::oldChannelNotify (
     io ( cacIn.createChannel ( guard, pName, *this, priority ) ),
     pConnCallBack ( pConnCallBackIn ),
     pPrivate ( pPrivateIn ), pAccessRightsFunc ( cacNoopAccesRightsHandler ),
+    pBatch ( 0 ), batchIndex ( UINT_MAX ),
     ioSeqNo ( 0 ), currentlyConnected ( false ), prevConnected ( false )
 {
     guard.assertIdenticalMutex ( cacIn.mutexRef () );
@@ -60,6 +63,22 @@ oldChannelNotify::oldChannelNotify (
     }
 }
 
+oldChannelNotify::oldChannelNotify (
+        epicsGuard < epicsMutex > & guard, ca_client_context & cacIn,
+        const char *pName, oldChannelBatch & batch,
+        void * pPrivateIn, capri priority ) :
+    cacCtx ( cacIn ),
+    io ( cacIn.createChannel ( guard, pName, *this, priority ) ),
+    pConnCallBack ( 0 ),
+    pPrivate ( pPrivateIn ), pAccessRightsFunc ( cacNoopAccesRightsHandler ),
+    pBatch ( 0 ), batchIndex ( UINT_MAX ),
+    ioSeqNo ( 0 ), currentlyConnected ( false ), prevConnected ( false )
+{
+    guard.assertIdenticalMutex ( cacIn.mutexRef () );
+    this->ioSeqNo = cacIn.sequenceNumberOfOutstandingIO ( guard );
+    batch.join ( *this );
+}
+
 oldChannelNotify::~oldChannelNotify ()
 {
 }
@@ -72,7 +91,10 @@ void  oldChannelNotify::destructor (
     this->io.destroy ( cbGuard, mutexGuard );
     // no need to worry about a connect preempting here because
     // the io (the nciu) has been destroyed above
-    if ( this->pConnCallBack == 0 && ! this->currentlyConnected ) {
+    if ( this->pBatch ) {
+        this->cacCtx.connectionBatchLeave ( mutexGuard, *this->pBatch, *this );
+    }
+    else if ( this->pConnCallBack == 0 && ! this->currentlyConnected ) {
         this->cacCtx.decrementOutstandingIO ( mutexGuard, this->ioSeqNo );
     }
     this->~oldChannelNotify ();
@@ -83,7 +105,11 @@ void oldChannelNotify::connectNotify (
 {
     this->currentlyConnected = true;
     this->prevConnected = true;
-    if ( this->pConnCallBack ) {
+    if ( this->pBatch ) {
+        this->cacCtx.connectionBatchPost ( guard, *this->pBatch,
+            *this, CA_OP_CONN_UP );
+    }
+    else if ( this->pConnCallBack ) {
         struct connection_handler_args  args;
         args.chid = this;
         args.op = CA_OP_CONN_UP;
@@ -102,7 +128,11 @@ void oldChannelNotify::disconnectNotify (
     epicsGuard < epicsMutex > & guard )
 {
     this->currentlyConnected = false;
-    if ( this->pConnCallBack ) {
+    if ( this->pBatch ) {
+        this->cacCtx.connectionBatchPost ( guard, *this->pBatch,
+            *this, CA_OP_CONN_DOWN );
+    }
+    else if ( this->pConnCallBack ) {
         struct connection_handler_args args;
         args.chid = this;
         args.op = CA_OP_CONN_DOWN;
@@ -220,7 +250,14 @@ void * epicsShareAPI ca_puser (
 int epicsShareAPI ca_change_connection_event ( chid pChan, caCh * pfunc )
 {
     epicsGuard < epicsMutex > guard ( pChan->cacCtx.mutexRef () );
-    if ( ! pChan->currentlyConnected ) {
+    if ( pChan->pBatch ) {
+        // from now on the channel has its own callback
+        pChan->cacCtx.connectionBatchLeave ( guard, *pChan->pBatch, *pChan );
+        if ( ! pfunc && ! pChan->currentlyConnected ) {
+            pChan->cacCtx.incrementOutstandingIO ( guard, pChan->ioSeqNo );
+        }
+    }
+    else if ( ! pChan->currentlyConnected ) {
          if ( pfunc ) {
             if ( ! pChan->pConnCallBack ) {
                 pChan->cacCtx.decrementOutstandingIO ( guard, pChan->ioSeqNo );
@@ -236,6 +273,126 @@ int epicsShareAPI ca_change_connection_event ( chid pChan, caCh * pfunc )
     return ECA_NORMAL;
 }
 
+oldChannelBatch::oldChannelBatch ( caChBatch * pFunc, void * pPrivateIn,
+        unsigned maxMembersIn ) :
+    queued ( false ), delivering ( false ),
+    pConnCallBack ( pFunc ), pPrivate ( pPrivateIn ),
+    pPendingChids ( 0 ), pPendingOps ( 0 ),
+    pDeliveredChids ( 0 ), pDeliveredOps ( 0 ),
+    nPending ( 0u ), nMembers ( 0u ), maxMembers ( maxMembersIn )
+{
+    // each channel has at most one pending state change
+    try {
+        this->pPendingChids = new chid [ maxMembersIn ];
+        this->pPendingOps = new long [ maxMembersIn ];
+        this->pDeliveredChids = new chid [ maxMembersIn ];
+        this->pDeliveredOps = new long [ maxMembersIn ];
+    }
+    catch ( ... ) {
+        delete [] this->pPendingChids;
+        delete [] this->pPendingOps;
+        delete [] this->pDeliveredChids;
+        throw;
+    }
+}
+
+oldChannelBatch::~oldChannelBatch ()
+{
+    delete [] this->pPendingChids;
+    delete [] this->pPendingOps;
+    delete [] this->pDeliveredChids;
+    delete [] this->pDeliveredOps;
+}
+
+void oldChannelBatch::join ( oldChannelNotify & chan )
+{
+    assert ( this->nMembers < this->maxMembers );
+    this->nMembers++;
+    chan.pBatch = this;
+    chan.batchIndex = UINT_MAX;
+}
+
+void oldChannelBatch::leave ( oldChannelNotify & chan )
+{
+    if ( chan.batchIndex != UINT_MAX ) {
+        this->removePending ( chan.batchIndex );
+    }
+    chan.pBatch = 0;
+    chan.batchIndex = UINT_MAX;
+    this->nMembers--;
+}
+
+void oldChannelBatch::removePending ( unsigned index )
+{
+    this->pPendingChids[index]->batchIndex = UINT_MAX;
+    this->nPending--;
+    if ( index < this->nPending ) {
+        this->pPendingChids[index] = this->pPendingChids[this->nPending];
+        this->pPendingOps[index] = this->pPendingOps[this->nPending];
+        this->pPendingChids[index]->batchIndex = index;
+    }
+}
+
+//
+// Returns true if the batch needs to be delivered. A change that
+// reverts one that is still pending cancels it, so the user only
+// sees changes of the state that was last delivered.
+//
+bool oldChannelBatch::post ( oldChannelNotify & chan, long op )
+{
+    if ( chan.batchIndex != UINT_MAX ) {
+        if ( this->pPendingOps[chan.batchIndex] != op ) {
+            this->removePending ( chan.batchIndex );
+        }
+        return false;
+    }
+    chan.batchIndex = this->nPending;
+    this->pPendingChids[this->nPending] = &chan;
+    this->pPendingOps[this->nPending] = op;
+    this->nPending++;
+    return true;
+}
+
+//
+// Changes posted while the callback runs go to the other buffer,
+// and are delivered before this returns
+//
+void oldChannelBatch::deliver ( epicsGuard < epicsMutex > & guard )
+{
+    this->delivering = true;
+    while ( this->nPending ) {
+        chid * pChids = this->pPendingChids;
+        long * pOps = this->pPendingOps;
+        unsigned count = this->nPending;
+
+        this->pPendingChids = this->pDeliveredChids;
+        this->pPendingOps = this->pDeliveredOps;
+        this->pDeliveredChids = pChids;
+        this->pDeliveredOps = pOps;
+        this->nPending = 0u;
+        for ( unsigned i = 0u; i < count; i++ ) {
+            pChids[i]->batchIndex = UINT_MAX;
+        }
+
+        struct connection_batch_args args;
+        args.usr = this->pPrivate;
+        args.count = count;
+        args.pChids = pChids;
+        args.pOps = pOps;
+        caChBatch * pFunc = this->pConnCallBack;
+        {
+            epicsGuardRelease < epicsMutex > unguard ( guard );
+            ( *pFunc ) ( args );
+        }
+    }
+    this->delivering = false;
+}
+
+bool oldChannelBatch::unused () const
+{
+    return this->nMembers == 0u && ! this->delivering;
+}
+
 /*
  * ca_replace_access_rights_event
  */
@@ -20,6 +20,8 @@
  */
 
 #include <stdexcept>
+#include <string.h>
+#include <stdlib.h>
 
 #include "errlog.h"
 
@@ -34,7 +36,9 @@ oldSubscription::oldSubscription  (
     caEventCallBackFunc * pFuncIn, void * pPrivateIn,
     evid * pEventId ) :
     chan ( chanIn ), id ( UINT_MAX ), pFunc ( pFuncIn ), 
-        pPrivate ( pPrivateIn )
+        pPrivate ( pPrivateIn ), pLatest ( 0 ), latestSize ( 0u ),
+        latestCount ( 0u ), latestType ( 0u ), latestOnlyMode ( false ),
+        latestIsQueued ( false )
 {
     // The users event id *must* be set prior to potentially
     // calling his callback from within subscribe.
@@ -49,12 +53,38 @@ oldSubscription::oldSubscription  (
 
 oldSubscription::~oldSubscription ()
 {
+    free ( this->pLatest );
 }
 
 void oldSubscription::current ( 
     epicsGuard < epicsMutex > & guard,
     unsigned type, arrayElementCount count, const void * pData )
 {
+    if ( this->latestOnlyMode ) {
+        size_t size = dbr_size_n ( type, count );
+        if ( size > this->latestSize ) {
+            void * pNew = malloc ( size );
+            if ( pNew ) {
+                free ( this->pLatest );
+                this->pLatest = pNew;
+                this->latestSize = size;
+            }
+        }
+        if ( size <= this->latestSize ) {
+            memcpy ( this->pLatest, pData, size );
+            this->latestType = type;
+            this->latestCount = count;
+            bool replaced = this->latestIsQueued;
+            if ( ! replaced ) {
+                this->latestTime = epicsTime::getCurrent ();
+                this->latestIsQueued = true;
+            }
+            this->chan.getClientCtx ().latestPost ( guard, *this, replaced );
+            return;
+        }
+        // no memory to hold the value, so deliver it right away
+        this->latestDrop ( guard );
+    }
     struct event_handler_args args;
     args.usr = this->pPrivate;
     args.chid = & this->chan;
@@ -78,7 +108,11 @@ void oldSubscription::exception (
         ca_client_context & cac = this->chan.getClientCtx ();
         cac.destroySubscription ( guard, *this );
     }
-    else if ( status != ECA_DISCONN ) {
+    else if ( status == ECA_DISCONN ) {
+        // a value from before the disconnect is of no use anymore
+        this->latestDrop ( guard );
+    }
+    else {
         struct event_handler_args args;
         args.usr = this->pPrivate;
         args.chid = & this->chan;
@@ -94,6 +128,50 @@ void oldSubscription::exception (
     }
 }
 
+void oldSubscription::latestOnly (
+    epicsGuard < epicsMutex > & guard, bool latestOnlyIn )
+{
+    if ( latestOnlyIn != this->latestOnlyMode ) {
+        this->latestOnlyMode = latestOnlyIn;
+        this->chan.getClientCtx ().latestOnlyChange ( guard, latestOnlyIn );
+    }
+}
+
+void oldSubscription::latestDrop ( epicsGuard < epicsMutex > & guard )
+{
+    if ( this->latestIsQueued ) {
+        this->latestIsQueued = false;
+        this->chan.getClientCtx ().latestDrop ( guard, *this );
+    }
+}
+
+// the client context has removed this from its pending list
+void oldSubscription::latestDeliver ( epicsGuard < epicsMutex > & guard )
+{
+    this->latestIsQueued = false;
+    struct event_handler_args args;
+    args.usr = this->pPrivate;
+    args.chid = & this->chan;
+    args.type = static_cast < long > ( this->latestType );
+    args.count = static_cast < long > ( this->latestCount );
+    args.status = ECA_NORMAL;
+    args.dbr = this->pLatest;
+    caEventCallBackFunc * pFuncTmp = this->pFunc;
+    {
+        epicsGuardRelease < epicsMutex > unguard ( guard );
+        ( *pFuncTmp ) ( args );
+    }
+}
+
+// the subscription is destroyed by the callback using this value
+void * oldSubscription::latestRelease ()
+{
+    void * pValue = this->pLatest;
+    this->pLatest = 0;
+    this->latestSize = 0u;
+    return pValue;
+}
+
 void oldSubscription::operator delete ( void * )
 {
     // Visual C++ .net appears to require operator delete if
@@ -98,6 +98,36 @@ void searchTimer::shutdown (
     }
 }
 
+//
+// move the channels that were last hosted by this server
+//
+void searchTimer::moveServerChannels ( 
+    epicsGuard < epicsMutex > & guard, const inetAddrID & server,
+    searchTimer & dest )
+{
+    tsDLIter < nciu > pChan = this->chanListRespPending.firstIter ();
+    while ( pChan.valid () ) {
+        nciu & chan = *pChan;
+        pChan++;
+        if ( chan.serverHintRestart ( guard, server ) ) {
+            this->chanListRespPending.remove ( chan );
+            if ( this->searchAttempts > 0 ) {
+                this->searchAttempts--;
+            }
+            dest.installChannel ( guard, chan );
+        }
+    }
+    pChan = this->chanListReqPending.firstIter ();
+    while ( pChan.valid () ) {
+        nciu & chan = *pChan;
+        pChan++;
+        if ( chan.serverHintRestart ( guard, server ) ) {
+            this->chanListReqPending.remove ( chan );
+            dest.installChannel ( guard, chan );
+        }
+    }
+}
+
 void searchTimer::installChannel ( 
     epicsGuard < epicsMutex > & guard, nciu & chan )
 {
@@ -233,6 +263,9 @@ epicsTimerNotify::expireStatus searchTimer::expire (
     this->searchAttempts = 0;
     this->searchResponses = 0;
 
+    // send all of the frames for this try at once
+    this->iiu.datagramBatchBegin ( guard );
+
     unsigned nFrameSent = 0u;
     while ( true ) {
         nciu * pChan = this->chanListReqPending.get ();
@@ -273,6 +306,8 @@ epicsTimerNotify::expireStatus searchTimer::expire (
         nFrameSent++;
     }
 
+    this->iiu.datagramBatchEnd ( guard );
+
     this->dgSeqNoAtTimerExpireEnd = 
         this->iiu.datagramSeqNumber ( guard ) - 1u;
 
@@ -55,6 +55,11 @@ public:
     virtual bool datagramFlush ( 
         epicsGuard < epicsMutex > &, 
         const epicsTime & currentTime ) = 0;
+    // frames flushed between these calls may be sent all at once
+    virtual void datagramBatchBegin ( 
+        epicsGuard < epicsMutex > & ) = 0;
+    virtual void datagramBatchEnd ( 
+        epicsGuard < epicsMutex > & ) = 0;
     virtual ca_uint32_t datagramSeqNumber (
         epicsGuard < epicsMutex > & ) const = 0;
 };
@@ -72,6 +77,9 @@ public:
         epicsGuard < epicsMutex > & guard );
     void moveChannels ( 
         epicsGuard < epicsMutex > &, searchTimer & dest );
+    void moveServerChannels ( 
+        epicsGuard < epicsMutex > &, const class inetAddrID & server,
+        searchTimer & dest );
     void installChannel ( 
         epicsGuard < epicsMutex > &, nciu & );
     void uninstallChan ( 
@@ -44,9 +44,14 @@
 #include "epicsSignal.h"
 #include "caerr.h"
 #include "udpiiu.h"
+#include "caCompress.h"
+#include "caLocalRing.h"
 
 using namespace std;
 
+// receive bursts for which held back subscription updates may be deferred
+static const unsigned maxDeferredSubscriptionFlush = 32u;
+
 tcpSendThread::tcpSendThread (
         class tcpiiu & iiuIn, const char * pName, 
         unsigned stackSize, unsigned priority ) :
@@ -297,8 +302,43 @@ unsigned tcpiiu::sendBytes ( const void *pBuf,
     return nBytes;
 }
 
+//
+// tcpiiu::recvBytes ()
+//
+// Once the server has switched to the local transport its responses
+// come from the shared memory ring, and it only sends wakeups over
+// TCP when the ring was found empty.  They are discarded here, what
+// matters is that a blocking recv() still sees the circuit go down.
+//
 void tcpiiu::recvBytes ( 
         void * pBuf, unsigned nBytesInBuf, statusWireIO & stat )
+{
+    if ( ! this->localRingActive ) {
+        this->recvSocketBytes ( pBuf, nBytesInBuf, stat );
+        return;
+    }
+    while ( true ) {
+        unsigned nBytes = caLocalRingGet ( this->pLocalRing, 
+            pBuf, nBytesInBuf );
+        if ( nBytes ) {
+            this->localRingBytes += nBytes;
+            stat.bytesCopied = nBytes;
+            stat.circuitState = swioConnected;
+            return;
+        }
+        if ( caLocalRingIdle ( this->pLocalRing ) ) {
+            char wakeups[ 4 * sizeof ( caHdr ) ];
+            this->recvSocketBytes ( wakeups, sizeof ( wakeups ), stat );
+            if ( stat.circuitState != swioConnected ) {
+                return;
+            }
+            this->localRingWakeups++;
+        }
+    }
+}
+
+void tcpiiu::recvSocketBytes ( 
+        void * pBuf, unsigned nBytesInBuf, statusWireIO & stat )
 {
     assert ( nBytesInBuf <= INT_MAX );
 
@@ -460,6 +500,7 @@ void tcpRecvThread::run ()
         this->iiu.cacRef.attachToClientCtx ();
 
         comBuf * pComBuf = 0;
+        unsigned deferredFlushes = 0u;
         while ( true ) {
 
             //
@@ -469,12 +510,20 @@ void tcpRecvThread::run ()
             // file manager call backs works correctly. This does not 
             // appear to impact performance.
             //
-            if ( ! pComBuf ) {
-                pComBuf = new ( this->iiu.comBufMemMgr ) comBuf;
-            }
-
+            // The rest of a large message body is received straight
+            // into the message body cache, skipping the comBuf copy.
+            //
             statusWireIO stat;
-            pComBuf->fillFromWire ( this->iiu, stat );
+            bool direct = this->iiu.directRecvPending ();
+            if ( direct ) {
+                this->iiu.recvDirect ( stat );
+            }
+            else {
+                if ( ! pComBuf ) {
+                    pComBuf = new ( this->iiu.comBufMemMgr ) comBuf;
+                }
+                pComBuf->fillFromWire ( this->iiu, stat );
+            }
 
             epicsTime currentTime = epicsTime::getCurrent ();
 
@@ -488,8 +537,10 @@ void tcpRecvThread::run ()
                     continue;
                 }
 
-                this->iiu.recvQue.pushLastComBufReceived ( *pComBuf );
-                pComBuf = 0;
+                if ( ! direct ) {
+                    this->iiu.recvQue.pushLastComBufReceived ( *pComBuf );
+                    pComBuf = 0;
+                }
 
                 this->iiu._receiveThreadIsBusy = true;
             }
@@ -526,6 +577,25 @@ void tcpRecvThread::run ()
                 this->iiu._receiveThreadIsBusy = false;
                 // reschedule connection activity watchdog
                 this->iiu.recvDog.messageArrivalNotify ( guard ); 
+                // batched connection state changes from the above
+                this->iiu.cacRef.connectionNotifyFlush ( guard );
+                //
+                // latest value only subscription updates are held back
+                // while more responses are waiting in the OS, so that
+                // newer values replace them instead of a slow consumer
+                // being handed each of them in turn
+                if ( this->iiu.cacRef.subscriptionNotifyPending ( guard ) ) {
+                    bool moreBytesPending;
+                    {
+                        epicsGuardRelease < epicsMutex > unguard ( guard );
+                        moreBytesPending = this->iiu.bytesArePendingInOS ();
+                    }
+                    if ( ! moreBytesPending ||
+                            ++deferredFlushes >= maxDeferredSubscriptionFlush ) {
+                        deferredFlushes = 0u;
+                        this->iiu.cacRef.subscriptionNotifyFlush ( guard );
+                    }
+                }
                 //
                 // if this thread has connected channels with subscriptions
                 // that need to be sent then wakeup the send thread
@@ -691,6 +761,8 @@ tcpiiu::tcpiiu (
     comBufMemMgr ( comBufMemMgrIn ),
     cacRef ( cac ),
     pCurData ( (char*) freeListMalloc(this->cacRef.tcpSmallRecvBufFreeList) ),
+    pExpandBuf ( 0 ),
+    expandBufMax ( 0u ),
     pSearchDest ( pSearchDestIn ),
     mutex ( mutexIn ),
     cbMutex ( cbMutexIn ),
@@ -702,6 +774,14 @@ tcpiiu::tcpiiu (
     socketLibrarySendBufferSize ( 0x1000 ),
     unacknowledgedSendBytes ( 0u ),
     channelCountTot ( 0u ),
+    compressedResponses ( 0u ),
+    compressedWireBytes ( 0.0 ),
+    compressedExpandedBytes ( 0.0 ),
+    compressedSeconds ( 0.0 ),
+    directRecvBytes ( 0.0 ),
+    pLocalRing ( 0 ),
+    localRingBytes ( 0.0 ),
+    localRingWakeups ( 0u ),
     _receiveThreadIsBusy ( false ),
     busyStateDetected ( false ),
     flowControlActive ( false ),
@@ -712,7 +792,8 @@ tcpiiu::tcpiiu (
     recvProcessPostponedFlush ( false ),
     discardingPendingData ( false ),
     socketHasBeenClosed ( false ),
-    unresponsiveCircuit ( false )
+    unresponsiveCircuit ( false ),
+    localRingActive ( false )
 {
     if(!pCurData)
         throw std::bad_alloc();
@@ -936,6 +1017,7 @@ void tcpiiu::unresponsiveCircuitNotify (
                     channelNode::cs_unrespCircuit;
                 pChan->unresponsiveCircuitNotify ( cbGuard, guard );
             }
+            this->cacRef.connectionNotifyFlush ( guard );
         }
     }
 }
@@ -1039,6 +1121,8 @@ tcpiiu :: ~tcpiiu ()
             free ( this->pCurData );
         }
     }
+    free ( this->pExpandBuf );
+    caLocalRingDelete ( this->pLocalRing );
 }
 
 void tcpiiu::show ( unsigned level ) const
@@ -1049,6 +1133,26 @@ void tcpiiu::show ( unsigned level ) const
     ::printf ( "Virtual circuit to \"%s\" at version V%u.%u state %u\n", 
         buf, CA_MAJOR_PROTOCOL_REVISION,
         this->minorProtocolVersion, this->state );
+    if ( this->compressedResponses ) {
+        ::printf ( "\t%u compressed responses, %.0f bytes expanded to %.0f"
+            " (%.1f%% saved), %.3f sec expanding\n",
+            this->compressedResponses, this->compressedWireBytes,
+            this->compressedExpandedBytes,
+            100.0 * ( 1.0 - this->compressedWireBytes /
+                this->compressedExpandedBytes ),
+            this->compressedSeconds );
+    }
+    if ( this->pLocalRing ) {
+        ::printf ( "\t%s %u byte shared memory ring, %.0f bytes received,"
+            " %u wakeups\n",
+            this->localRingActive ? "responses through" : "attached to",
+            caLocalRingSize ( this->pLocalRing ), this->localRingBytes,
+            this->localRingWakeups );
+    }
+    if ( this->directRecvBytes > 0.0 ) {
+        ::printf ( "\t%.0f bytes of large responses received directly\n",
+            this->directRecvBytes );
+    }
     if ( level > 1u ) {
         ::printf ( "\tcurrent data cache pointer = %p current data cache size = %lu\n",
             static_cast < void * > ( this->pCurData ), this->curDataMax );
@@ -1260,8 +1364,14 @@ bool tcpiiu::processIncoming (
                     return true;
                 }
             }
-            bool msgOK = this->cacRef.executeResponse ( mgr, *this, 
+            bool msgOK;
+            if ( this->curMsg.m_cmmd == CA_PROTO_COMPRESSED ) {
+                msgOK = this->expandResponse ( currentTime, mgr );
+            }
+            else {
+                msgOK = this->cacRef.executeResponse ( mgr, *this, 
                                 currentTime, this->curMsg, this->pCurData );
+            }
             if ( ! msgOK ) {
                 return false;
             }
@@ -1289,6 +1399,138 @@ bool tcpiiu::processIncoming (
     }
 }
 
+//
+// tcpiiu::directRecvPending ()
+//
+// True while the recv thread is part way through the body of a
+// message that is larger than a comBuf, and has already copied
+// everything that was in the receive queue into the message body
+// cache.  Only called by the recv thread.
+//
+bool tcpiiu::directRecvPending () const
+{
+    return this->msgHeaderAvailable &&
+        this->curMsg.m_postsize > MAX_TCP &&
+        this->curMsg.m_postsize <= this->curDataMax &&
+        this->curDataBytes < this->curMsg.m_postsize &&
+        this->recvQue.occupiedBytes () == 0u;
+}
+
+void tcpiiu::recvDirect ( statusWireIO & stat )
+{
+    arrayElementCount remaining = 
+        this->curMsg.m_postsize - this->curDataBytes;
+    if ( remaining > INT_MAX ) {
+        remaining = INT_MAX;
+    }
+    this->recvBytes ( &this->pCurData[this->curDataBytes], 
+        static_cast < unsigned > ( remaining ), stat );
+    if ( stat.circuitState == swioConnected ) {
+        this->curDataBytes += stat.bytesCopied;
+        this->directRecvBytes += stat.bytesCopied;
+    }
+}
+
+//
+// tcpiiu::expandResponse ()
+//
+// The payload of a CA_PROTO_COMPRESSED message starts with the header
+// of the response that the server compressed.  Rebuild that response
+// and dispatch it as if it had arrived uncompressed.
+//
+bool tcpiiu::expandResponse ( 
+    const epicsTime & currentTime, callbackManager & mgr )
+{
+    const epicsUInt8 * pSrc = 
+        reinterpret_cast < const epicsUInt8 * > ( this->pCurData );
+    const arrayElementCount srcSize = this->curMsg.m_postsize;
+    const ca_uint32_t compressedBytes = this->curMsg.m_cid;
+    arrayElementCount hdrSize = sizeof ( caHdr );
+    caHdrLargeArray hdr;
+    ca_uint16_t smallPostsize = 0u;
+    ca_uint16_t smallCount = 0u;
+
+    if ( srcSize < hdrSize ) {
+        this->printFormated ( mgr.cbGuard,
+            "CAC: server sent truncated compressed response\n" );
+        return false;
+    }
+    WireGet ( pSrc, hdr.m_cmmd );
+    WireGet ( pSrc + 2, smallPostsize );
+    WireGet ( pSrc + 4, hdr.m_dataType );
+    WireGet ( pSrc + 6, smallCount );
+    WireGet ( pSrc + 8, hdr.m_cid );
+    WireGet ( pSrc + 12, hdr.m_available );
+    hdr.m_postsize = smallPostsize;
+    hdr.m_count = smallCount;
+    if ( smallPostsize == 0xffff ) {
+        hdrSize += 2 * sizeof ( ca_uint32_t );
+        if ( srcSize < hdrSize ) {
+            this->printFormated ( mgr.cbGuard,
+                "CAC: server sent truncated compressed response\n" );
+            return false;
+        }
+        WireGet ( pSrc + 16, hdr.m_postsize );
+        WireGet ( pSrc + 20, hdr.m_count );
+    }
+
+    if ( hdr.m_cmmd == CA_PROTO_COMPRESSED || 
+            hdr.m_dataType > LAST_BUFFER_TYPE || 
+            ( hdr.m_postsize & 0x7 ) ||
+            hdr.m_postsize < dbr_value_offset[hdr.m_dataType] ||
+            srcSize - hdrSize < 
+                dbr_value_offset[hdr.m_dataType] + compressedBytes ) {
+        this->printFormated ( mgr.cbGuard,
+            "CAC: server sent corrupt compressed response\n" );
+        return false;
+    }
+    const unsigned prefixSize = dbr_value_offset[hdr.m_dataType];
+
+    if ( hdr.m_postsize > this->expandBufMax ) {
+        if ( this->cacRef.tcpLargeRecvBufFreeList && 
+                hdr.m_postsize > this->cacRef.maxRecvBytesTCP ) {
+            static bool once = false;
+            if ( ! once ) {
+                this->printFormated ( mgr.cbGuard,
+    "CAC: response with payload size=%u > EPICS_CA_MAX_ARRAY_BYTES ignored\n",
+                    hdr.m_postsize );
+                once = true;
+            }
+            return true;
+        }
+        char * pNewBuf = static_cast < char * > ( 
+            realloc ( this->pExpandBuf, hdr.m_postsize ) );
+        if ( ! pNewBuf ) {
+            this->printFormated ( mgr.cbGuard,
+                "CAC: not enough memory for message body cache (ignoring response message)\n");
+            return true;
+        }
+        this->pExpandBuf = pNewBuf;
+        this->expandBufMax = hdr.m_postsize;
+    }
+
+    epicsTime started = epicsTime::getCurrent ();
+    memcpy ( this->pExpandBuf, pSrc + hdrSize, prefixSize );
+    int nBytes = caExpandArray ( this->curMsg.m_dataType, hdr.m_dataType,
+        pSrc + hdrSize + prefixSize, compressedBytes,
+        this->pExpandBuf + prefixSize, hdr.m_postsize - prefixSize );
+    if ( nBytes < 0 ) {
+        this->printFormated ( mgr.cbGuard,
+            "CAC: server sent corrupt compressed response\n" );
+        return false;
+    }
+    memset ( this->pExpandBuf + prefixSize + nBytes, '\0', 
+        hdr.m_postsize - prefixSize - nBytes );
+
+    this->compressedResponses++;
+    this->compressedWireBytes += sizeof ( caHdr ) + srcSize;
+    this->compressedExpandedBytes += hdrSize + hdr.m_postsize;
+    this->compressedSeconds += epicsTime::getCurrent () - started;
+
+    return this->cacRef.executeResponse ( mgr, *this, 
+        currentTime, hdr, this->pExpandBuf );
+}
+
 void tcpiiu::hostNameSetRequest ( epicsGuard < epicsMutex > & guard )
 {
     guard.assertIdenticalMutex ( this->mutex );
@@ -1306,7 +1548,8 @@ void tcpiiu::hostNameSetRequest ( epicsGuard < epicsMutex > & guard )
         this->flushRequest ( guard );
     }
 
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_HOST_NAME, postSize, 
         0u, 0u, 0u, 0u, 
@@ -1336,7 +1579,8 @@ void tcpiiu::userNameSetRequest ( epicsGuard < epicsMutex > & guard )
         this->flushRequest ( guard );
     }
 
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_CLIENT_NAME, postSize, 
         0u, 0u, 0u, 0u, 
@@ -1354,7 +1598,8 @@ void tcpiiu::disableFlowControlRequest (
     if ( this->sendQue.flushEarlyThreshold ( 16u ) ) {
         this->flushRequest ( guard );
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_EVENTS_ON, 0u, 
         0u, 0u, 0u, 0u, 
@@ -1370,7 +1615,8 @@ void tcpiiu::enableFlowControlRequest (
     if ( this->sendQue.flushEarlyThreshold ( 16u ) ) {
         this->flushRequest ( guard );
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_EVENTS_OFF, 0u, 
         0u, 0u, 0u, 0u, 
@@ -1389,11 +1635,22 @@ void tcpiiu::versionMessage ( epicsGuard < epicsMutex > & guard,
         this->flushRequest ( guard );
     }
 
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    // ask for compressed array responses and for the local
+    // transport, servers before CA V4.14 and V4.15 ignore this
+    ca_uint32_t capabilities = 0u;
+    if ( this->cacRef.compressArrays ) {
+        capabilities |= CA_PROTO_VERSION_COMPRESS;
+    }
+    if ( this->cacRef.localTransport ) {
+        capabilities |= CA_PROTO_VERSION_LOCAL;
+    }
+
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_VERSION, 0u, 
         static_cast < ca_uint16_t > ( priority ), 
-        CA_MINOR_PROTOCOL_REVISION, 0u, 0u, 
+        CA_MINOR_PROTOCOL_REVISION, capabilities, 0u, 
         CA_V49 ( this->minorProtocolVersion ) );
     minder.commit ();
 }
@@ -1411,7 +1668,8 @@ void tcpiiu::echoRequest ( epicsGuard < epicsMutex > & guard )
     if ( this->sendQue.flushEarlyThreshold ( 16u ) ) {
         this->flushRequest ( guard );
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         command, 0u, 
         0u, 0u, 0u, 0u, 
@@ -1419,6 +1677,21 @@ void tcpiiu::echoRequest ( epicsGuard < epicsMutex > & guard )
     minder.commit ();
 }
 
+void tcpiiu::localTransportRequest ( epicsGuard < epicsMutex > & guard,
+                                    ca_uint16_t step )
+{
+    guard.assertIdenticalMutex ( this->mutex );
+
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
+    this->sendQue.insertRequestHeader ( 
+        CA_PROTO_LOCAL, 0u, 
+        step, 0u, 0u, 0u, 
+        CA_V49 ( this->minorProtocolVersion ) );
+    minder.commit ();
+    this->flushRequest ( guard );
+}
+
 void tcpiiu::writeRequest ( epicsGuard < epicsMutex > & guard,
     nciu &chan, unsigned type, arrayElementCount nElem, const void *pValue )
 {
@@ -1426,7 +1699,8 @@ void tcpiiu::writeRequest ( epicsGuard < epicsMutex > & guard,
     if ( INVALID_DB_REQ ( type ) ) {
         throw cacChannel::badType ();
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestWithPayLoad ( CA_PROTO_WRITE,  
         type, nElem, chan.getSID(guard), chan.getCID(guard), pValue,
         CA_V49 ( this->minorProtocolVersion ) );
@@ -1446,7 +1720,8 @@ void tcpiiu::writeNotifyRequest ( epicsGuard < epicsMutex > & guard,
     if ( INVALID_DB_REQ ( type ) ) {
         throw cacChannel::badType ();
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestWithPayLoad ( CA_PROTO_WRITE_NOTIFY,  
         type, nElem, chan.getSID(guard), io.getId(), pValue,
         CA_V49 ( this->minorProtocolVersion ) );
@@ -1475,7 +1750,8 @@ void tcpiiu::readNotifyRequest ( epicsGuard < epicsMutex > & guard,
     }
     if (nElem == 0 && !CA_V413(this->minorProtocolVersion))
        nElem = chan.getcount();
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_READ_NOTIFY, 0u, 
         static_cast < ca_uint16_t > ( dataType ), 
@@ -1515,7 +1791,8 @@ void tcpiiu::createChannelRequest (
         throw cacChannel::unsupportedByService();
     }
 
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     //
     // The available field is used (abused)
     // here to communicate the minor version number
@@ -1543,7 +1820,8 @@ void tcpiiu::clearChannelRequest ( epicsGuard < epicsMutex > & guard,
     if ( this->state != iiucs_connected ) {
         return;
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_CLEAR_CHANNEL, 0u, 
         0u, 0u, sid, cid, 
@@ -1585,7 +1863,8 @@ void tcpiiu::subscriptionRequest (
     if ( nElem > maxElem ) {
         throw cacChannel::msgBodyCacheTooSmall ();
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     // nElement bounds checked above
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_EVENT_ADD, 16u, 
@@ -1632,7 +1911,8 @@ void tcpiiu::subscriptionUpdateRequest (
     if ( nElem > maxElem ) {
         throw cacChannel::msgBodyCacheTooSmall ();
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     // nElem boounds checked above
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_READ_NOTIFY, 0u, 
@@ -1652,7 +1932,8 @@ void tcpiiu::subscriptionCancelRequest ( epicsGuard < epicsMutex > & guard,
     if ( this->state != iiucs_connected ) {
         return;
     }
-    comQueSendMsgMinder minder ( this->sendQue, guard );
+    epicsGuard < epicsMutex > sendGuard ( this->sendQueMutex );
+    comQueSendMsgMinder minder ( this->sendQue, sendGuard );
     this->sendQue.insertRequestHeader ( 
         CA_PROTO_EVENT_CANCEL, 0u, 
         static_cast < ca_uint16_t > ( subscr.getType ( guard ) ), 
@@ -2045,6 +2326,9 @@ void tcpiiu::flushRequest ( epicsGuard < epicsMutex > & )
 
 bool tcpiiu::bytesArePendingInOS () const
 {
+    if ( this->localRingActive ) {
+        return caLocalRingUsedBytes ( this->pLocalRing ) > 0u;
+    }
 #if 0
     FD_SET readBits;
     FD_ZERO ( & readBits );
@@ -2127,10 +2411,11 @@ void tcpiiu::uninstallChanDueToSuccessfulSearchResponse (
 
 bool tcpiiu::searchMsg (
     epicsGuard < epicsMutex > & guard, ca_uint32_t id, 
-        const char * pName, unsigned nameLength )
+        const char * pName, unsigned nameLength,
+        const osiSockAddr * pServer )
 {
     return netiiu::searchMsg (
-        guard, id, pName, nameLength );
+        guard, id, pName, nameLength, pServer );
 }
 
 SearchDestTCP :: SearchDestTCP (
@@ -2173,7 +2458,8 @@ void SearchDestTCP :: searchRequest (
     if ( CA_V412 ( _ptcpiiu->minorProtocolVersion ) ) {
         guard.assertIdenticalMutex ( _ptcpiiu->mutex );
         assert ( CA_MESSAGE_ALIGN ( len ) == len );
-        comQueSendMsgMinder minder ( _ptcpiiu->sendQue, guard );
+        epicsGuard < epicsMutex > sendGuard ( _ptcpiiu->sendQueMutex );
+        comQueSendMsgMinder minder ( _ptcpiiu->sendQue, sendGuard );
         _ptcpiiu->sendQue.pushString ( pBuf, len );
         minder.commit ();
         _ptcpiiu->flushRequest ( guard );
@@ -2191,6 +2477,45 @@ void tcpiiu :: versionRespNotify ( const caHdrLargeArray & msg )
     this->minorProtocolVersion = msg.m_count;
 }
 
+//
+// tcpiiu :: localTransportNotify ()
+//
+// Called by the recv thread for each step of the local
+// transport setup that the server takes
+//
+bool tcpiiu :: localTransportNotify ( 
+    const caHdrLargeArray & msg, void * pMsgBdy )
+{
+    if ( msg.m_dataType == CA_LOCAL_OFFER ) {
+        ca_uint16_t step = CA_LOCAL_DECLINE;
+        if ( this->cacRef.localTransport && ! this->pLocalRing &&
+                msg.m_postsize >= 2u * sizeof ( ca_uint32_t ) ) {
+            const epicsUInt8 * pCookie = 
+                static_cast < const epicsUInt8 * > ( pMsgBdy );
+            epicsUInt32 cookie[2];
+            WireGet ( pCookie, cookie[0] );
+            WireGet ( pCookie + 4, cookie[1] );
+            // fails unless the server runs on this host as the same user
+            this->pLocalRing = caLocalRingAttach ( msg.m_cid, 
+                static_cast < int > ( msg.m_available ), cookie );
+            if ( this->pLocalRing ) {
+                step = CA_LOCAL_ATTACH;
+            }
+        }
+        epicsGuard < epicsMutex > guard ( this->mutex );
+        this->localTransportRequest ( guard, step );
+    }
+    else if ( msg.m_dataType == CA_LOCAL_SWITCH ) {
+        if ( ! this->pLocalRing ) {
+            return false;
+        }
+        // whatever followed the switch over TCP are wakeups
+        this->recvQue.removeBytes ( this->recvQue.occupiedBytes () );
+        this->localRingActive = true;
+    }
+    return true;
+}
+
 void tcpiiu :: searchRespNotify (
     const epicsTime & currentTime, const caHdrLargeArray & msg )
 {    
@@ -2207,7 +2532,11 @@ void tcpiiu :: searchRespNotify (
     else {
         serverAddr = this->address ();
     }
+    // the name server, not the server, answered the search
+    osiSockAddr searchSource;
+    searchSource.sa.sa_family = AF_UNSPEC;
     cacRef.transferChanToVirtCircuit 
             ( msg.m_available, msg.m_cid, 0xffff, 
-                0, minorProtocolVersion, serverAddr, currentTime );
+                0, minorProtocolVersion, serverAddr, searchSource,
+                currentTime );
 }
@@ -0,0 +1,226 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Round trips through the array compression of CA_PROTO_COMPRESSED
+ * responses, and expansion of truncated and corrupt blocks.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "epicsTypes.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#include "db_access.h"
+#include "caProto.h"
+#include "caCompress.h"
+
+#define GUARD 64u
+#define GUARD_BYTE 0xa5
+
+static epicsUInt32 seed = 12345u;
+
+static epicsUInt8 randomByte(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (epicsUInt8) (seed >> 16);
+}
+
+/* Expands into a buffer followed by a guard, which must stay intact */
+static int guardedExpand(unsigned encoding, unsigned dbrType,
+    const epicsUInt8 *pSrc, unsigned srcSize, epicsUInt8 *pValue,
+    unsigned valueBytes, int *pOverrun)
+{
+    unsigned i;
+    int n;
+
+    memset(pValue + valueBytes, GUARD_BYTE, GUARD);
+    n = caExpandArray(encoding, dbrType, pSrc, srcSize, pValue, valueBytes);
+    for (i = 0; i < GUARD; i++) {
+        if (pValue[valueBytes + i] != GUARD_BYTE)
+            *pOverrun = 1;
+    }
+    return n;
+}
+
+/* Compresses and expands nBytes of pData, returns the compressed size */
+static unsigned roundTrip(const char *what, unsigned dbrType,
+    const epicsUInt8 *pData, unsigned nBytes, unsigned expectEncoding)
+{
+    unsigned dstSize = nBytes + nBytes / 255u + 16u;
+    void *pWork = malloc(caCompressWorkSize(nBytes));
+    epicsUInt8 *pDst = malloc(dstSize);
+    epicsUInt8 *pOut = malloc(nBytes + GUARD);
+    unsigned encoding = 0u, size;
+    int n, overrun = 0;
+
+    if (!pWork || !pDst || !pOut)
+        testAbort("No memory for %u bytes", nBytes);
+
+    size = caCompressArray(dbrType, pData, nBytes, pDst, dstSize, pWork,
+        &encoding);
+    n = guardedExpand(encoding, dbrType, pDst, size, pOut, nBytes,
+        &overrun);
+    testOk(size > 0 && encoding == expectEncoding && n == (int) nBytes &&
+        !overrun && memcmp(pOut, pData, nBytes) == 0,
+        "%s: %u bytes -> %u -> %d", what, nBytes, size, n);
+
+    free(pWork);
+    free(pDst);
+    free(pOut);
+    return size;
+}
+
+static void testRoundTrips(void)
+{
+    enum { N = 100000 };
+    epicsUInt8 *pData = malloc(N);
+    unsigned i, size;
+
+    if (!pData)
+        testAbort("No memory");
+
+    testDiag("Round trips");
+
+    roundTrip("empty", DBR_STRING, pData, 0, CA_COMPRESS_LZ4);
+    memset(pData, 'x', 12);
+    roundTrip("shorter than a match", DBR_STRING, pData, 12,
+        CA_COMPRESS_LZ4);
+
+    for (i = 0; i < N; i++)
+        pData[i] = randomByte();
+    roundTrip("random bytes", DBR_STRING, pData, N, CA_COMPRESS_LZ4);
+
+    memset(pData, 0, N);
+    size = roundTrip("zeros", DBR_DOUBLE, pData, N, CA_COMPRESS_LZ4);
+    testOk(size < N / 100, "zeros shrink to %u bytes", size);
+
+    for (i = 0; i < N; i++)
+        pData[i] = "0123456789abcdefghij"[i % 20];
+    roundTrip("repeating pattern", DBR_STRING, pData, N, CA_COMPRESS_LZ4);
+
+    /* literal runs longer than 15 + 255 between long matches */
+    for (i = 0; i < N; i++)
+        pData[i] = (i / 1000) % 2 ? 7 : randomByte();
+    roundTrip("alternating runs", DBR_STRING, pData, N, CA_COMPRESS_LZ4);
+    roundTrip("CHAR is delta encoded", DBR_CHAR, pData, N,
+        CA_COMPRESS_DELTA_LZ4);
+
+    /* 32 bit big endian ramp, as an array arrives from the network */
+    for (i = 0; i < N / 4; i++) {
+        pData[4 * i] = (epicsUInt8) (i >> 24);
+        pData[4 * i + 1] = (epicsUInt8) (i >> 16);
+        pData[4 * i + 2] = (epicsUInt8) (i >> 8);
+        pData[4 * i + 3] = (epicsUInt8) i;
+    }
+    size = roundTrip("LONG ramp", DBR_LONG, pData, N, CA_COMPRESS_DELTA_LZ4);
+    testOk(size < N / 100, "deltas shrink the ramp to %u bytes", size);
+    roundTrip("SHORT ramp", DBR_SHORT, pData, N, CA_COMPRESS_DELTA_LZ4);
+    roundTrip("odd size", DBR_LONG, pData, N - 3, CA_COMPRESS_DELTA_LZ4);
+    roundTrip("TIME_LONG", DBR_TIME_LONG, pData, N, CA_COMPRESS_DELTA_LZ4);
+    roundTrip("FLOAT is not delta encoded", DBR_FLOAT, pData, N,
+        CA_COMPRESS_LZ4);
+
+    free(pData);
+}
+
+static void testSmallOutput(void)
+{
+    epicsUInt8 data[1000], dst[100];
+    void *pWork = malloc(caCompressWorkSize(sizeof(data)));
+    unsigned encoding, i;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = randomByte();
+    testOk(caCompressArray(DBR_CHAR, data, sizeof(data), dst, sizeof(dst),
+        pWork, &encoding) == 0, "Output that doesn't fit gives zero");
+    free(pWork);
+}
+
+/* "abcd", then 8 bytes 4 back, then "efghi", in the LZ4 block format */
+static const epicsUInt8 reference[] = {
+    0x44, 'a', 'b', 'c', 'd', 0x04, 0x00,
+    0x50, 'e', 'f', 'g', 'h', 'i'
+};
+static const char referenceText[] = "abcdabcdabcdefghi";
+
+static void testReference(void)
+{
+    epicsUInt8 out[sizeof(referenceText) - 1 + GUARD];
+    int overrun = 0;
+    int n = guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, reference,
+        sizeof(reference), out, sizeof(referenceText) - 1, &overrun);
+
+    testOk(n == (int) sizeof(referenceText) - 1 && !overrun &&
+        memcmp(out, referenceText, n) == 0, "Expands a reference block");
+}
+
+static void testCorrupt(void)
+{
+    static const epicsUInt8 zeroDistance[] = { 0x14, 'a', 0, 0, 0x10, 'b' };
+    static const epicsUInt8 farDistance[] = { 0x14, 'a', 2, 0, 0x10, 'b' };
+    static const epicsUInt8 longLiteral[] = { 0x50, 'a', 'b' };
+    static const epicsUInt8 openLength[] = { 0xf0, 255, 255 };
+    epicsUInt8 out[64 + GUARD], block[sizeof(reference)];
+    unsigned i, nOk = 0, nTruncated = 0, nFlipped = 0;
+    int overrun = 0, n;
+
+    testDiag("Corrupt and truncated blocks");
+
+    testOk1(guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, zeroDistance,
+        sizeof(zeroDistance), out, 64, &overrun) == -1);
+    testOk1(guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, farDistance,
+        sizeof(farDistance), out, 64, &overrun) == -1);
+    testOk1(guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, longLiteral,
+        sizeof(longLiteral), out, 64, &overrun) == -1);
+    testOk1(guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, openLength,
+        sizeof(openLength), out, 64, &overrun) == -1);
+    testOk(guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, reference,
+        sizeof(reference), out, 10, &overrun) == -1,
+        "Output longer than the value array");
+    testOk(caExpandArray(99, DBR_CHAR, reference, sizeof(reference),
+        out, 64) == -1, "Unknown encoding");
+    testOk(caExpandArray(CA_COMPRESS_DELTA_LZ4, DBR_DOUBLE, reference,
+        sizeof(reference), out, 64) == -1, "Deltas of a DOUBLE array");
+
+    /* every prefix is either rejected or expands to less */
+    for (i = 0; i < sizeof(reference); i++) {
+        n = guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, reference, i, out,
+            sizeof(referenceText) - 1, &overrun);
+        if (n < (int) sizeof(referenceText) - 1)
+            nTruncated++;
+    }
+    testOk(nTruncated == sizeof(reference),
+        "%u of %u truncated blocks expand short or fail",
+        nTruncated, (unsigned) sizeof(reference));
+
+    /* no corruption may write past the value array */
+    for (i = 0; i < 10000; i++) {
+        memcpy(block, reference, sizeof(block));
+        block[randomByte() % sizeof(block)] = randomByte();
+        block[randomByte() % sizeof(block)] = randomByte();
+        n = guardedExpand(CA_COMPRESS_LZ4, DBR_CHAR, block, sizeof(block),
+            out, sizeof(referenceText) - 1, &overrun);
+        if (n <= (int) sizeof(referenceText) - 1)
+            nOk++;
+        if (n < 0)
+            nFlipped++;
+    }
+    testOk(nOk == 10000 && !overrun,
+        "Corrupted blocks stay within the value array, %u rejected",
+        nFlipped);
+}
+
+MAIN(caCompressTest)
+{
+    testPlan(25);
+    testRoundTrips();
+    testSmallOutput();
+    testReference();
+    testCorrupt();
+    return testDone();
+}
@@ -22,6 +22,11 @@
 #   pragma warning(disable:4355)
 #endif
 
+#include <new>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
 #define epicsAssertAuthor "Jeff Hill johill@lanl.gov"
 
 #include "envDefs.h"
@@ -122,6 +127,7 @@ udpiiu::udpiiu (
     cac & cac,
     unsigned port,
     tsDLList < SearchDest > & searchDestListIn ) :
+    timeAtStart ( epicsTime::getCurrent () ),
     recvThread ( *this, ctxNotifyIn, cbMutexIn, "CAC-UDP", 
         epicsThreadGetStackSize ( epicsThreadStackMedium ),
         cac::lowestPriorityLevelAbove (
@@ -139,8 +145,13 @@ udpiiu::udpiiu (
     cacMutex ( cacMutexIn ),
     nTimers ( getNTimers(maxPeriod) ),
     ppSearchTmr ( nTimers ),
+    pNameMcastFrames ( 0 ),
     nBytesInXmitBuf ( 0 ),
+    nBytesInServerXmitBuf ( 0 ),
     beaconAnomalyTimerIndex ( 0 ),
+    searchFramesSent ( 0u ),
+    serverSearchFramesSent ( 0u ),
+    negCacheHits ( 0u ),
     sequenceNumber ( 0 ),
     lastReceivedSeqNo ( 0 ),
     sock ( 0 ),
@@ -149,6 +160,12 @@ udpiiu::udpiiu (
     localPort ( 0 ),
     shutdownCmd ( false ),
     lastReceivedSeqNoIsValid ( false )
+#ifdef CA_UDP_HAVE_MMSG
+    , nSendFrames ( 0u ),
+    nSendMsgs ( 0u ),
+    sendBatchOpen ( false ),
+    mmsgSupported ( true )
+#endif
 {
     cacGuard.assertIdenticalMutex ( cacMutex );
 
@@ -207,6 +224,32 @@ udpiiu::udpiiu (
     }
 #endif
 
+    /*
+     * with multicast name resolution each search request goes
+     * to the group selected by the name
+     */
+    if ( caNameMcastConfigure ( & this->nameMcast, 
+            static_cast < unsigned short > ( this->serverPort ) ) == 0 ) {
+#ifdef IP_MULTICAST_IF
+        if ( this->nameMcast.intf.sin_addr.s_addr != htonl ( INADDR_ANY ) ) {
+            if ( setsockopt ( this->sock, IPPROTO_IP, IP_MULTICAST_IF,
+                    (char *) & this->nameMcast.intf.sin_addr, 
+                    sizeof ( this->nameMcast.intf.sin_addr ) ) ) {
+                char sockErrBuf[64];
+                epicsSocketConvertErrnoToString (
+                    sockErrBuf, sizeof ( sockErrBuf ) );
+                errlogPrintf ( "CAC: failed to set mcast interface because \"%s\"\n",
+                    sockErrBuf );
+            }
+        }
+#endif
+        this->pNameMcastFrames = 
+            new NameMcastFrame [ this->nameMcast.nGroups ];
+        for ( unsigned i = 0u; i < this->nameMcast.nGroups; i++ ) {
+            this->pNameMcastFrames[i].nBytes = 0u;
+        }
+    }
+
     int boolValue = true;
     int status = setsockopt ( this->sock, SOL_SOCKET, SO_BROADCAST, 
                 (char *) &boolValue, sizeof ( boolValue ) );
@@ -317,6 +360,7 @@ udpiiu::~udpiiu ()
         epicsGuard < epicsMutex > cbGuard ( this->cbMutex );
         epicsGuard < epicsMutex > guard ( this->cacMutex );
         this->shutdown ( cbGuard, guard );
+        this->negCacheClear ( guard );
     }
 
     tsDLIter < SearchDest > iter ( _searchDestList.firstIter () );
@@ -328,6 +372,8 @@ udpiiu::~udpiiu ()
     }
     
     epicsSocketDestroy ( this->sock );
+
+    delete [] this->pNameMcastFrames;
 }
 
 void udpiiu::shutdown ( 
@@ -392,18 +438,97 @@ void udpRecvThread::show ( unsigned /* level */ ) const
 {
 }
 
+static void reportRecvError ( int errnoCpy )
+{
+    if ( 
+        errnoCpy != SOCK_EINTR &&
+        errnoCpy != SOCK_SHUTDOWN &&
+        errnoCpy != SOCK_ENOTSOCK &&
+        errnoCpy != SOCK_EBADF &&
+        // Avoid spurious ECONNREFUSED bug in linux
+        errnoCpy != SOCK_ECONNREFUSED &&
+        // Avoid ECONNRESET from disconnected socket bug
+        // in windows
+        errnoCpy != SOCK_ECONNRESET ) {
+
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString ( 
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAC: UDP recv error was \"%s\"\n", 
+            sockErrBuf );
+    }
+}
+
+#ifdef CA_UDP_HAVE_MMSG
+// datagrams drained from the socket by one recvmmsg () call
+static const unsigned recvBatchSize = 8u;
+#endif
+
 void udpRecvThread::run ()
 {
     epicsThreadPrivateSet ( caClientCallbackThreadId, &this->iiu );
     
-    if ( this->iiu._searchDestList.count () == 0 ) { 
+    if ( this->iiu._searchDestList.count () == 0 &&
+            ! this->iiu.nameMcast.nGroups ) { 
         callbackManager mgr ( this->ctxNotify, this->cbMutex );
         epicsGuard < epicsMutex > guard ( this->iiu.cacMutex );
         genLocalExcep ( mgr.cbGuard, guard, 
             this->iiu.cacRef, ECA_NOSEARCHADDR, NULL );
     }
 
+#ifdef CA_UDP_HAVE_MMSG
+    // the first datagram goes into recvBuf, the others into pBatchBuf
+    char * pBatchBuf = new char [ ( recvBatchSize - 1u ) * MAX_UDP_RECV ];
+    struct mmsghdr msgs [recvBatchSize];
+    struct iovec iov [recvBatchSize];
+    osiSockAddr srcs [recvBatchSize];
+    bool mmsgSupported = true;
+
+    memset ( msgs, 0, sizeof ( msgs ) );
+    for ( unsigned i = 0u; i < recvBatchSize; i++ ) {
+        iov[i].iov_base = i ? 
+            & pBatchBuf[ ( i - 1u ) * MAX_UDP_RECV ] : this->iiu.recvBuf;
+        iov[i].iov_len = MAX_UDP_RECV;
+        msgs[i].msg_hdr.msg_iov = & iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = & srcs[i].sa;
+    }
+#endif
+
     do {
+#ifdef CA_UDP_HAVE_MMSG
+        if ( mmsgSupported ) {
+            for ( unsigned i = 0u; i < recvBatchSize; i++ ) {
+                msgs[i].msg_hdr.msg_namelen = sizeof ( srcs[i] );
+            }
+
+            // block for the first datagram, then take what is queued
+            int status = recvmmsg ( this->iiu.sock, 
+                msgs, recvBatchSize, MSG_WAITFORONE, 0 );
+
+            if ( status > 0 ) {
+                epicsTime currentTime = epicsTime::getCurrent ();
+                for ( int i = 0; i < status; i++ ) {
+                    if ( msgs[i].msg_len > 0u ) {
+                        this->iiu.postMsg ( srcs[i], 
+                            static_cast < char * > ( iov[i].iov_base ),
+                            (arrayElementCount) msgs[i].msg_len, 
+                            currentTime );
+                    }
+                }
+            }
+            else if ( status < 0 ) {
+                int errnoCpy = SOCKERRNO;
+                if ( errnoCpy == ENOSYS ) {
+                    mmsgSupported = false;
+                }
+                else {
+                    reportRecvError ( errnoCpy );
+                }
+            }
+            continue;
+        }
+#endif
         osiSockAddr src;
         osiSocklen_t src_size = sizeof ( src );
         int status = recvfrom ( this->iiu.sock, 
@@ -413,24 +538,7 @@ void udpRecvThread::run ()
         if ( status <= 0 ) {
 
             if ( status < 0 ) {
-                int errnoCpy = SOCKERRNO;
-                if ( 
-                    errnoCpy != SOCK_EINTR &&
-                    errnoCpy != SOCK_SHUTDOWN &&
-                    errnoCpy != SOCK_ENOTSOCK &&
-                    errnoCpy != SOCK_EBADF &&
-                    // Avoid spurious ECONNREFUSED bug in linux
-                    errnoCpy != SOCK_ECONNREFUSED &&
-                    // Avoid ECONNRESET from disconnected socket bug
-                    // in windows
-                    errnoCpy != SOCK_ECONNRESET ) {
-
-                    char sockErrBuf[64];
-                    epicsSocketConvertErrnoToString ( 
-                        sockErrBuf, sizeof ( sockErrBuf ) );
-                    errlogPrintf ( "CAC: UDP recv error was \"%s\"\n", 
-                        sockErrBuf );
-                }
+                reportRecvError ( SOCKERRNO );
             }
         }
         else if ( status > 0 ) {
@@ -439,6 +547,10 @@ void udpRecvThread::run ()
         }
 
     } while ( ! this->iiu.shutdownCmd );
+
+#ifdef CA_UDP_HAVE_MMSG
+    delete [] pBatchBuf;
+#endif
 }
 
 /* for sunpro compiler */
@@ -731,12 +843,12 @@ bool udpiiu :: searchRespAction (
     if ( CA_V42 ( minorVersion ) ) {
        cacRef.transferChanToVirtCircuit 
             ( msg.m_available, msg.m_cid, 0xffff, 
-                0, minorVersion, serverAddr, currentTime );
+                0, minorVersion, serverAddr, addr, currentTime );
     }
     else {
         cacRef.transferChanToVirtCircuit 
             ( msg.m_available, msg.m_cid, msg.m_dataType, 
-                msg.m_count, minorVersion, serverAddr, currentTime );
+                msg.m_count, minorVersion, serverAddr, addr, currentTime );
     }
 
     return true;
@@ -929,6 +1041,14 @@ bool udpiiu::pushVersionMsg ()
 
 bool udpiiu::pushDatagramMsg ( epicsGuard < epicsMutex > & guard, 
     const caHdr & msg, const void * pExt, ca_uint16_t extsize )
+{
+    return this->pushDatagramMsg ( guard, this->xmitBuf, 
+        this->nBytesInXmitBuf, msg, pExt, extsize );
+}
+
+bool udpiiu::pushDatagramMsg ( epicsGuard < epicsMutex > & guard, 
+    char * pBuf, unsigned & nBytesInBuf,
+    const caHdr & msg, const void * pExt, ca_uint16_t extsize )
 {
     guard.assertIdenticalMutex ( this->cacMutex );
 
@@ -936,15 +1056,15 @@ bool udpiiu::pushDatagramMsg ( epicsGuard < epicsMutex > & guard,
     arrayElementCount msgsize = sizeof ( caHdr ) + alignedExtSize;
 
     /* fail out if max message size exceeded */
-    if ( msgsize >= sizeof ( this->xmitBuf ) - 7 ) {
+    if ( msgsize >= MAX_UDP_SEND - 7 ) {
         return false;
     }
 
-    if ( msgsize + this->nBytesInXmitBuf > sizeof ( this->xmitBuf ) ) {
+    if ( msgsize + nBytesInBuf > MAX_UDP_SEND ) {
         return false;
     }
 
-    caHdr * pbufmsg = ( caHdr * ) &this->xmitBuf[this->nBytesInXmitBuf];
+    caHdr * pbufmsg = ( caHdr * ) &pBuf[nBytesInBuf];
     *pbufmsg = msg;
     if ( extsize ) {
         memcpy ( pbufmsg + 1, pExt, extsize );
@@ -954,7 +1074,7 @@ bool udpiiu::pushDatagramMsg ( epicsGuard < epicsMutex > & guard,
         }
     }
     AlignedWireRef < epicsUInt16 > ( pbufmsg->m_postsize ) = alignedExtSize;
-    this->nBytesInXmitBuf += msgsize;
+    nBytesInBuf += msgsize;
 
     return true;
 }
@@ -969,12 +1089,23 @@ void udpiiu :: SearchDestUDP :: searchRequest (
             epicsGuard < epicsMutex > & guard, const char * pBuf, size_t bufSize )
 {
     guard.assertIdenticalMutex ( _udpiiu.cacMutex );
+#ifdef CA_UDP_HAVE_MMSG
+    if ( _udpiiu.queueDatagram ( guard, _destAddr, pBuf, bufSize ) ) {
+        return;
+    }
+#endif
+    _udpiiu.sendDatagram ( _destAddr, pBuf, bufSize );
+}
+
+void udpiiu :: sendDatagram ( 
+    const osiSockAddr & dest, const char * pBuf, size_t bufSize )
+{
     assert ( bufSize <= INT_MAX );
     int bufSizeAsInt = static_cast < int > ( bufSize );
     while ( true ) {
         // This const_cast is needed for vxWorks:
-        int status = sendto ( _udpiiu.sock, const_cast<char *>(pBuf), bufSizeAsInt, 0, 
-                & _destAddr.sa, sizeof ( _destAddr.sa ) );
+        int status = sendto ( this->sock, const_cast<char *>(pBuf), bufSizeAsInt, 0, 
+                & dest.sa, sizeof ( dest.sa ) );
         if ( status == bufSizeAsInt ) {
             break;
         }
@@ -986,7 +1117,7 @@ void udpiiu :: SearchDestUDP :: searchRequest (
             int localErrno = SOCKERRNO;
 
             if ( localErrno == SOCK_EINTR ) {
-                if ( _udpiiu.shutdownCmd ) {
+                if ( this->shutdownCmd ) {
                     break;
                 }
                 else {
@@ -1007,7 +1138,7 @@ void udpiiu :: SearchDestUDP :: searchRequest (
                 epicsSocketConvertErrnoToString ( 
                     sockErrBuf, sizeof ( sockErrBuf ) );
                 char buf[64];
-                sockAddrToDottedIP ( &_destAddr.sa, buf, sizeof ( buf ) );
+                sockAddrToDottedIP ( &dest.sa, buf, sizeof ( buf ) );
                 errlogPrintf (
                     "CAC: error = \"%s\" sending UDP msg to %s\n",
                     sockErrBuf, buf);
@@ -1016,7 +1147,87 @@ void udpiiu :: SearchDestUDP :: searchRequest (
         }
     }
 }
-            
+
+#ifdef CA_UDP_HAVE_MMSG
+//
+// udpiiu :: queueDatagram ()
+//
+// Queues a frame built by datagramFlush () for sendmmsg (),
+// returns false if it must be sent right away
+//
+bool udpiiu :: queueDatagram ( epicsGuard < epicsMutex > & guard,
+    const osiSockAddr & dest, const char * pBuf, size_t bufSize )
+{
+    guard.assertIdenticalMutex ( this->cacMutex );
+
+    if ( ! this->mmsgSupported || this->nSendFrames == 0u ||
+        pBuf != this->sendIov[this->nSendFrames - 1u].iov_base ) {
+        return false;
+    }
+    if ( this->nSendMsgs >= sendBatchMsgs ) {
+        this->sendQueuedDatagrams ( guard );
+    }
+
+    unsigned i = this->nSendMsgs++;
+    this->sendAddrs[i] = dest;
+    struct msghdr & hdr = this->sendMsgs[i].msg_hdr;
+    memset ( & hdr, 0, sizeof ( hdr ) );
+    hdr.msg_name = & this->sendAddrs[i].sa;
+    hdr.msg_namelen = sizeof ( this->sendAddrs[i].sa );
+    hdr.msg_iov = & this->sendIov[this->nSendFrames - 1u];
+    hdr.msg_iovlen = 1;
+    return true;
+}
+
+//
+// udpiiu :: sendQueuedDatagrams ()
+//
+void udpiiu :: sendQueuedDatagrams ( epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->cacMutex );
+
+    unsigned next = 0u;
+    while ( next < this->nSendMsgs ) {
+        int status = sendmmsg ( this->sock, & this->sendMsgs[next], 
+            this->nSendMsgs - next, 0 );
+        if ( status > 0 ) {
+            for ( int i = 0; i < status; i++, next++ ) {
+                const struct msghdr & hdr = this->sendMsgs[next].msg_hdr;
+                if ( this->sendMsgs[next].msg_len != hdr.msg_iov->iov_len ) {
+                    errlogPrintf ( "CAC: UDP sendmmsg () call returned strange xmit count?\n" );
+                }
+            }
+            continue;
+        }
+
+        int localErrno = SOCKERRNO;
+        if ( localErrno == SOCK_EINTR && ! this->shutdownCmd ) {
+            continue;
+        }
+        if ( localErrno == SOCK_EINTR || 
+            localErrno == SOCK_SHUTDOWN || 
+            localErrno == SOCK_ENOTSOCK || 
+            localErrno == SOCK_EBADF ) {
+            break;
+        }
+        if ( localErrno == ENOSYS ) {
+            this->mmsgSupported = false;
+        }
+
+        // sendto () reports the error for this destination, 
+        // or sends the rest if sendmmsg () isnt available
+        do {
+            const struct msghdr & hdr = this->sendMsgs[next].msg_hdr;
+            this->sendDatagram ( this->sendAddrs[next], 
+                static_cast < const char * > ( hdr.msg_iov->iov_base ), 
+                hdr.msg_iov->iov_len );
+            next++;
+        } while ( ! this->mmsgSupported && next < this->nSendMsgs );
+    }
+    this->nSendMsgs = 0u;
+}
+#endif
+
 void udpiiu :: SearchDestUDP :: show ( 
     epicsGuard < epicsMutex > & guard, unsigned level ) const
 {
@@ -1090,12 +1301,12 @@ void udpiiu :: SearchRespCallback :: notify (
     if ( CA_V42 ( minorVersion ) ) {
        _udpiiu.cacRef.transferChanToVirtCircuit 
             ( msg.m_available, msg.m_cid, 0xffff, 
-                0, minorVersion, serverAddr, currentTime );
+                0, minorVersion, serverAddr, addr, currentTime );
     }
     else {
         _udpiiu.cacRef.transferChanToVirtCircuit 
             ( msg.m_available, msg.m_cid, msg.m_dataType, 
-                msg.m_count, minorVersion, serverAddr, currentTime );
+                msg.m_count, minorVersion, serverAddr, addr, currentTime );
     }
 }
 
@@ -1111,23 +1322,162 @@ bool udpiiu :: datagramFlush (
 {
     guard.assertIdenticalMutex ( cacMutex );
 
-    // dont send the version header by itself
-    if ( this->nBytesInXmitBuf <= sizeof ( caHdr ) ) {
-        return false;
+    this->sendServerFrame ( guard );
+
+    if ( this->nameMcast.nGroups ) {
+        bool sent = false;
+        for ( unsigned i = 0u; i < this->nameMcast.nGroups; i++ ) {
+            NameMcastFrame & frame = this->pNameMcastFrames[i];
+            // dont send the version header by itself
+            if ( frame.nBytes > sizeof ( caHdr ) ) {
+                osiSockAddr group;
+                caNameMcastGroup ( & this->nameMcast, i, & group.ia );
+                this->sendFrame ( guard, frame.buf, frame.nBytes, & group );
+                sent = true;
+            }
+            frame.nBytes = 0u;
+        }
+        if ( ! sent ) {
+            return false;
+        }
+    }
+    else {
+        // dont send the version header by itself
+        if ( this->nBytesInXmitBuf <= sizeof ( caHdr ) ) {
+            return false;
+        }
+        this->sendFrame ( guard, this->xmitBuf, this->nBytesInXmitBuf, 0 );
+    }
+
+#ifdef CA_UDP_HAVE_MMSG
+    if ( ! this->sendBatchOpen ) {
+        this->sendQueuedDatagrams ( guard );
+        this->nSendFrames = 0u;
+    }
+#endif
+
+    this->nBytesInXmitBuf = 0u;
+
+    this->pushVersionMsg ();
+
+    return true;
+}
+
+//
+// udpiiu :: sendFrame ()
+//
+// Sends a frame to each search destination, and to its 
+// name resolution group if there is one
+//
+void udpiiu :: sendFrame ( epicsGuard < epicsMutex > & guard, 
+    const char * pBuf, unsigned nBytes, const osiSockAddr * pGroup )
+{
+    const char * pFrame = this->batchFrame ( guard, pBuf, nBytes );
+    bool queued = false;
+
+#ifdef CA_UDP_HAVE_MMSG
+    if ( pGroup ) {
+        queued = this->queueDatagram ( guard, *pGroup, pFrame, nBytes );
+    }
+#endif
+
+    if ( pGroup && ! queued ) {
+        this->sendDatagram ( *pGroup, pFrame, nBytes );
     }
 
     tsDLIter < SearchDest > iter ( _searchDestList.firstIter () );
     while ( iter.valid () )
     {
-        iter->searchRequest ( guard, this->xmitBuf, this->nBytesInXmitBuf );
+        iter->searchRequest ( guard, pFrame, nBytes );
         iter++;
     }
 
-    this->nBytesInXmitBuf = 0u;
+    if ( this->searchFramesSent < UINT_MAX ) {
+        this->searchFramesSent++;
+    }
+}
 
-    this->pushVersionMsg ();
+//
+// udpiiu :: sendServerFrame ()
+//
+// Sends the searches for the channels of one server, if any
+//
+void udpiiu :: sendServerFrame ( epicsGuard < epicsMutex > & guard )
+{
+    // dont send the version header by itself
+    if ( this->nBytesInServerXmitBuf <= sizeof ( caHdr ) ) {
+        this->nBytesInServerXmitBuf = 0u;
+        return;
+    }
 
-    return true;
+    const char * pFrame = this->batchFrame ( guard, 
+        this->serverXmitBuf, this->nBytesInServerXmitBuf );
+    bool queued = false;
+
+#ifdef CA_UDP_HAVE_MMSG
+    queued = this->queueDatagram ( guard, this->serverXmitDest, 
+        pFrame, this->nBytesInServerXmitBuf );
+    if ( queued && ! this->sendBatchOpen ) {
+        this->sendQueuedDatagrams ( guard );
+        this->nSendFrames = 0u;
+    }
+#endif
+
+    if ( ! queued ) {
+        this->sendDatagram ( this->serverXmitDest, pFrame, 
+            this->nBytesInServerXmitBuf );
+    }
+
+    this->nBytesInServerXmitBuf = 0u;
+    if ( this->serverSearchFramesSent < UINT_MAX ) {
+        this->serverSearchFramesSent++;
+    }
+}
+
+//
+// udpiiu :: batchFrame ()
+//
+// Returns a copy of the frame that lasts until sendmmsg () has 
+// sent it to each destination
+//
+const char * udpiiu :: batchFrame ( epicsGuard < epicsMutex > & guard, 
+    const char * pBuf, unsigned nBytes )
+{
+    guard.assertIdenticalMutex ( this->cacMutex );
+#ifdef CA_UDP_HAVE_MMSG
+    if ( this->nSendFrames >= sendBatchFrames ) {
+        this->sendQueuedDatagrams ( guard );
+        this->nSendFrames = 0u;
+    }
+    char * pCopy = this->sendFrames[this->nSendFrames];
+    memcpy ( pCopy, pBuf, nBytes );
+    this->sendIov[this->nSendFrames].iov_base = pCopy;
+    this->sendIov[this->nSendFrames].iov_len = nBytes;
+    this->nSendFrames++;
+    return pCopy;
+#else
+    return pBuf;
+#endif
+}
+
+void udpiiu :: datagramBatchBegin ( 
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( cacMutex );
+#ifdef CA_UDP_HAVE_MMSG
+    this->sendBatchOpen = true;
+#endif
+}
+
+void udpiiu :: datagramBatchEnd ( 
+    epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( cacMutex );
+#ifdef CA_UDP_HAVE_MMSG
+    this->sendQueuedDatagrams ( guard );
+    this->nSendFrames = 0u;
+    this->sendBatchOpen = false;
+#endif
 }
 
 void udpiiu :: show ( unsigned level ) const
@@ -1135,11 +1485,28 @@ void udpiiu :: show ( unsigned level ) const
     epicsGuard < epicsMutex > guard ( this->cacMutex );
 
     ::printf ( "Datagram IO circuit (and disconnected channel repository)\n");
+    double elapsed = epicsTime::getCurrent () - this->timeAtStart;
+    if ( elapsed <= 0.0 ) {
+        elapsed = 1.0;
+    }
+    ::printf ( "\tsearch frames sent %u, %.2f per sec\n", 
+        this->searchFramesSent, this->searchFramesSent / elapsed );
+    ::printf ( "\tsearch frames sent to the last known server %u, "
+        "%.2f per sec\n", this->serverSearchFramesSent, 
+        this->serverSearchFramesSent / elapsed );
+    ::printf ( "\tunanswered names cached %u, hit %u times\n", 
+        this->negCacheList.count (), this->negCacheHits );
     if ( level > 1u ) {
         ::printf ("\trepeater port %u\n", this->repeaterPort );
         ::printf ("\tdefault server port %u\n", this->serverPort );
         ::printf ( "Search Destination List with %u items\n", 
             _searchDestList.count () );
+        if ( this->nameMcast.nGroups ) {
+            char buf[64];
+            ipAddrToDottedIP ( & this->nameMcast.base, buf, sizeof ( buf ) );
+            ::printf ( "\tname resolution multicast to %u groups from %s\n",
+                this->nameMcast.nGroups, buf );
+        }
         if ( level > 2u ) {
             tsDLIterConst < SearchDest > iter ( 
                 _searchDestList.firstIter () );
@@ -1191,8 +1558,18 @@ bool udpiiu::wakeupMsg ()
 }
 
 void udpiiu::beaconAnomalyNotify ( 
-    epicsGuard < epicsMutex > & cacGuard ) 
+    epicsGuard < epicsMutex > & cacGuard, const inetAddrID & server ) 
 {
+    // the new server may host any of the names
+    this->negCacheClear ( cacGuard );
+
+    // search right away for the channels that this server
+    // hosted before, and only at this server at first
+    for ( unsigned i = 1u; i < this->nTimers; i++ ) {
+        this->ppSearchTmr[i]->moveServerChannels ( cacGuard, 
+            server, *this->ppSearchTmr[0] );
+    }
+
     for ( unsigned i = this->beaconAnomalyTimerIndex+1u; 
             i < this->nTimers; i++ ) {
         this->ppSearchTmr[i]->moveChannels ( cacGuard, 
@@ -1215,6 +1592,9 @@ void udpiiu::uninstallChanDueToSuccessfulSearchResponse (
             guard, chan, this->lastReceivedSeqNo, 
             this->lastReceivedSeqNoIsValid, currentTime );
     }
+    if ( this->negCacheList.count () ) {
+        this->negCacheRemove ( guard, chan.pName ( guard ) );
+    }
 }
 
 void udpiiu::uninstallChan ( 
@@ -1233,7 +1613,8 @@ void udpiiu::uninstallChan (
 
 bool udpiiu::searchMsg (
     epicsGuard < epicsMutex > & guard, ca_uint32_t id, 
-        const char * pName, unsigned nameLength )
+        const char * pName, unsigned nameLength,
+        const osiSockAddr * pServer )
 {
     caHdr msg;
     AlignedWireRef < epicsUInt16 > ( msg.m_cmmd ) = CA_PROTO_SEARCH;
@@ -1241,6 +1622,44 @@ bool udpiiu::searchMsg (
     AlignedWireRef < epicsUInt16 > ( msg.m_dataType ) = DONTREPLY;
     AlignedWireRef < epicsUInt16 > ( msg.m_count ) = CA_MINOR_PROTOCOL_REVISION;
     AlignedWireRef < epicsUInt32 > ( msg.m_cid ) = id;
+
+    if ( pServer ) {
+        // the channels of one server are usually next to each
+        // other in the search timer's list
+        if ( this->nBytesInServerXmitBuf && 
+                ! ( inetAddrID ( this->serverXmitDest.ia ) == 
+                    inetAddrID ( pServer->ia ) ) ) {
+            this->sendServerFrame ( guard );
+        }
+        for ( unsigned i = 0u; i < 2u; i++ ) {
+            // each frame starts with the current version message
+            if ( this->nBytesInServerXmitBuf == 0u ) {
+                memcpy ( this->serverXmitBuf, this->xmitBuf, sizeof ( caHdr ) );
+                this->nBytesInServerXmitBuf = sizeof ( caHdr );
+                this->serverXmitDest = *pServer;
+            }
+            if ( this->pushDatagramMsg ( guard, this->serverXmitBuf, 
+                    this->nBytesInServerXmitBuf, msg, pName, 
+                    (ca_uint16_t) nameLength ) ) {
+                return true;
+            }
+            this->sendServerFrame ( guard );
+        }
+        return false;
+    }
+
+    if ( this->nameMcast.nGroups ) {
+        NameMcastFrame & frame = this->pNameMcastFrames [ 
+            caNameMcastIndex ( & this->nameMcast, pName, nameLength ) ];
+        // each frame starts with the current version message
+        if ( frame.nBytes == 0u ) {
+            memcpy ( frame.buf, this->xmitBuf, this->nBytesInXmitBuf );
+            frame.nBytes = this->nBytesInXmitBuf;
+        }
+        return this->pushDatagramMsg ( guard, frame.buf, frame.nBytes,
+            msg, pName, (ca_uint16_t) nameLength );
+    }
+
     return this->pushDatagramMsg ( 
         guard, msg, pName, (ca_uint16_t) nameLength );
 }
@@ -1249,12 +1668,28 @@ void udpiiu::installNewChannel (
     epicsGuard < epicsMutex > & guard, nciu & chan, netiiu * & piiu )
 {
     piiu = this;
-    this->ppSearchTmr[0]->installChannel ( guard, chan );
+    unsigned index = 0u;
+    if ( this->negCacheList.count () &&
+            this->negCacheFind ( guard, chan.pName ( guard ), 
+                epicsTime::getCurrent () ) ) {
+        index = this->beaconAnomalyTimerIndex + 1u;
+        if ( index >= this->nTimers ) {
+            index = this->nTimers - 1u;
+        }
+        if ( this->negCacheHits < UINT_MAX ) {
+            this->negCacheHits++;
+        }
+    }
+    this->ppSearchTmr[index]->installChannel ( guard, chan );
 }
 
 void udpiiu::installDisconnectedChannel ( 
     epicsGuard < epicsMutex > & guard, nciu & chan )
 {
+    osiSockAddr server = chan.getPIIU ( guard )->getNetworkAddress ( guard );
+    if ( server.sa.sa_family == AF_INET ) {
+        chan.setServerHint ( guard, server, this->serverPort );
+    }
     chan.setServerAddressUnknown ( *this, guard );
     this->govTmr.installChan ( guard, chan );
 }
@@ -1263,6 +1698,11 @@ void udpiiu::noSearchRespNotify (
     epicsGuard < epicsMutex > & guard, nciu & chan, unsigned index )
 {
     const unsigned nTimersMinusOne = this->nTimers - 1;
+    if ( index == this->beaconAnomalyTimerIndex && 
+            index < nTimersMinusOne ) {
+        this->negCacheAdd ( guard, chan.pName ( guard ), 
+            epicsTime::getCurrent () );
+    }
     if ( index < nTimersMinusOne ) {
         index++;
     }
@@ -1272,6 +1712,66 @@ void udpiiu::noSearchRespNotify (
     this->ppSearchTmr[index]->installChannel ( guard, chan );
 }
 
+bool udpiiu::negCacheFind ( epicsGuard < epicsMutex > & guard, 
+    const char * pName, const epicsTime & currentTime )
+{
+    this->negCacheExpire ( guard, currentTime );
+    stringId id ( pName, stringId::refString );
+    return this->negCache.lookup ( id ) != 0;
+}
+
+void udpiiu::negCacheAdd ( epicsGuard < epicsMutex > & guard, 
+    const char * pName, const epicsTime & currentTime )
+{
+    this->negCacheExpire ( guard, currentTime );
+    this->negCacheRemove ( guard, pName );
+    try {
+        searchNegCacheEntry * pEntry = 
+            new searchNegCacheEntry ( pName, currentTime + this->maxPeriod );
+        this->negCache.add ( *pEntry );
+        this->negCacheList.add ( *pEntry );
+    }
+    catch ( std::bad_alloc & ) {
+        // the cache is only an optimization
+    }
+}
+
+void udpiiu::negCacheRemove ( epicsGuard < epicsMutex > & guard, 
+    const char * pName )
+{
+    guard.assertIdenticalMutex ( this->cacMutex );
+    stringId id ( pName, stringId::refString );
+    searchNegCacheEntry * pEntry = this->negCache.remove ( id );
+    if ( pEntry ) {
+        this->negCacheList.remove ( *pEntry );
+        delete pEntry;
+    }
+}
+
+// all entries live equally long so the oldest are first
+void udpiiu::negCacheExpire ( epicsGuard < epicsMutex > & guard, 
+    const epicsTime & currentTime )
+{
+    guard.assertIdenticalMutex ( this->cacMutex );
+    while ( searchNegCacheEntry * pEntry = this->negCacheList.first () ) {
+        if ( pEntry->expire > currentTime ) {
+            break;
+        }
+        this->negCacheList.remove ( *pEntry );
+        this->negCache.remove ( *pEntry );
+        delete pEntry;
+    }
+}
+
+void udpiiu::negCacheClear ( epicsGuard < epicsMutex > & guard )
+{
+    guard.assertIdenticalMutex ( this->cacMutex );
+    while ( searchNegCacheEntry * pEntry = this->negCacheList.get () ) {
+        this->negCache.remove ( *pEntry );
+        delete pEntry;
+    }
+}
+
 void udpiiu::boostChannel ( 
     epicsGuard < epicsMutex > & guard, nciu & chan )
 {
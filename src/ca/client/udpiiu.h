@@ -36,6 +36,7 @@
 #include "epicsThread.h"
 #include "epicsTime.h"
 #include "tsDLList.h"
+#include "resourceLib.h"
 
 #ifdef udpiiuh_accessh_epicsExportSharedSymbols
 #   define epicsExportSharedSymbols
@@ -47,6 +48,13 @@
 #include "disconnectGovernorTimer.h"
 #include "repeaterSubscribeTimer.h"
 #include "SearchDest.h"
+#include "addrList.h"
+#include "inetAddrID.h"
+
+// batch the search requests and responses with sendmmsg () and recvmmsg ()
+#if defined(__linux__)
+#   define CA_UDP_HAVE_MMSG
+#endif
 
 extern "C" void cacRecvThreadUDP ( void *pParam );
 
@@ -85,6 +93,24 @@ static const double maxSearchPeriodDefault = 5.0 * 60.0; // seconds
 static const double maxSearchPeriodLowerLimit = 60.0; // seconds
 static const double beaconAnomalySearchPeriod = 5.0; // seconds
 
+//
+// A channel name that no server answered the searches for. New
+// channels with this name skip the fast initial searches until
+// the entry expires, or a new server appears.
+//
+class searchNegCacheEntry :
+    public tsSLNode < searchNegCacheEntry >,
+    public tsDLNode < searchNegCacheEntry >,
+    public stringId {
+public:
+    searchNegCacheEntry ( const char * pName, const epicsTime & expireIn ) :
+        stringId ( pName ), expire ( expireIn ) {}
+    const epicsTime expire;
+private:
+    searchNegCacheEntry ( const searchNegCacheEntry & );
+    searchNegCacheEntry & operator = ( const searchNegCacheEntry & );
+};
+
 class udpiiu : 
     private netiiu, 
     private searchTimerNotify, 
@@ -105,7 +131,7 @@ public:
     void installDisconnectedChannel ( 
         epicsGuard < epicsMutex > &, nciu & );
     void beaconAnomalyNotify ( 
-        epicsGuard < epicsMutex > & guard );
+        epicsGuard < epicsMutex > & guard, const inetAddrID & server );
     void shutdown ( epicsGuard < epicsMutex > & cbGuard, 
         epicsGuard < epicsMutex > & guard );
     void show ( unsigned level ) const;
@@ -153,8 +179,19 @@ private:
     private:
         udpiiu & m_udpiiu;
     };
+    // a frame for each multicast name resolution group
+    struct NameMcastFrame {
+        unsigned nBytes;
+        char buf [MAX_UDP_SEND];
+    };
     char xmitBuf [MAX_UDP_SEND];   
     char recvBuf [MAX_UDP_RECV];
+    // searches sent only to the server that last hosted the channels
+    char serverXmitBuf [MAX_UDP_SEND];
+    osiSockAddr serverXmitDest;
+    resTable < searchNegCacheEntry, stringId > negCache;
+    tsDLList < searchNegCacheEntry > negCacheList; // oldest first
+    epicsTime timeAtStart;
     udpRecvThread recvThread;
     M_repeaterTimerNotify m_repeaterTimerNotify;
     repeaterSubscribeTimer repeaterSubscribeTmr;
@@ -177,8 +214,14 @@ private:
         SearchArray(const SearchArray&);
         SearchArray& operator=(const SearchArray&);
     } ppSearchTmr;
+    caNameMcastConfig nameMcast;
+    NameMcastFrame * pNameMcastFrames;
     unsigned nBytesInXmitBuf;
+    unsigned nBytesInServerXmitBuf;
     unsigned beaconAnomalyTimerIndex;
+    unsigned searchFramesSent;
+    unsigned serverSearchFramesSent;
+    unsigned negCacheHits;
     ca_uint32_t sequenceNumber;
     ca_uint32_t lastReceivedSeqNo;
     SOCKET sock;
@@ -187,6 +230,19 @@ private:
     ca_uint16_t localPort;
     bool shutdownCmd;
     bool lastReceivedSeqNoIsValid;
+#ifdef CA_UDP_HAVE_MMSG
+    // search frames, and the datagrams to each destination, 
+    // waiting for sendmmsg ()
+    enum { sendBatchFrames = 16u, sendBatchMsgs = 64u };
+    char sendFrames [sendBatchFrames][MAX_UDP_SEND];
+    struct iovec sendIov [sendBatchFrames];
+    struct mmsghdr sendMsgs [sendBatchMsgs];
+    osiSockAddr sendAddrs [sendBatchMsgs];
+    unsigned nSendFrames;
+    unsigned nSendMsgs;
+    bool sendBatchOpen;
+    bool mmsgSupported;
+#endif
 
     bool wakeupMsg ();
 
@@ -198,6 +254,33 @@ private:
     bool pushDatagramMsg ( epicsGuard < epicsMutex > &, 
         const caHdr & hdr, const void * pExt, 
         ca_uint16_t extsize);
+    bool pushDatagramMsg ( epicsGuard < epicsMutex > &, 
+        char * pBuf, unsigned & nBytesInBuf,
+        const caHdr & hdr, const void * pExt, 
+        ca_uint16_t extsize);
+
+    void sendFrame ( epicsGuard < epicsMutex > &, 
+        const char * pBuf, unsigned nBytes, 
+        const osiSockAddr * pGroup );
+    void sendServerFrame ( epicsGuard < epicsMutex > & );
+    const char * batchFrame ( epicsGuard < epicsMutex > &,
+        const char * pBuf, unsigned nBytes );
+    bool negCacheFind ( epicsGuard < epicsMutex > &,
+        const char * pName, const epicsTime & currentTime );
+    void negCacheAdd ( epicsGuard < epicsMutex > &,
+        const char * pName, const epicsTime & currentTime );
+    void negCacheRemove ( epicsGuard < epicsMutex > &,
+        const char * pName );
+    void negCacheExpire ( epicsGuard < epicsMutex > &,
+        const epicsTime & currentTime );
+    void negCacheClear ( epicsGuard < epicsMutex > & );
+    void sendDatagram ( const osiSockAddr & dest, 
+        const char * pBuf, size_t bufSize );
+#ifdef CA_UDP_HAVE_MMSG
+    bool queueDatagram ( epicsGuard < epicsMutex > &,
+        const osiSockAddr & dest, const char * pBuf, size_t bufSize );
+    void sendQueuedDatagrams ( epicsGuard < epicsMutex > & );
+#endif
 
     typedef bool ( udpiiu::*pProtoStubUDP ) ( 
         const caHdr &, 
@@ -283,7 +366,8 @@ private:
         epicsGuard < epicsMutex > & ) const;
     bool searchMsg (
         epicsGuard < epicsMutex > &, ca_uint32_t id, 
-            const char * pName, unsigned nameLength );
+            const char * pName, unsigned nameLength,
+            const osiSockAddr * pServer );
 
     // searchTimerNotify stubs
     double getRTTE ( epicsGuard < epicsMutex > & ) const;
@@ -295,6 +379,10 @@ private:
         epicsGuard < epicsMutex > &, nciu & chan, unsigned index );
     bool datagramFlush ( 
         epicsGuard < epicsMutex > &, const epicsTime & currentTime );
+    void datagramBatchBegin ( 
+        epicsGuard < epicsMutex > & );
+    void datagramBatchEnd ( 
+        epicsGuard < epicsMutex > & );
     ca_uint32_t datagramSeqNumber ( 
         epicsGuard < epicsMutex > & ) const;
 
@@ -197,6 +197,7 @@ public:
     void searchRespNotify ( 
         const epicsTime &, const caHdrLargeArray & );
     void versionRespNotify ( const caHdrLargeArray & );
+    bool localTransportNotify ( const caHdrLargeArray &, void * pMsgBdy );
 
     void * operator new ( size_t size, 
         tsFreeList < class tcpiiu, 32, epicsMutexNOOP >  & );
@@ -211,6 +212,9 @@ private:
     tcpSendWatchdog sendDog;
     comQueSend sendQue;
     comQueRecv recvQue;
+    // Guards sendQue so that channels may queue requests holding
+    // only their request mutex. It is the last mutex taken.
+    epicsMutex sendQueMutex;
     // nciu state field tells us which list
     // protected by the callback mutex
     tsDLList < nciu > createReqPend;
@@ -226,6 +230,8 @@ private:
     comBufMemoryManager & comBufMemMgr;
     cac & cacRef;
     char * pCurData;
+    char * pExpandBuf; // responses expanded from CA_PROTO_COMPRESSED
+    arrayElementCount expandBufMax;
     SearchDestTCP * pSearchDest;
     epicsMutex & mutex;
     epicsMutex & cbMutex;
@@ -245,6 +251,14 @@ private:
     unsigned socketLibrarySendBufferSize;
     unsigned unacknowledgedSendBytes;
     unsigned channelCountTot;
+    unsigned compressedResponses; // only modified by the recv thread
+    double compressedWireBytes;
+    double compressedExpandedBytes;
+    double compressedSeconds;
+    double directRecvBytes; // only modified by the recv thread
+    struct caLocalRing * pLocalRing; // responses from a server on this host
+    double localRingBytes; // only modified by the recv thread
+    unsigned localRingWakeups; // only modified by the recv thread
     bool _receiveThreadIsBusy;
     bool busyStateDetected; // only modified by the recv thread
     bool flowControlActive; // only modified by the send process thread
@@ -256,13 +270,20 @@ private:
     bool discardingPendingData;
     bool socketHasBeenClosed;
     bool unresponsiveCircuit;
+    bool localRingActive; // only modified by the recv thread
 
     bool processIncoming ( 
         const epicsTime & currentTime, callbackManager & );
+    bool expandResponse ( 
+        const epicsTime & currentTime, callbackManager & );
     unsigned sendBytes ( const void *pBuf, 
         unsigned nBytesInBuf, const epicsTime & currentTime );
     void recvBytes ( 
         void * pBuf, unsigned nBytesInBuf, statusWireIO & );
+    void recvSocketBytes ( 
+        void * pBuf, unsigned nBytesInBuf, statusWireIO & );
+    bool directRecvPending () const;
+    void recvDirect ( statusWireIO & );
     const char * pHostName (
         epicsGuard < epicsMutex > & ) const throw ();
     double receiveWatchdogDelay (
@@ -286,6 +307,8 @@ private:
         epicsGuard < epicsMutex > & );
     void versionMessage ( 
         epicsGuard < epicsMutex > &, const cacChannel::priLev & priority );
+    void localTransportRequest ( 
+        epicsGuard < epicsMutex > &, ca_uint16_t step );
     void disableFlowControlRequest (
         epicsGuard < epicsMutex > & );
     void enableFlowControlRequest (
@@ -326,7 +349,8 @@ private:
         epicsGuard < epicsMutex > &, nciu &, const class epicsTime & );
     bool searchMsg (
         epicsGuard < epicsMutex > &, ca_uint32_t id, 
-            const char * pName, unsigned nameLength );
+            const char * pName, unsigned nameLength,
+            const osiSockAddr * pServer );
 
     friend class tcpRecvThread;
     friend class tcpSendThread;
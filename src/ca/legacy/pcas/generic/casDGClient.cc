@@ -54,6 +54,8 @@ casDGClient::pCASMsgHandler const casDGClient::msgHandlers[] =
     & casDGClient::uknownMessageAction,
     & casDGClient::uknownMessageAction,
 
+    & casDGClient::uknownMessageAction,
+    & casDGClient::uknownMessageAction,
     & casDGClient::uknownMessageAction,
     & casDGClient::uknownMessageAction,
     & casDGClient::uknownMessageAction
@@ -63,6 +63,8 @@ casStrmClient::pCASMsgHandler const casStrmClient::msgHandlers[] =
     & casStrmClient::uknownMessageAction,
     & casStrmClient::uknownMessageAction,
     & casStrmClient::uknownMessageAction,
+    & casStrmClient::uknownMessageAction,
+    & casStrmClient::uknownMessageAction,
     & casStrmClient::uknownMessageAction
 };
 
@@ -28,6 +28,7 @@
 #include "epicsRingPointer.h"
 #include "epicsString.h"
 #include "epicsThread.h"
+#include "epicsTime.h"
 #include "epicsTimer.h"
 #include "errlog.h"
 #include "errMdef.h"
@@ -49,17 +50,68 @@
 
 static int callbackQueueSize = 2000;
 
+/* Queue implementations, selectable per priority */
+typedef enum cbQueueType {
+    cbQueueLocked,      /* epicsRingPointer guarded by a spinlock */
+    cbQueueLockFree,    /* one lock-free MPMC queue shared by all threads */
+    cbQueueStealing     /* one lock-free queue per thread, idle threads steal */
+} cbQueueType;
+
+static const char * const cbQueueTypeName[] = {
+    "locked", "lockfree", "stealing"
+};
+
+/* Lock-free bounded multi-producer/multi-consumer queue.
+ *
+ * Each cell carries a sequence number that tells producers and consumers
+ * which lap of the ring the cell belongs to, so a push or pop only needs
+ * one compare-and-swap on the queue position (after D. Vyukov).
+ * The positions are kept on separate cache lines.
+ */
+#define CB_CACHE_LINE 64
+
+typedef struct cbCell {
+    size_t sequence;
+    CALLBACK *pcallback;
+    epicsTimeStamp queued;
+} cbCell;
+
+typedef struct cbLfQueue {
+    size_t enqueuePos;
+    char pad1[CB_CACHE_LINE - sizeof(size_t)];
+    size_t dequeuePos;
+    char pad2[CB_CACHE_LINE - sizeof(size_t)];
+    size_t mask;
+    cbCell *cells;
+} cbLfQueue;
+
 typedef struct cbQueueSet {
     epicsEventId semWakeUp;
     epicsRingPointerId queue;
+    cbQueueType type;
+    cbLfQueue *lfq;
+    int nLfq;
+    int queueSize;
     int queueOverflow;
     int shutdown;
     int threadsConfigured;
     int threadsRunning;
+    int threadsStarted;
+    int threadsIdle;
+    /* statistics */
+    int queueMaxUsed;
+    int queueOverflows;
+    size_t latencyCount;
+    size_t latencySum;  /* microseconds */
+    size_t latencyMax;
 } cbQueueSet;
 
 static cbQueueSet callbackQueue[NUM_CALLBACK_PRIORITIES];
 
+/* Measure queueing latency of the lock-free queues */
+epicsShareDef int callbackLatencyStats = 0;
+epicsExportAddress(int,callbackLatencyStats);
+
 int callbackThreadsDefault = 1;
 /* Don't know what a reasonable default is (yet).
  * For the time being: parallel means 2 if not explicitly specified */
@@ -98,8 +150,41 @@ int callbackSetQueueSize(int size)
     return 0;
 }
 
+/* Returns the index of prio in menuPriority, NUM_CALLBACK_PRIORITIES
+ * for all priorities or -1 on error.
+ */
+static int findPriority(const char *caller, const char *prio)
+{
+    dbMenu *pdbMenu;
+    int i;
+
+    if (!prio || *prio == 0 || strcmp(prio, "*") == 0)
+        return NUM_CALLBACK_PRIORITIES;
+
+    if (!pdbbase) {
+        fprintf(stderr, "%s: pdbbase not set\n", caller);
+        return -1;
+    }
+
+    /* Find prio in menuPriority */
+    pdbMenu = dbFindMenu(pdbbase, "menuPriority");
+    if (!pdbMenu) {
+        fprintf(stderr, "%s: No Priority menu\n", caller);
+        return -1;
+    }
+
+    for (i = 0; i < pdbMenu->nChoice; i++) {
+        if (epicsStrCaseCmp(prio, pdbMenu->papChoiceValue[i]) == 0)
+            return i;
+    }
+    fprintf(stderr, "%s: Unknown priority \"%s\"\n", caller, prio);
+    return -1;
+}
+
 int callbackParallelThreads(int count, const char *prio)
 {
+    int i;
+
     if (callbackIsInit) {
         fprintf(stderr, "Callback system already initialized\n");
         return -1;
@@ -111,51 +196,238 @@ int callbackParallelThreads(int count, const char *prio)
         count = callbackParallelThreadsDefault;
     if (count < 1) count = 1;
 
-    if (!prio || *prio == 0 || strcmp(prio, "*") == 0) {
-        int i;
+    i = findPriority("callbackParallelThreads", prio);
+    if (i < 0)
+        return -1;
 
+    if (i == NUM_CALLBACK_PRIORITIES) {
         for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
             callbackQueue[i].threadsConfigured = count;
         }
     }
     else {
-        dbMenu *pdbMenu;
-        int i;
+        callbackQueue[i].threadsConfigured = count;
+    }
+    return 0;
+}
 
-        if (!pdbbase) {
-            fprintf(stderr, "callbackParallelThreads: pdbbase not set\n");
-            return -1;
-        }
+int callbackSetQueueType(const char *type, const char *prio)
+{
+    int qtype;
+    int i;
+
+    if (callbackIsInit) {
+        fprintf(stderr, "Callback system already initialized\n");
+        return -1;
+    }
+
+    for (qtype = cbQueueLocked; qtype <= cbQueueStealing; qtype++) {
+        if (type && epicsStrCaseCmp(type, cbQueueTypeName[qtype]) == 0)
+            break;
+    }
+    if (qtype > cbQueueStealing) {
+        fprintf(stderr, "callbackSetQueueType: Unknown queue type \"%s\", "
+            "use \"locked\", \"lockfree\" or \"stealing\"\n",
+            type ? type : "");
+        return -1;
+    }
 
-        /* Find prio in menuPriority */
-        pdbMenu = dbFindMenu(pdbbase, "menuPriority");
-        if (!pdbMenu) {
-            fprintf(stderr, "callbackParallelThreads: No Priority menu\n");
-            return -1;
+    i = findPriority("callbackSetQueueType", prio);
+    if (i < 0)
+        return -1;
+
+    if (i == NUM_CALLBACK_PRIORITIES) {
+        for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+            callbackQueue[i].type = (cbQueueType) qtype;
         }
+    }
+    else {
+        callbackQueue[i].type = (cbQueueType) qtype;
+    }
+    return 0;
+}
 
-        for (i = 0; i < pdbMenu->nChoice; i++) {
-            if (epicsStrCaseCmp(prio, pdbMenu->papChoiceValue[i]) == 0)
-                goto found;
+static void lfqInit(cbLfQueue *q, int size)
+{
+    size_t n = 2;
+    size_t i;
+
+    while (n < (size_t) size)
+        n <<= 1;
+    q->cells = callocMustSucceed(n, sizeof(cbCell), "lfqInit");
+    for (i = 0; i < n; i++)
+        q->cells[i].sequence = i;
+    q->mask = n - 1;
+    q->enqueuePos = 0;
+    q->dequeuePos = 0;
+}
+
+static int lfqPush(cbLfQueue *q, CALLBACK *pcallback)
+{
+    size_t pos = epicsAtomicGetSizeT(&q->enqueuePos);
+    cbCell *cell;
+
+    for (;;) {
+        size_t seq;
+        ptrdiff_t dif;
+
+        cell = &q->cells[pos & q->mask];
+        seq = epicsAtomicGetSizeT(&cell->sequence);
+        dif = (ptrdiff_t) (seq - pos);
+        if (dif == 0) {
+            size_t prev = epicsAtomicCmpAndSwapSizeT(&q->enqueuePos,
+                pos, pos + 1);
+            if (prev == pos)
+                break;
+            pos = prev;
         }
-        fprintf(stderr, "callbackParallelThreads: "
-            "Unknown priority \"%s\"\n", prio);
-        return -1;
+        else if (dif < 0) {
+            return 0;   /* full */
+        }
+        else {
+            pos = epicsAtomicGetSizeT(&q->enqueuePos);
+        }
+    }
 
-found:
-        callbackQueue[i].threadsConfigured = count;
+    cell->pcallback = pcallback;
+    if (!callbackLatencyStats ||
+        (epicsInterruptIsInterruptContext() ?
+            epicsTimeGetCurrentInt(&cell->queued) :
+            epicsTimeGetCurrent(&cell->queued)) != epicsTimeOK)
+        cell->queued.secPastEpoch = cell->queued.nsec = 0;
+    /* Publish the cell to consumers */
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetSizeT(&cell->sequence, pos + 1);
+    return 1;
+}
+
+static CALLBACK * lfqPop(cbLfQueue *q, epicsTimeStamp *pqueued)
+{
+    size_t pos = epicsAtomicGetSizeT(&q->dequeuePos);
+    CALLBACK *pcallback;
+    cbCell *cell;
+
+    for (;;) {
+        size_t seq;
+        ptrdiff_t dif;
+
+        cell = &q->cells[pos & q->mask];
+        seq = epicsAtomicGetSizeT(&cell->sequence);
+        dif = (ptrdiff_t) (seq - (pos + 1));
+        if (dif == 0) {
+            size_t prev = epicsAtomicCmpAndSwapSizeT(&q->dequeuePos,
+                pos, pos + 1);
+            if (prev == pos)
+                break;
+            pos = prev;
+        }
+        else if (dif < 0) {
+            return NULL;    /* empty */
+        }
+        else {
+            pos = epicsAtomicGetSizeT(&q->dequeuePos);
+        }
     }
+
+    epicsAtomicReadMemoryBarrier();
+    pcallback = cell->pcallback;
+    *pqueued = cell->queued;
+    /* Hand the cell back to producers for the next lap */
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetSizeT(&cell->sequence, pos + q->mask + 1);
+    return pcallback;
+}
+
+static int lfqUsed(cbLfQueue *q)
+{
+    size_t deq = epicsAtomicGetSizeT(&q->dequeuePos);
+    size_t enq = epicsAtomicGetSizeT(&q->enqueuePos);
+    ptrdiff_t n = (ptrdiff_t) (enq - deq);
+
+    return n < 0 ? 0 : (int) n;
+}
+
+static int cbQueueUsed(cbQueueSet *mySet)
+{
+    int i, n = 0;
+
+    if (mySet->type == cbQueueLocked)
+        return epicsRingPointerGetUsed(mySet->queue);
+
+    for (i = 0; i < mySet->nLfq; i++)
+        n += lfqUsed(&mySet->lfq[i]);
+    return n;
+}
+
+/* Requests for the same CALLBACK always go to the same sub-queue, which
+ * keeps them on the same thread unless that thread falls behind.
+ */
+static int cbLfPush(cbQueueSet *mySet, CALLBACK *pcallback)
+{
+    int first = 0;
+    int i;
+
+    if (mySet->nLfq > 1)
+        first = (int) (((size_t) pcallback / sizeof(CALLBACK)) % mySet->nLfq);
+
+    i = first;
+    do {
+        if (lfqPush(&mySet->lfq[i], pcallback))
+            return 1;
+        if (++i >= mySet->nLfq) i = 0;
+    } while (i != first);
     return 0;
 }
 
-static void callbackTask(void *arg)
+/* Take from our own sub-queue first, then steal from the others */
+static CALLBACK * cbLfPop(cbQueueSet *mySet, int index)
 {
-    int prio = *(int*)arg;
-    cbQueueSet *mySet = &callbackQueue[prio];
+    CALLBACK *pcallback;
+    epicsTimeStamp queued;
+    int i = index;
+
+    do {
+        pcallback = lfqPop(&mySet->lfq[i], &queued);
+        if (pcallback)
+            break;
+        if (++i >= mySet->nLfq) i = 0;
+    } while (i != index);
+
+    if (pcallback && queued.secPastEpoch) {
+        epicsTimeStamp now;
+
+        if (epicsTimeGetCurrent(&now) == epicsTimeOK) {
+            double delay = epicsTimeDiffInSeconds(&now, &queued);
+            size_t usec = delay > 0 ? (size_t) (delay * 1e6) : 0;
+            size_t max = epicsAtomicGetSizeT(&mySet->latencyMax);
+
+            epicsAtomicIncrSizeT(&mySet->latencyCount);
+            epicsAtomicAddSizeT(&mySet->latencySum, usec);
+            while (usec > max) {
+                size_t prev = epicsAtomicCmpAndSwapSizeT(&mySet->latencyMax,
+                    max, usec);
+                if (prev == max)
+                    break;
+                max = prev;
+            }
+        }
+    }
+    return pcallback;
+}
 
-    taskwdInsert(0, NULL, NULL);
-    epicsEventSignal(startStopEvent);
+static int cbLfIsEmpty(cbQueueSet *mySet)
+{
+    int i;
 
+    for (i = 0; i < mySet->nLfq; i++) {
+        if (lfqUsed(&mySet->lfq[i]))
+            return 0;
+    }
+    return 1;
+}
+
+static void callbackLockedLoop(cbQueueSet *mySet)
+{
     while(!mySet->shutdown) {
         void *ptr;
         if (epicsRingPointerIsEmpty(mySet->queue))
@@ -169,6 +441,50 @@ static void callbackTask(void *arg)
             (*pcallback->callback)(pcallback);
         }
     }
+}
+
+/* Producers only signal the event when some thread has announced that it
+ * is going idle, so a busy thread set is never woken once per request.
+ */
+static void callbackLockFreeLoop(cbQueueSet *mySet, int index)
+{
+    while (!mySet->shutdown) {
+        CALLBACK *pcallback = cbLfPop(mySet, index);
+
+        if (!pcallback) {
+            /* Look again after announcing, a producer that
+             * missed the announcement must not strand its request */
+            epicsAtomicIncrIntT(&mySet->threadsIdle);
+            pcallback = cbLfPop(mySet, index);
+            if (!pcallback)
+                epicsEventMustWait(mySet->semWakeUp);
+            epicsAtomicDecrIntT(&mySet->threadsIdle);
+            if (!pcallback)
+                continue;
+        }
+
+        /* Pass the wakeup on while there is work left */
+        if (epicsAtomicGetIntT(&mySet->threadsIdle) && !cbLfIsEmpty(mySet))
+            epicsEventMustTrigger(mySet->semWakeUp);
+        if (mySet->queueOverflow)
+            mySet->queueOverflow = FALSE;
+        (*pcallback->callback)(pcallback);
+    }
+}
+
+static void callbackTask(void *arg)
+{
+    int prio = *(int*)arg;
+    cbQueueSet *mySet = &callbackQueue[prio];
+    int index = epicsAtomicIncrIntT(&mySet->threadsStarted) - 1;
+
+    taskwdInsert(0, NULL, NULL);
+    epicsEventSignal(startStopEvent);
+
+    if (mySet->type == cbQueueLocked)
+        callbackLockedLoop(mySet);
+    else
+        callbackLockFreeLoop(mySet, index % mySet->nLfq);
 
     if(!epicsAtomicDecrIntT(&mySet->threadsRunning))
         epicsEventSignal(startStopEvent);
@@ -206,7 +522,15 @@ void callbackCleanup(void)
 
         assert(epicsAtomicGetIntT(&mySet->threadsRunning)==0);
         epicsEventDestroy(mySet->semWakeUp);
-        epicsRingPointerDelete(mySet->queue);
+        if (mySet->queue)
+            epicsRingPointerDelete(mySet->queue);
+        if (mySet->lfq) {
+            int j;
+
+            for (j = 0; j < mySet->nLfq; j++)
+                free(mySet->lfq[j].cells);
+            free(mySet->lfq);
+        }
     }
 
     epicsTimerQueueRelease(timerQueue);
@@ -229,19 +553,39 @@ void callbackInit(void)
     if(!startStopEvent)
         startStopEvent = epicsEventMustCreate(epicsEventEmpty);
     cbCtl = ctlRun;
-    timerQueue = epicsTimerQueueAllocate(0, epicsThreadPriorityScanHigh);
+    timerQueue = epicsTimerQueueAllocateType(0, epicsThreadPriorityScanHigh,
+        epicsTimerQueueHeap);
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         epicsThreadId tid;
 
-        callbackQueue[i].semWakeUp = epicsEventMustCreate(epicsEventEmpty);
-        callbackQueue[i].queue = epicsRingPointerLockedCreate(callbackQueueSize);
-        if (callbackQueue[i].queue == 0)
-            cantProceed("epicsRingPointerLockedCreate failed for %s\n",
-                threadNamePrefix[i]);
-        callbackQueue[i].queueOverflow = FALSE;
-        if (callbackQueue[i].threadsConfigured == 0)
-            callbackQueue[i].threadsConfigured = callbackThreadsDefault;
+        cbQueueSet *mySet = &callbackQueue[i];
+
+        mySet->semWakeUp = epicsEventMustCreate(epicsEventEmpty);
+        if (mySet->threadsConfigured == 0)
+            mySet->threadsConfigured = callbackThreadsDefault;
+        if (mySet->type == cbQueueLocked) {
+            mySet->queue = epicsRingPointerLockedCreate(callbackQueueSize);
+            if (mySet->queue == 0)
+                cantProceed("epicsRingPointerLockedCreate failed for %s\n",
+                    threadNamePrefix[i]);
+            mySet->queueSize = callbackQueueSize;
+        }
+        else {
+            int subSize;
+
+            mySet->nLfq = mySet->type == cbQueueStealing ?
+                mySet->threadsConfigured : 1;
+            subSize = (callbackQueueSize + mySet->nLfq - 1) / mySet->nLfq;
+            mySet->lfq = callocMustSucceed(mySet->nLfq, sizeof(cbLfQueue),
+                "callbackInit");
+            mySet->queueSize = 0;
+            for (j = 0; j < mySet->nLfq; j++) {
+                lfqInit(&mySet->lfq[j], subSize);
+                mySet->queueSize += (int) mySet->lfq[j].mask + 1;
+            }
+        }
+        mySet->queueOverflow = FALSE;
 
         for (j = 0; j < callbackQueue[i].threadsConfigured; j++) {
             if (callbackQueue[i].threadsConfigured > 1 )
@@ -266,6 +610,7 @@ int callbackRequest(CALLBACK *pcallback)
 {
     int priority;
     int pushOK;
+    int nUsed;
     cbQueueSet *mySet;
 
     if (!pcallback) {
@@ -280,7 +625,10 @@ int callbackRequest(CALLBACK *pcallback)
     mySet = &callbackQueue[priority];
     if (mySet->queueOverflow) return S_db_bufFull;
 
-    pushOK = epicsRingPointerPush(mySet->queue, pcallback);
+    if (mySet->type == cbQueueLocked)
+        pushOK = epicsRingPointerPush(mySet->queue, pcallback);
+    else
+        pushOK = cbLfPush(mySet, pcallback);
 
     if (!pushOK) {
         char msg[48] = "callbackRequest: ";
@@ -289,12 +637,79 @@ int callbackRequest(CALLBACK *pcallback)
         strcat(msg, " ring buffer full\n");
         epicsInterruptContextMessage(msg);
         mySet->queueOverflow = TRUE;
+        epicsAtomicIncrIntT(&mySet->queueOverflows);
         return S_db_bufFull;
     }
-    epicsEventSignal(mySet->semWakeUp);
+
+    nUsed = cbQueueUsed(mySet);
+    if (nUsed > mySet->queueMaxUsed)
+        mySet->queueMaxUsed = nUsed;
+
+    if (mySet->type == cbQueueLocked ||
+        epicsAtomicGetIntT(&mySet->threadsIdle))
+        epicsEventSignal(mySet->semWakeUp);
+    return 0;
+}
+
+int callbackQueueStatus(const int reset, callbackQueueStats *result)
+{
+    int i;
+
+    if (!callbackIsInit) return -1;
+
+    for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+        cbQueueSet *mySet = &callbackQueue[i];
+
+        if (result) {
+            size_t count = epicsAtomicGetSizeT(&mySet->latencyCount);
+
+            result->type[i] = cbQueueTypeName[mySet->type];
+            result->size[i] = mySet->queueSize;
+            result->threads[i] = epicsAtomicGetIntT(&mySet->threadsRunning);
+            result->numUsed[i] = cbQueueUsed(mySet);
+            result->maxUsed[i] = mySet->queueMaxUsed;
+            result->numOverflow[i] = epicsAtomicGetIntT(&mySet->queueOverflows);
+            result->latencyAvg[i] = count ?
+                1e-6 * epicsAtomicGetSizeT(&mySet->latencySum) / count : 0.0;
+            result->latencyMax[i] =
+                1e-6 * epicsAtomicGetSizeT(&mySet->latencyMax);
+        }
+        if (reset) {
+            mySet->queueMaxUsed = 0;
+            epicsAtomicSetIntT(&mySet->queueOverflows, 0);
+            epicsAtomicSetSizeT(&mySet->latencyCount, 0);
+            epicsAtomicSetSizeT(&mySet->latencySum, 0);
+            epicsAtomicSetSizeT(&mySet->latencyMax, 0);
+        }
+    }
     return 0;
 }
 
+void callbackQueueShow(const int reset)
+{
+    callbackQueueStats stats;
+    int i;
+
+    if (callbackQueueStatus(reset, &stats) == -1) {
+        fprintf(stderr, "Callback system not initialized, yet. "
+            "Please run iocInit before using this command.\n");
+        return;
+    }
+
+    printf("PRIORITY TYPE      THREADS   SIZE   USED    MAX  OVERFLOWS"
+        "  LATENCY(avg/max)\n");
+    for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+        printf("%-8s %-8s %8d %6d %6d %6d %10d",
+            threadNamePrefix[i] + 2, stats.type[i], stats.threads[i],
+            stats.size[i], stats.numUsed[i], stats.maxUsed[i],
+            stats.numOverflow[i]);
+        if (stats.latencyAvg[i] > 0.0 || stats.latencyMax[i] > 0.0)
+            printf("  %.6f / %.6f\n", stats.latencyAvg[i], stats.latencyMax[i]);
+        else
+            printf("  -\n");
+    }
+}
+
 static void ProcessCallback(CALLBACK *pcallback)
 {
     dbCommon *pRec;
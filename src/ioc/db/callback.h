@@ -46,6 +46,18 @@ typedef struct callbackPvt {
 
 typedef void    (*CALLBACKFUNC)(struct callbackPvt*);
 
+typedef struct callbackQueueStats {
+    const char *type[NUM_CALLBACK_PRIORITIES];
+    int size[NUM_CALLBACK_PRIORITIES];
+    int threads[NUM_CALLBACK_PRIORITIES];
+    int numUsed[NUM_CALLBACK_PRIORITIES];
+    int maxUsed[NUM_CALLBACK_PRIORITIES];
+    int numOverflow[NUM_CALLBACK_PRIORITIES];
+    /* seconds, only measured by lock-free queues with callbackLatencyStats */
+    double latencyAvg[NUM_CALLBACK_PRIORITIES];
+    double latencyMax[NUM_CALLBACK_PRIORITIES];
+} callbackQueueStats;
+
 #define callbackSetCallback(PFUN, PCALLBACK) \
     ( (PCALLBACK)->callback = (PFUN) )
 #define callbackSetPriority(PRIORITY, PCALLBACK) \
@@ -72,6 +84,10 @@ epicsShareFunc void callbackRequestProcessCallbackDelayed(
     CALLBACK *pCallback, int Priority, void *pRec, double seconds);
 epicsShareFunc int callbackSetQueueSize(int size);
 epicsShareFunc int callbackParallelThreads(int count, const char *prio);
+epicsShareFunc int callbackSetQueueType(const char *type, const char *prio);
+epicsShareFunc int callbackQueueStatus(const int reset,
+    callbackQueueStats *result);
+epicsShareFunc void callbackQueueShow(const int reset);
 
 #ifdef __cplusplus
 }
@@ -51,6 +51,8 @@
 #include "dbLink.h"
 #include "dbLockPvt.h"
 #include "dbNotify.h"
+#include "dbParallelFwd.h"
+#include "dbProcTime.h"
 #include "dbScan.h"
 #include "dbServer.h"
 #include "dbStaticLib.h"
@@ -458,6 +460,24 @@ long dbScanPassive(dbCommon *pfrom, dbCommon *pto)
     return dbProcess(pto);
 }
 
+/*
+ * Run the record's process routine, waiting for any forward link
+ * branches it dispatched to the parallel pool.
+ */
+static long processJoined(dbCommon *precord, rset *prset)
+{
+    dbParallelFwdGroup group;
+    long status;
+
+    if (!dbParallelFwdActive)
+        return prset->process(precord);
+
+    dbParallelFwdEnter(&group, precord);
+    status = prset->process(precord);
+    dbParallelFwdJoin(&group);
+    return status;
+}
+
 /*
  *   Process the record.
  *     1.  Check for breakpoints.
@@ -592,7 +612,15 @@ long dbProcess(dbCommon *precord)
         printf("%s: Process %s\n", context, precord->name);
 
     /* process record */
-    status = prset->process(precord);
+    if (dbProcTimeStats) {
+        epicsTimeStamp start;
+
+        epicsTimeGetCurrent(&start);
+        status = processJoined(precord, prset);
+        dbProcTimeAdd(precord, &start);
+    }
+    else
+        status = processJoined(precord, prset);
 
     /* Print record's fields if PRINT_MASK set in breakpoint field */
     if (lset_stack_count != 0) {
@@ -166,6 +166,7 @@ public:
             cacReadNotify & notify );
     void callStateNotify ( struct dbChannel * dbch, unsigned type, unsigned long count,
             const struct db_field_log * pfl, cacStateNotify & notify );
+    void stateNotifyFlush ( bool eventsRemaining );
     void subscribe (
             epicsGuard < epicsMutex > &,
             struct dbChannel * dbch, dbChannelIO & chan,
@@ -191,6 +192,7 @@ private:
     dbContextReadNotifyCache readNotifyCache;
     dbEventCtx ctx;
     unsigned long stateNotifyCacheSize;
+    unsigned deferredFlushes;
     epicsMutex & mutex;
     epicsMutex & cbMutex;
     cacContextNotify & notify;
@@ -49,6 +49,7 @@ public:
     void callStateNotify (
         unsigned type, unsigned long count,
         const struct db_field_log * pfl, cacStateNotify & notify );
+    void stateNotifyFlush ( bool eventsRemaining );
     void show (
         epicsGuard < epicsMutex > &, unsigned level ) const;
     unsigned getName (
@@ -119,6 +120,11 @@ inline void dbChannelIO::callStateNotify ( unsigned type, unsigned long count,
     this->serviceIO.callStateNotify ( this->dbch, type, count, pfl, notify );
 }
 
+inline void dbChannelIO::stateNotifyFlush ( bool eventsRemaining )
+{
+    this->serviceIO.stateNotifyFlush ( eventsRemaining );
+}
+
 
 #endif // dbChannelIOh
 
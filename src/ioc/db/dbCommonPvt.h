@@ -8,6 +8,9 @@
 typedef struct dbCommonPvt {
     struct dbRecordNode *recnode;
 
+    /* Processing time statistics, allocated when first timed */
+    struct dbProcTime *ptime;
+
     struct dbCommon common;
 } dbCommonPvt;
 
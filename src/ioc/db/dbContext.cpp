@@ -43,6 +43,8 @@ public:
 
 static dbService dbs;
 
+static const unsigned maxDeferredStateNotifyFlush = 32u;
+
 cacContext & dbService::contextCreate (
     epicsMutex & mutualExclusion,
     epicsMutex & callbackControl,
@@ -69,7 +71,7 @@ dbBaseIO::dbBaseIO () {}
 dbContext::dbContext ( epicsMutex & cbMutexIn,
         epicsMutex & mutexIn, cacContextNotify & notifyIn ) :
     readNotifyCache ( mutexIn ), ctx ( 0 ),
-    stateNotifyCacheSize ( 0 ), mutex ( mutexIn ), cbMutex ( cbMutexIn ),
+    stateNotifyCacheSize ( 0 ), deferredFlushes ( 0u ), mutex ( mutexIn ), cbMutex ( cbMutexIn ),
     notify ( notifyIn ), pNetContext ( 0 ), pStateNotifyCache ( 0 ),
     isolated(dbServiceIsolate)
 {
@@ -190,6 +192,23 @@ void dbContext::callStateNotify ( struct dbChannel * dbch,
     }
 }
 
+//
+// Latest value only subscriptions are passed their updates once the
+// event queue is empty, or after a limited number of events if it
+// never empties, as the network context does for each receive burst.
+//
+void dbContext::stateNotifyFlush ( bool eventsRemaining )
+{
+    epicsGuard < epicsMutex > guard ( this->mutex );
+    if ( this->notify.subscriptionBatchPending ( guard ) ) {
+        if ( ! eventsRemaining ||
+                ++this->deferredFlushes >= maxDeferredStateNotifyFlush ) {
+            this->deferredFlushes = 0u;
+            this->notify.subscriptionBatchNotify ( guard );
+        }
+    }
+}
+
 extern "C" void cacAttachClientCtx ( void * pPrivate )
 {
     int status = ca_attach_context ( (ca_client_context *) pPrivate );
@@ -41,6 +41,7 @@
 #include "dbLink.h"
 #include "dbLockPvt.h"
 #include "dbNotify.h"
+#include "dbParallelFwd.h"
 #include "dbScan.h"
 #include "dbStaticLib.h"
 #include "devSup.h"
@@ -69,6 +70,11 @@ long dbDbInitLink(struct link *plink, short dbfType)
     pdbAddr = dbCalloc(1, sizeof(struct dbAddr));
     *pdbAddr = dbaddr; /* structure copy */
     plink->value.pv_link.pvt = pdbAddr;
+    if (dbfType == DBF_FWDLINK && dbParallelFwdEnabled()) {
+        /* target keeps its own lock set, cf. dbParallelFwd.c */
+        plink->value.pv_link.pvlMask |= pvlOptFwdPool;
+        return 0;
+    }
     ellAdd(&dbaddr.precord->bklnk, &plink->value.pv_link.backlinknode);
     /* merging into the same lockset is deferred to the caller.
      * cf. initPVLinks()
@@ -81,29 +87,50 @@ long dbDbInitLink(struct link *plink, short dbfType)
 void dbDbAddLink(struct dbLocker *locker, struct link *plink, short dbfType,
     DBADDR *ptarget)
 {
+    int pool = dbParallelFwdEnabled();
+
+    if (pool)
+        dbParallelFwdLinkChanging();
     plink->lset = &dbDb_lset;
     plink->type = DB_LINK;
     plink->value.pv_link.pvt = ptarget;
-    ellAdd(&ptarget->precord->bklnk, &plink->value.pv_link.backlinknode);
+    if (dbfType == DBF_FWDLINK && pool) {
+        plink->value.pv_link.pvlMask |= pvlOptFwdPool;
+    }
+    else {
+        ellAdd(&ptarget->precord->bklnk, &plink->value.pv_link.backlinknode);
 
-    /* target record is already locked in dbPutFieldLink() */
-    dbLockSetMerge(locker, plink->precord, ptarget->precord);
+        /* target record is already locked in dbPutFieldLink() */
+        dbLockSetMerge(locker, plink->precord, ptarget->precord);
+    }
+    if (pool)
+        dbParallelFwdLinkChanged(plink->precord);
 }
 
 static void dbDbRemoveLink(struct dbLocker *locker, struct link *plink)
 {
     DBADDR *pdbAddr = (DBADDR *) plink->value.pv_link.pvt;
+    int merged = !(plink->value.pv_link.pvlMask & pvlOptFwdPool);
 
     plink->type = PV_LINK;
 
     /* locker is NULL when an isolated IOC is closing its links */
     if (locker) {
+        int pool = dbParallelFwdEnabled();
+
+        if (pool)
+            dbParallelFwdLinkChanging();
         plink->value.pv_link.pvt = 0;
         plink->value.pv_link.getCvt = 0;
         plink->value.pv_link.pvlMask = 0;
         plink->value.pv_link.lastGetdbrType = 0;
-        ellDelete(&pdbAddr->precord->bklnk, &plink->value.pv_link.backlinknode);
-        dbLockSetSplit(locker, plink->precord, pdbAddr->precord);
+        if (merged) {
+            ellDelete(&pdbAddr->precord->bklnk,
+                &plink->value.pv_link.backlinknode);
+            dbLockSetSplit(locker, plink->precord, pdbAddr->precord);
+        }
+        if (pool)
+            dbParallelFwdLinkChanged(NULL);
     }
     free(pdbAddr);
 }
@@ -335,7 +362,10 @@ static void dbDbScanFwdLink(struct link *plink)
     dbCommon *precord = plink->precord;
     dbAddr *paddr = (dbAddr *) plink->value.pv_link.pvt;
 
-    dbScanPassive(precord, paddr->precord);
+    if (plink->value.pv_link.pvlMask & pvlOptFwdPool)
+        dbParallelFwdScan(plink);
+    else
+        dbScanPassive(precord, paddr->precord);
 }
 
 static long doLocked(struct link *plink, dbLinkUserCallback rtn, void *priv)
@@ -27,6 +27,7 @@
 #include "cantProceed.h"
 #include "dbDefs.h"
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsThread.h"
@@ -43,28 +44,37 @@
 #include "dbChannel.h"
 #include "dbCommon.h"
 #include "dbEvent.h"
+#include "dbExtractArray.h"
 #include "db_field_log.h"
 #include "dbFldTypes.h"
 #include "dbLock.h"
 #include "link.h"
+#include "recSup.h"
 #include "special.h"
+#include "epicsExport.h"
 
 #define EVENTSPERQUE    32
-#define EVENTENTRIES    4      /* the number of que entries for each event */
-#define EVENTQUESIZE    (EVENTENTRIES  * EVENTSPERQUE)
+#define EVENTENTRIES    4      /* default que entries for each event */
+#define EVENTENTRIESMAX 1024
 #define EVENTQEMPTY     ((struct evSubscrip *)NULL)
 
 /*
  * really a ring buffer
+ *
+ * Every subscription on a que reserves the same number of entries,
+ * and a que holds EVENTSPERQUE times that many.  Subscriptions with
+ * a different queue depth go on other ques of the same event user.
  */
 struct event_que {
     /* lock writers to the ring buffer only */
     /* readers must never slow up writers */
     epicsMutexId            writelock;
-    db_field_log            *valque[EVENTQUESIZE];
-    struct evSubscrip       *evque[EVENTQUESIZE];
+    db_field_log            **valque;
+    struct evSubscrip       **evque;
     struct event_que        *nextque;       /* in case que quota exceeded */
     struct event_user       *evUser;        /* event user parent struct */
+    unsigned short          size;           /* EVENTSPERQUE * nentries */
+    unsigned short          nentries;       /* entries for each event */
     unsigned short          putix;
     unsigned short          getix;
     unsigned short          quota;          /* the number of assigned entries*/
@@ -90,18 +100,86 @@ struct event_user {
     unsigned char       extra_labor;    /* if set call extra labor func */
     unsigned char       flowCtrlMode;   /* replace existing monitor */
     unsigned char       extraLaborBusy;
+    unsigned short      queueDepth;     /* default entries for each event */
     void                (*init_func)();
     epicsThreadId       init_func_arg;
 };
 
+/*
+ * Copy of an array or string field taken when an event is posted,
+ * shared by the field logs of all subscriptions to that field.
+ * The field data follows the structure.
+ */
+typedef struct event_snapshot {
+    int                 refcount;
+    void                *pfield;        /* record field that was copied */
+    epicsTimeStamp      time;
+    unsigned short      stat;
+    unsigned short      sevr;
+    short               field_type;
+    short               field_size;
+    long                no_elements;
+    void                *pconverted;    /* see db_event_snapshot_convert() */
+} event_snapshot;
+
+/*
+ * Postings accumulated by db_post_events_batch() until
+ * db_post_events_commit() queues them
+ */
+typedef struct batch_entry {
+    struct evSubscrip   *pevent;
+    db_field_log        *pLog;
+    unsigned            next;           /* next entry for the same queue */
+} batch_entry;
+
+/*
+ * Scratch space used by db_post_events_commit() to group the entries
+ * of a batch by event queue and the queues by event user
+ */
+typedef struct batch_queue {
+    struct event_que    *ev_que;
+    unsigned            first;          /* chain of entries through next */
+    unsigned            last;
+    unsigned            user;           /* index into users */
+} batch_queue;
+
+typedef struct batch_user {
+    struct event_user   *evUser;
+    int                 firstEventFlag;
+} batch_user;
+
+typedef struct batch_slot {
+    const void          *key;
+    unsigned            index;
+} batch_slot;
+
+struct dbEventBatch {
+    batch_entry         *entries;
+    unsigned            nEntries;
+    unsigned            nAlloc;
+    struct dbCommon     **records;      /* mlok held for each of these */
+    unsigned            nRecords;
+    unsigned            nRecAlloc;
+    int                 open;
+    batch_queue         *queues;        /* nAlloc of these */
+    batch_user          *users;         /* nAlloc of these */
+    batch_slot          *slots;         /* 2 * nSlots of these */
+    unsigned            nSlots;         /* power of two, >= 2 * nAlloc */
+};
+
+epicsShareDef int dbEventQueueDepth = EVENTENTRIES;
+epicsExportAddress(int, dbEventQueueDepth);
+epicsShareDef int dbEventArraySnapshots = 0;
+epicsExportAddress(int, dbEventArraySnapshots);
+
 /*
  * Reliable intertask communication requires copying the current value of the
  * channel for later queing so 3 stepper motor steps of 10 each do not turn
  * into only 10 or 20 total steps part of the time.
  */
 
-#define RNGINC(OLD)\
-( (unsigned short) ( (OLD) >= (EVENTQUESIZE-1) ? 0 : (OLD)+1 ) )
+#define RNGINC(EV_QUE, OLD)\
+( (unsigned short) ( (OLD) >= ((EV_QUE)->size-1) ? 0 : (OLD)+1 ) )
 
 #define LOCKEVQUE(EV_QUE)   epicsMutexMustLock((EV_QUE)->writelock)
 #define UNLOCKEVQUE(EV_QUE) epicsMutexUnlock((EV_QUE)->writelock)
@@ -124,12 +202,62 @@ static unsigned short ringSpace ( const struct event_que *pevq )
             return ( unsigned short ) ( pevq->getix - pevq->putix );
         }
         else {
-            return ( unsigned short ) ( ( EVENTQUESIZE + pevq->getix ) - pevq->putix );
+            return ( unsigned short ) ( ( pevq->size + pevq->getix ) - pevq->putix );
+        }
+    }
+    return 0;
+}
+
+static unsigned short queue_depth ( int depth )
+{
+    if ( depth < 1 ) {
+        return 1;
+    }
+    if ( depth > EVENTENTRIESMAX ) {
+        return EVENTENTRIESMAX;
+    }
+    return (unsigned short) depth;
+}
+
+/*
+ * init_ev_que()
+ */
+static int init_ev_que ( struct event_que * const ev_que,
+    struct event_user * const evUser, unsigned short nentries )
+{
+    ev_que->size = (unsigned short) ( nentries * EVENTSPERQUE );
+    ev_que->nentries = nentries;
+    ev_que->valque = (db_field_log **)
+        calloc ( ev_que->size, sizeof ( db_field_log * ) );
+    ev_que->evque = (struct evSubscrip **)
+        calloc ( ev_que->size, sizeof ( struct evSubscrip * ) );
+    ev_que->writelock = epicsMutexCreate();
+    if ( ! ev_que->valque || ! ev_que->evque || ! ev_que->writelock ) {
+        free ( ev_que->valque );
+        free ( ev_que->evque );
+        if ( ev_que->writelock ) {
+            epicsMutexDestroy ( ev_que->writelock );
         }
+        ev_que->valque = NULL;
+        ev_que->evque = NULL;
+        ev_que->writelock = NULL;
+        return -1;
     }
+    ev_que->evUser = evUser;
     return 0;
 }
 
+/*
+ * destroy_ev_que()
+ * frees the ring buffer but not the event_que itself
+ */
+static void destroy_ev_que ( struct event_que * const ev_que )
+{
+    epicsMutexDestroy ( ev_que->writelock );
+    free ( ev_que->valque );
+    free ( ev_que->evque );
+}
+
 /*
  *  db_event_list ()
  */
@@ -196,7 +324,7 @@ int dbel ( const char *pname, unsigned level )
                     printf ( ", thread=%p, queue full",
                         (void *) taskId );
                 }
-                else if ( nEntriesFree == EVENTQUESIZE ) {
+                else if ( nEntriesFree == pevent->ev_que->size ) {
                     printf ( ", thread=%p, queue empty",
                         (void *) taskId );
                 }
@@ -212,7 +340,8 @@ int dbel ( const char *pname, unsigned level )
                 if ( pevent->nreplace ) {
                     printf (", discarded by replacement=%ld", pevent->nreplace);
                 }
-                if ( ! pevent->useValque ) {
+                printf (", queue depth=%u", pevent->ev_que->nentries );
+                if ( ! pevent->useValque && ! dbEventArraySnapshots ) {
                     printf (", queueing disabled" );
                 }
                 LOCKEVQUE(pevent->ev_que);
@@ -271,8 +400,9 @@ dbEventCtx db_init_events (void)
             sizeof(struct evSubscrip),256);
     }
     if (!dbevFieldLogFreeList) {
-        freeListInitPvt(&dbevFieldLogFreeList,
-            sizeof(struct db_field_log),2048);
+        /* allocated by scan threads, freed by event tasks */
+        freeListInitMagazine(&dbevFieldLogFreeList,
+            sizeof(struct db_field_log),2048,64);
     }
 
     evUser = (struct event_user *)
@@ -284,9 +414,8 @@ dbEventCtx db_init_events (void)
     /* Flag will be cleared when event task starts */
     evUser->pendexit = TRUE;
 
-    evUser->firstque.evUser = evUser;
-    evUser->firstque.writelock = epicsMutexCreate();
-    if (!evUser->firstque.writelock)
+    evUser->queueDepth = queue_depth(dbEventQueueDepth);
+    if (init_ev_que(&evUser->firstque, evUser, evUser->queueDepth))
         goto fail;
 
     evUser->ppendsem = epicsEventCreate(epicsEventEmpty);
@@ -310,7 +439,7 @@ fail:
     if(evUser->lock)
         epicsMutexDestroy (evUser->lock);
     if(evUser->firstque.writelock)
-        epicsMutexDestroy (evUser->firstque.writelock);
+        destroy_ev_que (&evUser->firstque);
     if(evUser->ppendsem)
         epicsEventDestroy (evUser->ppendsem);
     if(evUser->pflush_sem)
@@ -383,32 +512,60 @@ void db_close_events (dbEventCtx ctx)
 /*
  * create_ev_que()
  */
-static struct event_que * create_ev_que ( struct event_user * const evUser )
+static struct event_que * create_ev_que ( struct event_user * const evUser,
+    unsigned short nentries )
 {
     struct event_que * const ev_que = (struct event_que *) 
         freeListCalloc ( dbevEventQueueFreeList );
     if ( ! ev_que ) {
         return NULL;
     }
-    ev_que->writelock = epicsMutexCreate();
-    if ( ! ev_que->writelock ) {
+    if ( init_ev_que ( ev_que, evUser, nentries ) ) {
         freeListFree ( dbevEventQueueFreeList, ev_que );
         return NULL;
     }
-    ev_que->evUser = evUser;
     return ev_que;
 }
 
+/*
+ * DB_EVENT_SET_QUEUE_DEPTH()
+ *
+ * Sets the queue depth used by later subscriptions that don't ask for
+ * a depth of their own
+ */
+void db_event_set_queue_depth ( dbEventCtx ctx, unsigned depth )
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+
+    epicsMutexMustLock ( evUser->lock );
+    evUser->queueDepth = queue_depth ( (int) depth );
+    epicsMutexUnlock ( evUser->lock );
+}
+
 /*
  * DB_ADD_EVENT()
  */
 dbEventSubscription db_add_event (
     dbEventCtx ctx, struct dbChannel *chan,
     EVENTFUNC *user_sub, void *user_arg, unsigned select)
+{
+    return db_add_event_depth ( ctx, chan, user_sub, user_arg, select, 0u );
+}
+
+/*
+ * DB_ADD_EVENT_DEPTH()
+ *
+ * depth is the number of queue entries reserved for the subscription,
+ * zero selects the event user's default
+ */
+dbEventSubscription db_add_event_depth (
+    dbEventCtx ctx, struct dbChannel *chan,
+    EVENTFUNC *user_sub, void *user_arg, unsigned select, unsigned depth)
 {
     struct event_user * const evUser = (struct event_user *) ctx;
     struct event_que * ev_que;
     struct evSubscrip * pevent;
+    unsigned short nentries;
 
     /*
      * Don't add events which will not be triggered
@@ -422,24 +579,27 @@ dbEventSubscription db_add_event (
         return NULL;
     }
 
-    /* find an event que block with enough quota */
+    /* find an event que block of this depth with enough quota */
     /* otherwise add a new one to the list */
     epicsMutexMustLock ( evUser->lock );
+    nentries = depth ? queue_depth ( (int) depth ) : evUser->queueDepth;
     ev_que = & evUser->firstque;
     while ( TRUE ) {
         int success = 0;
-        LOCKEVQUE ( ev_que );
-        success = ( ev_que->quota + ev_que->nCanceled < 
-                                EVENTQUESIZE - EVENTENTRIES );
-        if ( success ) {
-            ev_que->quota += EVENTENTRIES;
+        if ( ev_que->nentries == nentries ) {
+            LOCKEVQUE ( ev_que );
+            success = ( ev_que->quota + ev_que->nCanceled < 
+                                    ev_que->size - nentries );
+            if ( success ) {
+                ev_que->quota += nentries;
+            }
+            UNLOCKEVQUE ( ev_que );
         }
-        UNLOCKEVQUE ( ev_que );
         if ( success ) {
             break;
         }
         if ( ! ev_que->nextque ) {
-            ev_que->nextque = create_ev_que ( evUser );
+            ev_que->nextque = create_ev_que ( evUser, nentries );
             if ( ! ev_que->nextque ) {
                 ev_que = NULL;
                 break;
@@ -578,7 +738,7 @@ void db_cancel_event (dbEventSubscription event)
             pevent->ev_que->nCanceled++;
             event_remove ( pevent->ev_que, getix, &canceledEvent );
         }
-        getix = RNGINC ( getix );
+        getix = RNGINC ( pevent->ev_que, getix );
         if ( getix == pevent->ev_que->getix ) {
             break;
         }
@@ -596,7 +756,7 @@ void db_cancel_event (dbEventSubscription event)
         }
     }
 
-    pevent->ev_que->quota -= EVENTENTRIES;
+    pevent->ev_que->quota -= pevent->ev_que->nentries;
 
     UNLOCKEVQUE (pevent->ev_que);
 
@@ -704,6 +864,183 @@ db_field_log* db_create_event_log (struct evSubscrip *pevent)
     return pLog;
 }
 
+/*
+ *  snapshot_create()
+ *
+ *  NOTE: This assumes that the db scan lock is already applied
+ */
+static event_snapshot * snapshot_create (struct dbChannel *chan)
+{
+    struct dbCommon *prec = dbChannelRecord(chan);
+    /* get_array_info() may change pfield, so work on a copy */
+    DBADDR addr = chan->addr;
+    long no_elements = addr.no_elements;
+    long offset = 0;
+    event_snapshot *psnap;
+    rset *prset;
+
+    if (addr.special == SPC_DBADDR &&
+        (prset = dbGetRset(&addr)) &&
+        prset->get_array_info) {
+        prset->get_array_info(&addr, &no_elements, &offset);
+    }
+
+    psnap = (event_snapshot *) malloc(sizeof(event_snapshot) +
+        no_elements * addr.field_size);
+    if (!psnap)
+        return NULL;
+
+    psnap->refcount = 1;
+    psnap->pconverted = NULL;
+    psnap->pfield = dbChannelField(chan);
+    psnap->time = prec->time;
+    psnap->stat = prec->stat;
+    psnap->sevr = prec->sevr;
+    psnap->field_type = addr.field_type;
+    psnap->field_size = addr.field_size;
+    psnap->no_elements = no_elements;
+    if (no_elements) {
+        dbExtractArrayFromRec(&addr, psnap + 1, no_elements,
+            addr.no_elements, offset, 1);
+    }
+    return psnap;
+}
+
+static void snapshot_release (event_snapshot *psnap)
+{
+    if (epicsAtomicDecrIntT(&psnap->refcount) == 0) {
+        free(psnap->pconverted);
+        free(psnap);
+    }
+}
+
+static void snapshot_log_dtor (db_field_log *pfl)
+{
+    snapshot_release((event_snapshot *) pfl->u.r.pvt);
+}
+
+/*
+ *  db_event_snapshot_hold()
+ *
+ *  Keeps the data of a snapshot field log valid after the field log
+ *  has been deleted.  Returns NULL if the field log doesn't refer to
+ *  a snapshot, otherwise a handle for db_event_snapshot_release().
+ */
+void * db_event_snapshot_hold (const db_field_log *pfl)
+{
+    event_snapshot *psnap;
+
+    if (!pfl || pfl->type != dbfl_type_ref ||
+        pfl->u.r.dtor != snapshot_log_dtor)
+        return NULL;
+
+    psnap = (event_snapshot *) pfl->u.r.pvt;
+    epicsAtomicIncrIntT(&psnap->refcount);
+    return psnap;
+}
+
+void db_event_snapshot_release (void *pSnapshot)
+{
+    if (pSnapshot)
+        snapshot_release((event_snapshot *) pSnapshot);
+}
+
+/*
+ *  db_event_snapshot_convert()
+ *
+ *  Returns a converted copy of the array of a snapshot, which is made
+ *  by the first caller and then shared by all the subscriptions that
+ *  the snapshot was queued for.  Callers that race for the first copy
+ *  may each convert, but only one copy is kept.  The copy lives as
+ *  long as the snapshot, which the caller must hold.  Returns NULL if
+ *  the field log doesn't refer to a snapshot or the copy failed.
+ */
+const void * db_event_snapshot_convert (const db_field_log *pfl,
+    DB_SNAPSHOT_CONVERT *convert, void *arg)
+{
+    event_snapshot *psnap;
+    char *pconverted, *pprev;
+    size_t size, offset;
+
+    if (!pfl || pfl->type != dbfl_type_ref ||
+        pfl->u.r.dtor != snapshot_log_dtor)
+        return NULL;
+
+    /* a filter may have moved the field log into the array */
+    psnap = (event_snapshot *) pfl->u.r.pvt;
+    size = psnap->no_elements * psnap->field_size;
+    offset = (char *) pfl->u.r.field - (char *) (psnap + 1);
+    if (offset >= size)
+        return NULL;
+
+    pconverted = epicsAtomicGetPtrT(&psnap->pconverted);
+    if (pconverted) {
+        epicsAtomicReadMemoryBarrier();
+        return pconverted + offset;
+    }
+
+    pconverted = malloc(size);
+    if (!pconverted)
+        return NULL;
+    if ((*convert)(psnap + 1, pconverted, psnap->no_elements, arg)) {
+        free(pconverted);
+        return NULL;
+    }
+
+    pprev = epicsAtomicCmpAndSwapPtrT(&psnap->pconverted, NULL, pconverted);
+    if (pprev) {
+        free(pconverted);
+        pconverted = pprev;
+    }
+    return pconverted + offset;
+}
+
+/*
+ *  create_event_log()
+ *
+ *  Fields that can't be queued by value are copied into a snapshot,
+ *  if enabled.  The snapshot is taken for the first subscription that
+ *  needs it and then shared through *ppsnap with the others to the
+ *  same field.
+ */
+static db_field_log* create_event_log (struct evSubscrip *pevent,
+    event_snapshot **ppsnap)
+{
+    struct dbChannel *chan = pevent->chan;
+    event_snapshot *psnap = *ppsnap;
+    db_field_log *pLog;
+
+    if (pevent->useValque || !dbEventArraySnapshots ||
+        dbChannelFieldType(chan) > DBF_ENUM) {
+        return db_create_event_log(pevent);
+    }
+
+    if (!psnap || psnap->pfield != dbChannelField(chan)) {
+        if (psnap)
+            snapshot_release(psnap);
+        *ppsnap = psnap = snapshot_create(chan);
+        if (!psnap)
+            return db_create_event_log(pevent);
+    }
+
+    pLog = (db_field_log *) freeListCalloc(dbevFieldLogFreeList);
+    if (pLog) {
+        epicsAtomicIncrIntT(&psnap->refcount);
+        pLog->ctx = dbfl_context_event;
+        pLog->type = dbfl_type_ref;
+        pLog->stat = psnap->stat;
+        pLog->sevr = psnap->sevr;
+        pLog->time = psnap->time;
+        pLog->field_type = psnap->field_type;
+        pLog->field_size = psnap->field_size;
+        pLog->no_elements = psnap->no_elements;
+        pLog->u.r.dtor = snapshot_log_dtor;
+        pLog->u.r.pvt = psnap;
+        pLog->u.r.field = psnap + 1;
+    }
+    return pLog;
+}
+
 /*
  *  DB_CREATE_READ_LOG()
  *
@@ -720,23 +1057,17 @@ db_field_log* db_create_read_log (struct dbChannel *chan)
 }
 
 /*
- *  DB_QUEUE_EVENT_LOG()
+ *  queue_event_log_locked()
  *
+ *  NOTE: The event queue lock must be applied.
+ *  Returns true if the event task needs to be notified.
  */
-static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
+static int queue_event_log_locked (evSubscrip *pevent, db_field_log *pLog)
 {
-    struct event_que    *ev_que;
+    struct event_que * const ev_que = pevent->ev_que;
     int firstEventFlag;
     unsigned rngSpace;
 
-    ev_que = pevent->ev_que;
-    /*
-     * evUser ring buffer must be locked for the multiple
-     * threads writing/reading it
-     */
-
-    LOCKEVQUE (ev_que);
-
     /*
      * if we have an event on the queue and both the last
      * event on the queue and the current event are emtpy
@@ -747,8 +1078,7 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
         (*pevent->pLastLog)->type == dbfl_type_rec &&
         pLog->type == dbfl_type_rec) {
         db_delete_field_log(pLog);
-        UNLOCKEVQUE (ev_que);
-        return;
+        return 0;
     }
 
     /*
@@ -794,15 +1124,33 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
          * if the ring buffer was empty before
          * adding this event
          */
-        if (rngSpace==EVENTQUESIZE) {
+        if (rngSpace==ev_que->size) {
             firstEventFlag = 1;
         }
         else {
             firstEventFlag = 0;
         }
-        ev_que->putix = RNGINC ( ev_que->putix );
+        ev_que->putix = RNGINC ( ev_que, ev_que->putix );
     }
 
+    return firstEventFlag;
+}
+
+/*
+ *  DB_QUEUE_EVENT_LOG()
+ *
+ */
+static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
+{
+    struct event_que * const ev_que = pevent->ev_que;
+    int firstEventFlag;
+
+    /*
+     * evUser ring buffer must be locked for the multiple
+     * threads writing/reading it
+     */
+    LOCKEVQUE (ev_que);
+    firstEventFlag = queue_event_log_locked (pevent, pLog);
     UNLOCKEVQUE (ev_que);
 
     /*
@@ -833,6 +1181,7 @@ unsigned int    caEventMask
 {
     struct dbCommon   * const prec = (struct dbCommon *) pRecord;
     struct evSubscrip *pevent;
+    event_snapshot *psnap = NULL;
 
     if (prec->mlis.count == 0) return DB_EVENT_OK;       /* no monitors set */
 
@@ -847,17 +1196,265 @@ unsigned int    caEventMask
          */
         if ( (dbChannelField(pevent->chan) == (void *)pField || pField==NULL) &&
             (caEventMask & pevent->select)) {
-            db_field_log *pLog = db_create_event_log(pevent);
+            db_field_log *pLog = create_event_log(pevent, &psnap);
             pLog = dbChannelRunPreChain(pevent->chan, pLog);
             if (pLog) db_queue_event_log(pevent, pLog);
         }
     }
 
     UNLOCKREC (prec);
+    if (psnap) snapshot_release(psnap);
     return DB_EVENT_OK;
 
 }
 
+/*
+ *  DB_EVENT_BATCH_CREATE()
+ */
+dbEventBatch * db_event_batch_create (void)
+{
+    return (dbEventBatch *) calloc(1, sizeof(dbEventBatch));
+}
+
+/*
+ *  DB_EVENT_BATCH_DESTROY()
+ */
+void db_event_batch_destroy (dbEventBatch *pbatch)
+{
+    if (!pbatch)
+        return;
+    if (pbatch->open)
+        db_post_events_commit(pbatch);
+    free(pbatch->entries);
+    free(pbatch->records);
+    free(pbatch->queues);
+    free(pbatch->users);
+    free(pbatch->slots);
+    free(pbatch);
+}
+
+/*
+ *  DB_POST_EVENTS_BEGIN()
+ */
+void db_post_events_begin (dbEventBatch *pbatch)
+{
+    if (pbatch->open)
+        db_post_events_commit(pbatch);
+    pbatch->open = TRUE;
+}
+
+/*
+ *  DB_POST_EVENTS_BATCH()
+ *
+ *  Like db_post_events() but the field logs are kept in the batch
+ *  instead of being queued.  The record's mlok stays held until the
+ *  batch is committed so that none of its subscriptions can be
+ *  canceled in the meantime.
+ *
+ *  NOTE: This assumes that the db scan lock is already applied,
+ *        and stays applied until db_post_events_commit().
+ */
+int db_post_events_batch (
+dbEventBatch    *pbatch,
+void            *pRecord,
+void            *pField,
+unsigned int    caEventMask
+)
+{
+    struct dbCommon   * const prec = (struct dbCommon *) pRecord;
+    struct evSubscrip *pevent;
+    event_snapshot *psnap = NULL;
+
+    if (!pbatch->open)
+        return db_post_events(pRecord, pField, caEventMask);
+    if (prec->mlis.count == 0) return DB_EVENT_OK;       /* no monitors set */
+
+    if (pbatch->nRecords == pbatch->nRecAlloc) {
+        unsigned nAlloc = pbatch->nRecAlloc ? 2 * pbatch->nRecAlloc : 64;
+        struct dbCommon **records = (struct dbCommon **)
+            realloc(pbatch->records, nAlloc * sizeof(struct dbCommon *));
+
+        if (!records)
+            return db_post_events(pRecord, pField, caEventMask);
+        pbatch->records = records;
+        pbatch->nRecAlloc = nAlloc;
+    }
+
+    LOCKREC (prec);
+    pbatch->records[pbatch->nRecords++] = prec;
+
+    for (pevent = (struct evSubscrip *) prec->mlis.node.next;
+        pevent; pevent = (struct evSubscrip *) pevent->node.next){
+
+        if ( (dbChannelField(pevent->chan) == (void *)pField || pField==NULL) &&
+            (caEventMask & pevent->select)) {
+            db_field_log *pLog = create_event_log(pevent, &psnap);
+
+            pLog = dbChannelRunPreChain(pevent->chan, pLog);
+            if (!pLog)
+                continue;
+
+            if (pbatch->nEntries == pbatch->nAlloc) {
+                unsigned nAlloc = pbatch->nAlloc ? 2 * pbatch->nAlloc : 256;
+                batch_entry *entries = (batch_entry *)
+                    realloc(pbatch->entries, nAlloc * sizeof(batch_entry));
+
+                if (!entries) {
+                    db_queue_event_log(pevent, pLog);
+                    continue;
+                }
+                pbatch->entries = entries;
+                pbatch->nAlloc = nAlloc;
+            }
+            pbatch->entries[pbatch->nEntries].pevent = pevent;
+            pbatch->entries[pbatch->nEntries].pLog = pLog;
+            pbatch->nEntries++;
+        }
+    }
+
+    if (psnap) snapshot_release(psnap);
+    return DB_EVENT_OK;
+}
+
+/*
+ * Find the slot of key in one of the open addressed hash tables
+ * of the batch, returns an empty slot if it isn't there
+ */
+static batch_slot * batch_find_slot (batch_slot *table, unsigned nSlots,
+    const void *key)
+{
+    const unsigned mask = nSlots - 1u;
+    size_t hash = (size_t) key;
+    unsigned i;
+
+    hash ^= hash >> 4;
+    i = (unsigned) (hash * 2654435761u) & mask;
+    while (table[i].key && table[i].key != key)
+        i = (i + 1u) & mask;
+    return &table[i];
+}
+
+/*
+ * Make sure the grouping scratch space can hold every entry
+ */
+static int batch_reserve_groups (dbEventBatch *pbatch)
+{
+    unsigned nSlots = pbatch->nSlots ? pbatch->nSlots : 64;
+    batch_queue *queues;
+    batch_user *users;
+    batch_slot *slots;
+
+    if (pbatch->queues && pbatch->nSlots >= 2 * pbatch->nAlloc)
+        return 0;
+
+    while (nSlots < 2 * pbatch->nAlloc)
+        nSlots *= 2;
+    queues = (batch_queue *) malloc(pbatch->nAlloc * sizeof(batch_queue));
+    users = (batch_user *) malloc(pbatch->nAlloc * sizeof(batch_user));
+    slots = (batch_slot *) malloc(2 * nSlots * sizeof(batch_slot));
+    if (!queues || !users || !slots) {
+        free(queues);
+        free(users);
+        free(slots);
+        return -1;
+    }
+    free(pbatch->queues);
+    free(pbatch->users);
+    free(pbatch->slots);
+    pbatch->queues = queues;
+    pbatch->users = users;
+    pbatch->slots = slots;
+    pbatch->nSlots = nSlots;
+    return 0;
+}
+
+/*
+ *  DB_POST_EVENTS_COMMIT()
+ *
+ *  Queues the batch with one lock of each event queue involved, in
+ *  posting order, and wakes each event task at most once.  The entries
+ *  are first chained together by event queue in a single pass.
+ */
+void db_post_events_commit (dbEventBatch *pbatch)
+{
+    batch_entry * const entries = pbatch->entries;
+    const unsigned n = pbatch->nEntries;
+    unsigned nQueues = 0, nUsers = 0;
+    unsigned i;
+
+    if (n > 0 && batch_reserve_groups(pbatch) == 0) {
+        batch_queue * const queues = pbatch->queues;
+        batch_user * const users = pbatch->users;
+        batch_slot * const queueSlots = pbatch->slots;
+        batch_slot * const userSlots = pbatch->slots + pbatch->nSlots;
+
+        /* The first queue of a user shares its address, so the queues
+         * and users are looked up in separate tables.
+         */
+        memset(pbatch->slots, 0, 2 * pbatch->nSlots * sizeof(batch_slot));
+
+        for (i = 0; i < n; i++) {
+            struct event_que * const ev_que = entries[i].pevent->ev_que;
+            batch_slot *pslot = batch_find_slot(queueSlots, pbatch->nSlots,
+                ev_que);
+
+            entries[i].next = n;
+            if (pslot->key) {
+                batch_queue * const pq = &queues[pslot->index];
+
+                entries[pq->last].next = i;
+                pq->last = i;
+            }
+            else {
+                batch_queue * const pq = &queues[nQueues];
+                batch_slot *puslot = batch_find_slot(userSlots,
+                    pbatch->nSlots, ev_que->evUser);
+
+                pslot->key = ev_que;
+                pslot->index = nQueues++;
+                if (!puslot->key) {
+                    puslot->key = ev_que->evUser;
+                    puslot->index = nUsers;
+                    users[nUsers].evUser = ev_que->evUser;
+                    users[nUsers++].firstEventFlag = 0;
+                }
+                pq->ev_que = ev_que;
+                pq->first = pq->last = i;
+                pq->user = puslot->index;
+            }
+        }
+
+        for (i = 0; i < nQueues; i++) {
+            struct event_que * const ev_que = queues[i].ev_que;
+            int firstEventFlag = 0;
+            unsigned k;
+
+            LOCKEVQUE (ev_que);
+            for (k = queues[i].first; k < n; k = entries[k].next) {
+                firstEventFlag |= queue_event_log_locked (
+                    entries[k].pevent, entries[k].pLog);
+            }
+            UNLOCKEVQUE (ev_que);
+            users[queues[i].user].firstEventFlag |= firstEventFlag;
+        }
+
+        for (i = 0; i < nUsers; i++) {
+            if (users[i].firstEventFlag)
+                epicsEventSignal(users[i].evUser->ppendsem);
+        }
+    }
+    else {
+        for (i = 0; i < n; i++)
+            db_queue_event_log(entries[i].pevent, entries[i].pLog);
+    }
+
+    while (pbatch->nRecords > 0) {
+        UNLOCKREC (pbatch->records[--pbatch->nRecords]);
+    }
+    pbatch->nEntries = 0;
+    pbatch->open = FALSE;
+}
+
 /*
  *  DB_POST_SINGLE_EVENT()
  */
@@ -865,15 +1462,17 @@ void db_post_single_event (dbEventSubscription event)
 {
     struct evSubscrip * const pevent = (struct evSubscrip *) event;
     struct dbCommon * const prec = dbChannelRecord(pevent->chan);
+    event_snapshot *psnap = NULL;
     db_field_log *pLog;
 
     dbScanLock (prec);
 
-    pLog = db_create_event_log(pevent);
+    pLog = create_event_log(pevent, &psnap);
     pLog = dbChannelRunPreChain(pevent->chan, pLog);
     if(pLog) db_queue_event_log(pevent, pLog);
 
     dbScanUnlock (prec);
+    if (psnap) snapshot_release(psnap);
 }
 
 /*
@@ -911,7 +1510,7 @@ static int event_read ( struct event_que *ev_que )
                 db_delete_field_log(ev_que->valque[ev_que->getix]);
                 ev_que->valque[ev_que->getix] = NULL;
             }
-            ev_que->getix = RNGINC ( ev_que->getix );
+            ev_que->getix = RNGINC ( ev_que, ev_que->getix );
             assert ( ev_que->nCanceled > 0 );
             ev_que->nCanceled--;
             continue;
@@ -924,7 +1523,7 @@ static int event_read ( struct event_que *ev_que )
          */
 
         event_remove ( ev_que, ev_que->getix, EVENTQEMPTY );
-        ev_que->getix = RNGINC ( ev_que->getix );
+        ev_que->getix = RNGINC ( ev_que, ev_que->getix );
 
         /*
          * create a local copy of the call back parameters while
@@ -1043,7 +1642,7 @@ static void event_task (void *pParm)
 
     } while( ! pendexit );
 
-    epicsMutexDestroy(evUser->firstque.writelock);
+    destroy_ev_que(&evUser->firstque);
 
     {
         struct event_que    *nextque;
@@ -1051,7 +1650,7 @@ static void event_task (void *pParm)
         ev_que = evUser->firstque.nextque;
         while (ev_que) {
             nextque = ev_que->nextque;
-            epicsMutexDestroy(ev_que->writelock);
+            destroy_ev_que(ev_que);
             freeListFree(dbevEventQueueFreeList, ev_que);
             ev_que = nextque;
         }
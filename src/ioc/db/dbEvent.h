@@ -47,6 +47,15 @@ epicsShareFunc int dbel (
 epicsShareFunc int db_post_events (
     void *pRecord, void *pField, unsigned caEventMask );
 
+/* Batched posting, see db_post_events_batch() */
+typedef struct dbEventBatch dbEventBatch;
+epicsShareFunc dbEventBatch * db_event_batch_create (void);
+epicsShareFunc void db_event_batch_destroy (dbEventBatch *pbatch);
+epicsShareFunc void db_post_events_begin (dbEventBatch *pbatch);
+epicsShareFunc int db_post_events_batch (dbEventBatch *pbatch,
+    void *pRecord, void *pField, unsigned caEventMask );
+epicsShareFunc void db_post_events_commit (dbEventBatch *pbatch);
+
 typedef void * dbEventCtx;
 
 typedef void EXTRALABORFUNC (void *extralabor_arg);
@@ -62,6 +71,13 @@ epicsShareFunc int db_add_extra_labor_event (
 epicsShareFunc void db_flush_extra_labor_event (dbEventCtx);
 epicsShareFunc int db_post_extra_labor (dbEventCtx ctx);
 epicsShareFunc void db_event_change_priority ( dbEventCtx ctx, unsigned epicsPriority );
+epicsShareFunc void db_event_set_queue_depth ( dbEventCtx ctx, unsigned depth );
+epicsShareFunc void * db_event_snapshot_hold ( const struct db_field_log *pfl );
+epicsShareFunc void db_event_snapshot_release ( void *pSnapshot );
+typedef int DB_SNAPSHOT_CONVERT ( const void *pfrom, void *pto,
+    long no_elements, void *arg );
+epicsShareFunc const void * db_event_snapshot_convert (
+    const struct db_field_log *pfl, DB_SNAPSHOT_CONVERT *convert, void *arg );
 
 #ifdef EPICS_PRIVATE_API
 epicsShareFunc void db_cleanup_events(void);
@@ -74,6 +90,9 @@ typedef void * dbEventSubscription;
 epicsShareFunc dbEventSubscription db_add_event (
     dbEventCtx ctx, struct dbChannel *chan,
     EVENTFUNC *user_sub, void *user_arg, unsigned select);
+epicsShareFunc dbEventSubscription db_add_event_depth (
+    dbEventCtx ctx, struct dbChannel *chan,
+    EVENTFUNC *user_sub, void *user_arg, unsigned select, unsigned depth);
 epicsShareFunc void db_cancel_event (dbEventSubscription es);
 epicsShareFunc void db_post_single_event (dbEventSubscription es);
 epicsShareFunc void db_event_enable (dbEventSubscription es);
@@ -83,6 +102,11 @@ epicsShareFunc struct db_field_log* db_create_event_log (struct evSubscrip *peve
 epicsShareFunc struct db_field_log* db_create_read_log (struct dbChannel *chan);
 epicsShareFunc void db_delete_field_log (struct db_field_log *pfl);
 
+/* Default queue depth of new event users */
+epicsShareExtern int dbEventQueueDepth;
+/* Non-zero queues a shared copy of array and string fields with each event */
+epicsShareExtern int dbEventArraySnapshots;
+
 #define DB_EVENT_OK 0
 #define DB_EVENT_ERROR (-1)
 
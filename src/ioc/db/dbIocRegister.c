@@ -19,6 +19,8 @@
 #include "dbJLink.h"
 #include "dbLock.h"
 #include "dbNotify.h"
+#include "dbParallelFwd.h"
+#include "dbProcTime.h"
 #include "dbScan.h"
 #include "dbServer.h"
 #include "dbState.h"
@@ -290,6 +292,71 @@ static void scanOnceSetQueueSizeCallFunc(const iocshArgBuf *args)
     scanOnceSetQueueSize(args[0].ival);
 }
 
+/* dbProcTimeShow */
+static const iocshArg dbProcTimeShowArg0 = { "record name",iocshArgString};
+static const iocshArg * const dbProcTimeShowArgs[1] = {&dbProcTimeShowArg0};
+static const iocshFuncDef dbProcTimeShowFuncDef =
+    {"dbProcTimeShow",1,dbProcTimeShowArgs};
+static void dbProcTimeShowCallFunc(const iocshArgBuf *args)
+{ dbProcTimeShow(args[0].sval);}
+
+/* dbProcTimeScan */
+static const iocshArg dbProcTimeScanArg0 = { "rate",iocshArgDouble};
+static const iocshArg dbProcTimeScanArg1 = { "count",iocshArgInt};
+static const iocshArg * const dbProcTimeScanArgs[2] =
+    {&dbProcTimeScanArg0,&dbProcTimeScanArg1};
+static const iocshFuncDef dbProcTimeScanFuncDef =
+    {"dbProcTimeScan",2,dbProcTimeScanArgs};
+static void dbProcTimeScanCallFunc(const iocshArgBuf *args)
+{ dbProcTimeScan(args[0].dval, args[1].ival);}
+
+/* dbProcTimeLockSet */
+static const iocshArg dbProcTimeLockSetArg0 = { "count",iocshArgInt};
+static const iocshArg * const dbProcTimeLockSetArgs[1] =
+    {&dbProcTimeLockSetArg0};
+static const iocshFuncDef dbProcTimeLockSetFuncDef =
+    {"dbProcTimeLockSet",1,dbProcTimeLockSetArgs};
+static void dbProcTimeLockSetCallFunc(const iocshArgBuf *args)
+{ dbProcTimeLockSet(args[0].ival);}
+
+/* dbProcTimeReset */
+static const iocshFuncDef dbProcTimeResetFuncDef = {"dbProcTimeReset",0};
+static void dbProcTimeResetCallFunc(const iocshArgBuf *args)
+{ dbProcTimeReset();}
+
+/* scanPeriodicParallel */
+static const iocshArg scanPeriodicParallelArg0 = { "count",iocshArgInt};
+static const iocshArg * const scanPeriodicParallelArgs[1] =
+    {&scanPeriodicParallelArg0};
+static const iocshFuncDef scanPeriodicParallelFuncDef =
+    {"scanPeriodicParallel",1,scanPeriodicParallelArgs};
+static void scanPeriodicParallelCallFunc(const iocshArgBuf *args)
+{
+    scanPeriodicParallel(args[0].ival);
+}
+
+/* dbParallelFwdThreads */
+static const iocshArg dbParallelFwdThreadsArg0 = { "count",iocshArgInt};
+static const iocshArg * const dbParallelFwdThreadsArgs[1] =
+    {&dbParallelFwdThreadsArg0};
+static const iocshFuncDef dbParallelFwdThreadsFuncDef =
+    {"dbParallelFwdThreads",1,dbParallelFwdThreadsArgs};
+static void dbParallelFwdThreadsCallFunc(const iocshArgBuf *args)
+{
+    dbParallelFwdThreads(args[0].ival);
+}
+
+/* dbParallelFwdShow */
+static const iocshArg dbParallelFwdShowArg0 = { "level",iocshArgInt};
+static const iocshArg * const dbParallelFwdShowArgs[1] =
+    {&dbParallelFwdShowArg0};
+static const iocshFuncDef dbParallelFwdShowFuncDef =
+    {"dbParallelFwdShow",1,dbParallelFwdShowArgs};
+static void dbParallelFwdShowCallFunc(const iocshArgBuf *args)
+{
+    dbParallelFwdShow(args[0].ival);
+}
+
 /* scanppl */
 static const iocshArg scanpplArg0 = { "rate",iocshArgDouble};
 static const iocshArg * const scanpplArgs[1] = {&scanpplArg0};
@@ -341,6 +408,29 @@ static void callbackParallelThreadsCallFunc(const iocshArgBuf *args)
     callbackParallelThreads(args[0].ival, args[1].sval);
 }
 
+/* callbackSetQueueType */
+static const iocshArg callbackSetQueueTypeArg0 = { "type", iocshArgString};
+static const iocshArg callbackSetQueueTypeArg1 = { "priority", iocshArgString};
+static const iocshArg * const callbackSetQueueTypeArgs[2] =
+    {&callbackSetQueueTypeArg0,&callbackSetQueueTypeArg1};
+static const iocshFuncDef callbackSetQueueTypeFuncDef =
+    {"callbackSetQueueType",2,callbackSetQueueTypeArgs};
+static void callbackSetQueueTypeCallFunc(const iocshArgBuf *args)
+{
+    callbackSetQueueType(args[0].sval, args[1].sval);
+}
+
+/* callbackQueueShow */
+static const iocshArg callbackQueueShowArg0 = { "reset", iocshArgInt};
+static const iocshArg * const callbackQueueShowArgs[1] =
+    {&callbackQueueShowArg0};
+static const iocshFuncDef callbackQueueShowFuncDef =
+    {"callbackQueueShow",1,callbackQueueShowArgs};
+static void callbackQueueShowCallFunc(const iocshArgBuf *args)
+{
+    callbackQueueShow(args[0].ival);
+}
+
 /* dbStateCreate */
 static const iocshArg dbStateArgName = { "name", iocshArgString };
 static const iocshArg * const dbStateCreateArgs[] = { &dbStateArgName };
@@ -434,6 +524,14 @@ void dbIocRegister(void)
     iocshRegister(&dbLockShowLockedFuncDef,dbLockShowLockedCallFunc);
 
     iocshRegister(&scanOnceSetQueueSizeFuncDef,scanOnceSetQueueSizeCallFunc);
+    iocshRegister(&dbProcTimeShowFuncDef,dbProcTimeShowCallFunc);
+    iocshRegister(&dbProcTimeScanFuncDef,dbProcTimeScanCallFunc);
+    iocshRegister(&dbProcTimeLockSetFuncDef,dbProcTimeLockSetCallFunc);
+    iocshRegister(&dbProcTimeResetFuncDef,dbProcTimeResetCallFunc);
+
+    iocshRegister(&scanPeriodicParallelFuncDef,scanPeriodicParallelCallFunc);
+    iocshRegister(&dbParallelFwdThreadsFuncDef,dbParallelFwdThreadsCallFunc);
+    iocshRegister(&dbParallelFwdShowFuncDef,dbParallelFwdShowCallFunc);
     iocshRegister(&scanpplFuncDef,scanpplCallFunc);
     iocshRegister(&scanpelFuncDef,scanpelCallFunc);
     iocshRegister(&postEventFuncDef,postEventCallFunc);
@@ -441,6 +539,8 @@ void dbIocRegister(void)
 
     iocshRegister(&callbackSetQueueSizeFuncDef,callbackSetQueueSizeCallFunc);
     iocshRegister(&callbackParallelThreadsFuncDef,callbackParallelThreadsCallFunc);
+    iocshRegister(&callbackSetQueueTypeFuncDef,callbackSetQueueTypeCallFunc);
+    iocshRegister(&callbackQueueShowFuncDef,callbackQueueShowCallFunc);
 
     /* Needed before callback system is initialized */
     callbackParallelThreadsDefault = epicsThreadGetCPUs();
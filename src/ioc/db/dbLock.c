@@ -749,6 +749,10 @@ void dbLockSetSplit(dbLocker *locker, dbCommon *pfirst, dbCommon *psecond)
                 if(plink->type!=DB_LINK)
                     continue;
 
+                /* forward links into another lock set don't join them */
+                if(plink->value.pv_link.pvlMask & pvlOptFwdPool)
+                    continue;
+
                 ptarget = plink->value.pv_link.pvt;
                 lr = ptarget->precord->lset;
                 assert(lr);
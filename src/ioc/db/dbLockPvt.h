@@ -38,6 +38,10 @@ typedef struct dbLockSet {
     ELLNODE             lockernode;
 
     int                 trace; /*For field TPRO*/
+
+    /* loop checks in dbParallelFwd.c, while its graph lock is held */
+    unsigned long       fwdVisit;
+    int                 fwdNode;
 } lockSet;
 
 struct lockRecord;
@@ -0,0 +1,646 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Processes the targets of forward links that point into another lock
+ *  set on a pool of worker threads.
+ *
+ *  When enabled, DB forward links no longer merge their source and target
+ *  records into one lock set.  A fan-out then dispatches each branch that
+ *  lands in a different lock set to the pool, and dbProcess() of the
+ *  source joins them before it returns, so the chain still completes
+ *  before the source record does.  A thread waiting for its branches
+ *  runs any of them that no worker has started yet itself, so nested
+ *  fan-outs can't starve the pool.
+ *
+ *  A thread that joins its branches holds its lock set while it waits
+ *  for theirs, so the lock sets that such links connect must never form
+ *  a loop.  dbParallelFwdInit() merges each loop into one lock set, as
+ *  if its links had never gone to the pool.  A link changed at run-time
+ *  that closes a loop is marked deferred instead: its target is queued
+ *  without anybody waiting for it, after the source's lock is released.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "ellLib.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "freeList.h"
+
+#define epicsExportSharedSymbols
+#include "dbAccessDefs.h"
+#include "dbAddr.h"
+#include "dbBase.h"
+#include "dbCommon.h"
+#include "dbLockPvt.h"
+#include "dbNotify.h"
+#include "dbParallelFwd.h"
+#include "dbScan.h"
+#include "dbStaticLib.h"
+#include "link.h"
+
+typedef struct fwdJob {
+    ELLNODE node;
+    dbCommon *pto;
+    dbParallelFwdGroup *pgroup;     /* NULL if nobody waits for it */
+} fwdJob;
+
+typedef struct fwdWaiter {
+    ELLNODE node;
+    epicsEventId done;
+} fwdWaiter;
+
+/* Walks the pool forward links of the records in a lock set */
+typedef struct fwdLinkIter {
+    ELLNODE *pnode;     /* lockRecord::node */
+    short iLink;
+} fwdLinkIter;
+
+typedef struct loopNode {
+    lockSet *pset;
+    fwdLinkIter it;
+    int index;
+    int lowlink;
+    int onStack;
+    int loop;           /* root of the loop it was found in */
+} loopNode;
+
+/* State of a walk through the lock sets, see fwdVisit */
+typedef struct loopWalk {
+    loopNode *nodes;
+    int *path;          /* the nodes being walked from */
+    int *stack;         /* Tarjan's stack of unfinished loops */
+    int nNodes, nPath, nStack, maxNodes;
+} loopWalk;
+
+int dbParallelFwdActive = 0;
+
+static int fwdThreads = 0;
+static epicsThreadOnceId fwdOnce = EPICS_THREAD_ONCE_INIT;
+static epicsThreadPrivateId fwdCurrent;    /* innermost dbParallelFwdGroup */
+
+static epicsMutexId graphLock;              /* guards links between sets */
+static unsigned long fwdVisit;              /* marks lockSet::fwdNode valid */
+
+static epicsMutexId fwdLock;                /* guards everything below */
+static ELLLIST jobQ = ELLLIST_INIT;
+static ELLLIST waiterList = ELLLIST_INIT;   /* unused waiters */
+static void *jobFreeList;
+static epicsEventId jobReady;
+static epicsEventId threadsExited;
+static int threadsRunning;
+static volatile int fwdExit;
+
+/* Statistics */
+static size_t nDispatched;      /* branches queued */
+static size_t nJoined;          /* fan-outs that had to wait */
+static size_t nStolen;          /* run by the waiting thread */
+static size_t nInline;          /* target in the same lock set */
+static size_t nDeferred;        /* target lock set held up the chain */
+static size_t nLoopsMerged;     /* loops merged into one lock set */
+static size_t nLinksDeferred;   /* links that closed a loop at run-time */
+
+static void fwdOnceFunc(void *junk)
+{
+    fwdCurrent = epicsThreadPrivateCreate();
+    graphLock = epicsMutexMustCreate();
+    fwdLock = epicsMutexMustCreate();
+}
+
+int dbParallelFwdThreads(int count)
+{
+    if (dbParallelFwdActive || interruptAccept) {
+        fprintf(stderr, "dbParallelFwdThreads: must be called before iocInit\n");
+        return -1;
+    }
+
+    if (count < 0) {
+        count = epicsThreadGetCPUs() + count;
+        if (count < 1) count = 1;
+    }
+    fwdThreads = count;
+    return 0;
+}
+
+int dbParallelFwdEnabled(void)
+{
+    return fwdThreads > 0;
+}
+
+/* Is the lock set of precord held by a thread waiting for this one? */
+static dbParallelFwdGroup * heldUpChain(dbParallelFwdGroup *pgroup,
+    dbCommon *precord)
+{
+    lockSet *plockSet = precord->lset->plockSet;
+
+    for (; pgroup; pgroup = pgroup->parent) {
+        if (pgroup->precord->lset->plockSet == plockSet)
+            return pgroup;
+    }
+    return NULL;
+}
+
+static dbCommon * fwdTarget(struct link *plink)
+{
+    return ((dbAddr *) plink->value.pv_link.pvt)->precord;
+}
+
+static void fwdLinkFirst(fwdLinkIter *pit, lockSet *pset)
+{
+    pit->pnode = ellFirst(&pset->lockRecordList);
+    pit->iLink = 0;
+}
+
+/* Returns the next pool link, skipping deferred ones unless all is set */
+static struct link * fwdLinkNext(fwdLinkIter *pit, int all)
+{
+    while (pit->pnode) {
+        dbCommon *prec = CONTAINER(pit->pnode, lockRecord, node)->precord;
+        dbRecordType *prdes = prec->rdes;
+
+        while (pit->iLink < prdes->no_links) {
+            dbFldDes *pflddes = prdes->papFldDes[prdes->link_ind[pit->iLink++]];
+            struct link *plink = (struct link *)
+                ((char *) prec + pflddes->offset);
+            short mask = plink->value.pv_link.pvlMask;
+
+            if (pflddes->field_type == DBF_FWDLINK &&
+                plink->type == DB_LINK && (mask & pvlOptFwdPool) &&
+                (all || !(mask & pvlOptFwdDefer)))
+                return plink;
+        }
+        pit->pnode = ellNext(pit->pnode);
+        pit->iLink = 0;
+    }
+    return NULL;
+}
+
+static int loopNodeFind(lockSet *pset)
+{
+    return pset->fwdVisit == fwdVisit ? pset->fwdNode : -1;
+}
+
+static int loopNodeAdd(loopWalk *pw, lockSet *pset)
+{
+    loopNode *pnode;
+
+    if (pw->nNodes == pw->maxNodes) {
+        int max = pw->maxNodes ? 2 * pw->maxNodes : 64;
+
+        pw->nodes = realloc(pw->nodes, max * sizeof(loopNode));
+        pw->path = realloc(pw->path, max * sizeof(int));
+        pw->stack = realloc(pw->stack, max * sizeof(int));
+        if (!pw->nodes || !pw->path || !pw->stack)
+            cantProceed("dbParallelFwd: No memory to check for loops\n");
+        pw->maxNodes = max;
+    }
+    pnode = &pw->nodes[pw->nNodes];
+    pnode->pset = pset;
+    fwdLinkFirst(&pnode->it, pset);
+    pnode->index = pnode->lowlink = pw->nNodes;
+    pnode->onStack = TRUE;
+    pnode->loop = -1;
+    pset->fwdVisit = fwdVisit;
+    pset->fwdNode = pw->nNodes;
+    pw->path[pw->nPath++] = pw->nNodes;
+    pw->stack[pw->nStack++] = pw->nNodes;
+    return pw->nNodes++;
+}
+
+static void loopWalkFree(loopWalk *pw)
+{
+    free(pw->nodes);
+    free(pw->path);
+    free(pw->stack);
+}
+
+/* The nodes on top of the stack down to root form a loop, put all of
+ * their lock sets into one.  Must be called with graphLock held.
+ */
+static void mergeLoop(loopWalk *pw, int root)
+{
+    struct link **plinks = NULL;
+    int i, nLinks = 0, maxLinks = 0, first = pw->nStack;
+
+    do {
+        loopNode *pnode = &pw->nodes[pw->stack[--first]];
+
+        pnode->onStack = FALSE;
+        pnode->loop = root;
+    } while (pw->stack[first] != root);
+
+    /* find the links before merging moves records between the sets */
+    for (i = first; pw->nStack - first > 1 && i < pw->nStack; i++) {
+        loopNode *pnode = &pw->nodes[pw->stack[i]];
+        struct link *plink;
+
+        fwdLinkFirst(&pnode->it, pnode->pset);
+        while ((plink = fwdLinkNext(&pnode->it, TRUE))) {
+            int target = loopNodeFind(fwdTarget(plink)->lset->plockSet);
+
+            if (target < 0 || pw->nodes[target].loop != root)
+                continue;
+            if (nLinks == maxLinks) {
+                maxLinks = maxLinks ? 2 * maxLinks : 16;
+                plinks = realloc(plinks, maxLinks * sizeof(*plinks));
+                if (!plinks)
+                    cantProceed("dbParallelFwd: No memory to merge loops\n");
+            }
+            plinks[nLinks++] = plink;
+        }
+    }
+    pw->nStack = first;
+
+    for (i = 0; i < nLinks; i++) {
+        struct link *plink = plinks[i];
+        dbCommon *ptarget = fwdTarget(plink);
+
+        plink->value.pv_link.pvlMask &= ~pvlOptFwdPool;
+        ellAdd(&ptarget->bklnk, &plink->value.pv_link.backlinknode);
+        dbLockSetMerge(NULL, plink->precord, ptarget);
+    }
+    if (nLinks)
+        nLoopsMerged++;
+    free(plinks);
+}
+
+/* Tarjan's algorithm for the loops reachable from pstart */
+static void findLoops(loopWalk *pw, lockSet *pstart)
+{
+    loopNodeAdd(pw, pstart);
+    while (pw->nPath) {
+        int v = pw->path[pw->nPath - 1];
+        struct link *plink = fwdLinkNext(&pw->nodes[v].it, TRUE);
+
+        if (plink) {
+            lockSet *pset = fwdTarget(plink)->lset->plockSet;
+            int w = loopNodeFind(pset);
+
+            if (w < 0)
+                loopNodeAdd(pw, pset);
+            else if (pw->nodes[w].onStack &&
+                     pw->nodes[w].index < pw->nodes[v].lowlink)
+                pw->nodes[v].lowlink = pw->nodes[w].index;
+            continue;
+        }
+
+        if (--pw->nPath) {
+            int u = pw->path[pw->nPath - 1];
+
+            if (pw->nodes[v].lowlink < pw->nodes[u].lowlink)
+                pw->nodes[u].lowlink = pw->nodes[v].lowlink;
+        }
+        if (pw->nodes[v].lowlink == pw->nodes[v].index)
+            mergeLoop(pw, v);
+    }
+}
+
+/* Merges every loop of pool links into one lock set, at iocInit */
+static void mergeAllLoops(void)
+{
+    loopWalk walk = {NULL};
+    DBENTRY dbentry;
+    long status;
+
+    epicsMutexMustLock(graphLock);
+    fwdVisit++;
+    dbInitEntry(pdbbase, &dbentry);
+    for (status = dbFirstRecordType(&dbentry); !status;
+         status = dbNextRecordType(&dbentry)) {
+        for (status = dbFirstRecord(&dbentry); !status;
+             status = dbNextRecord(&dbentry)) {
+            dbCommon *prec = dbentry.precnode->precord;
+
+            if (dbentry.precnode->flags & DBRN_FLAGS_ISALIAS ||
+                !prec || !prec->lset ||
+                loopNodeFind(prec->lset->plockSet) >= 0)
+                continue;
+            findLoops(&walk, prec->lset->plockSet);
+        }
+    }
+    dbFinishEntry(&dbentry);
+    epicsMutexUnlock(graphLock);
+    loopWalkFree(&walk);
+}
+
+/* Do links that wait lead from pstart to pgoal? */
+static int reachesSet(loopWalk *pw, lockSet *pstart, lockSet *pgoal)
+{
+    fwdVisit++;
+    pw->nNodes = pw->nPath = pw->nStack = 0;
+    loopNodeAdd(pw, pstart);
+    while (pw->nPath) {
+        loopNode *pnode = &pw->nodes[pw->path[pw->nPath - 1]];
+        struct link *plink = fwdLinkNext(&pnode->it, FALSE);
+        lockSet *pset;
+
+        if (!plink) {
+            pw->nPath--;
+            continue;
+        }
+        pset = fwdTarget(plink)->lset->plockSet;
+        if (pset == pgoal)
+            return TRUE;
+        if (loopNodeFind(pset) < 0)
+            loopNodeAdd(pw, pset);
+    }
+    return FALSE;
+}
+
+void dbParallelFwdLinkChanging(void)
+{
+    epicsThreadOnce(&fwdOnce, fwdOnceFunc, NULL);
+    epicsMutexMustLock(graphLock);
+}
+
+void dbParallelFwdLinkChanged(dbCommon *precord)
+{
+    if (precord) {
+        /* Any new loop runs through the lock set of precord */
+        lockSet *pset = precord->lset->plockSet;
+        loopWalk walk = {NULL};
+        fwdLinkIter it;
+        struct link *plink;
+
+        fwdLinkFirst(&it, pset);
+        while ((plink = fwdLinkNext(&it, FALSE))) {
+            lockSet *ptarget = fwdTarget(plink)->lset->plockSet;
+
+            if (ptarget != pset && reachesSet(&walk, ptarget, pset)) {
+                plink->value.pv_link.pvlMask |= pvlOptFwdDefer;
+                nLinksDeferred++;
+            }
+        }
+        loopWalkFree(&walk);
+    }
+    epicsMutexUnlock(graphLock);
+}
+
+/* Must be called with fwdLock held */
+static void branchDone(dbParallelFwdGroup *pgroup)
+{
+    if (!--pgroup->pending && pgroup->waiter)
+        epicsEventSignal(pgroup->waiter->done);
+}
+
+static void runJob(fwdJob *pjob)
+{
+    dbCommon *pto = pjob->pto;
+    dbParallelFwdGroup *pgroup = pjob->pgroup;
+    void *saved = epicsThreadPrivateGet(fwdCurrent);
+
+    /* Groups of the target link back to ours, see heldUpChain() */
+    epicsThreadPrivateSet(fwdCurrent, pgroup);
+    dbScanLock(pto);
+    dbScanPassive(NULL, pto);
+    dbScanUnlock(pto);
+    epicsThreadPrivateSet(fwdCurrent, saved);
+
+    epicsMutexMustLock(fwdLock);
+    if (pgroup)
+        branchDone(pgroup);
+    freeListFree(jobFreeList, pjob);
+    epicsMutexUnlock(fwdLock);
+}
+
+static void fwdWorker(void *junk)
+{
+    while (!fwdExit) {
+        fwdJob *pjob;
+
+        epicsMutexMustLock(fwdLock);
+        pjob = (fwdJob *) ellGet(&jobQ);
+        if (pjob && ellCount(&jobQ))
+            epicsEventSignal(jobReady);
+        epicsMutexUnlock(fwdLock);
+
+        if (pjob)
+            runJob(pjob);
+        else
+            epicsEventMustWait(jobReady);
+    }
+
+    if (!epicsAtomicDecrIntT(&threadsRunning))
+        epicsEventSignal(threadsExited);
+    else
+        epicsEventSignal(jobReady);
+}
+
+void dbParallelFwdInit(void)
+{
+    int i;
+
+    epicsThreadOnce(&fwdOnce, fwdOnceFunc, NULL);
+    if (fwdThreads <= 0 || dbParallelFwdActive)
+        return;
+
+    mergeAllLoops();
+
+    if (!jobFreeList)
+        freeListInitPvt(&jobFreeList, sizeof(fwdJob), 64);
+    jobReady = epicsEventMustCreate(epicsEventEmpty);
+    threadsExited = epicsEventMustCreate(epicsEventEmpty);
+    fwdExit = FALSE;
+
+    for (i = 0; i < fwdThreads; i++) {
+        char name[20];
+
+        epicsSnprintf(name, sizeof(name), "dbFwd%d", i);
+        if (!epicsThreadCreate(name, epicsThreadPriorityScanHigh,
+                epicsThreadGetStackSize(epicsThreadStackBig),
+                fwdWorker, NULL)) {
+            errlogPrintf("dbParallelFwdInit: Can't create thread %s\n",
+                name);
+            break;
+        }
+        epicsAtomicIncrIntT(&threadsRunning);
+    }
+    dbParallelFwdActive = (threadsRunning > 0);
+}
+
+void dbParallelFwdCleanup(void)
+{
+    fwdWaiter *pwaiter;
+
+    if (!jobReady)
+        return;
+
+    dbParallelFwdActive = FALSE;
+    fwdExit = TRUE;
+    if (epicsAtomicGetIntT(&threadsRunning)) {
+        epicsEventSignal(jobReady);
+        epicsEventMustWait(threadsExited);
+    }
+
+    epicsEventDestroy(jobReady);
+    jobReady = NULL;
+    epicsEventDestroy(threadsExited);
+    threadsExited = NULL;
+
+    while ((pwaiter = (fwdWaiter *) ellGet(&waiterList))) {
+        epicsEventDestroy(pwaiter->done);
+        free(pwaiter);
+    }
+    freeListCleanup(jobFreeList);
+    jobFreeList = NULL;
+}
+
+void dbParallelFwdEnter(dbParallelFwdGroup *pgroup, dbCommon *precord)
+{
+    pgroup->parent = epicsThreadPrivateGet(fwdCurrent);
+    pgroup->precord = precord;
+    pgroup->waiter = NULL;
+    pgroup->pending = 0;
+    epicsThreadPrivateSet(fwdCurrent, pgroup);
+}
+
+void dbParallelFwdJoin(dbParallelFwdGroup *pgroup)
+{
+    if (pgroup->pending) {
+        fwdWaiter *pwaiter = NULL;
+
+        epicsMutexMustLock(fwdLock);
+        nJoined++;
+        while (pgroup->pending) {
+            fwdJob *pjob = (fwdJob *) ellFirst(&jobQ);
+
+            /* Run our own branches that haven't started yet */
+            while (pjob && pjob->pgroup != pgroup)
+                pjob = (fwdJob *) ellNext(&pjob->node);
+            if (pjob) {
+                ellDelete(&jobQ, &pjob->node);
+                nStolen++;
+                epicsMutexUnlock(fwdLock);
+                runJob(pjob);
+                epicsMutexMustLock(fwdLock);
+                continue;
+            }
+
+            if (!pwaiter) {
+                pwaiter = (fwdWaiter *) ellGet(&waiterList);
+                if (!pwaiter) {
+                    pwaiter = callocMustSucceed(1, sizeof(fwdWaiter),
+                        "dbParallelFwdJoin");
+                    pwaiter->done = epicsEventMustCreate(epicsEventEmpty);
+                }
+                pgroup->waiter = pwaiter;
+            }
+            epicsMutexUnlock(fwdLock);
+            epicsEventMustWait(pwaiter->done);
+            epicsMutexMustLock(fwdLock);
+        }
+        if (pwaiter) {
+            /* Consume a signal sent after we last looked */
+            epicsEventTryWait(pwaiter->done);
+            ellAdd(&waiterList, &pwaiter->node);
+        }
+        epicsMutexUnlock(fwdLock);
+    }
+    epicsThreadPrivateSet(fwdCurrent, pgroup->parent);
+}
+
+void dbParallelFwdScan(struct link *plink)
+{
+    dbCommon *pfrom = plink->precord;
+    dbCommon *pto = fwdTarget(plink);
+    int defer = plink->value.pv_link.pvlMask & pvlOptFwdDefer;
+    dbParallelFwdGroup *pgroup;
+    fwdJob *pjob;
+
+    /* if not passive just return */
+    if (pto->scan != 0)
+        return;
+
+    if (pto->lset->plockSet == pfrom->lset->plockSet) {
+        /* Other links put them in the same lock set */
+        epicsAtomicIncrSizeT(&nInline);
+        dbScanPassive(pfrom, pto);
+        return;
+    }
+
+    if (!dbParallelFwdActive || (pfrom->ppn && !defer)) {
+        /* No pool, or dbNotify must see the target added to its wait
+         * list before the source completes.  Process it right here.
+         */
+        dbScanLock(pto);
+        dbScanPassive(pfrom, pto);
+        dbScanUnlock(pto);
+        return;
+    }
+
+    pgroup = epicsThreadPrivateGet(fwdCurrent);
+    if (pgroup) {
+        dbParallelFwdGroup *pheld = heldUpChain(pgroup, pto);
+
+        if (pheld) {
+            /* Looped back into a lock set whose owner waits for us */
+            if (pheld->precord == pto || pto->pact)
+                return;
+            epicsAtomicIncrSizeT(&nDeferred);
+            pgroup = NULL;
+        }
+        else if (pgroup->precord->lset->plockSet != pfrom->lset->plockSet) {
+            /* Not called from inside dbProcess() of pfrom's lock set */
+            pgroup = NULL;
+        }
+        else if (defer) {
+            /* Closes a loop of lock sets, see dbParallelFwdLinkChanged() */
+            epicsAtomicIncrSizeT(&nDeferred);
+            pgroup = NULL;
+        }
+    }
+
+    epicsMutexMustLock(fwdLock);
+    pjob = freeListMalloc(jobFreeList);
+    pjob->pto = pto;
+    pjob->pgroup = pgroup;
+    if (pgroup)
+        pgroup->pending++;
+    ellAdd(&jobQ, &pjob->node);
+    nDispatched++;
+    epicsMutexUnlock(fwdLock);
+    epicsEventSignal(jobReady);
+}
+
+long dbParallelFwdShow(int level)
+{
+    if (!dbParallelFwdActive) {
+        printf("Parallel forward links are %s\n",
+            fwdThreads > 0 ? "not running" : "disabled");
+        return 0;
+    }
+
+    epicsMutexMustLock(fwdLock);
+    printf("%d dbFwd threads, %d branches queued\n",
+        epicsAtomicGetIntT(&threadsRunning), ellCount(&jobQ));
+    printf("    %lu dispatched, %lu joined, %lu run by the waiter\n",
+        (unsigned long) nDispatched, (unsigned long) nJoined,
+        (unsigned long) nStolen);
+    printf("    %lu in the same lock set, %lu deferred after a loop\n",
+        (unsigned long) epicsAtomicGetSizeT(&nInline),
+        (unsigned long) epicsAtomicGetSizeT(&nDeferred));
+    printf("    %lu loops merged into one lock set, %lu links deferred\n",
+        (unsigned long) nLoopsMerged, (unsigned long) nLinksDeferred);
+    if (level > 0) {
+        fwdJob *pjob;
+
+        for (pjob = (fwdJob *) ellFirst(&jobQ); pjob;
+             pjob = (fwdJob *) ellNext(&pjob->node))
+            printf("    %s%s\n", pjob->pto->name,
+                pjob->pgroup ? "" : " (not joined)");
+    }
+    epicsMutexUnlock(fwdLock);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* dbParallelFwd.h */
+/* Parallel processing of forward links into other lock sets */
+
+#ifndef INCdbParallelFwdH
+#define INCdbParallelFwdH
+
+#include "shareLib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct dbCommon;
+struct fwdWaiter;
+struct link;
+
+/* One per active dbProcess() call while the forward link pool runs.
+ * Branches dispatched while processing the record are counted in
+ * pending, and are joined before dbProcess() returns.
+ */
+typedef struct dbParallelFwdGroup {
+    struct dbParallelFwdGroup *parent;  /* group that led to this one */
+    struct dbCommon *precord;           /* record being processed */
+    struct fwdWaiter *waiter;           /* set while joining */
+    int pending;
+} dbParallelFwdGroup;
+
+/* Non-zero while the pool is running */
+epicsShareExtern int dbParallelFwdActive;
+
+/* Configuration, must be called before iocInit */
+epicsShareFunc int dbParallelFwdThreads(int count);
+epicsShareFunc int dbParallelFwdEnabled(void);
+
+epicsShareFunc void dbParallelFwdInit(void);
+epicsShareFunc void dbParallelFwdCleanup(void);
+
+/* Called by dbProcess() around the record's process routine */
+epicsShareFunc void dbParallelFwdEnter(dbParallelFwdGroup *pgroup,
+    struct dbCommon *precord);
+epicsShareFunc void dbParallelFwdJoin(dbParallelFwdGroup *pgroup);
+
+/* Called for DB forward links that don't share the lock set */
+epicsShareFunc void dbParallelFwdScan(struct link *plink);
+
+/* Called around run-time changes of DB links.  Pass the source record
+ * of a link that was added, which makes any forward link that now
+ * closes a loop of lock sets deferred.
+ */
+epicsShareFunc void dbParallelFwdLinkChanging(void);
+epicsShareFunc void dbParallelFwdLinkChanged(struct dbCommon *precord);
+
+epicsShareFunc long dbParallelFwdShow(int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCdbParallelFwdH */
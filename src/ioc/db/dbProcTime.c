@@ -0,0 +1,346 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* dbProcTime.c */
+/* Per-record processing time histograms and hot spot reports */
+
+/* The time charged to a record covers its record support process()
+ * routine, so it includes any records processed synchronously through
+ * its links and forward link.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "dbDefs.h"
+#include "epicsStdio.h"
+#include "epicsTime.h"
+
+#define epicsExportSharedSymbols
+#include "dbAccessDefs.h"
+#include "dbAddr.h"
+#include "dbBase.h"
+#include "dbCommonPvt.h"
+#include "dbLock.h"
+#include "dbProcTime.h"
+#include "dbScan.h"
+#include "dbStaticLib.h"
+#include "epicsExport.h"
+
+epicsShareDef int dbProcTimeStats = 0;
+epicsExportAddress(int, dbProcTimeStats);
+
+#define DEFAULT_COUNT 10
+
+typedef struct procTimeEntry {
+    dbCommon *precord;
+    unsigned long key;
+    unsigned long count;
+    double total;
+    double max;
+} procTimeEntry;
+
+typedef struct procTimeGroup {
+    procTimeEntry *pfirst;
+    int nRecords;
+    double total;
+} procTimeGroup;
+
+void dbProcTimeAdd(dbCommon *precord, const epicsTimeStamp *pstart)
+{
+    dbCommonPvt *ppvt = CONTAINER(precord, dbCommonPvt, common);
+    dbProcTime *ptime = ppvt->ptime;
+    epicsTimeStamp now;
+    double elapsed;
+    unsigned long usec;
+    int bin = 0;
+
+    epicsTimeGetCurrent(&now);
+    elapsed = epicsTimeDiffInSeconds(&now, pstart);
+    if (elapsed < 0.0)
+        elapsed = 0.0;
+
+    if (!ptime) {
+        ptime = calloc(1, sizeof(dbProcTime));
+        if (!ptime)
+            return;
+        ppvt->ptime = ptime;
+    }
+
+    usec = (unsigned long) (elapsed * 1e6);
+    while (usec && bin < DB_PROC_TIME_BINS - 1) {
+        usec >>= 1;
+        bin++;
+    }
+    ptime->hist[bin]++;
+    ptime->count++;
+    ptime->total += elapsed;
+    if (elapsed > ptime->max)
+        ptime->max = elapsed;
+}
+
+long dbProcTimeGet(dbCommon *precord, dbProcTime *ptime)
+{
+    dbCommonPvt *ppvt = CONTAINER(precord, dbCommonPvt, common);
+
+    dbScanLock(precord);
+    if (ppvt->ptime)
+        *ptime = *ppvt->ptime;
+    else
+        memset(ptime, 0, sizeof(dbProcTime));
+    dbScanUnlock(precord);
+    return 0;
+}
+
+typedef void (*procTimeIter)(void *arg, dbCommon *precord);
+
+static void forEachRecord(procTimeIter fn, void *arg)
+{
+    DBENTRY dbentry;
+    long status;
+
+    dbInitEntry(pdbbase, &dbentry);
+    status = dbFirstRecordType(&dbentry);
+    while (!status) {
+        status = dbFirstRecord(&dbentry);
+        while (!status) {
+            dbRecordNode *precnode = dbentry.precnode;
+
+            if (precnode->recordname[0] &&
+                !(precnode->flags & DBRN_FLAGS_ISALIAS))
+                fn(arg, precnode->precord);
+            status = dbNextRecord(&dbentry);
+        }
+        status = dbNextRecordType(&dbentry);
+    }
+    dbFinishEntry(&dbentry);
+}
+
+static void resetRecord(void *arg, dbCommon *precord)
+{
+    dbCommonPvt *ppvt = CONTAINER(precord, dbCommonPvt, common);
+
+    dbScanLock(precord);
+    if (ppvt->ptime)
+        memset(ppvt->ptime, 0, sizeof(dbProcTime));
+    dbScanUnlock(precord);
+}
+
+long dbProcTimeReset(void)
+{
+    if (!pdbbase) {
+        printf("No database loaded\n");
+        return -1;
+    }
+    forEachRecord(resetRecord, NULL);
+    return 0;
+}
+
+long dbProcTimeShow(const char *pname)
+{
+    DBADDR addr;
+    dbProcTime time;
+    int bin;
+
+    if (!pname || !*pname) {
+        printf("Usage: dbProcTimeShow \"record name\"\n");
+        return -1;
+    }
+    if (dbNameToAddr(pname, &addr)) {
+        printf("Record '%s' not found\n", pname);
+        return -1;
+    }
+    dbProcTimeGet(addr.precord, &time);
+
+    printf("%s: processed %lu times", addr.precord->name, time.count);
+    if (!time.count) {
+        printf("%s\n", dbProcTimeStats ? "" : " (dbProcTimeStats is 0)");
+        return 0;
+    }
+    printf(", total %.6f avg %.6f max %.6f seconds\n",
+        time.total, time.total / time.count, time.max);
+
+    for (bin = 0; bin < DB_PROC_TIME_BINS; bin++) {
+        if (!time.hist[bin])
+            continue;
+        if (bin == 0)
+            printf("    %8s - %8u usec %10lu\n", "",
+                1u, time.hist[bin]);
+        else if (bin == DB_PROC_TIME_BINS - 1)
+            printf("    %8u - %8s usec %10lu\n",
+                1u << (bin - 1), "", time.hist[bin]);
+        else
+            printf("    %8u - %8u usec %10lu\n",
+                1u << (bin - 1), 1u << bin, time.hist[bin]);
+    }
+    return 0;
+}
+
+/* Snapshot of the statistics of every record that has been timed */
+
+typedef struct procTimeList {
+    procTimeEntry *pentries;
+    int nEntries;
+    int nAlloc;
+    int byLockSet;
+} procTimeList;
+
+static void collectRecord(void *arg, dbCommon *precord)
+{
+    procTimeList *plist = (procTimeList *)arg;
+    dbProcTime time;
+    procTimeEntry *pentry;
+
+    dbProcTimeGet(precord, &time);
+    if (!time.count)
+        return;
+
+    if (plist->nEntries == plist->nAlloc) {
+        int nAlloc = plist->nAlloc ? 2 * plist->nAlloc : 256;
+        procTimeEntry *pentries = realloc(plist->pentries,
+            nAlloc * sizeof(procTimeEntry));
+
+        if (!pentries)
+            return;
+        plist->pentries = pentries;
+        plist->nAlloc = nAlloc;
+    }
+
+    pentry = &plist->pentries[plist->nEntries++];
+    pentry->precord = precord;
+    pentry->key = plist->byLockSet ? dbLockGetLockId(precord) : precord->scan;
+    pentry->count = time.count;
+    pentry->total = time.total;
+    pentry->max = time.max;
+}
+
+static int compareEntries(const void *pa, const void *pb)
+{
+    const procTimeEntry *a = (const procTimeEntry *)pa;
+    const procTimeEntry *b = (const procTimeEntry *)pb;
+
+    if (a->key != b->key)
+        return a->key < b->key ? -1 : 1;
+    if (a->total != b->total)
+        return a->total > b->total ? -1 : 1;
+    return 0;
+}
+
+static int compareGroups(const void *pa, const void *pb)
+{
+    const procTimeGroup *a = (const procTimeGroup *)pa;
+    const procTimeGroup *b = (const procTimeGroup *)pb;
+
+    if (a->total != b->total)
+        return a->total > b->total ? -1 : 1;
+    return 0;
+}
+
+/* Collect and sort by key, slowest first within each key */
+static int collectList(procTimeList *plist, int byLockSet)
+{
+    memset(plist, 0, sizeof(procTimeList));
+    plist->byLockSet = byLockSet;
+
+    if (!pdbbase) {
+        printf("No database loaded\n");
+        return -1;
+    }
+    forEachRecord(collectRecord, plist);
+    if (!plist->nEntries) {
+        printf("No processing times recorded%s\n",
+            dbProcTimeStats ? "" : " (dbProcTimeStats is 0)");
+        return -1;
+    }
+    qsort(plist->pentries, plist->nEntries, sizeof(procTimeEntry),
+        compareEntries);
+    return 0;
+}
+
+static void printEntries(const procTimeEntry *pentry, int n, int count)
+{
+    int i;
+
+    printf("    %-28s %10s %12s %12s %12s\n",
+        "Record", "Count", "Total", "Average", "Maximum");
+    for (i = 0; i < n && i < count; i++, pentry++) {
+        printf("    %-28s %10lu %12.6f %12.6f %12.6f\n",
+            pentry->precord->name, pentry->count, pentry->total,
+            pentry->total / pentry->count, pentry->max);
+    }
+}
+
+long dbProcTimeScan(double period, int count)
+{
+    dbMenu *pmenu = dbFindMenu(pdbbase, "menuScan");
+    procTimeList list;
+    int i, first;
+
+    if (count <= 0)
+        count = DEFAULT_COUNT;
+    if (!pmenu || collectList(&list, 0))
+        return -1;
+
+    for (first = 0; first < list.nEntries; first = i) {
+        unsigned long scan = list.pentries[first].key;
+
+        for (i = first; i < list.nEntries && list.pentries[i].key == scan;)
+            i++;
+
+        if (period > 0.0 &&
+            (scan < SCAN_1ST_PERIODIC ||
+             fabs(period - scanPeriod(scan)) > 0.05))
+            continue;
+
+        printf("Slowest records with SCAN = '%s':\n",
+            scan < (unsigned long) pmenu->nChoice ?
+            pmenu->papChoiceValue[scan] : "?");
+        printEntries(&list.pentries[first], i - first, count);
+    }
+
+    free(list.pentries);
+    return 0;
+}
+
+long dbProcTimeLockSet(int count)
+{
+    procTimeList list;
+    procTimeGroup *pgroups;
+    int i, first, nGroups = 0;
+
+    if (count <= 0)
+        count = DEFAULT_COUNT;
+    if (collectList(&list, 1))
+        return -1;
+
+    pgroups = calloc(list.nEntries, sizeof(procTimeGroup));
+    if (!pgroups) {
+        free(list.pentries);
+        return -1;
+    }
+    for (first = 0; first < list.nEntries; first = i) {
+        procTimeGroup *pgroup = &pgroups[nGroups++];
+
+        pgroup->pfirst = &list.pentries[first];
+        for (i = first; i < list.nEntries &&
+             list.pentries[i].key == list.pentries[first].key; i++)
+            pgroup->total += list.pentries[i].total;
+        pgroup->nRecords = i - first;
+    }
+    qsort(pgroups, nGroups, sizeof(procTimeGroup), compareGroups);
+
+    for (i = 0; i < nGroups && i < count; i++) {
+        printf("Lock set %lu, %.6f seconds in %d records:\n",
+            pgroups[i].pfirst->key, pgroups[i].total, pgroups[i].nRecords);
+        printEntries(pgroups[i].pfirst, pgroups[i].nRecords, count);
+    }
+
+    free(pgroups);
+    free(list.pentries);
+    return 0;
+}
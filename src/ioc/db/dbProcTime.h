@@ -0,0 +1,54 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* dbProcTime.h */
+/* Record processing time statistics */
+
+#ifndef INCdbProcTimeH
+#define INCdbProcTimeH
+
+#include "epicsTime.h"
+#include "shareLib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct dbCommon;
+
+/* Bin 0 counts times below 1 usec, bin n times from 2^(n-1) up to 2^n
+ * usec.  The last bin also counts anything slower.
+ */
+#define DB_PROC_TIME_BINS 24
+
+typedef struct dbProcTime {
+    unsigned long count;
+    double total;       /* seconds */
+    double max;
+    unsigned long hist[DB_PROC_TIME_BINS];
+} dbProcTime;
+
+/* Non-zero enables timing in dbProcess() */
+epicsShareExtern int dbProcTimeStats;
+
+/* Called by dbProcess() with the record locked */
+epicsShareFunc void dbProcTimeAdd(struct dbCommon *precord,
+    const epicsTimeStamp *pstart);
+
+epicsShareFunc long dbProcTimeGet(struct dbCommon *precord,
+    dbProcTime *ptime);
+epicsShareFunc long dbProcTimeReset(void);
+
+/* iocsh reports */
+epicsShareFunc long dbProcTimeShow(const char *pname);
+epicsShareFunc long dbProcTimeScan(double period, int count);
+epicsShareFunc long dbProcTimeLockSet(int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCdbProcTimeH */
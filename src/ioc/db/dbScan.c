@@ -24,6 +24,7 @@
 #include "cantProceed.h"
 #include "dbDefs.h"
 #include "ellLib.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsPrint.h"
@@ -32,6 +33,7 @@
 #include "epicsStdlib.h"
 #include "epicsString.h"
 #include "epicsThread.h"
+#include "epicsThreadPool.h"
 #include "epicsTime.h"
 #include "taskwd.h"
 
@@ -85,6 +87,24 @@ typedef struct scan_element{
 
 #define OVERRUN_REPORT_DELAY 10.0   /* Time between initial reports */
 #define OVERRUN_REPORT_MAX 3600.0   /* Maximum time between reports */
+
+struct periodic_scan_list;
+
+/* In parallel mode each periodic list is split into partitions, records
+ * in the same lock set always going to the same partition.  The partitions
+ * are scanned one phase (PHAS value) at a time, [first, last) holding the
+ * records of the current phase.
+ */
+typedef struct scan_partition {
+    struct periodic_scan_list *ppsl;
+    epicsJob            *job;
+    struct dbCommon     **precords; /* points into ppsl->precords */
+    epicsInt16          *phas;      /* points into ppsl->phas */
+    int                 nRecords;
+    int                 first;
+    int                 last;
+} scan_partition;
+
 typedef struct periodic_scan_list {
     scan_list           scan_list;
     double              period;
@@ -92,12 +112,29 @@ typedef struct periodic_scan_list {
     unsigned long       overruns;
     volatile enum ctl   scanCtl;
     epicsEventId        loopEvent;
+    /* Statistics, written by the scan thread only */
+    unsigned long       scans;
+    double              lastTime;
+    double              maxTime;
+    double              sumTime;
+    /* Parallel mode only */
+    epicsThreadPool     *pool;      /* at the priority of this list */
+    scan_partition      *partitions;
+    int                 nActive;    /* partitions holding records */
+    int                 nBusy;      /* partitions not yet finished */
+    epicsEventId        partsDone;
+    struct dbCommon     **precords; /* snapshot of scan_list, by partition */
+    epicsInt16          *phas;      /* PHAS of each, at the snapshot */
+    int                 *partOf;
+    int                 nAlloc;
 } periodic_scan_list;
 
 static int nPeriodic = 0;
 static periodic_scan_list **papPeriodic; /* pointer to array of pointers */
 static epicsThreadId *periodicTaskId;    /* array of thread ids */
 
+static int periodicThreads = 0;          /* 0 = one thread per list */
+
 
 static char *priorityName[NUM_CALLBACK_PRIORITIES] = {
     "Low", "Medium", "High"
@@ -145,6 +182,8 @@ static void ioscanCallback(CALLBACK *pcallback);
 static void ioscanDestroy(void);
 static void printList(scan_list *psl, char *message);
 static void scanList(scan_list *psl);
+static void scanListParallel(periodic_scan_list *ppsl);
+static void periodicJob(void *arg, epicsJobMode mode);
 static void buildScanLists(void);
 static void addToList(struct dbCommon *precord, scan_list *psl);
 static void deleteFromList(struct dbCommon *precord, scan_list *psl);
@@ -382,10 +421,53 @@ double scanPeriod(int scan) {
     return ppsl ? ppsl->period : 0.0;
 }
 
+int scanPeriodicParallel(int count)
+{
+    if (papPeriodic) {
+        fprintf(stderr, "scanPeriodicParallel: dbScan already initialized\n");
+        return -1;
+    }
+
+    if (count < 0) {
+        count = epicsThreadGetCPUs() + count;
+        if (count < 1) count = 1;
+    }
+    periodicThreads = count;
+    return 0;
+}
+
+int scanPeriodicStatus(int scan, int reset, scanPeriodicStats *pstats)
+{
+    periodic_scan_list *ppsl;
+
+    scan -= SCAN_1ST_PERIODIC;
+    if (!papPeriodic || scan < 0 || scan >= nPeriodic)
+        return -1;
+    ppsl = papPeriodic[scan];
+    if (!ppsl)
+        return -1;
+
+    if (pstats) {
+        pstats->period = ppsl->period;
+        pstats->scans = ppsl->scans;
+        pstats->overruns = ppsl->overruns;
+        pstats->lastTime = ppsl->lastTime;
+        pstats->maxTime = ppsl->maxTime;
+        pstats->avgTime = ppsl->scans ? ppsl->sumTime / ppsl->scans : 0.0;
+        pstats->partitions = ppsl->nActive;
+    }
+    if (reset) {
+        ppsl->scans = 0;
+        ppsl->overruns = 0;
+        ppsl->lastTime = ppsl->maxTime = ppsl->sumTime = 0.0;
+    }
+    return 0;
+}
+
 int scanppl(double period)      /* print periodic scan list(s) */
 {
     dbMenu *pmenu = dbFindMenu(pdbbase, "menuScan");
-    char message[80];
+    char message[200];
     int i;
 
     if (!pmenu || !papPeriodic) {
@@ -407,8 +489,21 @@ int scanppl(double period)      /* print periodic scan list(s) */
             (fabs(period - ppsl->period) > 0.05))
             continue;
 
-        sprintf(message, "Records with SCAN = '%s' (%lu over-runs):",
-            ppsl->name, ppsl->overruns);
+        if (ppsl->partitions)
+            epicsSnprintf(message, sizeof(message),
+                "Records with SCAN = '%s' (%lu over-runs in %lu scans, "
+                "%d partitions,\n  scan time last %.6f avg %.6f max %.6f):",
+                ppsl->name, ppsl->overruns, ppsl->scans, ppsl->nActive,
+                ppsl->lastTime,
+                ppsl->scans ? ppsl->sumTime / ppsl->scans : 0.0,
+                ppsl->maxTime);
+        else
+            epicsSnprintf(message, sizeof(message),
+                "Records with SCAN = '%s' (%lu over-runs in %lu scans,\n"
+                "  scan time last %.6f avg %.6f max %.6f):",
+                ppsl->name, ppsl->overruns, ppsl->scans, ppsl->lastTime,
+                ppsl->scans ? ppsl->sumTime / ppsl->scans : 0.0,
+                ppsl->maxTime);
         printList(&ppsl->scan_list, message);
     }
     return 0;
@@ -750,8 +845,24 @@ static void periodicTask(void *arg)
         double delay;
         epicsTimeStamp now;
 
-        if (ppsl->scanCtl == ctlRun)
-            scanList(&ppsl->scan_list);
+        if (ppsl->scanCtl == ctlRun) {
+            epicsTimeStamp start;
+            double elapsed;
+
+            epicsTimeGetCurrent(&start);
+            if (ppsl->partitions)
+                scanListParallel(ppsl);
+            else
+                scanList(&ppsl->scan_list);
+            epicsTimeGetCurrent(&now);
+
+            elapsed = epicsTimeDiffInSeconds(&now, &start);
+            ppsl->scans++;
+            ppsl->lastTime = elapsed;
+            ppsl->sumTime += elapsed;
+            if (elapsed > ppsl->maxTime)
+                ppsl->maxTime = elapsed;
+        }
 
         epicsTimeAddSeconds(&next, ppsl->period);
         epicsTimeGetCurrent(&now);
@@ -776,9 +887,12 @@ static void periodicTask(void *arg)
                 errlogPrintf("\ndbScan warning from '%s' scan thread:\n"
                     "\tScan processing averages %.3f seconds (%.3f .. %.3f).\n"
                     "\tOver-runs have now happened %u times in a row.\n"
-                    "\tTo fix this, move some records to a slower scan rate.\n",
+                    "\tTo fix this, move some records to a slower scan rate.\n"
+                    "\tdbProcTimeScan(%g) shows the slowest records in this list\n"
+                    "\twhile dbProcTimeStats is set.\n",
                     ppsl->name, ppsl->period + overtime / overruns,
-                    ppsl->period + over_min, ppsl->period + over_max, overruns);
+                    ppsl->period + over_min, ppsl->period + over_max, overruns,
+                    ppsl->period);
 
                 reported = now;
                 if (report_delay < (OVERRUN_REPORT_MAX / 2))
@@ -814,6 +928,7 @@ static void initPeriodic(void)
     nPeriodic = pmenu->nChoice - SCAN_1ST_PERIODIC;
     papPeriodic = dbCalloc(nPeriodic, sizeof(periodic_scan_list*));
     periodicTaskId = dbCalloc(nPeriodic, sizeof(void *));
+
     for (i = 0; i < nPeriodic; i++) {
         periodic_scan_list *ppsl = dbCalloc(1, sizeof(periodic_scan_list));
         const char *choice = pmenu->papChoiceValue[i + SCAN_1ST_PERIODIC];
@@ -855,6 +970,40 @@ static void initPeriodic(void)
         ppsl->scanCtl = ctlPause;
         ppsl->loopEvent = epicsEventMustCreate(epicsEventEmpty);
 
+        if (periodicThreads > 0) {
+            /* Each list gets its own pool, so its records are processed
+             * at the same priority as on its own scan thread.  Workers
+             * are only started once the list has records to share out.
+             */
+            epicsThreadPoolConfig opts;
+
+            epicsThreadPoolConfigDefaults(&opts);
+            opts.initialThreads = 0;
+            opts.maxThreads = periodicThreads;
+            opts.workerStack = epicsThreadGetStackSize(epicsThreadStackBig);
+            opts.workerPriority = epicsThreadPriorityScanLow + i;
+            ppsl->pool = epicsThreadPoolCreate(&opts);
+            if (!ppsl->pool)
+                errlogPrintf("initPeriodic: Can't create thread pool, "
+                    "SCAN = '%s' will not run in parallel\n", choice);
+        }
+        if (ppsl->pool) {
+            int j;
+
+            ppsl->partitions = dbCalloc(periodicThreads,
+                sizeof(scan_partition));
+            for (j = 0; j < periodicThreads; j++) {
+                scan_partition *ppart = &ppsl->partitions[j];
+
+                ppart->ppsl = ppsl;
+                ppart->job = epicsJobCreate(ppsl->pool, periodicJob, ppart);
+                if (!ppart->job)
+                    cantProceed("initPeriodic: epicsJobCreate failed\n");
+            }
+            ppsl->partsDone = epicsEventMustCreate(epicsEventEmpty);
+            ppsl->scan_list.modified = TRUE;
+        }
+
         number = ppsl->period / quantum;
         if ((ppsl->period < 2 * quantum) ||
             (number / floor(number) > 1.1)) {
@@ -874,6 +1023,19 @@ static void deletePeriodic(void)
         periodic_scan_list *ppsl = papPeriodic[i];
 
         if (!ppsl) continue;
+        if (ppsl->partitions) {
+            int j;
+
+            for (j = 0; j < periodicThreads; j++)
+                epicsJobDestroy(ppsl->partitions[j].job);
+            free(ppsl->partitions);
+            free(ppsl->precords);
+            free(ppsl->phas);
+            free(ppsl->partOf);
+            epicsEventDestroy(ppsl->partsDone);
+        }
+        if (ppsl->pool)
+            epicsThreadPoolDestroy(ppsl->pool);
         ellFree(&ppsl->scan_list.list);
         epicsEventDestroy(ppsl->loopEvent);
         epicsMutexDestroy(ppsl->scan_list.lock);
@@ -994,6 +1156,176 @@ static void scanList(scan_list *psl)
     }
 }
 
+/* Rebuild the partitions after the list has been changed.
+ * Records keep their scan list order within a partition.
+ */
+static void partitionList(periodic_scan_list *ppsl)
+{
+    scan_list *psl = &ppsl->scan_list;
+    scan_element *pse;
+    int nRecords, i, n;
+
+    epicsMutexMustLock(psl->lock);
+    if (!psl->modified) {
+        epicsMutexUnlock(psl->lock);
+        return;
+    }
+
+    nRecords = ellCount(&psl->list);
+    if (nRecords > ppsl->nAlloc) {
+        free(ppsl->precords);
+        free(ppsl->phas);
+        free(ppsl->partOf);
+        ppsl->precords = dbCalloc(nRecords, sizeof(struct dbCommon *));
+        ppsl->phas = dbCalloc(nRecords, sizeof(epicsInt16));
+        ppsl->partOf = dbCalloc(nRecords, sizeof(int));
+        ppsl->nAlloc = nRecords;
+    }
+
+    for (i = 0; i < periodicThreads; i++)
+        ppsl->partitions[i].nRecords = 0;
+    for (pse = (scan_element *)ellFirst(&psl->list), i = 0; pse;
+         pse = (scan_element *)ellNext(&pse->node), i++) {
+        int part = dbLockGetLockId(pse->precord) % periodicThreads;
+
+        ppsl->partOf[i] = part;
+        ppsl->partitions[part].nRecords++;
+    }
+
+    ppsl->nActive = 0;
+    for (i = 0, n = 0; i < periodicThreads; i++) {
+        scan_partition *ppart = &ppsl->partitions[i];
+
+        ppart->precords = ppsl->precords + n;
+        ppart->phas = ppsl->phas + n;
+        n += ppart->nRecords;
+        if (ppart->nRecords)
+            ppsl->nActive++;
+        ppart->nRecords = 0;
+    }
+    for (pse = (scan_element *)ellFirst(&psl->list), i = 0; pse;
+         pse = (scan_element *)ellNext(&pse->node), i++) {
+        scan_partition *ppart = &ppsl->partitions[ppsl->partOf[i]];
+
+        ppart->phas[ppart->nRecords] = pse->precord->phas;
+        ppart->precords[ppart->nRecords++] = pse->precord;
+    }
+
+    psl->modified = FALSE;
+    epicsMutexUnlock(psl->lock);
+}
+
+static void scanPartition(scan_partition *ppart)
+{
+    scan_list *psl = &ppart->ppsl->scan_list;
+    int i;
+
+    for (i = ppart->first; i < ppart->last; i++) {
+        struct dbCommon *precord = ppart->precords[i];
+        scan_element *pse;
+
+        dbScanLock(precord);
+        /* SCAN changes happen with the record locked, so a record
+         * that has left this list since partitioning is skipped here.
+         */
+        pse = precord->spvt;
+        if (pse && pse->pscan_list == psl)
+            dbProcess(precord);
+        dbScanUnlock(precord);
+    }
+}
+
+static void periodicJob(void *arg, epicsJobMode mode)
+{
+    scan_partition *ppart = (scan_partition *)arg;
+    periodic_scan_list *ppsl = ppart->ppsl;
+
+    if (mode == epicsJobModeCleanup)
+        return;
+
+    scanPartition(ppart);
+    if (epicsAtomicDecrIntT(&ppsl->nBusy) == 0)
+        epicsEventMustTrigger(ppsl->partsDone);
+}
+
+/* Queue all but one partition holding records of the current phase on
+ * the pool and process that one on the scan thread.  Returns when every
+ * partition has finished the phase.
+ */
+static void scanPhaseParallel(periodic_scan_list *ppsl, int nBusy)
+{
+    scan_partition *pmine = NULL;
+    int i;
+
+    epicsAtomicSetIntT(&ppsl->nBusy, nBusy);
+    for (i = 0; i < periodicThreads; i++) {
+        scan_partition *ppart = &ppsl->partitions[i];
+
+        if (ppart->first == ppart->last)
+            continue;
+        if (!pmine) {
+            pmine = ppart;
+        }
+        else if (epicsJobQueue(ppart->job)) {
+            /* Pool not accepting jobs, do it here */
+            scanPartition(ppart);
+            epicsAtomicDecrIntT(&ppsl->nBusy);
+        }
+    }
+
+    scanPartition(pmine);
+    if (epicsAtomicDecrIntT(&ppsl->nBusy) != 0)
+        epicsEventMustWait(ppsl->partsDone);
+}
+
+/* Scan the partitions in parallel one phase at a time, lowest PHAS first,
+ * so every record of a phase has been processed before the next phase
+ * starts, whichever partition it is in.  Returns when the whole list has
+ * been processed, so the next period never starts before this one has
+ * finished.
+ */
+static void scanListParallel(periodic_scan_list *ppsl)
+{
+    int i;
+
+    partitionList(ppsl);
+    if (!ppsl->nActive)
+        return;
+
+    for (i = 0; i < periodicThreads; i++)
+        ppsl->partitions[i].first = ppsl->partitions[i].last = 0;
+
+    for (;;) {
+        epicsInt16 phase = 0;
+        int found = FALSE;
+        int nBusy = 0;
+
+        for (i = 0; i < periodicThreads; i++) {
+            scan_partition *ppart = &ppsl->partitions[i];
+
+            if (ppart->last < ppart->nRecords &&
+                (!found || ppart->phas[ppart->last] < phase)) {
+                phase = ppart->phas[ppart->last];
+                found = TRUE;
+            }
+        }
+        if (!found)
+            break;
+
+        for (i = 0; i < periodicThreads; i++) {
+            scan_partition *ppart = &ppsl->partitions[i];
+
+            ppart->first = ppart->last;
+            while (ppart->last < ppart->nRecords &&
+                   ppart->phas[ppart->last] == phase)
+                ppart->last++;
+            if (ppart->last > ppart->first)
+                nBusy++;
+        }
+        scanPhaseParallel(ppsl, nBusy);
+    }
+}
+
 static void buildScanLists(void)
 {
     dbRecordType *pdbRecordType;
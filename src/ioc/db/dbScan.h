@@ -43,6 +43,16 @@ struct dbCommon;
 typedef void (*io_scan_complete)(void *usr, IOSCANPVT, int prio);
 typedef void (*once_complete)(void *usr, struct dbCommon*);
 
+typedef struct scanPeriodicStats {
+    double period;
+    unsigned long scans;
+    unsigned long overruns;
+    double lastTime;    /* seconds taken by the latest scan */
+    double avgTime;
+    double maxTime;
+    int partitions;     /* partitions holding records, parallel mode only */
+} scanPeriodicStats;
+
 epicsShareFunc long scanInit(void);
 epicsShareFunc void scanRun(void);
 epicsShareFunc void scanPause(void);
@@ -58,6 +68,9 @@ epicsShareFunc double scanPeriod(int scan);
 epicsShareFunc int scanOnce(struct dbCommon *);
 epicsShareFunc int scanOnceCallback(struct dbCommon *, once_complete cb, void *usr);
 epicsShareFunc int scanOnceSetQueueSize(int size);
+epicsShareFunc int scanPeriodicParallel(int count);
+epicsShareFunc int scanPeriodicStatus(int scan, int reset,
+    scanPeriodicStats *pstats);
 
 /*print periodic lists*/
 epicsShareFunc int scanppl(double rate);
@@ -112,10 +112,11 @@ void dbSubscriptionIO::operator delete ( void * pCadaver,
 #endif
 
 extern "C" void dbSubscriptionEventCallback ( void *pPrivate, struct dbChannel * /* dbch */,
-	int /* eventsRemaining */, struct db_field_log *pfl )
+	int eventsRemaining, struct db_field_log *pfl )
 {
     dbSubscriptionIO * pIO = static_cast < dbSubscriptionIO * > ( pPrivate );
     pIO->chan.callStateNotify ( pIO->type, pIO->count, pfl, pIO->notify );
+    pIO->chan.stateNotifyFlush ( eventsRemaining != 0 );
 }
 
 void dbSubscriptionIO::show ( unsigned level ) const
@@ -0,0 +1,166 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Compares posting monitors with db_post_events() one record at a time
+ * against batched posting, with many clients subscribed to every record.
+ */
+
+#include <stdio.h>
+
+#include "xRecord.h"
+#include "cantProceed.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "epicsAtomic.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define NCLIENTS 100
+#define NRECORDS 20
+#define NROUNDS 500
+
+static size_t delivered;
+
+static void eventCallback(void *user_arg, struct dbChannel *chan,
+    int eventsRemaining, struct db_field_log *pfl)
+{
+    epicsAtomicIncrSizeT(&delivered);
+}
+
+/* Waits until the event tasks have gone quiet */
+static void drain(void)
+{
+    size_t last;
+
+    do {
+        last = epicsAtomicGetSizeT(&delivered);
+        epicsThreadSleep(0.05);
+    } while (epicsAtomicGetSizeT(&delivered) != last);
+}
+
+static void runBench(dbCommon **precs, int batched)
+{
+    dbLocker *locker = dbLockerAlloc(precs, NRECORDS, 0);
+    dbEventBatch *pbatch = db_event_batch_create();
+    epicsTimeStamp start, posted, done;
+    double tpost, tall;
+    int i, j;
+
+    if (!locker || !pbatch)
+        testAbort("Out of memory");
+
+    drain();
+    epicsAtomicSetSizeT(&delivered, 0);
+    epicsTimeGetCurrent(&start);
+
+    for (i = 0; i < NROUNDS; i++) {
+        dbScanLockMany(locker);
+        if (batched)
+            db_post_events_begin(pbatch);
+        for (j = 0; j < NRECORDS; j++) {
+            xRecord *prec = (xRecord *)precs[j];
+
+            prec->val = i;
+            if (batched)
+                db_post_events_batch(pbatch, prec, &prec->val, DBE_VALUE);
+            else
+                db_post_events(prec, &prec->val, DBE_VALUE);
+        }
+        if (batched)
+            db_post_events_commit(pbatch);
+        dbScanUnlockMany(locker);
+    }
+
+    epicsTimeGetCurrent(&posted);
+    drain();
+    epicsTimeGetCurrent(&done);
+
+    tpost = epicsTimeDiffInSeconds(&posted, &start);
+    tall = epicsTimeDiffInSeconds(&done, &start) - 0.05;
+    testDiag("%s: %d postings to %d clients in %.3f sec, %.0f postings/sec",
+        batched ? "batched" : "single ", NROUNDS * NRECORDS, NCLIENTS,
+        tpost, NROUNDS * NRECORDS / tpost);
+    testDiag("         %lu events delivered, %.0f events/sec",
+        (unsigned long)epicsAtomicGetSizeT(&delivered),
+        epicsAtomicGetSizeT(&delivered) / tall);
+
+    db_event_batch_destroy(pbatch);
+    dbLockerFree(locker);
+}
+
+MAIN(benchdbEvent)
+{
+    dbEventCtx ctx[NCLIENTS];
+    dbChannel *chans[NCLIENTS][NRECORDS];
+    dbEventSubscription subs[NCLIENTS][NRECORDS];
+    dbCommon *precs[NRECORDS];
+    char buf[40];
+    int i, j;
+
+    testPlan(0);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    for (j = 0; j < NRECORDS; j++) {
+        sprintf(buf, "N=%d", j);
+        testdbReadDatabase("benchdbEvent.db", NULL, buf);
+    }
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    for (j = 0; j < NRECORDS; j++) {
+        sprintf(buf, "bench%d", j);
+        precs[j] = testdbRecordPtr(buf);
+    }
+
+    for (i = 0; i < NCLIENTS; i++) {
+        ctx[i] = db_init_events();
+        for (j = 0; j < NRECORDS; j++) {
+            sprintf(buf, "bench%d.VAL", j);
+            chans[i][j] = dbChannelCreate(buf);
+            if (!chans[i][j] || dbChannelOpen(chans[i][j]))
+                testAbort("Can't open channel %s", buf);
+            subs[i][j] = db_add_event(ctx[i], chans[i][j], eventCallback,
+                NULL, DBE_VALUE);
+            db_event_enable(subs[i][j]);
+        }
+        db_start_events(ctx[i], "benchdbEvent", NULL, NULL,
+            epicsThreadPriorityMedium);
+    }
+
+    runBench(precs, 0);
+    runBench(precs, 1);
+    runBench(precs, 0);
+    runBench(precs, 1);
+
+    for (i = 0; i < NCLIENTS; i++) {
+        for (j = 0; j < NRECORDS; j++) {
+            db_cancel_event(subs[i][j]);
+            dbChannelDelete(chans[i][j]);
+        }
+        db_close_events(ctx[i]);
+    }
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
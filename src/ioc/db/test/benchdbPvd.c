@@ -0,0 +1,121 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Times adding names to the process variable directory, then looking
+ * up names that are present and names that are not, as dbNameToAddr()
+ * does for every CA search and channel create.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cantProceed.h"
+#include "dbAccess.h"
+#include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+#include "dbUnitTest.h"
+#include "epicsStdio.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NAME_SIZE 40
+#define NLOOKUPS 1000000
+
+static void makeName(char *name, unsigned i, const char *suffix)
+{
+    /* Names share long prefixes, like those of a real facility */
+    epicsSnprintf(name, NAME_SIZE, "SR%02u:C%03u:BPM%03u:%s%s",
+        i % 40, (i / 40) % 1000, i / 40000, "PosX", suffix);
+}
+
+static void runBench(unsigned nNames)
+{
+    dbRecordNode *nodes = callocMustSucceed(nNames, sizeof(dbRecordNode),
+        "runBench");
+    char *names = callocMustSucceed(nNames, NAME_SIZE, "runBench");
+    char *misses = callocMustSucceed(nNames, NAME_SIZE, "runBench");
+    unsigned *order = callocMustSucceed(NLOOKUPS, sizeof(unsigned),
+        "runBench");
+    epicsTimeStamp t0, t1, t2, t3, t4;
+    unsigned i, found = 0, missed = 0;
+
+    for (i = 0; i < nNames; i++) {
+        char *name = names + i * NAME_SIZE;
+
+        makeName(name, i, "");
+        makeName(misses + i * NAME_SIZE, i, "_");
+        nodes[i].recordname = name;
+    }
+    srand(1);
+    for (i = 0; i < NLOOKUPS; i++)
+        order[i] = rand() % nNames;
+
+    epicsTimeGetCurrent(&t0);
+    for (i = 0; i < nNames; i++)
+        dbPvdAdd(pdbbase, NULL, &nodes[i]);
+    epicsTimeGetCurrent(&t1);
+
+    for (i = 0; i < NLOOKUPS; i++) {
+        const char *name = names + order[i] * NAME_SIZE;
+
+        if (dbPvdFind(pdbbase, name, strlen(name)))
+            found++;
+    }
+    epicsTimeGetCurrent(&t2);
+
+    for (i = 0; i < NLOOKUPS; i++) {
+        const char *name = misses + order[i] * NAME_SIZE;
+
+        if (!dbPvdFind(pdbbase, name, strlen(name)))
+            missed++;
+    }
+    epicsTimeGetCurrent(&t3);
+
+    for (i = 0; i < nNames; i++)
+        dbPvdDelete(pdbbase, &nodes[i]);
+    epicsTimeGetCurrent(&t4);
+
+    testDiag("%u names, nsec per operation:", nNames);
+    testDiag("    add %7.1f  find %7.1f  miss %7.1f  delete %7.1f",
+        epicsTimeDiffInSeconds(&t1, &t0) * 1e9 / nNames,
+        epicsTimeDiffInSeconds(&t2, &t1) * 1e9 / NLOOKUPS,
+        epicsTimeDiffInSeconds(&t3, &t2) * 1e9 / NLOOKUPS,
+        epicsTimeDiffInSeconds(&t4, &t3) * 1e9 / nNames);
+    if (found != NLOOKUPS || missed != NLOOKUPS)
+        testDiag("    %u of %u names found, %u of %u misses not found!",
+            found, NLOOKUPS, missed, NLOOKUPS);
+
+    free(order);
+    free(misses);
+    free(names);
+    free(nodes);
+}
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+MAIN(benchdbPvd)
+{
+    testPlan(0);
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testIocInitOk();
+
+    runBench(1000);
+    runBench(10000);
+    runBench(100000);
+    runBench(500000);
+    runBench(1000000);
+
+    dbPvdDump(pdbbase, 0);
+    testIocShutdownOk();
+    testdbCleanup();
+    return testDone();
+}
@@ -0,0 +1,145 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Runs the same load through each callback queue type: several producer
+ * threads request every callback once, and each callback must be executed
+ * exactly once by the parallel callback threads.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "callback.h"
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NPRODUCERS 4
+#define NCALLBACKS 1500
+
+typedef struct myPvt {
+    CALLBACK cb;
+    int count;
+} myPvt;
+
+static myPvt *pvts;
+static int executed;
+static epicsEventId finished;
+
+epicsShareExtern int callbackLatencyStats;
+
+static void myCallback(CALLBACK *pCallback)
+{
+    myPvt *pmyPvt;
+
+    callbackGetUser(pmyPvt, pCallback);
+    epicsAtomicIncrIntT(&pmyPvt->count);
+    if (epicsAtomicIncrIntT(&executed) == NCALLBACKS)
+        epicsEventSignal(finished);
+}
+
+static void producer(void *arg)
+{
+    int first = *(int *)arg;
+    int i;
+
+    for (i = first; i < NCALLBACKS; i += NPRODUCERS) {
+        while (callbackRequest(&pvts[i].cb) != 0)
+            epicsThreadSleep(0.01);
+    }
+}
+
+static void testQueueType(const char *type)
+{
+    static int first[NPRODUCERS];
+    callbackQueueStats stats;
+    int i, faults = 0;
+
+    testDiag("Queue type \"%s\"", type);
+
+    testOk1(callbackSetQueueType(type, "") == 0);
+    callbackParallelThreads(NPRODUCERS, "");
+    callbackInit();
+
+    executed = 0;
+    for (i = 0; i < NCALLBACKS; i++) {
+        callbackSetCallback(myCallback, &pvts[i].cb);
+        callbackSetPriority(i % NUM_CALLBACK_PRIORITIES, &pvts[i].cb);
+        callbackSetUser(&pvts[i], &pvts[i].cb);
+        pvts[i].count = 0;
+    }
+
+    for (i = 0; i < NPRODUCERS; i++) {
+        first[i] = i;
+        epicsThreadMustCreate("producer", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackSmall),
+            producer, &first[i]);
+    }
+    testOk(epicsEventWaitWithTimeout(finished, 10.0) == epicsEventOK,
+        "All callbacks executed (%d)", epicsAtomicGetIntT(&executed));
+
+    for (i = 0; i < NCALLBACKS; i++) {
+        if (pvts[i].count != 1) {
+            if (faults++ < 10)
+                testDiag("callback %d executed %d times", i, pvts[i].count);
+        }
+    }
+    testOk(faults == 0, "%d callbacks not executed exactly once", faults);
+
+    testOk1(callbackQueueStatus(0, &stats) == 0);
+    testOk(strcmp(stats.type[priorityLow], type) == 0,
+        "Queue type reported as \"%s\"", stats.type[priorityLow]);
+    testOk(stats.threads[priorityHigh] == NPRODUCERS,
+        "%d threads running", stats.threads[priorityHigh]);
+    testOk(stats.numUsed[priorityMedium] == 0,
+        "Queue empty (%d used)", stats.numUsed[priorityMedium]);
+    testOk(stats.maxUsed[priorityMedium] > 0 &&
+        stats.maxUsed[priorityMedium] <= stats.size[priorityMedium],
+        "High-water mark %d of %d", stats.maxUsed[priorityMedium],
+        stats.size[priorityMedium]);
+    callbackQueueShow(0);
+
+    testOk1(callbackQueueStatus(1, NULL) == 0);
+    testOk1(callbackQueueStatus(0, &stats) == 0);
+    testOk(stats.maxUsed[priorityMedium] == 0 &&
+        stats.numOverflow[priorityMedium] == 0, "Statistics reset");
+
+    callbackStop();
+    callbackCleanup();
+}
+
+MAIN(callbackQueueTest)
+{
+    testPlan(1 + 3*11 + 1);
+
+    pvts = callocMustSucceed(NCALLBACKS, sizeof(myPvt), "pvts");
+    finished = epicsEventMustCreate(epicsEventEmpty);
+
+    testOk(callbackSetQueueType("bogus", "") != 0,
+        "Unknown queue type rejected");
+
+    callbackLatencyStats = 1;
+    testQueueType("locked");
+    testQueueType("lockfree");
+    testQueueType("stealing");
+    callbackLatencyStats = 0;
+
+    testOk(callbackQueueStatus(0, NULL) == -1,
+        "No status after cleanup");
+
+    epicsEventDestroy(finished);
+    free(pvts);
+
+    return testDone();
+}
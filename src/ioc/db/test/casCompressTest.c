@@ -0,0 +1,281 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Read and monitor responses of large arrays, compressed for a client
+ * that announced CA_PROTO_VERSION_COMPRESS.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "caProto.h"
+#include "caCompress.h"
+#include "caerr.h"
+#include "caeventmask.h"
+#include "db_access.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsEndian.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "osiSock.h"
+#include "testMain.h"
+
+#include "arrRecord.h"
+#include "casTestClient.h"
+
+#define NELEM 20000
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+/* A response as the server would have sent it uncompressed */
+typedef struct expanded {
+    unsigned encoding;
+    unsigned cmmd;
+    unsigned dataType;
+    unsigned count;
+    unsigned cid;
+    unsigned available;
+    char *pValue;
+} expanded;
+
+static double netDouble(const char *p)
+{
+    union { epicsFloat64 f; char c[8]; } u;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        u.c[i] = EPICS_BYTE_ORDER == EPICS_ENDIAN_BIG ? p[i] : p[7 - i];
+    return u.f;
+}
+
+static epicsUInt32 netLong(const char *p)
+{
+    const epicsUInt8 *pb = (const epicsUInt8 *) p;
+
+    return ((epicsUInt32) pb[0] << 24) | ((epicsUInt32) pb[1] << 16) |
+        ((epicsUInt32) pb[2] << 8) | pb[3];
+}
+
+/* Expands a CA_PROTO_COMPRESSED message, returns -1 if it is corrupt */
+static int expand(const casTestMsg *pmsg, expanded *pexp)
+{
+    const char *pPayload = pmsg->pPayload;
+    unsigned hdrSize = sizeof(caHdr);
+    unsigned postsize, prefixSize;
+    caHdr hdr;
+
+    if (pmsg->size < hdrSize)
+        return -1;
+    memcpy(&hdr, pPayload, sizeof(hdr));
+    pexp->encoding = pmsg->dataType;
+    pexp->cmmd = ntohs(hdr.m_cmmd);
+    pexp->dataType = ntohs(hdr.m_dataType);
+    pexp->cid = ntohl(hdr.m_cid);
+    pexp->available = ntohl(hdr.m_available);
+    postsize = ntohs(hdr.m_postsize);
+    pexp->count = ntohs(hdr.m_count);
+    if (postsize == 0xffff) {
+        ca_uint32_t ext[2];
+
+        hdrSize += sizeof(ext);
+        if (pmsg->size < hdrSize)
+            return -1;
+        memcpy(ext, pPayload + sizeof(caHdr), sizeof(ext));
+        postsize = ntohl(ext[0]);
+        pexp->count = ntohl(ext[1]);
+    }
+    if (pexp->dataType > LAST_BUFFER_TYPE)
+        return -1;
+    prefixSize = dbr_value_offset[pexp->dataType];
+    if (pmsg->size < hdrSize + prefixSize + pmsg->cid ||
+        postsize < prefixSize)
+        return -1;
+
+    pexp->pValue = malloc(postsize);
+    if (!pexp->pValue)
+        return -1;
+    memcpy(pexp->pValue, pPayload + hdrSize, prefixSize);
+    if (caExpandArray(pexp->encoding, pexp->dataType,
+            pPayload + hdrSize + prefixSize, pmsg->cid,
+            pexp->pValue + prefixSize, postsize - prefixSize) < 0) {
+        free(pexp->pValue);
+        return -1;
+    }
+    pexp->pValue += prefixSize;
+    return 0;
+}
+
+static void fillArrays(void)
+{
+    arrRecord *pramp = (arrRecord *) testdbRecordPtr("ramp");
+    arrRecord *pflat = (arrRecord *) testdbRecordPtr("flat");
+    epicsInt32 *pLong = (epicsInt32 *) pramp->bptr;
+    epicsFloat64 *pDouble = (epicsFloat64 *) pflat->bptr;
+    int i;
+
+    for (i = 0; i < NELEM; i++) {
+        pLong[i] = i;
+        pDouble[i] = 1.5;
+    }
+    pramp->nord = NELEM;
+    pflat->nord = NELEM;
+}
+
+static int rampOk(const char *pValue)
+{
+    unsigned i;
+
+    for (i = 0; i < NELEM; i++) {
+        if (netLong(pValue + 4 * i) != i)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static int flatOk(const char *pValue)
+{
+    unsigned i;
+
+    for (i = 0; i < NELEM; i++) {
+        if (netDouble(pValue + 8 * i) != 1.5)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/* A request count of zero asks for all elements */
+static void testRead(SOCKET sock, int sid, unsigned dataType,
+    unsigned reqCount, unsigned encoding, unsigned ioid,
+    int (*check)(const char *))
+{
+    casTestMsg msg;
+    expanded exp;
+
+    memset(&msg, 0, sizeof(msg));
+    casTestSend(sock, CA_PROTO_READ_NOTIFY, dataType, reqCount,
+        (unsigned) sid, ioid, NULL, 0);
+    if (casTestRecv(sock, &msg, 5.0)) {
+        testFail("No reply to READ_NOTIFY %s",
+            dbr_type_to_text(dataType));
+    }
+    else if (msg.cmmd != CA_PROTO_COMPRESSED) {
+        testFail("READ_NOTIFY %s reply not compressed, command %u",
+            dbr_type_to_text(dataType), msg.cmmd);
+    }
+    else if (expand(&msg, &exp)) {
+        testFail("READ_NOTIFY %s reply is corrupt",
+            dbr_type_to_text(dataType));
+    }
+    else {
+        testOk(exp.encoding == encoding &&
+            exp.cmmd == CA_PROTO_READ_NOTIFY && exp.dataType == dataType &&
+            exp.count == NELEM && exp.cid == ECA_NORMAL &&
+            exp.available == ioid && check(exp.pValue),
+            "READ_NOTIFY %s count %u reply compressed %u to %u bytes",
+            dbr_type_to_text(dataType), reqCount,
+            dbr_size_n(dataType, NELEM), msg.size);
+        free(exp.pValue - dbr_value_offset[dataType]);
+    }
+    casTestMsgFree(&msg);
+}
+
+static void testMonitorUpdate(SOCKET sock, int sid)
+{
+    struct mon_info mi;
+    casTestMsg msg;
+    expanded exp;
+
+    memset(&mi, 0, sizeof(mi));
+    mi.m_mask = htons(DBE_VALUE);
+    memset(&msg, 0, sizeof(msg));
+    casTestSend(sock, CA_PROTO_EVENT_ADD, DBR_TIME_DOUBLE, NELEM,
+        (unsigned) sid, 77, &mi, sizeof(mi));
+    if (casTestRecv(sock, &msg, 5.0) || msg.cmmd != CA_PROTO_COMPRESSED ||
+        expand(&msg, &exp)) {
+        testFail("Monitor update not compressed");
+    }
+    else {
+        testOk(exp.encoding == CA_COMPRESS_LZ4 &&
+            exp.cmmd == CA_PROTO_EVENT_ADD &&
+            exp.dataType == DBR_TIME_DOUBLE && exp.available == 77 &&
+            flatOk(exp.pValue),
+            "Monitor update compressed %u to %u bytes",
+            dbr_size_n(DBR_TIME_DOUBLE, NELEM), msg.size);
+        free(exp.pValue - dbr_value_offset[DBR_TIME_DOUBLE]);
+    }
+    casTestMsgFree(&msg);
+}
+
+static void testPlainClient(unsigned short port)
+{
+    SOCKET sock = casTestConnect(port, 0);
+    unsigned type, count;
+    casTestMsg msg;
+    int sid;
+
+    memset(&msg, 0, sizeof(msg));
+    sid = casTestCreateChan(sock, "ramp", 2, &type, &count);
+    casTestSend(sock, CA_PROTO_READ_NOTIFY, DBR_LONG, NELEM,
+        (unsigned) sid, 3, NULL, 0);
+    testOk(casTestRecv(sock, &msg, 5.0) == 0 &&
+        msg.cmmd == CA_PROTO_READ_NOTIFY && msg.available == 3 &&
+        rampOk(msg.pPayload),
+        "Client that didn't ask gets the reply uncompressed");
+    casTestMsgFree(&msg);
+    epicsSocketDestroy(sock);
+}
+
+MAIN(casCompressTest)
+{
+    unsigned short port;
+    unsigned type, count;
+    casTestMsg msg;
+    SOCKET sock;
+    int rampSid, flatSid;
+
+    testPlan(7);
+
+    port = casTestPrepare();
+    epicsEnvSet("EPICS_CAS_COMPRESS_THRESHOLD", "1024");
+    epicsEnvSet("EPICS_CA_MAX_ARRAY_BYTES", "1000000");
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("casCompressTest.db", NULL, NULL);
+
+    eltc(0);
+    testOk(iocInit() == 0, "iocInit on port %u", port);
+    eltc(1);
+    fillArrays();
+
+    sock = casTestConnectVersion(port, 0, 14, CA_PROTO_VERSION_COMPRESS);
+    rampSid = casTestCreateChan(sock, "ramp", 0, &type, &count);
+    flatSid = casTestCreateChan(sock, "flat", 1, &type, &count);
+    if (rampSid < 0 || flatSid < 0)
+        testAbort("Can't connect to the arrays");
+
+    testRead(sock, rampSid, DBR_LONG, NELEM, CA_COMPRESS_DELTA_LZ4, 1,
+        rampOk);
+    testRead(sock, rampSid, DBR_LONG, 0, CA_COMPRESS_DELTA_LZ4, 2, rampOk);
+    testRead(sock, flatSid, DBR_DOUBLE, NELEM, CA_COMPRESS_LZ4, 3, flatOk);
+    testMonitorUpdate(sock, flatSid);
+
+    memset(&msg, 0, sizeof(msg));
+    casTestSend(sock, CA_PROTO_READ_NOTIFY, DBR_LONG, 10,
+        (unsigned) rampSid, 5, NULL, 0);
+    testOk(casTestRecv(sock, &msg, 5.0) == 0 &&
+        msg.cmmd == CA_PROTO_READ_NOTIFY && msg.available == 5,
+        "Reply below the threshold sent uncompressed");
+    casTestMsgFree(&msg);
+    epicsSocketDestroy(sock);
+
+    testPlainClient(port);
+
+    return testDone();
+}
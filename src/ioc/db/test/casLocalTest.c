@@ -0,0 +1,191 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Responses through the shared memory ring of the local transport,
+ * and a client that hangs up while the server waits for space in a
+ * full ring.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "caProto.h"
+#include "caLocalRing.h"
+#include "caerr.h"
+#include "db_access.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "osiSock.h"
+#include "rsrv.h"
+#include "testMain.h"
+
+#include "casTestClient.h"
+
+#define NBIG 60000
+#define NBIGREADS 4
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+/* Copies size bytes out of the ring, returns -1 on timeout */
+static int ringGet(caLocalRing *pRing, void *pBuf, unsigned size,
+    double timeout)
+{
+    char *pOut = (char *) pBuf;
+    epicsTimeStamp start, now;
+
+    epicsTimeGetCurrent(&start);
+    while (size > 0) {
+        unsigned n = caLocalRingGet(pRing, pOut, size);
+
+        if (n == 0) {
+            epicsTimeGetCurrent(&now);
+            if (epicsTimeDiffInSeconds(&now, &start) > timeout)
+                return -1;
+            epicsThreadSleep(0.01);
+            continue;
+        }
+        pOut += n;
+        size -= n;
+    }
+    return 0;
+}
+
+/* Receives the header of one message from the ring, skips its payload */
+static int ringRecv(caLocalRing *pRing, caHdr *pHdr, double timeout)
+{
+    unsigned size;
+
+    if (ringGet(pRing, pHdr, sizeof(*pHdr), timeout))
+        return -1;
+    size = ntohs(pHdr->m_postsize);
+    if (size == 0xffff) {
+        ca_uint32_t ext[2];
+
+        if (ringGet(pRing, ext, sizeof(ext), timeout))
+            return -1;
+        size = ntohl(ext[0]);
+    }
+    while (size > 0) {
+        char buf[256];
+        unsigned n = size < sizeof(buf) ? size : sizeof(buf);
+
+        if (ringGet(pRing, buf, n, timeout))
+            return -1;
+        size -= n;
+    }
+    return 0;
+}
+
+/* Accepts the ring the server offers, NULL if it doesn't offer one */
+static caLocalRing * attachRing(SOCKET sock)
+{
+    caLocalRing *pRing = NULL;
+    casTestMsg msg;
+
+    memset(&msg, 0, sizeof(msg));
+    if (casTestRecv(sock, &msg, 2.0) == 0 &&
+        msg.cmmd == CA_PROTO_LOCAL && msg.dataType == CA_LOCAL_OFFER &&
+        msg.size >= 8) {
+        epicsUInt32 cookie[2];
+        ca_uint32_t netCookie[2];
+
+        memcpy(netCookie, msg.pPayload, sizeof(netCookie));
+        cookie[0] = ntohl(netCookie[0]);
+        cookie[1] = ntohl(netCookie[1]);
+        pRing = caLocalRingAttach(msg.cid, (int) msg.available, cookie);
+    }
+    casTestMsgFree(&msg);
+    return pRing;
+}
+
+static unsigned circuitCount(void)
+{
+    unsigned channels, circuits;
+
+    casStatsFetch(&channels, &circuits);
+    return circuits;
+}
+
+MAIN(casLocalTest)
+{
+    unsigned short port;
+    unsigned type, count, j;
+    caLocalRing *pRing;
+    casTestMsg msg;
+    caHdr hdr;
+    SOCKET sock;
+    int smallSid, bigSid;
+    double waited;
+
+    testPlan(5);
+
+    port = casTestPrepare();
+    epicsEnvSet("EPICS_CAS_LOCAL_RING_BYTES", "4096");
+    epicsEnvSet("EPICS_CA_MAX_ARRAY_BYTES", "1000000");
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("casPoolTest.db", NULL, NULL);
+
+    eltc(0);
+    testOk(iocInit() == 0, "iocInit on port %u", port);
+    eltc(1);
+
+    sock = casTestConnectVersion(port, 0, 15, CA_PROTO_VERSION_LOCAL);
+    pRing = attachRing(sock);
+    if (!pRing) {
+        testSkip(4, "No local transport on this host");
+        epicsSocketDestroy(sock);
+        return testDone();
+    }
+
+    /* the replies still come over TCP until the switch */
+    smallSid = casTestCreateChan(sock, "small", 1, &type, &count);
+    bigSid = casTestCreateChan(sock, "big", 2, &type, &count);
+    if (smallSid < 0 || bigSid < 0)
+        testAbort("Can't create the channels");
+
+    memset(&msg, 0, sizeof(msg));
+    casTestSend(sock, CA_PROTO_LOCAL, CA_LOCAL_ATTACH, 0, 0, 0, NULL, 0);
+    testOk(casTestRecv(sock, &msg, 5.0) == 0 &&
+        msg.cmmd == CA_PROTO_LOCAL && msg.dataType == CA_LOCAL_SWITCH,
+        "Server switched to the ring");
+    casTestMsgFree(&msg);
+
+    casTestSend(sock, CA_PROTO_READ_NOTIFY, DBR_LONG, 1,
+        (unsigned) smallSid, 7, NULL, 0);
+    testOk(ringRecv(pRing, &hdr, 5.0) == 0 &&
+        ntohs(hdr.m_cmmd) == CA_PROTO_READ_NOTIFY &&
+        ntohl(hdr.m_cid) == ECA_NORMAL && ntohl(hdr.m_available) == 7,
+        "READ_NOTIFY reply came through the ring");
+
+    testDiag("A client that hangs up with the ring full");
+
+    /* far more than the ring takes */
+    for (j = 0; j < NBIGREADS; j++)
+        casTestSend(sock, CA_PROTO_READ_NOTIFY, DBR_DOUBLE, NBIG,
+            (unsigned) bigSid, j, NULL, 0);
+    epicsThreadSleep(0.5);
+    testOk(circuitCount() == 1 &&
+        caLocalRingUsedBytes(pRing) == caLocalRingSize(pRing),
+        "Server waits for space in the full ring");
+
+    epicsSocketDestroy(sock);
+    caLocalRingDelete(pRing);
+
+    for (waited = 0.0; waited < 10.0 && circuitCount() != 0; waited += 0.1)
+        epicsThreadSleep(0.1);
+    testOk(circuitCount() == 0, "Server dropped the circuit after %.1f sec",
+        waited);
+
+    return testDone();
+}
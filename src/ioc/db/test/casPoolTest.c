@@ -0,0 +1,171 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Drives many circuits through the CA server's I/O thread pool,
+ * including one client that stops reading its replies.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "caProto.h"
+#include "caerr.h"
+#include "db_access.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "osiSock.h"
+#include "testMain.h"
+
+#include "casTestClient.h"
+
+#define NCIRCUITS 40
+#define NREQUESTS 20
+#define NBIG 60000
+#define NBIGREADS 16
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static SOCKET socks[NCIRCUITS];
+static unsigned sids[NCIRCUITS];
+
+/* Reads the replies to n READ_NOTIFYs on each circuit in [first, last),
+ * returns how many came back complete and in order
+ */
+static int readReplies(int first, int last, unsigned n, unsigned count,
+    double timeout)
+{
+    casTestMsg msg;
+    int i, good = 0;
+
+    memset(&msg, 0, sizeof(msg));
+    for (i = first; i < last; i++) {
+        unsigned j;
+
+        for (j = 0; j < n; j++) {
+            if (casTestRecv(socks[i], &msg, timeout) ||
+                msg.cmmd != CA_PROTO_READ_NOTIFY ||
+                msg.cid != ECA_NORMAL || msg.available != j ||
+                msg.count != count)
+                break;
+        }
+        if (j == n) {
+            good++;
+        }
+        else {
+            testDiag("Circuit %d: reply %u of %u missing", i, j, n);
+            timeout = 0.1;
+        }
+    }
+    casTestMsgFree(&msg);
+    return good;
+}
+
+static void testManyCircuits(void)
+{
+    int i, good;
+
+    testDiag("%u READ_NOTIFYs on each of %d circuits", NREQUESTS, NCIRCUITS);
+
+    for (i = 0; i < NCIRCUITS; i++) {
+        unsigned j;
+
+        for (j = 0; j < NREQUESTS; j++)
+            casTestSend(socks[i], CA_PROTO_READ_NOTIFY, DBR_LONG, 1,
+                sids[i], j, NULL, 0);
+    }
+    good = readReplies(0, NCIRCUITS, NREQUESTS, 1, 5.0);
+    testOk(good == NCIRCUITS, "%d of %d circuits got all replies",
+        good, NCIRCUITS);
+}
+
+static void testStalledClient(unsigned short port)
+{
+    SOCKET sock = casTestConnect(port, 4096);
+    unsigned type, count, j;
+    casTestMsg msg;
+    int sid, good;
+
+    testDiag("A client that doesn't read its replies");
+
+    sid = casTestCreateChan(sock, "big", 1000, &type, &count);
+    testOk(sid >= 0 && count == NBIG, "Connected to big, %u elements", count);
+
+    /* far more than the socket buffers take */
+    for (j = 0; j < NBIGREADS; j++)
+        casTestSend(sock, CA_PROTO_READ_NOTIFY, DBR_DOUBLE, NBIG,
+            (unsigned) sid, j, NULL, 0);
+    epicsThreadSleep(0.5);
+
+    for (j = 0; j < (unsigned) NCIRCUITS; j++)
+        casTestSend(socks[j], CA_PROTO_READ_NOTIFY, DBR_LONG, 1,
+            sids[j], 0, NULL, 0);
+    good = readReplies(0, NCIRCUITS, 1, 1, 5.0);
+    testOk(good == NCIRCUITS, "%d of %d other circuits still serviced",
+        good, NCIRCUITS);
+
+    memset(&msg, 0, sizeof(msg));
+    for (j = 0; j < NBIGREADS; j++) {
+        if (casTestRecv(sock, &msg, 10.0) ||
+            msg.cmmd != CA_PROTO_READ_NOTIFY || msg.available != j ||
+            msg.count != NBIG ||
+            ((epicsFloat64 *) msg.pPayload)[NBIG - 1] != 0.0)
+            break;
+    }
+    testOk(j == NBIGREADS, "Stalled client got %u of %u large replies",
+        j, NBIGREADS);
+    casTestMsgFree(&msg);
+    epicsSocketDestroy(sock);
+}
+
+MAIN(casPoolTest)
+{
+    unsigned short port;
+    int i, connected = 0;
+
+    testPlan(5);
+
+    port = casTestPrepare();
+    epicsEnvSet("EPICS_CAS_IO_THREADS", "1");
+    epicsEnvSet("EPICS_CA_MAX_ARRAY_BYTES", "1000000");
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("casPoolTest.db", NULL, NULL);
+
+    eltc(0);
+    testOk(iocInit() == 0, "iocInit with one CAS-io thread on port %u",
+        port);
+    eltc(1);
+
+    for (i = 0; i < NCIRCUITS; i++) {
+        unsigned type, count;
+        int sid;
+
+        socks[i] = casTestConnect(port, 0);
+        if (socks[i] == INVALID_SOCKET)
+            continue;
+        sid = casTestCreateChan(socks[i], "small", i, &type, &count);
+        if (sid >= 0) {
+            sids[i] = (unsigned) sid;
+            connected++;
+        }
+    }
+    if (connected != NCIRCUITS)
+        testAbort("Only %d of %d circuits connected", connected, NCIRCUITS);
+
+    testManyCircuits();
+    testStalledClient(port);
+
+    for (i = 0; i < NCIRCUITS; i++)
+        epicsSocketDestroy(socks[i]);
+
+    return testDone();
+}
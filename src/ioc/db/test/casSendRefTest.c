@@ -0,0 +1,159 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Large array monitor updates sent by reference from the event
+ * snapshot, to clients that only take them in a few kB at a time.
+ * The circuits are serviced by an I/O thread, whose non-blocking
+ * sockets make sendmsg() return after sending part of an update.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "caProto.h"
+#include "caerr.h"
+#include "caeventmask.h"
+#include "db_access.h"
+#include "db_access_routines.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsEndian.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "osiSock.h"
+#include "testMain.h"
+
+#include "arrRecord.h"
+#include "casTestClient.h"
+
+#define NBIG 60000
+#define NUPDATES 8
+#define NCLIENTS 3
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+/* Reads a double in network byte order */
+static double netDouble(const char *p)
+{
+    union { epicsFloat64 f; char c[8]; } u;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        u.c[i] = EPICS_BYTE_ORDER == EPICS_ENDIAN_BIG ? p[i] : p[7 - i];
+    return u.f;
+}
+
+static void postUpdate(arrRecord *prec, double value)
+{
+    epicsFloat64 *pdata = (epicsFloat64 *) prec->bptr;
+    int i;
+
+    dbScanLock((dbCommon *) prec);
+    for (i = 0; i < NBIG; i++)
+        pdata[i] = value;
+    prec->nord = NBIG;
+    db_post_events(prec, NULL, DBE_VALUE);
+    dbScanUnlock((dbCommon *) prec);
+}
+
+/* Checks that every update is whole and newer than the one before,
+ * returns the last value or -1
+ */
+static double readUpdates(SOCKET sock, unsigned dataType)
+{
+    unsigned offset = dbr_value_offset[dataType];
+    double last = -1.0;
+    casTestMsg msg;
+
+    memset(&msg, 0, sizeof(msg));
+    while (last < NUPDATES) {
+        double first;
+        unsigned i;
+
+        /* let the server find the socket full */
+        epicsThreadSleep(0.01);
+        if (casTestRecv(sock, &msg, 10.0) ||
+            msg.cmmd != CA_PROTO_EVENT_ADD || msg.cid != ECA_NORMAL ||
+            msg.count != NBIG || msg.size < offset + NBIG * 8u) {
+            testDiag("Update after %g missing", last);
+            last = -1.0;
+            break;
+        }
+        first = netDouble(msg.pPayload + offset);
+        for (i = 1; i < NBIG; i++) {
+            if (netDouble(msg.pPayload + offset + 8u * i) != first)
+                break;
+        }
+        if (i != NBIG || first <= last) {
+            testDiag("Update %g after %g is torn at element %u",
+                first, last, i);
+            last = -1.0;
+            break;
+        }
+        last = first;
+    }
+    casTestMsgFree(&msg);
+    return last;
+}
+
+MAIN(casSendRefTest)
+{
+    static const unsigned dataTypes[NCLIENTS] =
+        { DBR_DOUBLE, DBR_TIME_DOUBLE, DBR_DOUBLE };
+    SOCKET socks[NCLIENTS];
+    unsigned short port;
+    arrRecord *prec;
+    int i;
+
+    testPlan(1 + 2 * NCLIENTS);
+
+    port = casTestPrepare();
+    epicsEnvSet("EPICS_CAS_IO_THREADS", "1");
+    epicsEnvSet("EPICS_CA_MAX_ARRAY_BYTES", "1000000");
+    dbEventArraySnapshots = 1;
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("casPoolTest.db", NULL, NULL);
+
+    eltc(0);
+    testOk(iocInit() == 0, "iocInit on port %u", port);
+    eltc(1);
+
+    prec = (arrRecord *) testdbRecordPtr("big");
+    postUpdate(prec, 0.0);
+
+    for (i = 0; i < NCLIENTS; i++) {
+        struct mon_info mi;
+        unsigned type, count;
+        int sid;
+
+        socks[i] = casTestConnect(port, 4096);
+        sid = casTestCreateChan(socks[i], "big", i, &type, &count);
+        memset(&mi, 0, sizeof(mi));
+        mi.m_mask = htons(DBE_VALUE);
+        testOk(sid >= 0 &&
+            casTestSend(socks[i], CA_PROTO_EVENT_ADD, dataTypes[i], NBIG,
+                (unsigned) sid, i, &mi, sizeof(mi)) == 0,
+            "Client %d subscribed to %s", i, dbr_type_to_text(dataTypes[i]));
+    }
+
+    for (i = 1; i <= NUPDATES; i++)
+        postUpdate(prec, i);
+
+    for (i = 0; i < NCLIENTS; i++)
+        testOk(readUpdates(socks[i], dataTypes[i]) == NUPDATES,
+            "Client %d got whole updates in order", i);
+
+    for (i = 0; i < NCLIENTS; i++)
+        epicsSocketDestroy(socks[i]);
+
+    return testDone();
+}
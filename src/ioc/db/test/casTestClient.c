@@ -0,0 +1,229 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * A bare CA client speaking the TCP protocol directly, so that tests
+ * can control how the circuits to an IOC's own server are read.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "caProto.h"
+#include "envDefs.h"
+#include "epicsStdio.h"
+#include "epicsTime.h"
+#include "osiSock.h"
+
+#include "casTestClient.h"
+
+/* the server's extended headers were added in V4.9 */
+#define CAS_TEST_MINOR_VERSION 13u
+
+unsigned short casTestPrepare(void)
+{
+    struct sockaddr_in addr;
+    osiSocklen_t size = sizeof(addr);
+    unsigned short port = 0;
+    SOCKET sock;
+    char buf[16];
+
+    osiSockAttach();
+
+    /* ask the system for a port that is free right now */
+    sock = epicsSocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock != INVALID_SOCKET) {
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (bind(sock, (struct sockaddr *) &addr, sizeof(addr)) == 0 &&
+            getsockname(sock, (struct sockaddr *) &addr, &size) == 0)
+            port = ntohs(addr.sin_port);
+        epicsSocketDestroy(sock);
+    }
+
+    epicsSnprintf(buf, sizeof(buf), "%u", port);
+    epicsEnvSet("EPICS_CAS_SERVER_PORT", buf);
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CAS_AUTO_BEACON_ADDR_LIST", "NO");
+    epicsEnvSet("EPICS_CAS_BEACON_ADDR_LIST", "127.0.0.1");
+    return port;
+}
+
+/* Waits up to timeout seconds for sock to become readable */
+static int waitReadable(SOCKET sock, double timeout)
+{
+    struct timeval tv;
+    fd_set fds;
+
+    if (timeout < 0.0)
+        timeout = 0.0;
+    tv.tv_sec = (long) timeout;
+    tv.tv_usec = (long) ((timeout - tv.tv_sec) * 1e6);
+    FD_ZERO(&fds);
+    FD_SET(sock, &fds);
+    return select((int) sock + 1, &fds, NULL, NULL, &tv) > 0;
+}
+
+static int recvAll(SOCKET sock, char *pBuf, unsigned size,
+    const epicsTimeStamp *pDeadline)
+{
+    while (size > 0) {
+        epicsTimeStamp now;
+        int n;
+
+        epicsTimeGetCurrent(&now);
+        if (!waitReadable(sock, epicsTimeDiffInSeconds(pDeadline, &now)))
+            return -1;
+        n = recv(sock, pBuf, size, 0);
+        if (n <= 0)
+            return -1;
+        pBuf += n;
+        size -= (unsigned) n;
+    }
+    return 0;
+}
+
+int casTestSend(SOCKET sock, unsigned cmmd, unsigned dataType,
+    unsigned count, unsigned cid, unsigned available,
+    const void *pPayload, unsigned size)
+{
+    unsigned alignedSize = CA_MESSAGE_ALIGN(size);
+    unsigned total = sizeof(caHdr) + alignedSize;
+    char *pMsg = calloc(1, total);
+    caHdr *pHdr = (caHdr *) pMsg;
+    char *pOut = pMsg;
+    int status = 0;
+
+    if (!pMsg)
+        return -1;
+    pHdr->m_cmmd = htons((ca_uint16_t) cmmd);
+    pHdr->m_postsize = htons((ca_uint16_t) alignedSize);
+    pHdr->m_dataType = htons((ca_uint16_t) dataType);
+    pHdr->m_count = htons((ca_uint16_t) count);
+    pHdr->m_cid = htonl(cid);
+    pHdr->m_available = htonl(available);
+    if (size)
+        memcpy(pHdr + 1, pPayload, size);
+
+    while (total > 0) {
+        int n = send(sock, pOut, total, 0);
+
+        if (n <= 0) {
+            status = -1;
+            break;
+        }
+        pOut += n;
+        total -= (unsigned) n;
+    }
+    free(pMsg);
+    return status;
+}
+
+int casTestRecv(SOCKET sock, casTestMsg *pmsg, double timeout)
+{
+    epicsTimeStamp deadline;
+    caHdr hdr;
+
+    epicsTimeGetCurrent(&deadline);
+    epicsTimeAddSeconds(&deadline, timeout);
+
+    if (recvAll(sock, (char *) &hdr, sizeof(hdr), &deadline))
+        return -1;
+    pmsg->cmmd = ntohs(hdr.m_cmmd);
+    pmsg->size = ntohs(hdr.m_postsize);
+    pmsg->dataType = ntohs(hdr.m_dataType);
+    pmsg->count = ntohs(hdr.m_count);
+    pmsg->cid = ntohl(hdr.m_cid);
+    pmsg->available = ntohl(hdr.m_available);
+
+    if (pmsg->size == 0xffff) {
+        ca_uint32_t ext[2];
+
+        if (recvAll(sock, (char *) ext, sizeof(ext), &deadline))
+            return -1;
+        pmsg->size = ntohl(ext[0]);
+        pmsg->count = ntohl(ext[1]);
+    }
+
+    if (pmsg->size > pmsg->maxSize) {
+        char *pPayload = realloc(pmsg->pPayload, pmsg->size);
+
+        if (!pPayload)
+            return -1;
+        pmsg->pPayload = pPayload;
+        pmsg->maxSize = pmsg->size;
+    }
+    return recvAll(sock, pmsg->pPayload, pmsg->size, &deadline);
+}
+
+void casTestMsgFree(casTestMsg *pmsg)
+{
+    free(pmsg->pPayload);
+    pmsg->pPayload = NULL;
+    pmsg->maxSize = 0;
+}
+
+SOCKET casTestConnect(unsigned short port, int rcvBuf)
+{
+    return casTestConnectVersion(port, rcvBuf, CAS_TEST_MINOR_VERSION, 0);
+}
+
+SOCKET casTestConnectVersion(unsigned short port, int rcvBuf,
+    unsigned minorVersion, unsigned capabilities)
+{
+    struct sockaddr_in addr;
+    casTestMsg msg;
+    SOCKET sock;
+
+    sock = epicsSocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET)
+        return sock;
+    if (rcvBuf)
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUF,
+            (char *) &rcvBuf, sizeof(rcvBuf));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    memset(&msg, 0, sizeof(msg));
+    if (connect(sock, (struct sockaddr *) &addr, sizeof(addr)) ||
+        casTestRecv(sock, &msg, 5.0) || msg.cmmd != CA_PROTO_VERSION ||
+        casTestSend(sock, CA_PROTO_VERSION, CA_PROTO_PRIORITY_MIN,
+            minorVersion, capabilities, 0, NULL, 0)) {
+        epicsSocketDestroy(sock);
+        sock = INVALID_SOCKET;
+    }
+    casTestMsgFree(&msg);
+    return sock;
+}
+
+int casTestCreateChan(SOCKET sock, const char *name, unsigned cid,
+    unsigned *pType, unsigned *pCount)
+{
+    casTestMsg msg;
+    int sid = -1;
+
+    if (casTestSend(sock, CA_PROTO_CREATE_CHAN, 0, 0, cid,
+            CAS_TEST_MINOR_VERSION, name, strlen(name) + 1))
+        return -1;
+
+    /* access rights come first */
+    memset(&msg, 0, sizeof(msg));
+    while (casTestRecv(sock, &msg, 5.0) == 0) {
+        if (msg.cmmd == CA_PROTO_ACCESS_RIGHTS)
+            continue;
+        if (msg.cmmd == CA_PROTO_CREATE_CHAN && msg.cid == cid) {
+            sid = (int) msg.available;
+            *pType = msg.dataType;
+            *pCount = msg.count;
+        }
+        break;
+    }
+    casTestMsgFree(&msg);
+    return sid;
+}
@@ -0,0 +1,64 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * A bare CA client speaking the TCP protocol directly, so that tests
+ * can control how the circuits to an IOC's own server are read.
+ */
+
+#ifndef INC_casTestClient_H
+#define INC_casTestClient_H
+
+#include "osiSock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct casTestMsg {
+    unsigned    cmmd;
+    unsigned    dataType;
+    unsigned    count;
+    unsigned    cid;
+    unsigned    available;
+    unsigned    size;       /* of the payload */
+    char        *pPayload;  /* reused by the next casTestRecv() */
+    unsigned    maxSize;
+} casTestMsg;
+
+/* Points the CA server at a free port on the loopback interface,
+ * call before iocInit().  Returns the port.
+ */
+unsigned short casTestPrepare(void);
+
+/* Opens a circuit and exchanges the version messages.  A non-zero
+ * rcvBuf sets SO_RCVBUF of the client's socket.
+ */
+SOCKET casTestConnect(unsigned short port, int rcvBuf);
+
+/* Same, but announces another minor protocol version and passes
+ * capabilities in the m_cid field of the version message.
+ */
+SOCKET casTestConnectVersion(unsigned short port, int rcvBuf,
+    unsigned minorVersion, unsigned capabilities);
+
+int casTestSend(SOCKET sock, unsigned cmmd, unsigned dataType,
+    unsigned count, unsigned cid, unsigned available,
+    const void *pPayload, unsigned size);
+
+/* Receives one message, returns -1 on timeout or error */
+int casTestRecv(SOCKET sock, casTestMsg *pmsg, double timeout);
+
+void casTestMsgFree(casTestMsg *pmsg);
+
+/* Creates a channel, returns the server's id of it or -1 */
+int casTestCreateChan(SOCKET sock, const char *name, unsigned cid,
+    unsigned *pType, unsigned *pCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_casTestClient_H */
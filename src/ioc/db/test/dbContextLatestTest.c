@@ -0,0 +1,148 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Latest value only subscriptions of a CA client in the IOC, whose
+ * channels to the IOC's own records are served by the dbContext.
+ */
+
+#include <string.h>
+
+#include "cadef.h"
+#include "db_access_routines.h"
+#include "dbUnitTest.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "testMain.h"
+
+#define NPUTS 100
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static epicsEventId gate, switched;
+static evid latestSub;
+static volatile int latestValue = -1, latestAtSwitch = -1;
+static volatile unsigned latestCount, plainCount;
+
+static void latestCallback(struct event_handler_args args)
+{
+    if (args.status == ECA_NORMAL) {
+        latestValue = *(const dbr_long_t *) args.dbr;
+        latestCount++;
+    }
+}
+
+/* Holds up the event thread at 1, switches the other subscription
+ * back to every update at 2
+ */
+static void plainCallback(struct event_handler_args args)
+{
+    dbr_long_t value;
+
+    if (args.status != ECA_NORMAL)
+        return;
+    value = *(const dbr_long_t *) args.dbr;
+    if (value == 1) {
+        epicsEventMustWait(gate);
+    }
+    else if (value == 2) {
+        ca_subscription_latest_only(latestSub, 0);
+        latestAtSwitch = latestValue;
+        epicsEventSignal(switched);
+    }
+    plainCount++;
+}
+
+static void putValue(chid chan, dbr_long_t value)
+{
+    ca_put(DBR_LONG, chan, &value);
+    ca_flush_io();
+}
+
+static int waitFor(volatile unsigned *pCount, unsigned count)
+{
+    int i;
+
+    for (i = 0; i < 500 && *pCount < count; i++)
+        epicsThreadSleep(0.01);
+    return *pCount >= count;
+}
+
+MAIN(dbContextLatestTest)
+{
+    struct ca_backlog backlog;
+    evid plainSub;
+    chid chan;
+    int i;
+
+    testPlan(5);
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbContextLatestTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    gate = epicsEventMustCreate(epicsEventEmpty);
+    switched = epicsEventMustCreate(epicsEventEmpty);
+
+    ca_context_create(ca_enable_preemptive_callback);
+    if (ca_create_channel("latest", NULL, NULL, 0, &chan) != ECA_NORMAL ||
+        ca_pend_io(5.0) != ECA_NORMAL)
+        testAbort("No channel to the record");
+
+    /* the events of both are in one queue, latestSub's in front */
+    ca_create_subscription(DBR_LONG, 1, chan, DBE_VALUE, latestCallback,
+        NULL, &latestSub);
+    ca_create_subscription(DBR_LONG, 1, chan, DBE_VALUE, plainCallback,
+        NULL, &plainSub);
+    ca_flush_io();
+    testOk(waitFor(&latestCount, 1) && waitFor(&plainCount, 1),
+        "Initial updates delivered");
+
+    testDiag("Switching latest value only mode off");
+    ca_subscription_latest_only(latestSub, 1);
+    putValue(chan, 1);
+    epicsThreadSleep(0.1);
+    /* queued behind 1, while the event thread waits at the gate */
+    putValue(chan, 2);
+    epicsEventSignal(gate);
+    testOk(epicsEventWaitWithTimeout(switched, 5.0) == epicsEventWaitOK &&
+        latestAtSwitch == 2,
+        "Waiting update delivered when the mode was switched off (%d)",
+        latestAtSwitch);
+
+    testDiag("A burst of updates through the database event queue");
+    ca_subscription_latest_only(latestSub, 1);
+    for (i = 3; i <= NPUTS; i++)
+        putValue(chan, i);
+    for (i = 0; i < 500 && latestValue != NPUTS; i++)
+        epicsThreadSleep(0.01);
+    testOk(latestValue == NPUTS, "Latest value %d delivered", latestValue);
+    testOk(waitFor(&plainCount, NPUTS), "Other subscription got %u updates",
+        plainCount);
+
+    ca_context_backlog(NULL, &backlog);
+    testOk(backlog.latestOnly == 1u && backlog.pending == 0u,
+        "Backlog: %u latest only, %u pending, %.0f delivered, %.0f replaced",
+        backlog.latestOnly, backlog.pending, backlog.delivered,
+        backlog.replaced);
+
+    ca_clear_subscription(latestSub);
+    ca_clear_subscription(plainSub);
+    ca_clear_channel(chan);
+    ca_context_destroy();
+
+    testIocShutdownOk();
+    testdbCleanup();
+
+    epicsEventDestroy(gate);
+    epicsEventDestroy(switched);
+    return testDone();
+}
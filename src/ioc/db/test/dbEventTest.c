@@ -0,0 +1,266 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Checks per-subscription queue depths, the array snapshots that
+ * are shared between subscriptions and batched posting.
+ */
+
+#include <string.h>
+
+#include "arrRecord.h"
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "db_field_log.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "errlog.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+#define MAXUPDATES 16
+#define NUPDATE_ELEMENTS 3
+
+typedef struct sink {
+    int count;
+    int type[MAXUPDATES];
+    long nelem[MAXUPDATES];
+    epicsInt32 first[MAXUPDATES];
+    void *field[MAXUPDATES];
+} sink;
+
+static epicsEventId delivered;
+
+static void eventCallback(void *user_arg, struct dbChannel *chan,
+    int eventsRemaining, struct db_field_log *pfl)
+{
+    sink *psink = (sink *)user_arg;
+    int i = psink->count;
+
+    if (i < MAXUPDATES) {
+        psink->type[i] = pfl->type;
+        psink->nelem[i] = pfl->no_elements;
+        if (pfl->type == dbfl_type_ref) {
+            psink->field[i] = pfl->u.r.field;
+            psink->first[i] = *(epicsInt32 *)pfl->u.r.field;
+        }
+    }
+    psink->count++;
+    epicsEventMustTrigger(delivered);
+}
+
+static void postValue(arrRecord *prec, epicsInt32 value)
+{
+    epicsInt32 *pdata = (epicsInt32 *)prec->bptr;
+    int i;
+
+    dbScanLock((dbCommon *)prec);
+    for (i = 0; i < NUPDATE_ELEMENTS; i++)
+        pdata[i] = value;
+    prec->nord = NUPDATE_ELEMENTS;
+    db_post_events(prec, NULL, DBE_VALUE);
+    dbScanUnlock((dbCommon *)prec);
+}
+
+static void waitFor(sink *psink, int count)
+{
+    while (psink->count < count &&
+           epicsEventWaitWithTimeout(delivered, 5.0) == epicsEventOK)
+        ;
+    /* catch any extra updates */
+    epicsThreadSleep(0.1);
+}
+
+static dbChannel* openChannel(const char *name)
+{
+    dbChannel *chan = dbChannelCreate(name);
+
+    if (!chan || dbChannelOpen(chan))
+        testAbort("Can't open channel %s", name);
+    return chan;
+}
+
+static void testSnapshots(arrRecord *prec)
+{
+    static sink sinkA, sinkB;
+    dbChannel *chanA = openChannel("i32.VAL");
+    dbChannel *chanB = openChannel("i32.VAL");
+    dbEventCtx ctx = db_init_events();
+    dbEventSubscription subA, subB;
+    int i, inOrder = 1, shared = 1;
+
+    testDiag("Array snapshots enabled");
+    dbEventArraySnapshots = 1;
+
+    subA = db_add_event_depth(ctx, chanA, eventCallback, &sinkA,
+        DBE_VALUE, 1);
+    subB = db_add_event(ctx, chanB, eventCallback, &sinkB, DBE_VALUE);
+    testOk(subA && subB, "Subscriptions added");
+    db_event_enable(subA);
+    db_event_enable(subB);
+
+    /* Queue the updates before the event task runs */
+    for (i = 1; i <= 5; i++)
+        postValue(prec, i);
+    db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityMedium);
+    waitFor(&sinkB, 5);
+
+    testOk(sinkB.count == 5, "Default depth delivered %d updates",
+        sinkB.count);
+    for (i = 0; i < sinkB.count && i < 5; i++) {
+        if (sinkB.type[i] != dbfl_type_ref ||
+            sinkB.first[i] != i + 1 ||
+            sinkB.nelem[i] != NUPDATE_ELEMENTS) {
+            testDiag("update %d: type %s value %d elements %ld", i,
+                dbflTypeStr(sinkB.type[i]), sinkB.first[i], sinkB.nelem[i]);
+            inOrder = 0;
+        }
+    }
+    testOk(inOrder, "Each update carries its own snapshot");
+
+    testOk(sinkA.count == 1, "Depth 1 delivered %d update", sinkA.count);
+    testOk(sinkA.type[0] == dbfl_type_ref && sinkA.first[0] == 5,
+        "Depth 1 got the latest value %d", sinkA.first[0]);
+    testOk(sinkA.field[0] == sinkB.field[4],
+        "Snapshot shared between subscriptions");
+
+    for (i = 1; i < 4; i++) {
+        if (sinkB.field[i] == sinkB.field[i - 1])
+            shared = 0;
+    }
+    testOk(shared, "Separate snapshot for each post");
+
+    db_cancel_event(subA);
+    db_cancel_event(subB);
+    db_close_events(ctx);
+    dbChannelDelete(chanA);
+    dbChannelDelete(chanB);
+    dbEventArraySnapshots = 0;
+}
+
+static void testNoSnapshots(arrRecord *prec)
+{
+    static sink sinkC;
+    dbChannel *chanC = openChannel("i32.VAL");
+    dbEventCtx ctx = db_init_events();
+    dbEventSubscription subC;
+    int i;
+
+    testDiag("Array snapshots disabled");
+
+    subC = db_add_event(ctx, chanC, eventCallback, &sinkC, DBE_VALUE);
+    db_event_enable(subC);
+
+    for (i = 1; i <= 5; i++)
+        postValue(prec, i);
+    db_start_events(ctx, "dbEventTest", NULL, NULL,
+        epicsThreadPriorityMedium);
+    waitFor(&sinkC, 1);
+
+    testOk(sinkC.count == 1 && sinkC.type[0] == dbfl_type_rec,
+        "Updates merged into %d reference to the record", sinkC.count);
+
+    db_cancel_event(subC);
+    db_close_events(ctx);
+    dbChannelDelete(chanC);
+}
+
+static void testBatch(arrRecord *prec)
+{
+    static sink sinkD, sinkE;
+    dbChannel *chanD = openChannel("i32.VAL");
+    dbChannel *chanE = openChannel("i32.VAL");
+    dbEventCtx ctxD = db_init_events();
+    dbEventCtx ctxE = db_init_events();
+    dbEventSubscription subD, subE;
+    dbEventBatch *pbatch = db_event_batch_create();
+    epicsInt32 *pdata = (epicsInt32 *)prec->bptr;
+    int i, j, inOrder = 1;
+
+    testDiag("Batched posting");
+    dbEventArraySnapshots = 1;
+
+    subD = db_add_event(ctxD, chanD, eventCallback, &sinkD, DBE_VALUE);
+    subE = db_add_event(ctxE, chanE, eventCallback, &sinkE, DBE_VALUE);
+    db_event_enable(subD);
+    db_event_enable(subE);
+    db_start_events(ctxD, "dbEventTestD", NULL, NULL,
+        epicsThreadPriorityMedium);
+    db_start_events(ctxE, "dbEventTestE", NULL, NULL,
+        epicsThreadPriorityMedium);
+
+    dbScanLock((dbCommon *)prec);
+    db_post_events_begin(pbatch);
+    for (i = 1; i <= 3; i++) {
+        for (j = 0; j < NUPDATE_ELEMENTS; j++)
+            pdata[j] = i;
+        prec->nord = NUPDATE_ELEMENTS;
+        db_post_events_batch(pbatch, prec, NULL, DBE_VALUE);
+    }
+    epicsThreadSleep(0.1);
+    testOk(sinkD.count == 0 && sinkE.count == 0,
+        "Nothing delivered before commit");
+    db_post_events_commit(pbatch);
+    dbScanUnlock((dbCommon *)prec);
+
+    waitFor(&sinkD, 3);
+    waitFor(&sinkE, 3);
+    testOk(sinkD.count == 3 && sinkE.count == 3,
+        "Commit delivered %d and %d updates", sinkD.count, sinkE.count);
+    for (i = 0; i < 3; i++) {
+        if (sinkD.first[i] != i + 1 || sinkE.first[i] != i + 1)
+            inOrder = 0;
+    }
+    testOk(inOrder, "Updates delivered in posting order");
+
+    db_event_batch_destroy(pbatch);
+    db_cancel_event(subD);
+    db_cancel_event(subE);
+    db_close_events(ctxD);
+    db_close_events(ctxE);
+    dbChannelDelete(chanD);
+    dbChannelDelete(chanE);
+    dbEventArraySnapshots = 0;
+}
+
+MAIN(dbEventTest)
+{
+    arrRecord *prec;
+
+    testPlan(11);
+
+    delivered = epicsEventMustCreate(epicsEventEmpty);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbChArrTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    prec = (arrRecord *)testdbRecordPtr("i32");
+
+    testSnapshots(prec);
+    testNoSnapshots(prec);
+    testBatch(prec);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    epicsEventDestroy(delivered);
+
+    return testDone();
+}
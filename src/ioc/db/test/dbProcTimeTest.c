@@ -0,0 +1,111 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Checks the processing time statistics collected by dbProcess()
+ */
+
+#include <string.h>
+
+#include "dbAccess.h"
+#include "dbProcTime.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "xRecord.h"
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static void slowProcess(xRecord *prec)
+{
+    epicsThreadSleep(0.002);
+}
+
+static unsigned long histTotal(const dbProcTime *ptime)
+{
+    unsigned long total = 0;
+    int bin;
+
+    for (bin = 0; bin < DB_PROC_TIME_BINS; bin++)
+        total += ptime->hist[bin];
+    return total;
+}
+
+static int slowestBin(const dbProcTime *ptime)
+{
+    int bin;
+
+    for (bin = DB_PROC_TIME_BINS - 1; bin > 0; bin--)
+        if (ptime->hist[bin])
+            break;
+    return bin;
+}
+
+MAIN(dbProcTimeTest)
+{
+    dbCommon *preca, *precb;
+    dbProcTime time;
+    int i;
+
+    testPlan(20);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbLockTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    preca = testdbRecordPtr("reca");
+    precb = testdbRecordPtr("recb");
+    ((xRecord *)precb)->clbk = slowProcess;
+
+    testDiag("Timing disabled");
+    testdbPutFieldOk("reca.PROC", DBF_LONG, 1);
+    dbProcTimeGet(preca, &time);
+    testOk(time.count == 0, "Nothing recorded (%lu)", time.count);
+
+    testDiag("Timing enabled");
+    dbProcTimeStats = 1;
+    for (i = 0; i < 5; i++) {
+        testdbPutFieldOk("reca.PROC", DBF_LONG, 1);
+        testdbPutFieldOk("recb.PROC", DBF_LONG, 1);
+    }
+    dbProcTimeStats = 0;
+
+    dbProcTimeGet(preca, &time);
+    testOk(time.count == 5, "reca processed %lu times", time.count);
+    testOk(histTotal(&time) == time.count, "Histogram holds %lu entries",
+        histTotal(&time));
+
+    dbProcTimeGet(precb, &time);
+    testOk(time.count == 5 && time.max >= 0.002 &&
+        time.total >= 5 * 0.002,
+        "recb total %f max %f", time.total, time.max);
+    testOk(slowestBin(&time) >= 11, "Slowest recb time in bin %d",
+        slowestBin(&time));
+
+    dbProcTimeShow("recb");
+    testOk1(dbProcTimeScan(0.0, 5) == 0);
+    testOk1(dbProcTimeLockSet(2) == 0);
+
+    testOk1(dbProcTimeReset() == 0);
+    dbProcTimeGet(precb, &time);
+    testOk(time.count == 0 && time.max == 0.0 && histTotal(&time) == 0,
+        "Statistics reset");
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
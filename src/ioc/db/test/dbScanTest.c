@@ -10,15 +10,19 @@
  */
 
 #include <string.h>
+#include <stdio.h>
 
 #include "dbScan.h"
 #include "epicsEvent.h"
+#include "epicsThread.h"
+#include "menuScan.h"
 
 #include "dbUnitTest.h"
 #include "testMain.h"
 
 #include "dbAccess.h"
 #include "errlog.h"
+#include "xRecord.h"
 
 void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
 
@@ -65,9 +69,151 @@ static void testOnce(void)
     epicsEventDestroy(waiter);
 }
 
+#define NGROUPS 8
+
+static xRecord *precA[NGROUPS], *precB[NGROUPS];
+static xRecord *precC[NGROUPS], *precD[NGROUPS];
+static epicsThreadId lastThread[NGROUPS][2];
+static int phaseErrors, priorityErrors;
+
+static void phasedProcess(xRecord *prec)
+{
+    static int seen[NGROUPS][NGROUPS];
+    unsigned int prio = epicsThreadPriorityScanLow +
+        menuScan_2_second - SCAN_1ST_PERIODIC;
+    int i, j;
+
+    if (epicsThreadGetPrioritySelf() != prio)
+        priorityErrors++;
+    /* Each PHAS 0 record must have been processed again since the last
+     * time this PHAS 1 record was.
+     */
+    for (i = 0; i < NGROUPS; i++) {
+        if (prec != precC[i])
+            continue;
+        for (j = 0; j < NGROUPS; j++) {
+            if (prec->val && precD[j]->val <= seen[i][j])
+                phaseErrors++;
+            seen[i][j] = precD[j]->val;
+        }
+    }
+    prec->val++;
+}
+
+static void periodicProcess(xRecord *prec)
+{
+    int i;
+
+    for (i = 0; i < NGROUPS; i++) {
+        if (prec == precA[i])
+            lastThread[i][0] = epicsThreadGetIdSelf();
+        else if (prec == precB[i])
+            lastThread[i][1] = epicsThreadGetIdSelf();
+    }
+    prec->val++;
+}
+
+static void testPeriodicParallel(void)
+{
+    scanPeriodicStats stats;
+    epicsThreadId firstThread;
+    int i, unscanned = 0, split = 0, threads = 1;
+
+    testDiag("check parallel periodic scanning");
+
+    testOk1(scanPeriodicParallel(3) == 0);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    for (i = 0; i < NGROUPS; i++) {
+        char macros[16];
+
+        sprintf(macros, "N=%d", i);
+        testdbReadDatabase("dbScanTest.db", NULL, macros);
+    }
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOk(scanPeriodicParallel(2) != 0, "Not changed after iocInit");
+
+    for (i = 0; i < NGROUPS; i++) {
+        char name[8];
+
+        sprintf(name, "pa%d", i);
+        precA[i] = (xRecord *)testdbRecordPtr(name);
+        sprintf(name, "pb%d", i);
+        precB[i] = (xRecord *)testdbRecordPtr(name);
+        dbScanLock((dbCommon *)precA[i]);
+        precA[i]->clbk = periodicProcess;
+        precB[i]->clbk = periodicProcess;
+        dbScanUnlock((dbCommon *)precA[i]);
+        sprintf(name, "pc%d", i);
+        precC[i] = (xRecord *)testdbRecordPtr(name);
+        sprintf(name, "pd%d", i);
+        precD[i] = (xRecord *)testdbRecordPtr(name);
+    }
+    for (i = 0; i < NGROUPS; i++) {
+        dbScanLock((dbCommon *)precD[i]);
+        precD[i]->clbk = phasedProcess;
+        dbScanUnlock((dbCommon *)precD[i]);
+    }
+    for (i = 0; i < NGROUPS; i++) {
+        dbScanLock((dbCommon *)precC[i]);
+        precC[i]->val = 0;
+        precC[i]->clbk = phasedProcess;
+        dbScanUnlock((dbCommon *)precC[i]);
+    }
+
+    epicsThreadSleep(1.0);
+    /* Let the current scan finish */
+    scanPause();
+    epicsThreadSleep(0.5);
+
+    firstThread = lastThread[0][0];
+    for (i = 0; i < NGROUPS; i++) {
+        if (precA[i]->val == 0 || precB[i]->val == 0)
+            unscanned++;
+        if (lastThread[i][0] != lastThread[i][1])
+            split++;
+        if (lastThread[i][0] != firstThread)
+            threads = 2;
+    }
+    testOk(unscanned == 0, "%d lock sets not scanned", unscanned);
+    testOk(split == 0, "%d lock sets split between threads", split);
+    testOk(threads > 1, "Lock sets processed by several threads");
+    testOk(precC[0]->val > 1, "PHAS 1 records scanned %d times",
+        (int) precC[0]->val);
+    testOk(phaseErrors == 0, "%d PHAS 1 records processed early",
+        phaseErrors);
+    testOk(priorityErrors == 0,
+        "%d records processed at another scan priority", priorityErrors);
+
+    testOk1(scanPeriodicStatus(menuScan_1_second, 0, &stats) == 0);
+    testOk(stats.scans > 0 && stats.partitions == 3,
+        "%lu scans of %d partitions", stats.scans, stats.partitions);
+    testOk(stats.maxTime >= stats.lastTime && stats.avgTime > 0.0,
+        "Scan time last %f avg %f max %f",
+        stats.lastTime, stats.avgTime, stats.maxTime);
+    scanppl(0.1);
+
+    testOk1(scanPeriodicStatus(menuScan_1_second, 1, NULL) == 0);
+    testOk1(scanPeriodicStatus(menuScan_1_second, 0, &stats) == 0);
+    testOk(stats.scans == 0 && stats.maxTime == 0.0, "Statistics reset");
+
+    testIocShutdownOk();
+    testdbCleanup();
+
+    testOk1(scanPeriodicParallel(0) == 0);
+}
+
 MAIN(dbScanTest)
 {
-    testPlan(3);
+    testPlan(3 + 15);
     testOnce();
+    testPeriodicParallel();
     return testDone();
 }
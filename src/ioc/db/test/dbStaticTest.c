@@ -1,6 +1,7 @@
 #include <string.h>
 
 #include <errlog.h>
+#include <epicsStdio.h>
 #include <dbAccess.h>
 #include <dbStaticLib.h>
 #include <dbStaticPvt.h>
@@ -118,11 +119,68 @@ static void testRec2Entry(const char *recname)
     dbFinishEntry(&entry2);
 }
 
+#define NPVD 3000
+
+static void testPvd(void)
+{
+    DBENTRY entry;
+    char name[20];
+    int i, nFound, nGone;
+
+    testDiag("testPvd() with %d records", NPVD);
+
+    dbInitEntry(pdbbase, &entry);
+    for (i = 0; i < NPVD; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd%d", i);
+        if (dbFindRecordType(&entry, "x") ||
+            dbCreateRecord(&entry, name))
+            break;
+    }
+    testOk(i == NPVD, "Created %d records", i);
+
+    for (i = nFound = 0; i < NPVD; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd%d", i);
+        if (!dbFindRecord(&entry, name))
+            nFound++;
+    }
+    testOk(nFound == NPVD, "Found %d records", nFound);
+
+    for (i = 0; i < NPVD; i += 2) {
+        epicsSnprintf(name, sizeof(name), "pvd%d", i);
+        if (!dbFindRecord(&entry, name))
+            dbDeleteRecord(&entry);
+    }
+    for (i = nFound = nGone = 0; i < NPVD; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd%d", i);
+        if (dbFindRecord(&entry, name))
+            nGone += !(i & 1);
+        else
+            nFound += i & 1;
+    }
+    testOk(nFound == NPVD / 2 && nGone == NPVD / 2,
+        "Found %d remaining, %d deleted not found", nFound, nGone);
+
+    for (i = 1; i < NPVD; i += 2) {
+        epicsSnprintf(name, sizeof(name), "pvd%d", i);
+        if (!dbFindRecord(&entry, name))
+            dbDeleteRecord(&entry);
+    }
+    for (i = nFound = 0; i < NPVD; i++) {
+        epicsSnprintf(name, sizeof(name), "pvd%d", i);
+        if (!dbFindRecord(&entry, name))
+            nFound++;
+    }
+    testOk(nFound == 0, "%d records left after deleting all", nFound);
+    testOk1(dbFindRecord(&entry, "testalias3") == 0);
+
+    dbFinishEntry(&entry);
+}
+
 void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
 
 MAIN(dbStaticTest)
 {
-    testPlan(200);
+    testPlan(205);
     testdbPrepare();
 
     testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
@@ -141,6 +199,7 @@ MAIN(dbStaticTest)
     testRec2Entry("testalias");
     testRec2Entry("testalias2");
     testRec2Entry("testalias3");
+    testPvd();
 
     eltc(0);
     testIocInitOk();
@@ -19,10 +19,13 @@
 int testdbConvert(void);
 int callbackTest(void);
 int callbackParallelTest(void);
+int callbackQueueTest(void);
 int dbStateTest(void);
 int dbCaStatsTest(void);
 int dbShutdownTest(void);
 int dbScanTest(void);
+int dbProcTimeTest(void);
+int dbEventTest(void);
 int scanIoTest(void);
 int dbLockTest(void);
 int dbPutLinkTest(void);
@@ -40,10 +43,13 @@ void epicsRunDbTests(void)
     runTest(testdbConvert);
     runTest(callbackTest);
     runTest(callbackParallelTest);
+    runTest(callbackQueueTest);
     runTest(dbStateTest);
     runTest(dbCaStatsTest);
     runTest(dbShutdownTest);
     runTest(dbScanTest);
+    runTest(dbProcTimeTest);
+    runTest(dbEventTest);
     runTest(scanIoTest);
     runTest(dbLockTest);
     runTest(dbPutLinkTest);
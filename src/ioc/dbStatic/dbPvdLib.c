@@ -15,7 +15,6 @@
 #include <string.h>
 
 #include "dbDefs.h"
-#include "ellLib.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
 #include "epicsString.h"
@@ -25,22 +24,41 @@
 #include "dbStaticLib.h"
 #include "dbStaticPvt.h"
 
+/*
+ * The directory is an open-addressing hash table using Robin Hood
+ * insertion: an entry never sits further from its home slot than the
+ * entry it displaced, so probe sequences stay short and a lookup can
+ * stop as soon as it reaches an entry that is closer to home than the
+ * name being searched for would be.  Each slot keeps the full hash and
+ * the record name, so only true candidates have their names compared
+ * and a lookup doesn't have to follow the entry to get to the name.
+ */
+
 typedef struct {
-    ELLLIST      list;
-    epicsMutexId lock;
-} dbPvdBucket;
+    unsigned int hash;
+    const char   *recordname;
+    PVDENTRY     *ppvdNode;     /* NULL if the slot is empty */
+} dbPvdSlot;
 
 typedef struct dbPvd {
     unsigned int size;
     unsigned int mask;
-    dbPvdBucket **buckets;
+    unsigned int count;
+    unsigned int maxCount;      /* grow when count reaches this */
+    dbPvdSlot    *slots;
+    epicsMutexId lock;
 } dbPvd;
 
 unsigned int dbPvdHashTableSize = 0;
 
 #define MIN_SIZE 256
 #define DEFAULT_SIZE 512
-#define MAX_SIZE 65536
+
+/* Load factor 7/8 */
+#define MAX_COUNT(size) ((size) - (size) / 8)
+
+/* How far the entry in slot i is from its home slot */
+#define DISTANCE(ppvd, hash, i) (((i) - (hash)) & (ppvd)->mask)
 
 
 int dbPvdTableSize(int size)
@@ -53,9 +71,6 @@ int dbPvdTableSize(int size)
     if (size < MIN_SIZE)
         size = MIN_SIZE;
 
-    if (size > MAX_SIZE)
-        size = MAX_SIZE;
-
     dbPvdHashTableSize = size;
     return 0;
 }
@@ -71,130 +86,182 @@ void dbPvdInitPvt(dbBase *pdbbase)
     }
 
     ppvd = (dbPvd *)dbMalloc(sizeof(dbPvd));
-    ppvd->size    = dbPvdHashTableSize;
-    ppvd->mask    = dbPvdHashTableSize - 1;
-    ppvd->buckets = dbCalloc(ppvd->size, sizeof(dbPvdBucket *));
+    ppvd->size     = dbPvdHashTableSize;
+    ppvd->mask     = dbPvdHashTableSize - 1;
+    ppvd->count    = 0;
+    ppvd->maxCount = MAX_COUNT(ppvd->size);
+    ppvd->slots    = dbCalloc(ppvd->size, sizeof(dbPvdSlot));
+    ppvd->lock     = epicsMutexMustCreate();
 
     pdbbase->ppvd = ppvd;
     return;
 }
 
+/* Caller must hold the lock */
+static void dbPvdInsert(dbPvd *ppvd, dbPvdSlot entry)
+{
+    unsigned int i = entry.hash & ppvd->mask;
+    unsigned int dist = 0;
+
+    while (ppvd->slots[i].ppvdNode) {
+        dbPvdSlot *pslot = &ppvd->slots[i];
+        unsigned int slotDist = DISTANCE(ppvd, pslot->hash, i);
+
+        if (slotDist < dist) {
+            /* Take the slot, carry on inserting the one we displaced */
+            dbPvdSlot displaced = *pslot;
+
+            *pslot = entry;
+            entry = displaced;
+            dist = slotDist;
+        }
+        i = (i + 1) & ppvd->mask;
+        dist++;
+    }
+    ppvd->slots[i] = entry;
+}
+
+/* Caller must hold the lock */
+static void dbPvdGrow(dbPvd *ppvd)
+{
+    dbPvdSlot *oldSlots = ppvd->slots;
+    unsigned int oldSize = ppvd->size;
+    unsigned int i;
+
+    ppvd->size     = oldSize * 2;
+    ppvd->mask     = ppvd->size - 1;
+    ppvd->maxCount = MAX_COUNT(ppvd->size);
+    ppvd->slots    = dbCalloc(ppvd->size, sizeof(dbPvdSlot));
+
+    for (i = 0; i < oldSize; i++) {
+        if (oldSlots[i].ppvdNode)
+            dbPvdInsert(ppvd, oldSlots[i]);
+    }
+    free(oldSlots);
+}
+
+/* Returns the slot index of name, or -1.  Caller must hold the lock */
+static int dbPvdLookup(dbPvd *ppvd, unsigned int hash,
+    const char *name, size_t lenName)
+{
+    unsigned int i = hash & ppvd->mask;
+    unsigned int dist = 0;
+
+    for (;;) {
+        dbPvdSlot *pslot = &ppvd->slots[i];
+
+        if (!pslot->ppvdNode ||
+            DISTANCE(ppvd, pslot->hash, i) < dist)
+            return -1;
+
+        if (pslot->hash == hash &&
+            strncmp(name, pslot->recordname, lenName) == 0 &&
+            pslot->recordname[lenName] == '\0')
+            return (int) i;
+        i = (i + 1) & ppvd->mask;
+        dist++;
+    }
+}
+
 PVDENTRY *dbPvdFind(dbBase *pdbbase, const char *name, size_t lenName)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
-    PVDENTRY *ppvdNode;
-    
-    pbucket = ppvd->buckets[epicsMemHash(name, lenName, 0) & ppvd->mask];
-    if (pbucket == NULL) return NULL;
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        const char *recordname = ppvdNode->precnode->recordname;
-
-        if (strncmp(name, recordname, lenName) == 0 &&
-            strlen(recordname) == lenName)
-            break;
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
-    }
-    epicsMutexUnlock(pbucket->lock);
+    unsigned int hash = epicsMemHash(name, lenName, 0);
+    PVDENTRY *ppvdNode = NULL;
+    int i;
+
+    epicsMutexMustLock(ppvd->lock);
+    i = dbPvdLookup(ppvd, hash, name, lenName);
+    if (i >= 0)
+        ppvdNode = ppvd->slots[i].ppvdNode;
+    epicsMutexUnlock(ppvd->lock);
     return ppvdNode;
 }
-
+
 PVDENTRY *dbPvdAdd(dbBase *pdbbase, dbRecordType *precordType,
     dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
     PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
-    unsigned int h;
-
-    h = epicsStrHash(name, 0) & ppvd->mask;
-    pbucket = ppvd->buckets[h];
-    if (pbucket == NULL) {
-        pbucket = dbCalloc(1, sizeof(dbPvdBucket));
-        ellInit(&pbucket->list);
-        pbucket->lock = epicsMutexCreate();
-        ppvd->buckets[h] = pbucket;
-    }
+    dbPvdSlot entry;
 
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            epicsMutexUnlock(pbucket->lock);
-            return NULL;
-        }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+    entry.hash = epicsStrHash(name, 0);
+    entry.recordname = name;
+
+    epicsMutexMustLock(ppvd->lock);
+    if (dbPvdLookup(ppvd, entry.hash, name, strlen(name)) >= 0) {
+        epicsMutexUnlock(ppvd->lock);
+        return NULL;
     }
+    if (ppvd->count >= ppvd->maxCount)
+        dbPvdGrow(ppvd);
+
     ppvdNode = dbCalloc(1, sizeof(PVDENTRY));
     ppvdNode->precordType = precordType;
     ppvdNode->precnode = precnode;
-    ellAdd(&pbucket->list, (ELLNODE *)ppvdNode);
-    epicsMutexUnlock(pbucket->lock);
+    entry.ppvdNode = ppvdNode;
+    dbPvdInsert(ppvd, entry);
+    ppvd->count++;
+    epicsMutexUnlock(ppvd->lock);
     return ppvdNode;
 }
 
 void dbPvdDelete(dbBase *pdbbase, dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
-    PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
+    unsigned int i, next;
+    int found;
 
-    pbucket = ppvd->buckets[epicsStrHash(name, 0) & ppvd->mask];
-    if (pbucket == NULL) return;
-
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (ppvdNode->precnode &&
-            ppvdNode->precnode->recordname &&
-            strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
-            free(ppvdNode);
-            break;
-        }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+    if (!name) return;
+
+    epicsMutexMustLock(ppvd->lock);
+    found = dbPvdLookup(ppvd, epicsStrHash(name, 0), name, strlen(name));
+    if (found < 0) {
+        epicsMutexUnlock(ppvd->lock);
+        return;
     }
-    epicsMutexUnlock(pbucket->lock);
+    i = (unsigned int) found;
+    free(ppvd->slots[i].ppvdNode);
+
+    /* Shift the following entries back until one is at home */
+    next = (i + 1) & ppvd->mask;
+    while (ppvd->slots[next].ppvdNode &&
+           DISTANCE(ppvd, ppvd->slots[next].hash, next) > 0) {
+        ppvd->slots[i] = ppvd->slots[next];
+        i = next;
+        next = (next + 1) & ppvd->mask;
+    }
+    memset(&ppvd->slots[i], 0, sizeof(dbPvdSlot));
+    ppvd->count--;
+    epicsMutexUnlock(ppvd->lock);
     return;
 }
 
 void dbPvdFreeMem(dbBase *pdbbase)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    unsigned int h;
+    unsigned int i;
 
     if (ppvd == NULL) return;
     pdbbase->ppvd = NULL;
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
-
-        if (pbucket == NULL) continue;
-        epicsMutexMustLock(pbucket->lock);
-        ppvd->buckets[h] = NULL;
-        while ((ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list))) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
-            free(ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
-        epicsMutexDestroy(pbucket->lock);
-        free(pbucket);
+    for (i = 0; i < ppvd->size; i++) {
+        free(ppvd->slots[i].ppvdNode);
     }
-    free(ppvd->buckets);
+    epicsMutexDestroy(ppvd->lock);
+    free(ppvd->slots);
     free(ppvd);
 }
 
 void dbPvdDump(dbBase *pdbbase, int verbose)
 {
-    unsigned int empty = 0;
+    unsigned int hist[8] = {0};
+    unsigned int maxDist = 0;
+    double sumDist = 0.0;
     dbPvd *ppvd;
-    unsigned int h;
+    unsigned int i;
 
     if (!pdbbase) {
         fprintf(stderr,"pdbbase not specified\n");
@@ -203,27 +270,30 @@ void dbPvdDump(dbBase *pdbbase, int verbose)
     ppvd = pdbbase->ppvd;
     if (ppvd == NULL) return;
 
-    printf("Process Variable Directory has %u buckets", ppvd->size);
-
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
-        int i = 1;
-
-        if (pbucket == NULL) {
-            empty++;
-            continue;
-        }
-        epicsMutexMustLock(pbucket->lock);
-        ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-        printf("\n [%4u] %4d  ", h, ellCount(&pbucket->list));
-        while (ppvdNode && verbose) {
-            if (!(++i % 4))
-                printf("\n         ");
-            printf("  %s", ppvdNode->precnode->recordname);
-            ppvdNode = (PVDENTRY *) ellNext((ELLNODE*)ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
+    epicsMutexMustLock(ppvd->lock);
+    printf("Process Variable Directory has %u entries in %u slots "
+        "(%.1f%% full)\n", ppvd->count, ppvd->size,
+        100.0 * ppvd->count / ppvd->size);
+
+    for (i = 0; i < ppvd->size; i++) {
+        dbPvdSlot *pslot = &ppvd->slots[i];
+        unsigned int dist;
+
+        if (!pslot->ppvdNode) continue;
+        dist = DISTANCE(ppvd, pslot->hash, i);
+        sumDist += dist;
+        if (dist > maxDist)
+            maxDist = dist;
+        hist[dist < NELEMENTS(hist) ? dist : NELEMENTS(hist) - 1]++;
+        if (verbose)
+            printf(" [%6u] %3u  %s\n", i, dist, pslot->recordname);
     }
-    printf("\n%u buckets empty.\n", empty);
+    printf("Probe length average %.2f, maximum %u\n",
+        ppvd->count ? 1.0 + sumDist / ppvd->count : 0.0, maxDist + 1);
+    printf("Probe lengths:");
+    for (i = 0; i < NELEMENTS(hist); i++)
+        printf(" %u%s:%u", i + 1, i == NELEMENTS(hist) - 1 ? "+" : "",
+            hist[i]);
+    printf("\n");
+    epicsMutexUnlock(ppvd->lock);
 }
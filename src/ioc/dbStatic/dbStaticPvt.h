@@ -96,7 +96,6 @@ typedef struct dbGuiGroup {
 /*The following are in dbPvdLib.c*/
 /*directory*/
 typedef struct{
-	ELLNODE		node;
 	dbRecordType	*precordType;
 	dbRecordNode	*precnode;
 }PVDENTRY;
@@ -175,11 +175,14 @@ long dbFreeRecord(DBENTRY *pdbentry)
 {
     dbRecordType *pdbRecordType = pdbentry->precordType;
     dbRecordNode *precnode = pdbentry->precnode;
+    dbCommonPvt *ppvt;
 
     if(!pdbRecordType) return(S_dbLib_recordTypeNotFound);
     if(!precnode) return(S_dbLib_recNotFound);
     if(!precnode->precord) return(S_dbLib_recNotFound);
-    free(CONTAINER(precnode->precord, dbCommonPvt, common));
+    ppvt = CONTAINER(precnode->precord, dbCommonPvt, common);
+    free(ppvt->ptime);
+    free(ppvt);
     precnode->precord = NULL;
     return(0);
 }
@@ -68,6 +68,8 @@ epicsShareExtern maplinkType pamaplinkType[];
 #define pvlOptOutNative  0x200	/*Output native*/
 #define pvlOptOutString  0x400	/*Output as string*/
 #define pvlOptTSELisTime 0x800	/*Field TSEL is getting timeStamp*/
+#define pvlOptFwdPool   0x1000	/*Forward link target has its own lock set*/
+#define pvlOptFwdDefer  0x2000	/*Forward link closes a loop, don't wait*/
 
 /* DBLINK Flag bits */
 #define DBLINK_FLAG_INITIALIZED    1 /* dbInitLink() called */
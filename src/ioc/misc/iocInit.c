@@ -52,6 +52,7 @@
 #include "dbFldTypes.h"
 #include "dbLock.h"
 #include "dbNotify.h"
+#include "dbParallelFwd.h"
 #include "dbScan.h"
 #include "dbStaticLib.h"
 #include "dbStaticPvt.h"
@@ -169,6 +170,7 @@ static int iocBuild_2(void)
     initHookAnnounce(initHookAfterFinishDevSup);
 
     scanInit();
+    dbParallelFwdInit();
     if (asInit()) {
         errlogPrintf("iocBuild: asInit Failed.\n");
         return -1;
@@ -708,6 +710,7 @@ int iocShutdown(void)
         /* stop and "join" threads */
         scanStop();
         callbackStop();
+        dbParallelFwdCleanup();
     }
     dbCaShutdown(); /* must be before dbFreeRecord and dbChannelExit */
     if (iocBuildMode==buildIsolated) {
@@ -23,6 +23,7 @@
 #include <stdarg.h>
 #include <limits.h>
 
+#include "epicsEndian.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
@@ -42,6 +43,7 @@
 #include "callback.h"
 #include "db_access.h"
 #include "db_access_routines.h"
+#include "db_convert.h"
 #include "dbChannel.h"
 #include "dbCommon.h"
 #include "dbEvent.h"
@@ -372,6 +374,16 @@ static int tcp_version_action ( caHdrLargeArray *mp, void *pPayload,
         return RSRV_ERROR;
     }
 
+    client->compressArrays = CA_V414 ( mp->m_count ) &&
+        ( mp->m_cid & CA_PROTO_VERSION_COMPRESS ) && casCompressThreshold;
+
+    if ( CA_V415 ( mp->m_count ) &&
+        ( mp->m_cid & CA_PROTO_VERSION_LOCAL ) && casLocalRingBytes ) {
+        SEND_LOCK ( client );
+        cas_local_offer ( client );
+        SEND_UNLOCK ( client );
+    }
+
     tmp = mp->m_dataType - CA_PROTO_PRIORITY_MIN;
     tmp *= epicsThreadPriorityCAServerHigh - epicsThreadPriorityCAServerLow;
     tmp /= CA_PROTO_PRIORITY_MAX - CA_PROTO_PRIORITY_MIN;
@@ -399,6 +411,18 @@ static int tcp_version_action ( caHdrLargeArray *mp, void *pPayload,
     return RSRV_OK;
 }
 
+/*
+ * local_transport_action()
+ */
+static int local_transport_action ( caHdrLargeArray *mp,
+    void *pPayload, struct client *client )
+{
+    SEND_LOCK ( client );
+    cas_local_switch ( client, mp->m_dataType == CA_LOCAL_ATTACH );
+    SEND_UNLOCK ( client );
+    return RSRV_OK;
+}
+
 /*
  * tcp_echo_action()
  */
@@ -479,6 +503,133 @@ static void no_read_access_event ( struct client *pClient,
     }
 }
 
+/*
+ * Converts the array of a snapshot to network format,
+ * arg points to its DBR type
+ */
+static int snapshot_to_net ( const void *pfrom, void *pto,
+    long no_elements, void *arg )
+{
+    const unsigned *pType = arg;
+
+    return caNetConvert ( *pType, pfrom, pto,
+        TRUE /* host -> net format */, no_elements ) != ECA_NORMAL;
+}
+
+/*
+ *  read_reply_ref()
+ *
+ *  Sends a large array from an event snapshot without copying it into
+ *  the send buffer.  Arrays that need no conversion to network format
+ *  are referenced in place.  Others are converted once per snapshot,
+ *  and that copy is shared by all the clients the update goes to.
+ *  Returns FALSE if the update must be sent the usual way.
+ *
+ *  !! LOCK needs to applied by caller !!
+ */
+static int read_reply_ref ( struct client *pClient,
+    struct event_ext *pevext, db_field_log *pfl, int eventsRemaining )
+{
+    const ca_uint16_t type = pevext->msg.m_dataType;
+    const unsigned baseType = type % ( LAST_TYPE + 1 );
+    const unsigned valueSize = dbr_value_size[type];
+    struct dbr_time_double meta;
+    unsigned hdrSize;
+    long count;
+    ca_uint32_t payloadSize;
+    void ( *release ) ( void * );
+    const void *pRef;
+    void *pvt;
+    int status;
+
+    if ( pfl->type != dbfl_type_ref || ! pfl->u.r.field ) {
+        return FALSE;
+    }
+    if ( dbr_type_is_plain ( type ) ) {
+        hdrSize = 0u;
+    }
+    else if ( dbr_type_is_TIME ( type ) ) {
+        hdrSize = dbr_value_offset[type];
+    }
+    else {
+        return FALSE;
+    }
+
+    /* the array must already be in the requested type */
+    if ( baseType == DBR_STRING ||
+         pfl->field_type < 0 || pfl->field_type > newDBR_ENUM ||
+         dbDBRnewToDBRold[pfl->field_type] != baseType ||
+         pfl->field_size != valueSize ||
+         ( valueSize > 1u &&
+           dbDBRoldToDBFnew[baseType] != pfl->field_type ) ) {
+        return FALSE;
+    }
+
+    count = pevext->msg.m_count ? (long) pevext->msg.m_count : pfl->no_elements;
+    if ( count <= 0 || count > pfl->no_elements ) {
+        return FALSE;
+    }
+    payloadSize = dbr_size_n ( type, count );
+    if ( payloadSize <= MAX_TCP ) {
+        return FALSE;
+    }
+
+    memset ( &meta, 0, sizeof ( meta ) );
+    meta.status = htons ( pfl->stat );
+    meta.severity = htons ( pfl->sevr );
+    meta.stamp.secPastEpoch = htonl ( pfl->time.secPastEpoch );
+    meta.stamp.nsec = htonl ( pfl->time.nsec );
+    assert ( hdrSize <= sizeof ( meta ) );
+
+    pvt = db_event_snapshot_hold ( pfl );
+    if ( pvt && ( valueSize == 1u ||
+           ( EPICS_BYTE_ORDER == EPICS_ENDIAN_BIG &&
+             EPICS_FLOAT_WORD_ORDER == EPICS_ENDIAN_BIG ) ) ) {
+        pRef = pfl->u.r.field;
+        release = db_event_snapshot_release;
+    }
+    else if ( pvt && ( pRef = db_event_snapshot_convert ( pfl,
+                snapshot_to_net, (void *) &baseType ) ) ) {
+        release = db_event_snapshot_release;
+    }
+    else {
+        db_event_snapshot_release ( pvt );
+        pvt = malloc ( count * valueSize );
+        if ( ! pvt ) {
+            return FALSE;
+        }
+        if ( caNetConvert ( baseType, pfl->u.r.field, pvt,
+                TRUE /* host -> net format */, count ) != ECA_NORMAL ) {
+            free ( pvt );
+            return FALSE;
+        }
+        pRef = pvt;
+        release = free;
+    }
+
+    if ( cas_copy_in_compressed ( pClient, pevext->msg.m_cmmd, payloadSize,
+            type, count, ECA_NORMAL, pevext->msg.m_available,
+            &meta, hdrSize, pRef, count * valueSize ) ) {
+        ( *release ) ( pvt );
+        if ( ! eventsRemaining )
+            cas_send_bs_msg ( pClient, FALSE );
+        return TRUE;
+    }
+
+    status = cas_copy_in_ref ( pClient, pevext->msg.m_cmmd, payloadSize,
+        type, count, ECA_NORMAL, pevext->msg.m_available,
+        &meta, hdrSize, pRef, count * valueSize, release, pvt );
+    if ( status != ECA_NORMAL ) {
+        ( *release ) ( pvt );
+        return FALSE;
+    }
+
+    if ( ! eventsRemaining )
+        cas_send_bs_msg ( pClient, FALSE );
+
+    return TRUE;
+}
+
 /*
  *  read_reply()
  */
@@ -496,10 +647,17 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
     int local_fl = 0;
     long item_count;
     ca_uint32_t payload_size;
+    unsigned msgStart;
     dbAddr *paddr=&dbch->addr;
 
     SEND_LOCK ( pClient );
 
+    if ( readAccess && pfl && read_reply_ref ( pClient, pevext, pfl,
+            eventsRemaining ) ) {
+        SEND_UNLOCK ( pClient );
+        return;
+    }
+
     cid = ECA_NORMAL;
 
     /* If the client has requested a zero element count we interpret this as a
@@ -591,7 +749,10 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
             memset ( pPayload, 0, payload_size );
             cas_set_header_cid ( pClient, cacStatus );
         }
+        msgStart = pClient->send.stk;
         cas_commit_msg ( pClient, payload_size );
+        if ( cacStatus == ECA_NORMAL )
+            cas_compress_msg ( pClient, msgStart );
     }
 
     /*
@@ -2338,7 +2499,9 @@ static const pProtoStubTCP tcpJumpTable[] =
     bad_tcp_cmd_action,
     bad_tcp_cmd_action,
     bad_tcp_cmd_action,
-    bad_tcp_cmd_action
+    bad_tcp_cmd_action,
+    bad_tcp_cmd_action,
+    local_transport_action
 };
 
 /*
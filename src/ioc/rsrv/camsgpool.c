@@ -0,0 +1,372 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Services the TCP circuits of many clients with a fixed pool of
+ *  I/O threads instead of one receive thread per client.
+ *
+ *  Every circuit is registered with a single epoll instance using
+ *  EPOLLONESHOT, so only one pool thread at a time receives and
+ *  processes the requests of a client, which keeps them in order.
+ *  The circuit is re-armed once the thread is done with it.
+ *
+ *  The sockets don't block.  A circuit whose replies don't fit in
+ *  the socket is re-armed for EPOLLOUT instead of EPOLLIN, so no
+ *  further requests are read from that client until its backlog
+ *  has been sent.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(__linux__)
+#   include <sys/epoll.h>
+#   include <poll.h>
+#   define CAS_HAVE_EPOLL
+#endif
+
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "epicsSignal.h"
+#include "epicsStdio.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "osiSock.h"
+#include "taskwd.h"
+
+#include "caerr.h"
+
+#define epicsExportSharedSymbols
+#include "rsrv.h"
+#include "server.h"
+
+/*
+ * Requests received from a client before the thread moves on,
+ * so that one busy client can't hold a pool thread indefinitely
+ */
+#define CAS_POOL_RECV_BURST 16
+#define CAS_POOL_MAX_EVENTS 32
+
+typedef struct casIoThread {
+    epicsThreadId   tid;
+    unsigned long   wakeups;        /* epoll_wait() returns */
+    unsigned long   dispatches;     /* circuits serviced */
+    unsigned long   receives;       /* socket reads processed */
+    unsigned long   disconnects;
+    double          busy;           /* seconds spent servicing */
+} casIoThread;
+
+static casIoThread *ioThreads;
+static unsigned nIoThreads;
+static epicsTimeStamp poolStarted;
+static epicsThreadPrivateId ioThreadPrivate;
+
+#ifdef CAS_HAVE_EPOLL
+
+static int epollFd = -1;
+
+/*
+ * True while replies are waiting for the socket to take them
+ */
+static int casPoolBacklogged ( struct client *client )
+{
+    int backlogged;
+
+    SEND_LOCK ( client );
+    backlogged = client->pBacklog != NULL;
+    SEND_UNLOCK ( client );
+    return backlogged;
+}
+
+/*
+ * Services one circuit, returns the events to re-arm it with,
+ * or zero when the client must be destroyed
+ */
+static unsigned casPoolService ( casIoThread *pThread, struct client *client )
+{
+    unsigned n;
+    int status = 0;
+
+    epicsThreadPrivateSet ( rsrvCurrentClient, client );
+
+    for ( n = 0; n < CAS_POOL_RECV_BURST; n++ ) {
+        if ( castcp_ctl != ctlRun || client->disconnect ) {
+            status = -1;
+            break;
+        }
+        if ( casPoolBacklogged ( client ) ) {
+            break;
+        }
+        status = camsgrecv ( client, MSG_DONTWAIT );
+        if ( status ) {
+            break;
+        }
+        pThread->receives++;
+    }
+
+    /*
+     * always flush before re-arming, nothing else would send
+     * the replies if the client now waits for them
+     */
+    if ( status >= 0 ) {
+        cas_send_bs_msg ( client, TRUE );
+        status = client->disconnect ? -1 : 0;
+    }
+
+    epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+
+    if ( status < 0 ) {
+        return 0u;
+    }
+    return casPoolBacklogged ( client ) ? EPOLLOUT : EPOLLIN;
+}
+
+static void casPoolRemove ( struct client *client )
+{
+    epoll_ctl ( epollFd, EPOLL_CTL_DEL, client->sock, NULL );
+
+    LOCK_CLIENTQ;
+    ellDelete ( &clientQ, &client->node );
+    UNLOCK_CLIENTQ;
+
+    destroy_tcp_client ( client );
+}
+
+static void casIoThreadMain ( void *pParm )
+{
+    casIoThread *pThread = (casIoThread *) pParm;
+    struct epoll_event events[CAS_POOL_MAX_EVENTS];
+
+    epicsSignalInstallSigAlarmIgnore ();
+    epicsSignalInstallSigPipeIgnore ();
+    epicsThreadPrivateSet ( ioThreadPrivate, pThread );
+    taskwdInsert ( epicsThreadGetIdSelf (), NULL, NULL );
+
+    while ( TRUE ) {
+        int i, nevents;
+
+        nevents = epoll_wait ( epollFd, events, NELEMENTS ( events ), -1 );
+        if ( nevents < 0 ) {
+            if ( errno != EINTR ) {
+                char sockErrBuf[64];
+                epicsSocketConvertErrnoToString (
+                    sockErrBuf, sizeof ( sockErrBuf ) );
+                errlogPrintf ( "CAS: I/O thread wait failed - %s\n",
+                    sockErrBuf );
+                epicsThreadSleep ( 1.0 );
+            }
+            continue;
+        }
+        pThread->wakeups++;
+
+        for ( i = 0; i < nevents; i++ ) {
+            struct client *client = (struct client *) events[i].data.ptr;
+            epicsTimeStamp start, done;
+            unsigned rearm;
+
+            epicsTimeGetCurrent ( &start );
+            pThread->dispatches++;
+
+            rearm = casPoolService ( pThread, client );
+            if ( ! rearm ) {
+                pThread->disconnects++;
+                casPoolRemove ( client );
+            }
+            else {
+                struct epoll_event ev;
+
+                memset ( &ev, 0, sizeof ( ev ) );
+                ev.events = rearm | EPOLLONESHOT;
+                ev.data.ptr = client;
+                if ( epoll_ctl ( epollFd, EPOLL_CTL_MOD, client->sock, &ev ) ) {
+                    pThread->disconnects++;
+                    casPoolRemove ( client );
+                }
+            }
+
+            epicsTimeGetCurrent ( &done );
+            pThread->busy += epicsTimeDiffInSeconds ( &done, &start );
+        }
+    }
+}
+
+/*
+ *  casPoolInit()
+ *
+ *  Starts nThreads I/O threads, returns RSRV_OK or RSRV_ERROR
+ */
+int casPoolInit ( unsigned nThreads )
+{
+    unsigned i;
+
+    if ( nThreads == 0 || ioThreads ) {
+        return RSRV_ERROR;
+    }
+
+    epollFd = epoll_create1 ( EPOLL_CLOEXEC );
+    if ( epollFd < 0 ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString (
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        errlogPrintf ( "CAS: epoll_create failed - %s\n", sockErrBuf );
+        return RSRV_ERROR;
+    }
+
+    ioThreadPrivate = epicsThreadPrivateCreate ();
+    ioThreads = callocMustSucceed ( nThreads, sizeof ( casIoThread ),
+        "casPoolInit" );
+    nIoThreads = nThreads;
+    epicsTimeGetCurrent ( &poolStarted );
+
+    for ( i = 0; i < nThreads; i++ ) {
+        char name[20];
+
+        epicsSnprintf ( name, sizeof ( name ), "CAS-io%u", i );
+        ioThreads[i].tid = epicsThreadMustCreate ( name,
+            epicsThreadPriorityCAServerLow,
+            epicsThreadGetStackSize ( epicsThreadStackBig ),
+            casIoThreadMain, &ioThreads[i] );
+    }
+    return RSRV_OK;
+}
+
+/*
+ *  casPoolAdd()
+ *
+ *  Hands a new circuit to the I/O threads.  The client must
+ *  already be on clientQ, and is destroyed here on failure.
+ */
+int casPoolAdd ( struct client *client )
+{
+    struct epoll_event ev;
+    osiSockIoctl_t yes = TRUE;
+    int status;
+
+    if ( socket_ioctl ( client->sock, FIONBIO, &yes ) ) {
+        LOCK_CLIENTQ;
+        ellDelete ( &clientQ, &client->node );
+        UNLOCK_CLIENTQ;
+        destroy_tcp_client ( client );
+        return RSRV_ERROR;
+    }
+    client->pooled = TRUE;
+
+    /*
+     * send the server's minor version number to the client
+     */
+    status = cas_copy_in_header ( client, CA_PROTO_VERSION, 0,
+        0, CA_MINOR_PROTOCOL_REVISION, 0, 0, 0 );
+    if ( status == ECA_NORMAL ) {
+        cas_send_bs_msg ( client, TRUE );
+
+        memset ( &ev, 0, sizeof ( ev ) );
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.ptr = client;
+        status = epoll_ctl ( epollFd, EPOLL_CTL_ADD, client->sock, &ev );
+    }
+    else {
+        status = -1;
+    }
+    if ( status ) {
+        LOCK_CLIENTQ;
+        ellDelete ( &clientQ, &client->node );
+        UNLOCK_CLIENTQ;
+        destroy_tcp_client ( client );
+        return RSRV_ERROR;
+    }
+    return RSRV_OK;
+}
+
+/*
+ *  casPoolWaitWritable()
+ *
+ *  Waits up to a second for the socket of a pooled client to take
+ *  data again, for threads other than the CAS-io threads
+ */
+void casPoolWaitWritable ( struct client *client )
+{
+    struct pollfd pfd;
+
+    pfd.fd = client->sock;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    poll ( &pfd, 1, 1000 );
+}
+
+#else /* CAS_HAVE_EPOLL */
+
+int casPoolInit ( unsigned nThreads )
+{
+    errlogPrintf ( "CAS: EPICS_CAS_IO_THREADS is not supported on this "
+        "target, using a thread per client\n" );
+    return RSRV_ERROR;
+}
+
+int casPoolAdd ( struct client *client )
+{
+    return RSRV_ERROR;
+}
+
+void casPoolWaitWritable ( struct client *client )
+{
+    epicsThreadSleep ( 0.01 );
+}
+
+#endif /* CAS_HAVE_EPOLL */
+
+int casPoolRunning ( void )
+{
+    return nIoThreads > 0;
+}
+
+int casPoolInIoThread ( void )
+{
+    return ioThreadPrivate && epicsThreadPrivateGet ( ioThreadPrivate );
+}
+
+/*
+ *  casPoolShow()
+ *
+ *  Reports the load of each I/O thread
+ */
+void casPoolShow ( unsigned level )
+{
+    epicsTimeStamp now;
+    double elapsed;
+    unsigned i;
+
+    if ( ! nIoThreads ) {
+        return;
+    }
+
+    epicsTimeGetCurrent ( &now );
+    elapsed = epicsTimeDiffInSeconds ( &now, &poolStarted );
+    if ( elapsed <= 0.0 ) {
+        elapsed = 1.0;
+    }
+
+    printf ( "%u CAS-io thread%s servicing the TCP circuits\n",
+        nIoThreads, nIoThreads == 1 ? "" : "s" );
+    if ( level < 1u ) {
+        return;
+    }
+    printf ( "    %-10s %10s %10s %10s %8s %6s\n", "Thread",
+        "Wakeups", "Dispatches", "Receives", "Discons", "Busy%" );
+    for ( i = 0; i < nIoThreads; i++ ) {
+        casIoThread *pThread = &ioThreads[i];
+        char name[20];
+
+        epicsThreadGetName ( pThread->tid, name, sizeof ( name ) );
+        printf ( "    %-10s %10lu %10lu %10lu %8lu %6.2f\n", name,
+            pThread->wakeups, pThread->dispatches, pThread->receives,
+            pThread->disconnects, 100.0 * pThread->busy / elapsed );
+    }
+}
@@ -34,6 +34,113 @@
 #include "rsrv.h"
 #include "server.h"
 
+/*
+ *  camsgrecv()
+ *
+ *  Receives whatever the client has sent and processes the complete
+ *  messages. Returns 0 while the circuit is up, 1 if MSG_DONTWAIT was
+ *  given in flags and nothing could be read, and -1 when the client
+ *  should be disconnected.
+ */
+int camsgrecv ( struct client *client, int flags )
+{
+    osiSockIoctl_t nchars;
+    int status;
+
+    client->recv.stk = 0;
+    assert ( client->recv.maxstk >= client->recv.cnt );
+    nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt], 
+            (int) ( client->recv.maxstk - client->recv.cnt ), flags );
+    if ( nchars == 0 ){
+        if ( CASDEBUG > 0 ) {
+            /* convert to u long so that %lu works on both 32 and 64 bit archs */
+            unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
+            errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
+                cnt );
+        }
+        return -1;
+    }
+    else if ( nchars < 0 ) {
+        int anerrno = SOCKERRNO;
+
+        if ( anerrno == SOCK_EINTR ) {
+            return 0;
+        }
+
+        if ( anerrno == SOCK_EWOULDBLOCK && flags ) {
+            return 1;
+        }
+
+        if ( anerrno == SOCK_ENOBUFS && flags ) {
+            return 1;
+        }
+
+        if ( anerrno == SOCK_ENOBUFS ) {
+            errlogPrintf (
+                "CAS: Out of network buffers, retring receive in 15 seconds\n" );
+            epicsThreadSleep ( 15.0 );
+            return 0;
+        }
+
+        /*
+         * normal conn lost conditions
+         */
+        if (    ( anerrno != SOCK_ECONNABORTED &&
+            anerrno != SOCK_ECONNRESET &&
+            anerrno != SOCK_ETIMEDOUT ) ||
+            CASDEBUG > 2 ) {
+            char sockErrBuf[64];
+
+            epicsSocketConvertErrorToString(
+                sockErrBuf, sizeof ( sockErrBuf ), anerrno);
+            errlogPrintf ( "CAS: Client disconnected - %s\n",
+                sockErrBuf );
+        }
+        return -1;
+    }
+
+    epicsTimeGetCurrent ( &client->time_at_last_recv );
+    client->recv.cnt += ( unsigned ) nchars;
+
+    status = camessage ( client );
+    if (status == 0) {
+        /*
+         * if there is a partial message
+         * align it with the start of the buffer
+         */
+        if (client->recv.cnt > client->recv.stk) {
+            unsigned bytes_left;
+
+            bytes_left = client->recv.cnt - client->recv.stk;
+
+            /*
+             * overlapping regions handled
+             * properly by memmove 
+             */
+            memmove (client->recv.buf, 
+                &client->recv.buf[client->recv.stk], bytes_left);
+            client->recv.cnt = bytes_left;
+        }
+        else {
+            client->recv.cnt = 0ul;
+        }
+    }
+    else {
+        char buf[64];
+        
+        client->recv.cnt = 0ul;
+        
+        /*
+         * disconnect when there are severe message errors
+         */
+        ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+        epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
+        return -1;
+    }
+
+    return 0;
+}
+
 /*
  *  camsgtask()
  *
@@ -79,88 +186,9 @@ void camsgtask ( void *pParm )
             cas_send_bs_msg(client, TRUE);
         }
 
-        client->recv.stk = 0;
-        assert ( client->recv.maxstk >= client->recv.cnt );
-        nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt], 
-                (int) ( client->recv.maxstk - client->recv.cnt ), 0 );
-        if ( nchars == 0 ){
-            if ( CASDEBUG > 0 ) {
-                /* convert to u long so that %lu works on both 32 and 64 bit archs */
-                unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
-                errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
-                    cnt );
-            }
-            break;
-        }
-        else if ( nchars < 0 ) {
-            int anerrno = SOCKERRNO;
-
-            if ( anerrno == SOCK_EINTR ) {
-                continue;
-            }
-
-            if ( anerrno == SOCK_ENOBUFS ) {
-                errlogPrintf (
-                    "CAS: Out of network buffers, retring receive in 15 seconds\n" );
-                epicsThreadSleep ( 15.0 );
-                continue;
-            }
-
-            /*
-             * normal conn lost conditions
-             */
-            if (    ( anerrno != SOCK_ECONNABORTED &&
-                anerrno != SOCK_ECONNRESET &&
-                anerrno != SOCK_ETIMEDOUT ) ||
-                CASDEBUG > 2 ) {
-                char sockErrBuf[64];
-
-                epicsSocketConvertErrorToString(
-                    sockErrBuf, sizeof ( sockErrBuf ), anerrno);
-                errlogPrintf ( "CAS: Client disconnected - %s\n",
-                    sockErrBuf );
-            }
+        if ( camsgrecv ( client, 0 ) < 0 ) {
             break;
         }
-
-        epicsTimeGetCurrent ( &client->time_at_last_recv );
-        client->recv.cnt += ( unsigned ) nchars;
-
-        status = camessage ( client );
-        if (status == 0) {
-            /*
-             * if there is a partial message
-             * align it with the start of the buffer
-             */
-            if (client->recv.cnt > client->recv.stk) {
-                unsigned bytes_left;
-
-                bytes_left = client->recv.cnt - client->recv.stk;
-
-                /*
-                 * overlapping regions handled
-                 * properly by memmove 
-                 */
-                memmove (client->recv.buf, 
-                    &client->recv.buf[client->recv.stk], bytes_left);
-                client->recv.cnt = bytes_left;
-            }
-            else {
-                client->recv.cnt = 0ul;
-            }
-        }
-        else {
-            char buf[64];
-            
-            client->recv.cnt = 0ul;
-            
-            /*
-             * disconnect when there are severe message errors
-             */
-            ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-            epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
-                break;
-        }
     }
 
     LOCK_CLIENTQ;
@@ -21,25 +21,306 @@
 #include <errno.h>
 #include <limits.h>
 
+#if !defined(_WIN32) && !defined(vxWorks)
+#   include <sys/uio.h>
+#   define CAS_HAVE_SENDMSG
+#endif
+
+#if defined(__linux__)
+#   include <poll.h>
+#endif
+
 #include "dbDefs.h"
 #include "epicsSignal.h"
 #include "epicsTime.h"
 #include "errlog.h"
 #include "osiSock.h"
 
+#include "caCompress.h"
+#include "caLocalRing.h"
 #include "caerr.h"
+#include "db_access.h"
 #include "net_convert.h"
 
 #define epicsExportSharedSymbols
 #include "server.h"
 
+/*
+ *  cas_release_refs()
+ *
+ *  Drops the payloads referenced by the send buffer,
+ *  send lock must be on
+ */
+void cas_release_refs ( struct client *pclient )
+{
+    unsigned i;
+
+    for ( i = 0u; i < pclient->nSendRef; i++ ) {
+        struct send_ref *pRef = &pclient->sendRef[i];
+        if ( pRef->release ) {
+            ( *pRef->release ) ( pRef->pvt );
+        }
+    }
+    pclient->nSendRef = 0u;
+}
+
+/*
+ * Position within the send buffer and the referenced
+ * payloads up to which the data has been sent
+ */
+typedef struct send_cursor {
+    unsigned bufSent;
+    unsigned ref;
+    unsigned refSent;
+} send_cursor;
+
+/*
+ *  cas_sendv()
+ *
+ *  Sends the unsent part of the buffer together with the
+ *  payloads it references, returns what send() would.
+ */
+static int cas_sendv ( struct client *pclient, const send_cursor *pCur )
+{
+#ifdef CAS_HAVE_SENDMSG
+    struct iovec iov[2 * CAS_SEND_REFS + 1];
+    struct msghdr msg;
+    unsigned bufPos = pCur->bufSent;
+    unsigned refSent = pCur->refSent;
+    unsigned i, n = 0u;
+
+    for ( i = pCur->ref; i < pclient->nSendRef; i++ ) {
+        struct send_ref *pRef = &pclient->sendRef[i];
+        if ( pRef->offset > bufPos ) {
+            iov[n].iov_base = &pclient->send.buf[bufPos];
+            iov[n].iov_len = pRef->offset - bufPos;
+            n++;
+        }
+        iov[n].iov_base = ( char * ) pRef->pData + refSent;
+        iov[n].iov_len = pRef->size - refSent;
+        n++;
+        bufPos = pRef->offset;
+        refSent = 0u;
+    }
+    if ( pclient->send.stk > bufPos ) {
+        iov[n].iov_base = &pclient->send.buf[bufPos];
+        iov[n].iov_len = pclient->send.stk - bufPos;
+        n++;
+    }
+
+    memset ( &msg, 0, sizeof ( msg ) );
+    msg.msg_iov = iov;
+    msg.msg_iovlen = n;
+    return sendmsg ( pclient->sock, &msg, 0 );
+#else
+    /* no scatter/gather, send one piece at a time */
+    if ( pCur->ref < pclient->nSendRef ) {
+        struct send_ref *pRef = &pclient->sendRef[pCur->ref];
+        if ( pRef->offset > pCur->bufSent ) {
+            return send ( pclient->sock, &pclient->send.buf[pCur->bufSent],
+                pRef->offset - pCur->bufSent, 0 );
+        }
+        return send ( pclient->sock, pRef->pData + pCur->refSent,
+            pRef->size - pCur->refSent, 0 );
+    }
+    return send ( pclient->sock, &pclient->send.buf[pCur->bufSent],
+        pclient->send.stk - pCur->bufSent, 0 );
+#endif
+}
+
+/*
+ * Advances the cursor past n sent bytes, returns
+ * true once everything has been sent
+ */
+static int cas_advance ( struct client *pclient, send_cursor *pCur,
+    unsigned n )
+{
+    while ( pCur->ref < pclient->nSendRef ) {
+        struct send_ref *pRef = &pclient->sendRef[pCur->ref];
+        unsigned avail = pRef->offset - pCur->bufSent;
+
+        if ( n < avail ) {
+            pCur->bufSent += n;
+            return FALSE;
+        }
+        n -= avail;
+        pCur->bufSent = pRef->offset;
+
+        avail = pRef->size - pCur->refSent;
+        if ( n < avail ) {
+            pCur->refSent += n;
+            return FALSE;
+        }
+        n -= avail;
+        pCur->ref++;
+        pCur->refSent = 0u;
+    }
+    pCur->bufSent += n;
+    return pCur->bufSent >= pclient->send.stk;
+}
+
+/*
+ * Puts one piece into the ring, returns true if all of it fit
+ */
+static int cas_put_local ( caLocalRing *pRing, const char *pData,
+    unsigned size, unsigned *pTotal )
+{
+    unsigned n = caLocalRingPut ( pRing, pData, size );
+    *pTotal += n;
+    return n == size;
+}
+
+/*
+ *  cas_local_hangup()
+ *
+ *  True if the client closed its end of the TCP circuit, which is
+ *  all that tells a writer waiting for space in the ring that the
+ *  client is gone.
+ */
+static int cas_local_hangup ( struct client *pclient )
+{
+#if defined(__linux__)
+    struct pollfd pfd;
+
+    pfd.fd = pclient->sock;
+    pfd.events = POLLRDHUP;
+    pfd.revents = 0;
+    if ( poll ( &pfd, 1, 0 ) > 0 &&
+            ( pfd.revents & ( POLLRDHUP | POLLHUP | POLLERR ) ) ) {
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
+
+/*
+ *  cas_send_local()
+ *
+ *  Puts what cas_sendv() would send into the shared memory ring of a
+ *  client on this host, and wakes the client up over TCP if it waits
+ *  for the ring.  Returns what send() would, except that zero means
+ *  that it waited for the client to make space in the ring.  A client
+ *  that hung up while the ring was full fails like a reset circuit.
+ */
+static int cas_send_local ( struct client *pclient, const send_cursor *pCur )
+{
+    caLocalRing *pRing = pclient->pLocalRing;
+    unsigned bufPos = pCur->bufSent;
+    unsigned refSent = pCur->refSent;
+    unsigned i, total = 0u;
+    int fit = TRUE;
+
+    for ( i = pCur->ref; i < pclient->nSendRef && fit; i++ ) {
+        struct send_ref *pRef = &pclient->sendRef[i];
+        if ( pRef->offset > bufPos ) {
+            fit = cas_put_local ( pRing, &pclient->send.buf[bufPos],
+                pRef->offset - bufPos, &total );
+        }
+        if ( fit ) {
+            fit = cas_put_local ( pRing, pRef->pData + refSent,
+                pRef->size - refSent, &total );
+        }
+        bufPos = pRef->offset;
+        refSent = 0u;
+    }
+    if ( fit && pclient->send.stk > bufPos ) {
+        cas_put_local ( pRing, &pclient->send.buf[bufPos],
+            pclient->send.stk - bufPos, &total );
+    }
+
+    if ( total == 0u ) {
+        caLocalRingWaitForSpace ( pRing, 1.0 );
+        if ( caLocalRingUsedBytes ( pRing ) == caLocalRingSize ( pRing ) &&
+                cas_local_hangup ( pclient ) ) {
+            errno = SOCK_ECONNRESET;
+            return -1;
+        }
+        return 0;
+    }
+    pclient->localRingBytes += total;
+
+    if ( caLocalRingWakeupNeeded ( pRing ) ) {
+        caHdr wakeup;
+        memset ( &wakeup, 0, sizeof ( wakeup ) );
+        wakeup.m_cmmd = htons ( CA_PROTO_LOCAL );
+        wakeup.m_dataType = htons ( CA_LOCAL_WAKEUP );
+        pclient->localRingWakeups++;
+        if ( send ( pclient->sock, ( char * ) &wakeup,
+                sizeof ( wakeup ), 0 ) < 0 ) {
+            return -1;
+        }
+    }
+    return ( int ) total;
+}
+
+/*
+ *  cas_spill()
+ *
+ *  Moves what is left to send of the send buffer and the payloads
+ *  it references to the end of the backlog, which is sent before
+ *  anything else once the socket of a pooled client takes data
+ *  again.  Send lock must be on.
+ */
+static int cas_spill ( struct client *pclient, const send_cursor *pCur )
+{
+    unsigned bufPos = pCur->bufSent;
+    unsigned refSent = pCur->refSent;
+    unsigned i, total = 0u, size;
+    char *pBacklog, *pOut;
+
+    for ( i = pCur->ref; i < pclient->nSendRef; i++ ) {
+        struct send_ref *pRef = &pclient->sendRef[i];
+        total += pRef->offset - bufPos + pRef->size - refSent;
+        bufPos = pRef->offset;
+        refSent = 0u;
+    }
+    total += pclient->send.stk - bufPos;
+
+    size = pclient->backlogSize - pclient->backlogSent;
+    if ( pclient->backlogSent ) {
+        memmove ( pclient->pBacklog,
+            &pclient->pBacklog[pclient->backlogSent], size );
+    }
+    pBacklog = realloc ( pclient->pBacklog, size + total );
+    if ( ! pBacklog ) {
+        return -1;
+    }
+    pOut = pBacklog + size;
+
+    bufPos = pCur->bufSent;
+    refSent = pCur->refSent;
+    for ( i = pCur->ref; i < pclient->nSendRef; i++ ) {
+        struct send_ref *pRef = &pclient->sendRef[i];
+        memcpy ( pOut, &pclient->send.buf[bufPos], pRef->offset - bufPos );
+        pOut += pRef->offset - bufPos;
+        memcpy ( pOut, pRef->pData + refSent, pRef->size - refSent );
+        pOut += pRef->size - refSent;
+        bufPos = pRef->offset;
+        refSent = 0u;
+    }
+    memcpy ( pOut, &pclient->send.buf[bufPos], pclient->send.stk - bufPos );
+
+    pclient->pBacklog = pBacklog;
+    pclient->backlogSize = size + total;
+    pclient->backlogSent = 0u;
+    cas_release_refs ( pclient );
+    pclient->send.stk = 0u;
+    return 0;
+}
+
 /*
  *  cas_send_bs_msg()
  *
  *  (channel access server send message)
+ *
+ *  The sockets of pooled clients don't block.  When one is full the
+ *  unsent data goes to the backlog, and a CAS-io thread returns at
+ *  once and waits for EPOLLOUT, while any other thread waits here
+ *  with the send lock released until everything has been sent.
  */
 void cas_send_bs_msg ( struct client *pclient, int lock_needed )
 {
+    send_cursor cursor = { 0u, 0u, 0u };
     int status;
 
     if ( CASDEBUG > 2 && pclient->send.stk ) {
@@ -51,7 +332,14 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
             errlogPrintf ( "CAS: msg Discard for sock %d addr %x\n",
                 pclient->sock, (unsigned) pclient->addr.sin_addr.s_addr );
         }
+        if ( lock_needed ) {
+            SEND_LOCK ( pclient );
+        }
+        cas_release_refs ( pclient );
         pclient->send.stk = 0u;
+        if ( lock_needed ) {
+            SEND_UNLOCK ( pclient );
+        }
         return;
     }
 
@@ -59,9 +347,41 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
         SEND_LOCK ( pclient );
     }
 
-    while ( pclient->send.stk && ! pclient->disconnect ) {
-        status = send ( pclient->sock, pclient->send.buf, pclient->send.stk, 0 );
-        if ( status >= 0 ) {
+    while ( ( pclient->send.stk || pclient->pBacklog ) &&
+            ! pclient->disconnect ) {
+        if ( pclient->pBacklog ) {
+            status = send ( pclient->sock,
+                &pclient->pBacklog[pclient->backlogSent],
+                pclient->backlogSize - pclient->backlogSent, 0 );
+            if ( status >= 0 ) {
+                pclient->backlogSent += (unsigned) status;
+                if ( pclient->backlogSent >= pclient->backlogSize ) {
+                    free ( pclient->pBacklog );
+                    pclient->pBacklog = NULL;
+                    pclient->backlogSize = pclient->backlogSent = 0u;
+                    epicsTimeGetCurrent ( &pclient->time_at_last_send );
+                }
+                continue;
+            }
+        }
+        else if ( pclient->pLocalRing ) {
+            status = cas_send_local ( pclient, &cursor );
+        }
+        else if ( pclient->nSendRef ) {
+            status = cas_sendv ( pclient, &cursor );
+        }
+        else {
+            status = send ( pclient->sock, pclient->send.buf, pclient->send.stk, 0 );
+        }
+        if ( status >= 0 && pclient->nSendRef ) {
+            if ( cas_advance ( pclient, &cursor, (unsigned) status ) ) {
+                cas_release_refs ( pclient );
+                pclient->send.stk = 0;
+                epicsTimeGetCurrent ( &pclient->time_at_last_send );
+                break;
+            }
+        }
+        else if ( status >= 0 ) {
             unsigned transferSize = (unsigned) status;
             if ( transferSize >= pclient->send.stk ) {
                 pclient->send.stk = 0;
@@ -81,6 +401,7 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
             char buf[64];
 
             if ( pclient->disconnect ) {
+                cas_release_refs ( pclient );
                 pclient->send.stk = 0u;
                 break;
             }
@@ -89,7 +410,21 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                 continue;
             }
 
-            if ( anerrno == SOCK_ENOBUFS ) {
+            if ( pclient->pooled && ( anerrno == SOCK_EWOULDBLOCK ||
+                    anerrno == SOCK_ENOBUFS ) ) {
+                if ( cas_spill ( pclient, &cursor ) == 0 ) {
+                    cursor.bufSent = cursor.ref = cursor.refSent = 0u;
+                    if ( casPoolInIoThread () ) {
+                        break;
+                    }
+                    SEND_UNLOCK ( pclient );
+                    casPoolWaitWritable ( pclient );
+                    SEND_LOCK ( pclient );
+                    continue;
+                }
+            }
+
+            if ( anerrno == SOCK_ENOBUFS && ! pclient->pooled ) {
                 errlogPrintf (
                     "CAS: Out of network buffers, retrying send in 15 seconds\n" );
                 epicsThreadSleep ( 15.0 );
@@ -113,6 +448,7 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                     buf, sockErrBuf);
             }
             pclient->disconnect = TRUE;
+            cas_release_refs ( pclient );
             pclient->send.stk = 0u;
 
             /*
@@ -275,6 +611,7 @@ int cas_copy_in_header (
 
     if ( pclient->send.stk > pclient->send.maxstk - msgSize ) {
         if ( pclient->disconnect ) {
+            cas_release_refs ( pclient );
             pclient->send.stk = 0;
         }
         else{
@@ -321,6 +658,294 @@ int cas_copy_in_header (
     return ECA_NORMAL;
 }
 
+/*
+ *
+ *  cas_copy_in_ref()
+ *
+ *  Adds a complete message whose payload is hdrSize bytes copied from
+ *  pHdr, followed by refSize bytes sent in place from pRef, and zeros
+ *  up to payloadSize.  release(pvt) is called once pRef is no longer
+ *  needed, unless the message couldn't be added, which is reported
+ *  by the returned status as in cas_copy_in_header().
+ *
+ *  This avoids copying large arrays into the send buffer, and having
+ *  to expand it for them.  TCP only, send lock must be on.
+ */
+int cas_copy_in_ref (
+    struct client *pclient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pHdr, unsigned hdrSize,
+    const void *pRef, unsigned refSize,
+    void ( *release ) ( void *pvt ), void *pvt )
+{
+    ca_uint32_t alignedPayloadSize;
+    unsigned hdrBytes = sizeof ( caHdr );
+    unsigned padBytes;
+    struct send_ref *pSendRef;
+    caHdr *pMsg;
+    char *pBuf;
+
+    if ( pclient->proto != IPPROTO_TCP ) {
+        return ECA_INTERNAL;
+    }
+
+    if ( payloadSize > UINT_MAX - sizeof ( caHdr ) - 8u ||
+        (ca_uint32_t) hdrSize + refSize > payloadSize ) {
+        return ECA_TOLARGE;
+    }
+
+    alignedPayloadSize = CA_MESSAGE_ALIGN ( payloadSize );
+    if ( alignedPayloadSize >= 0xffff || nElem >= 0xffff ) {
+        if ( ! CA_V49 ( pclient->minor_version_number ) ) {
+            return ECA_16KARRAYCLIENT;
+        }
+        hdrBytes += 2 * sizeof ( ca_uint32_t );
+    }
+
+    /* the same limit as for messages copied into a jumbo buffer */
+    if ( rsrvLargeBufFreeListTCP &&
+        alignedPayloadSize + hdrBytes > rsrvSizeofLargeBufTCP ) {
+        return ECA_TOLARGE;
+    }
+
+    padBytes = alignedPayloadSize - hdrSize - refSize;
+    if ( hdrBytes + hdrSize + padBytes > pclient->send.maxstk ) {
+        return ECA_TOLARGE;
+    }
+
+    if ( pclient->send.stk >
+            pclient->send.maxstk - ( hdrBytes + hdrSize + padBytes ) ||
+        pclient->nSendRef >= CAS_SEND_REFS ) {
+        if ( pclient->disconnect ) {
+            cas_release_refs ( pclient );
+            pclient->send.stk = 0;
+        }
+        else {
+            cas_send_bs_msg ( pclient, FALSE );
+        }
+    }
+
+    pMsg = (caHdr *) &pclient->send.buf[pclient->send.stk];
+    pMsg->m_cmmd = htons(response);
+    pMsg->m_dataType = htons(dataType);
+    pMsg->m_cid = htonl(cid);
+    pMsg->m_available = htonl(responseSpecific);
+    if ( hdrBytes == sizeof ( caHdr ) ) {
+        pMsg->m_postsize = htons(((ca_uint16_t) alignedPayloadSize));
+        pMsg->m_count = htons(((ca_uint16_t) nElem));
+    }
+    else {
+        ca_uint32_t *pW32 = (ca_uint32_t *) (pMsg + 1);
+        pMsg->m_postsize = htons(0xffff);
+        pMsg->m_count = htons(0u);
+        pW32[0] = htonl(alignedPayloadSize);
+        pW32[1] = htonl(nElem);
+    }
+
+    pBuf = &pclient->send.buf[pclient->send.stk + hdrBytes];
+    memcpy ( pBuf, pHdr, hdrSize );
+    pBuf += hdrSize;
+
+    pSendRef = &pclient->sendRef[pclient->nSendRef++];
+    pSendRef->pData = (const char *) pRef;
+    pSendRef->size = refSize;
+    pSendRef->offset = pclient->send.stk + hdrBytes + hdrSize;
+    pSendRef->release = release;
+    pSendRef->pvt = pvt;
+
+    /* zero out pad bytes */
+    memset ( pBuf, '\0', padBytes );
+
+    pclient->send.stk += hdrBytes + hdrSize + padBytes;
+
+    return ECA_NORMAL;
+}
+
+/*
+ *  cas_compress_array()
+ *
+ *  Compresses a value array into the client's scratch buffer, behind
+ *  hdrSpace bytes left for the caller to fill in.  Returns the size
+ *  of the compressed array, or zero if it is below the threshold or
+ *  doesn't shrink by at least an eighth.  Send lock must be on.
+ */
+static unsigned cas_compress_array ( struct client *pclient,
+    ca_uint16_t dataType, const void *pValue, unsigned valueBytes,
+    unsigned hdrSpace, unsigned *pEncoding, char **ppOut )
+{
+    unsigned workSize, maxBytes, bufSize, nBytes;
+    epicsTimeStamp started, done;
+
+    /* nothing is gained by compressing what goes through the ring */
+    if ( ! pclient->compressArrays || valueBytes < casCompressThreshold ||
+         pclient->pLocalRing ) {
+        return 0u;
+    }
+
+    workSize = CA_MESSAGE_ALIGN ( caCompressWorkSize ( valueBytes ) );
+    maxBytes = valueBytes - valueBytes / 8u;
+    bufSize = workSize + hdrSpace + maxBytes;
+    if ( bufSize > pclient->compressBufSize ) {
+        char *pNewBuf = realloc ( pclient->pCompressBuf, bufSize );
+        if ( ! pNewBuf ) {
+            return 0u;
+        }
+        pclient->pCompressBuf = pNewBuf;
+        pclient->compressBufSize = bufSize;
+    }
+
+    epicsTimeGetCurrent ( &started );
+    nBytes = caCompressArray ( dataType, pValue, valueBytes,
+        pclient->pCompressBuf + workSize + hdrSpace, maxBytes,
+        pclient->pCompressBuf, pEncoding );
+    epicsTimeGetCurrent ( &done );
+    pclient->compress.seconds += epicsTimeDiffInSeconds ( &done, &started );
+
+    *ppOut = pclient->pCompressBuf + workSize;
+    return nBytes;
+}
+
+/*
+ *  cas_put_compressed()
+ *
+ *  Adds a CA_PROTO_COMPRESSED message whose payload has been put
+ *  together in the scratch buffer
+ */
+static int cas_put_compressed ( struct client *pclient, const char *pPayload,
+    unsigned payloadSize, unsigned encoding, unsigned compressedBytes,
+    unsigned rawMsgSize )
+{
+    unsigned msgStart;
+    void *pDest;
+    int status;
+
+    status = cas_copy_in_header ( pclient, CA_PROTO_COMPRESSED, payloadSize,
+        encoding, 0u, compressedBytes, 0u, &pDest );
+    if ( status != ECA_NORMAL ) {
+        return FALSE;
+    }
+    msgStart = pclient->send.stk;
+    memcpy ( pDest, pPayload, payloadSize );
+    cas_commit_msg ( pclient, payloadSize );
+
+    pclient->compress.messages++;
+    pclient->compress.rawBytes += rawMsgSize;
+    pclient->compress.wireBytes += pclient->send.stk - msgStart;
+    return TRUE;
+}
+
+/*
+ *  cas_compress_msg()
+ *
+ *  Replaces the read or event response that was committed at offset
+ *  msgStart of the send buffer with a compressed one, if the client
+ *  asked for it and compression pays off.  Returns TRUE if it was
+ *  replaced.  Send lock must be on.
+ */
+int cas_compress_msg ( struct client *pclient, unsigned msgStart )
+{
+    caHdr *pMsg = (caHdr *) &pclient->send.buf[msgStart];
+    unsigned hdrSize = sizeof ( caHdr );
+    unsigned rawMsgSize = pclient->send.stk - msgStart;
+    ca_uint16_t dataType = ntohs ( pMsg->m_dataType );
+    ca_uint32_t payloadSize = ntohs ( pMsg->m_postsize );
+    ca_uint32_t nElem = ntohs ( pMsg->m_count );
+    unsigned prefixSize, valueBytes, encoding, nBytes;
+    char *pOut;
+
+    if ( ! pclient->compressArrays || dataType > LAST_BUFFER_TYPE ) {
+        return FALSE;
+    }
+    if ( payloadSize == 0xffff ) {
+        ca_uint32_t *pW32 = (ca_uint32_t *) ( pMsg + 1 );
+        payloadSize = ntohl ( pW32[0] );
+        nElem = ntohl ( pW32[1] );
+        hdrSize += 2 * sizeof ( ca_uint32_t );
+    }
+    prefixSize = dbr_value_offset[dataType];
+    valueBytes = dbr_size_n ( dataType, nElem );
+    if ( valueBytes > payloadSize ) {
+        return FALSE;
+    }
+    valueBytes -= prefixSize;
+
+    nBytes = cas_compress_array ( pclient, dataType,
+        (char *) pMsg + hdrSize + prefixSize, valueBytes,
+        hdrSize + prefixSize, &encoding, &pOut );
+    if ( ! nBytes ) {
+        return FALSE;
+    }
+
+    /* the original header and the part in front of the values */
+    memcpy ( pOut, pMsg, hdrSize + prefixSize );
+    pclient->send.stk = msgStart;
+    if ( ! cas_put_compressed ( pclient, pOut, hdrSize + prefixSize + nBytes,
+            encoding, nBytes, rawMsgSize ) ) {
+        /* can't happen, it's smaller than the original */
+        pclient->send.stk = msgStart + rawMsgSize;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ *  cas_copy_in_compressed()
+ *
+ *  Adds a complete response as cas_copy_in_ref() does, but with the
+ *  value array compressed.  Returns FALSE, and adds nothing, if the
+ *  client didn't ask for it or compression doesn't pay off.
+ *  TCP only, send lock must be on.
+ */
+int cas_copy_in_compressed (
+    struct client *pclient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pHdr, unsigned hdrSize,
+    const void *pValue, unsigned valueBytes )
+{
+    ca_uint32_t alignedPayloadSize = CA_MESSAGE_ALIGN ( payloadSize );
+    unsigned msgHdrSize = sizeof ( caHdr );
+    unsigned encoding, nBytes;
+    caHdr *pMsg;
+    char *pOut;
+
+    if ( pclient->proto != IPPROTO_TCP ||
+            (ca_uint32_t) hdrSize + valueBytes > payloadSize ) {
+        return FALSE;
+    }
+    if ( alignedPayloadSize >= 0xffff || nElem >= 0xffff ) {
+        msgHdrSize += 2 * sizeof ( ca_uint32_t );
+    }
+
+    nBytes = cas_compress_array ( pclient, dataType, pValue, valueBytes,
+        msgHdrSize + hdrSize, &encoding, &pOut );
+    if ( ! nBytes ) {
+        return FALSE;
+    }
+
+    /* the header as cas_copy_in_header() would have written it */
+    pMsg = (caHdr *) pOut;
+    pMsg->m_cmmd = htons ( response );
+    pMsg->m_dataType = htons ( dataType );
+    pMsg->m_cid = htonl ( cid );
+    pMsg->m_available = htonl ( responseSpecific );
+    if ( msgHdrSize == sizeof ( caHdr ) ) {
+        pMsg->m_postsize = htons ( (ca_uint16_t) alignedPayloadSize );
+        pMsg->m_count = htons ( (ca_uint16_t) nElem );
+    }
+    else {
+        ca_uint32_t w32[2];
+        pMsg->m_postsize = htons ( 0xffff );
+        pMsg->m_count = htons ( 0u );
+        w32[0] = htonl ( alignedPayloadSize );
+        w32[1] = htonl ( nElem );
+        memcpy ( pMsg + 1, w32, sizeof ( w32 ) );
+    }
+    memcpy ( pOut + msgHdrSize, pHdr, hdrSize );
+
+    return cas_put_compressed ( pclient, pOut, msgHdrSize + hdrSize + nBytes,
+        encoding, nBytes, msgHdrSize + alignedPayloadSize );
+}
+
 void cas_set_header_cid ( struct client *pClient, ca_uint32_t cid )
 {
     caHdr *pMsg = ( caHdr * ) &pClient->send.buf[pClient->send.stk];
@@ -398,3 +1023,83 @@ ca_uint32_t rsrvGetUInt32 ( struct message_buffer *recv )
     result |= pBuf[recv->stk++] << 0u;
     return result;
 }
+
+/*
+ *  cas_local_offer()
+ *
+ *  Offers a shared memory ring to a client that asked for the
+ *  local transport, if it is on this host.  Send lock must be on.
+ */
+void cas_local_offer ( struct client *pclient )
+{
+    struct sockaddr_in local;
+    osiSocklen_t addrSize = sizeof ( local );
+    epicsTimeStamp now;
+    epicsUInt32 cookie[2];
+    ca_uint32_t *pCookie;
+    unsigned long pid;
+    int fd;
+
+    /* a CAS-io thread must never wait for the ring to have space */
+    if ( pclient->pLocalRing || pclient->pLocalOffer || pclient->pooled ) {
+        return;
+    }
+
+    /* both ends of a circuit within a host have the same address */
+    if ( getsockname ( pclient->sock, ( struct sockaddr * ) &local,
+            &addrSize ) < 0 ||
+         local.sin_addr.s_addr != pclient->addr.sin_addr.s_addr ) {
+        return;
+    }
+
+    /* tells the client that it opened our ring, not just any */
+    epicsTimeGetCurrent ( &now );
+    cookie[0] = now.nsec ^ ( epicsUInt32 ) ( size_t ) pclient;
+    cookie[1] = now.secPastEpoch ^ ntohs ( pclient->addr.sin_port );
+
+    pclient->pLocalOffer = caLocalRingCreate ( casLocalRingBytes, cookie );
+    if ( ! pclient->pLocalOffer ) {
+        return;
+    }
+    caLocalRingLocation ( pclient->pLocalOffer, &pid, &fd );
+    if ( cas_copy_in_header ( pclient, CA_PROTO_LOCAL, sizeof ( cookie ),
+            CA_LOCAL_OFFER, 0u, ( ca_uint32_t ) pid, ( ca_uint32_t ) fd,
+            ( void ** ) &pCookie ) != ECA_NORMAL ) {
+        caLocalRingDelete ( pclient->pLocalOffer );
+        pclient->pLocalOffer = NULL;
+        return;
+    }
+    pCookie[0] = htonl ( cookie[0] );
+    pCookie[1] = htonl ( cookie[1] );
+    cas_commit_msg ( pclient, sizeof ( cookie ) );
+}
+
+/*
+ *  cas_local_switch()
+ *
+ *  Once the client has attached to the offered ring, all responses
+ *  that follow the switch message go through it.  Send lock must
+ *  be on.
+ */
+void cas_local_switch ( struct client *pclient, int attached )
+{
+    caLocalRing *pRing = pclient->pLocalOffer;
+
+    pclient->pLocalOffer = NULL;
+    if ( ! pRing ) {
+        return;
+    }
+    if ( ! attached ||
+         cas_copy_in_header ( pclient, CA_PROTO_LOCAL, 0u,
+            CA_LOCAL_SWITCH, 0u, 0u, 0u, NULL ) != ECA_NORMAL ) {
+        caLocalRingDelete ( pRing );
+        return;
+    }
+    cas_commit_msg ( pclient, 0u );
+    cas_send_bs_msg ( pclient, FALSE );
+    if ( pclient->disconnect ) {
+        caLocalRingDelete ( pRing );
+        return;
+    }
+    pclient->pLocalRing = pRing;
+}
@@ -33,13 +33,16 @@
 #include "osiSock.h"
 #include "taskwd.h"
 #include "cantProceed.h"
+#include "caLocalRing.h"
 
 #include "epicsExport.h"
 
 #define epicsExportSharedSymbols
+#include "dbAccessDefs.h"
 #include "dbChannel.h"
 #include "dbCommon.h"
 #include "dbEvent.h"
+#include "dbStaticLib.h"
 #include "db_field_log.h"
 #include "dbServer.h"
 #include "rsrv.h"
@@ -115,6 +118,14 @@ static void req_server (void *pParm)
             ellAdd ( &clientQ, &pClient->node );
             UNLOCK_CLIENTQ;
 
+            if ( casPoolRunning () ) {
+                /* client is destroyed if unsuccessful here */
+                if ( casPoolAdd ( pClient ) != RSRV_OK ) {
+                    errlogPrintf ( "CAS: I/O thread pool refused new client\n" );
+                }
+                continue;
+            }
+
             id = epicsThreadCreate ( "CAS-client", epicsThreadPriorityCAServerLow,
                     epicsThreadGetStackSize ( epicsThreadStackBig ),
                     camsgtask, pClient );
@@ -279,6 +290,93 @@ SOCKET* rsrv_grab_tcp(unsigned short *port)
     return socks;
 }
 
+/*
+ * Collects the multicast name resolution groups of all record names
+ * and aliases, see EPICS_CA_NAME_MCAST_ADDR.  Searches for the names
+ * served by other IOCs are then never delivered to this one.
+ */
+static
+void rsrv_build_name_mcast_list(void)
+{
+    DBENTRY dbentry;
+    char *pUsed;
+    unsigned i;
+    long status;
+
+    ellInit ( &casNameMCastAddrList );
+
+    if (caNameMcastConfigure(&casNameMcast, ca_udp_port) || !pdbbase)
+        return;
+
+    pUsed = callocMustSucceed(casNameMcast.nGroups, 1, "rsrv_init");
+
+    dbInitEntry(pdbbase, &dbentry);
+    for (status = dbFirstRecordType(&dbentry); !status;
+         status = dbNextRecordType(&dbentry)) {
+        for (status = dbFirstRecord(&dbentry); !status;
+             status = dbNextRecord(&dbentry)) {
+            const char *pname = dbGetRecordName(&dbentry);
+
+            pUsed[caNameMcastIndex(&casNameMcast, pname,
+                (unsigned) strlen(pname))] = 1;
+        }
+    }
+    dbFinishEntry(&dbentry);
+
+    for (i = 0; i < casNameMcast.nGroups; i++) {
+        osiSockAddrNode *pNode;
+
+        if (!pUsed[i])
+            continue;
+        pNode = callocMustSucceed(1, sizeof(*pNode), "rsrv_init");
+        caNameMcastGroup(&casNameMcast, i, &pNode->addr.ia);
+        ellAdd(&casNameMCastAddrList, &pNode->node);
+    }
+    free(pUsed);
+}
+
+#ifdef IP_ADD_MEMBERSHIP
+/* join a UDP socket to the multicast groups in pList */
+static
+void rsrv_join_mcast_groups(SOCKET sock, const ELLLIST *pList,
+    const osiSockAddr *pIface, const char *ifaceName)
+{
+    osiSockAddrNode *pNode;
+    int nFailed = 0;
+
+    for(pNode = (osiSockAddrNode*)ellFirst(pList);
+        pNode;
+        pNode = (osiSockAddrNode*)ellNext(&pNode->node))
+    {
+        struct ip_mreq mreq;
+
+        memset(&mreq, 0, sizeof(mreq));
+        mreq.imr_multiaddr = pNode->addr.ia.sin_addr;
+        mreq.imr_interface.s_addr = pIface->ia.sin_addr.s_addr;
+
+        if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+            (char *) &mreq, sizeof(mreq))!=0) {
+            struct sockaddr_in temp;
+            char name[40];
+            char sockErrBuf[64];
+            temp.sin_family = AF_INET;
+            temp.sin_addr = mreq.imr_multiaddr;
+            temp.sin_port = pIface->ia.sin_port;
+            epicsSocketConvertErrnoToString (
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            ipAddrToDottedIP (&temp, name, sizeof(name));
+            if (!nFailed++)
+                fprintf(stderr, "CAS: Socket mcast join %s to %s failed with \"%s\"\n",
+                    ifaceName, name, sockErrBuf );
+        }
+    }
+    if (nFailed > 1)
+        fprintf(stderr, "CAS: %d of %d mcast joins on %s failed, the number of "
+            "groups per socket may be limited (igmp_max_memberships on Linux)\n",
+            nFailed, ellCount(pList), ifaceName);
+}
+#endif
+
 static
 void rsrv_build_addr_lists(void)
 {
@@ -483,6 +581,9 @@ static dbServer rsrv_server = {
 int rsrv_init (void)
 {
     long maxBytesAsALong;
+    long ioThreads;
+    long compressThreshold;
+    long localRingBytes;
     long status;
     SOCKET *socks;
     int autoMaxBytes;
@@ -556,6 +657,25 @@ int rsrv_init (void)
         cantProceed("RSRV failed to allocate ID lookup table\n");
 
     rsrv_build_addr_lists();
+    rsrv_build_name_mcast_list();
+
+    /* Arrays this large are compressed for clients that ask for it */
+    if ( envGetLongConfigParam ( &EPICS_CAS_COMPRESS_THRESHOLD,
+            &compressThreshold ) == 0 && compressThreshold > 0 ) {
+        casCompressThreshold = (unsigned) compressThreshold;
+    }
+
+    /* Clients on this host that ask for it get responses through a ring */
+    if ( envGetLongConfigParam ( &EPICS_CAS_LOCAL_RING_BYTES,
+            &localRingBytes ) == 0 && localRingBytes > 0 ) {
+        casLocalRingBytes = (unsigned) localRingBytes;
+    }
+
+    /* A fixed pool of I/O threads replaces the thread per TCP client */
+    if ( envGetLongConfigParam ( &EPICS_CAS_IO_THREADS, &ioThreads ) == 0 &&
+         ioThreads > 0 ) {
+        casPoolInit ( (unsigned) ioThreads );
+    }
 
     castcp_startStopEvent = epicsEventMustCreate(epicsEventEmpty);
     casudp_startStopEvent = epicsEventMustCreate(epicsEventEmpty);
@@ -571,6 +691,8 @@ int rsrv_init (void)
      * Started later per TCP client
      *  TCP receiver: epicsThreadPriorityCAServerLow
      *  TCP sender : epicsThreadPriorityCAServerLow-1
+     * or with EPICS_CAS_IO_THREADS set, instead of the TCP receivers
+     *  CAS-io pool: epicsThreadPriorityCAServerLow
      */
     {
         unsigned i;
@@ -623,7 +745,7 @@ int rsrv_init (void)
 
             ipAddrToDottedIP (&conf->tcpAddr.ia, ifaceName, sizeof(ifaceName));
 
-            conf->udp = conf->udpbcast = INVALID_SOCKET;
+            conf->udp = conf->udpbcast = conf->udpmcast = INVALID_SOCKET;
 
             /* create and bind UDP name receiver socket(s) */
 
@@ -641,37 +763,40 @@ int rsrv_init (void)
 
 #ifdef IP_ADD_MEMBERSHIP
             /* join UDP socket to any multicast groups */
-            {
-                osiSockAddrNode *pNode;
+            rsrv_join_mcast_groups(conf->udp, &casMCastAddrList,
+                &conf->udpAddr, ifaceName);
 
-                for(pNode = (osiSockAddrNode*)ellFirst(&casMCastAddrList);
-                    pNode;
-                    pNode = (osiSockAddrNode*)ellNext(&pNode->node))
-                {
-                    struct ip_mreq mreq;
+            /* The name resolution groups have their own port, so a
+             * socket bound to the wildcard address only sees them
+             */
+            if(ellCount(&casNameMCastAddrList)) {
+                conf->udpmcast = epicsSocketCreate(AF_INET, SOCK_DGRAM, 0);
+                if(conf->udpmcast==INVALID_SOCKET)
+                    cantProceed("rsrv_init ran out of udp sockets for mcast");
 
-                    memset(&mreq, 0, sizeof(mreq));
-                    mreq.imr_multiaddr = pNode->addr.ia.sin_addr;
-                    mreq.imr_interface.s_addr = conf->udpAddr.ia.sin_addr.s_addr;
+                epicsSocketEnableAddressUseForDatagramFanout ( conf->udpmcast );
 
-                    if (setsockopt(conf->udp, IPPROTO_IP, IP_ADD_MEMBERSHIP,
-                        (char *) &mreq, sizeof(mreq))!=0) {
-                        struct sockaddr_in temp;
-                        char name[40];
-                        char sockErrBuf[64];
-                        temp.sin_family = AF_INET;
-                        temp.sin_addr = mreq.imr_multiaddr;
-                        temp.sin_port = conf->udpAddr.ia.sin_port;
-                        epicsSocketConvertErrnoToString (
-                            sockErrBuf, sizeof ( sockErrBuf ) );
-                        ipAddrToDottedIP (&temp, name, sizeof(name));
-                        fprintf(stderr, "CAS: Socket mcast join %s to %s failed with \"%s\"\n",
-                            ifaceName, name, sockErrBuf );
-                    }
+                memset(&conf->udpmcastAddr, 0, sizeof(conf->udpmcastAddr));
+                conf->udpmcastAddr.ia.sin_family = AF_INET;
+                conf->udpmcastAddr.ia.sin_addr.s_addr = htonl(INADDR_ANY);
+                conf->udpmcastAddr.ia.sin_port = casNameMcast.base.sin_port;
+
+                if(tryBind(conf->udpmcast, &conf->udpmcastAddr, "UDP Socket mcast"))
+                    goto cleanup;
+
+#ifdef IP_MULTICAST_ALL
+                {
+                    /* only the groups joined on this interface */
+                    int intFalse = 0;
+                    setsockopt(conf->udpmcast, IPPROTO_IP, IP_MULTICAST_ALL,
+                               (char *)&intFalse, sizeof(intFalse));
                 }
+#endif
+                rsrv_join_mcast_groups(conf->udpmcast, &casNameMCastAddrList,
+                    &conf->udpAddr, ifaceName);
             }
 #else
-            if(ellCount(&casMCastAddrList)){
+            if(ellCount(&casMCastAddrList) || ellCount(&casNameMCastAddrList)){
                 fprintf(stderr, "IPv4 Multicast name lookup not supported by this target\n");
             }
 #endif
@@ -748,12 +873,25 @@ int rsrv_init (void)
             }
 #endif /* !(defined(_WIN32) || defined(__CYGWIN__)) */
 
+            if(conf->udpmcast != INVALID_SOCKET) {
+                conf->startmcast = 1;
+
+                epicsThreadMustCreate("CAS-UDP3", threadPrios[4],
+                        epicsThreadGetStackSize(epicsThreadStackMedium),
+                        &cast_server, conf);
+
+                epicsEventMustWait(casudp_startStopEvent);
+
+                conf->startmcast = 0;
+            }
+
             havesometcp = 1;
             continue;
         cleanup:
             epicsSocketDestroy(conf->tcp);
             if(conf->udp!=INVALID_SOCKET) epicsSocketDestroy(conf->udp);
             if(conf->udpbcast!=INVALID_SOCKET) epicsSocketDestroy(conf->udpbcast);
+            if(conf->udpmcast!=INVALID_SOCKET) epicsSocketDestroy(conf->udpmcast);
             free(conf);
         }
 
@@ -827,6 +965,15 @@ static void showChanList (
     epicsMutexUnlock ( client->chanListLock );
 }
 
+static void showCompressStats ( const struct compress_stats *pStats )
+{
+    printf ( "\t%lu array responses compressed from %.0f to %.0f bytes"
+        " (%.1f%% saved), %.3f sec compressing\n",
+        pStats->messages, pStats->rawBytes, pStats->wireBytes,
+        100.0 * ( 1.0 - pStats->wireBytes / pStats->rawBytes ),
+        pStats->seconds );
+}
+
 /*
  *  log_one_client ()
  */
@@ -859,6 +1006,15 @@ static void log_one_client (struct client *client, unsigned level)
         client->minor_version_number,
         client->priority,
         n, n == 1 ? "" : "s" );
+    if ( client->compress.messages ) {
+        showCompressStats ( &client->compress );
+    }
+    if ( client->pLocalRing ) {
+        printf ( "\tResponses through a %u byte shared memory ring,"
+            " %.0f bytes sent, %lu wakeups\n",
+            caLocalRingSize ( client->pLocalRing ), client->localRingBytes,
+            client->localRingWakeups );
+    }
 
     if ( level >= 3u ) {
         double         send_delay;
@@ -870,8 +1026,14 @@ static void log_one_client (struct client *client, unsigned level)
         send_delay = epicsTimeDiffInSeconds(&current,&client->time_at_last_send);
         recv_delay = epicsTimeDiffInSeconds(&current,&client->time_at_last_recv);
 
-        printf ("\tTask Id = %p, Socket FD = %d\n",
-            (void *) client->tid, client->sock);
+        if ( client->pooled ) {
+            printf ("\tServiced by the CAS-io threads, Socket FD = %d\n",
+                client->sock);
+        }
+        else {
+            printf ("\tTask Id = %p, Socket FD = %d\n",
+                (void *) client->tid, client->sock);
+        }
         printf(
         "\t%.2f secs since last send, %.2f secs since last receive\n",
             send_delay, recv_delay);
@@ -933,8 +1095,22 @@ void casr (unsigned level)
         printf("No clients connected.\n");
     }
     else if (level == 0) {
+        struct client *client = (struct client *) ellFirst ( &clientQ );
+        struct compress_stats total;
+
+        memset ( &total, 0, sizeof ( total ) );
+        while (client) {
+            total.messages += client->compress.messages;
+            total.rawBytes += client->compress.rawBytes;
+            total.wireBytes += client->compress.wireBytes;
+            total.seconds += client->compress.seconds;
+            client = (struct client *) ellNext(&client->node);
+        }
         printf("%d client%s connected.\n",
             n, n == 1 ? "" : "s" );
+        if ( total.messages ) {
+            showCompressStats ( &total );
+        }
     }
     else {
         struct client *client = (struct client *) ellFirst ( &clientQ );
@@ -948,6 +1124,8 @@ void casr (unsigned level)
     }
     UNLOCK_CLIENTQ
 
+    casPoolShow ( level );
+
     if (level>=1) {
         rsrv_iface_config *iface = (rsrv_iface_config *) ellFirst ( &servers );
         while (iface) {
@@ -977,6 +1155,12 @@ void casr (unsigned level)
                     log_one_client(iface->bclient, level - 2);
             }
 #endif
+            if (iface->udpmcast!=INVALID_SOCKET) {
+                ipAddrToDottedIP (&iface->udpmcastAddr.ia, buf, sizeof(buf));
+                printf("    CAS-UDP multicast name server on %s\n", buf);
+                if (level >= 2)
+                    log_one_client(iface->mclient, level - 2);
+            }
 
             iface = (rsrv_iface_config *) ellNext(&iface->node);
         }
@@ -999,6 +1183,22 @@ void casr (unsigned level)
             }
         }
 
+        n = ellCount(&casNameMCastAddrList);
+        if (n) {
+            char base[40];
+
+            ipAddrToDottedIP (&casNameMcast.base, base, sizeof(base));
+            printf("Joined %d of %u name resolution groups from %s%s\n",
+                n, casNameMcast.nGroups, base, level >= 2 ? ":" : "");
+            for(pAddr = (osiSockAddrNode*)ellFirst(&casNameMCastAddrList);
+                pAddr && level >= 2;
+                pAddr = (osiSockAddrNode*)ellNext(&pAddr->node))
+            {
+                ipAddrToDottedIP (&pAddr->addr.ia, buf, sizeof(buf));
+                printf("    %s\n", buf);
+            }
+        }
+
         n = ellCount(&beaconAddrList);
         printf("Sending CAS-beacons to %d address%s:\n",
             n, n == 1 ? "" : "es");
@@ -1079,6 +1279,12 @@ void destroy_client ( struct client *client )
         epicsSocketDestroy ( client->sock );
     }
 
+    cas_release_refs ( client );
+    free ( client->pBacklog );
+    free ( client->pCompressBuf );
+    caLocalRingDelete ( client->pLocalOffer );
+    caLocalRingDelete ( client->pLocalRing );
+
     if ( client->proto == IPPROTO_TCP ) {
         if ( client->send.buf ) {
             if ( client->send.type == mbtSmallTCP ) {
@@ -1217,6 +1423,12 @@ void destroy_tcp_client ( struct client *client )
         errlogPrintf ( "CAS: Connection %d Terminated\n", client->sock );
     }
 
+    /*
+     * an event thread waiting for space in the local
+     * transport ring gives up when it sees this
+     */
+    client->disconnect = TRUE;
+
     if ( client->evuser ) {
         /*
          * turn off extra labor callbacks from the event thread
@@ -1317,6 +1529,7 @@ struct client * create_client ( SOCKET sock, int proto )
     client->evuser = NULL;
     client->priority = CA_PROTO_PRIORITY_MIN;
     client->disconnect = FALSE;
+    client->pooled = FALSE;
     epicsTimeGetCurrent ( &client->time_at_last_send );
     epicsTimeGetCurrent ( &client->time_at_last_recv );
     client->minor_version_number = CA_UKN_MINOR_VERSION;
@@ -1392,7 +1605,7 @@ void casExpandBuffer ( struct message_buffer *buf, ca_uint32_t size, int sendbuf
         /* free existing buffer */
         if(buf->type==mbtSmallTCP) {
             freeListFree ( rsrvSmallBufFreeListTCP,  buf->buf );
-        } else if(buf->type==mbtLargeTCP) {
+        } else if(rsrvLargeBufFreeListTCP && buf->type==mbtLargeTCP) {
             freeListFree ( rsrvLargeBufFreeListTCP,  buf->buf );
         } else {
             /* realloc() already free()'d if necessary */
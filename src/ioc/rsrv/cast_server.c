@@ -145,6 +145,10 @@ void cast_server(void *pParm)
         recv_sock = conf->udpbcast;
         conf->bclient = client;
     }
+    else if (conf->startmcast) {
+        recv_sock = conf->udpmcast;
+        conf->mclient = client;
+    }
     else {
         recv_sock = conf->udp;
         conf->client = client;
@@ -27,8 +27,9 @@
 #include "asLib.h"
 #include "dbChannel.h"
 #include "dbNotify.h"
-#define CA_MINOR_PROTOCOL_REVISION 13
+#define CA_MINOR_PROTOCOL_REVISION 15
 #include "caProto.h"
+#include "addrList.h"
 #include "ellLib.h"
 #include "epicsTime.h"
 #include "epicsAssert.h"
@@ -69,12 +70,49 @@ struct message_buffer {
   enum messageBufferType    type;
 };
 
+/*
+ * Payload sent from outside the send buffer, in front of the
+ * send buffer byte at offset.  Released once it has been sent.
+ */
+#define CAS_SEND_REFS 8
+struct send_ref {
+  const char                *pData;
+  unsigned                  size;
+  unsigned                  offset;
+  void                      (*release) ( void *pvt );
+  void                      *pvt;
+};
+
+/*
+ * Array responses that were sent compressed
+ */
+struct compress_stats {
+  unsigned long             messages;
+  double                    rawBytes; /* as they would have been sent */
+  double                    wireBytes;
+  double                    seconds; /* spent compressing */
+};
+
+struct caLocalRing;
+
 extern epicsThreadPrivateId rsrvCurrentClient;
 
 typedef struct client {
   ELLNODE               node;
   struct message_buffer send;
   struct message_buffer recv;
+  struct send_ref       sendRef[CAS_SEND_REFS];
+  unsigned              nSendRef; /* locked by lock */
+  char                  *pCompressBuf; /* locked by lock */
+  unsigned              compressBufSize;
+  struct compress_stats compress; /* locked by lock */
+  struct caLocalRing    *pLocalOffer; /* offered to the client, locked by lock */
+  struct caLocalRing    *pLocalRing; /* responses go here, locked by lock */
+  double                localRingBytes; /* locked by lock */
+  unsigned long         localRingWakeups; /* locked by lock */
+  char                  *pBacklog; /* unsent when a pooled socket was full */
+  unsigned              backlogSize; /* locked by lock */
+  unsigned              backlogSent; /* locked by lock */
   epicsMutexId          lock;
   epicsMutexId          putNotifyLock;
   epicsMutexId          chanListLock;
@@ -97,6 +135,8 @@ typedef struct client {
   unsigned              recvBytesToDrain;
   unsigned              priority;
   char                  disconnect; /* disconnect detected */
+  char                  pooled; /* serviced by the CAS-io threads */
+  char                  compressArrays; /* client asked for compression */
 } client;
 
 /* Channel state shows which struct client list a
@@ -155,11 +195,13 @@ typedef struct {
     ELLNODE node;
     osiSockAddr tcpAddr, /* TCP listener endpoint */
                 udpAddr, /* UDP name unicast receiver endpoint */
-                udpbcastAddr; /* UDP name broadcast receiver endpoint */
-    SOCKET tcp, udp, udpbcast;
-    struct client *client, *bclient;
+                udpbcastAddr, /* UDP name broadcast receiver endpoint */
+                udpmcastAddr; /* UDP name resolution multicast endpoint */
+    SOCKET tcp, udp, udpbcast, udpmcast;
+    struct client *client, *bclient, *mclient;
 
     unsigned int startbcast:1;
+    unsigned int startmcast:1;
 } rsrv_iface_config;
 
 enum ctl {ctlInit, ctlRun, ctlPause, ctlExit};
@@ -190,6 +232,8 @@ GLBLTYPE ELLLIST            servers; /* rsrv_iface_config::node, read-only after
 GLBLTYPE ELLLIST            beaconAddrList;
 GLBLTYPE SOCKET             beaconSocket;
 GLBLTYPE ELLLIST            casIntfAddrList, casMCastAddrList;
+GLBLTYPE ELLLIST            casNameMCastAddrList;
+GLBLTYPE caNameMcastConfig  casNameMcast;
 GLBLTYPE epicsUInt32        *casIgnoreAddrs;
 GLBLTYPE epicsMutexId       clientQlock;
 GLBLTYPE BUCKET             *pCaBucket; /* locked by clientQlock */
@@ -199,6 +243,8 @@ GLBLTYPE void               *rsrvEventFreeList;
 GLBLTYPE void               *rsrvSmallBufFreeListTCP;
 GLBLTYPE void               *rsrvLargeBufFreeListTCP;
 GLBLTYPE unsigned           rsrvSizeofLargeBufTCP;
+GLBLTYPE unsigned           casCompressThreshold; /* zero when disabled */
+GLBLTYPE unsigned           casLocalRingBytes; /* zero when disabled */
 GLBLTYPE void               *rsrvPutNotifyFreeList;
 GLBLTYPE unsigned           rsrvChannelCount; /* locked by clientQlock */
 
@@ -220,6 +266,13 @@ GLBLTYPE unsigned int       threadPrios[5];
 #define UNLOCK_CLIENTQ  epicsMutexUnlock (clientQlock);
 
 void camsgtask (void *client);
+int camsgrecv ( struct client *client, int flags );
+int casPoolInit ( unsigned nThreads );
+int casPoolAdd ( struct client *client );
+int casPoolRunning ( void );
+void casPoolShow ( unsigned level );
+int casPoolInIoThread ( void );
+void casPoolWaitWritable ( struct client *client );
 void cas_send_bs_msg ( struct client *pclient, int lock_needed );
 void cas_send_dg_msg ( struct client *pclient );
 void rsrv_online_notify_task (void *);
@@ -254,5 +307,20 @@ int cas_copy_in_header (
 void cas_set_header_cid ( struct client *pClient, ca_uint32_t );
 void cas_set_header_count (struct client *pClient, ca_uint32_t count);
 void cas_commit_msg ( struct client *pClient, ca_uint32_t size );
+int cas_copy_in_ref (
+    struct client *pClient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pHdr, unsigned hdrSize,
+    const void *pRef, unsigned refSize,
+    void ( *release ) ( void *pvt ), void *pvt );
+void cas_release_refs ( struct client *pClient );
+int cas_compress_msg ( struct client *pClient, unsigned msgStart );
+int cas_copy_in_compressed (
+    struct client *pClient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pHdr, unsigned hdrSize,
+    const void *pValue, unsigned valueBytes );
+void cas_local_offer ( struct client *pClient );
+void cas_local_switch ( struct client *pClient, int attached );
 
 #endif /*INCLserverh*/
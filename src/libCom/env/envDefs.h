@@ -52,6 +52,11 @@ epicsShareExtern const ENV_PARAM EPICS_CA_AUTO_ARRAY_BYTES;
 epicsShareExtern const ENV_PARAM EPICS_CA_MAX_SEARCH_PERIOD;
 epicsShareExtern const ENV_PARAM EPICS_CA_NAME_SERVERS;
 epicsShareExtern const ENV_PARAM EPICS_CA_MCAST_TTL;
+epicsShareExtern const ENV_PARAM EPICS_CA_NAME_MCAST_ADDR;
+epicsShareExtern const ENV_PARAM EPICS_CA_NAME_MCAST_GROUPS;
+epicsShareExtern const ENV_PARAM EPICS_CA_NAME_MCAST_INTF;
+epicsShareExtern const ENV_PARAM EPICS_CA_COMPRESS_ARRAYS;
+epicsShareExtern const ENV_PARAM EPICS_CA_LOCAL_TRANSPORT;
 epicsShareExtern const ENV_PARAM EPICS_CAS_INTF_ADDR_LIST;
 epicsShareExtern const ENV_PARAM EPICS_CAS_IGNORE_ADDR_LIST;
 epicsShareExtern const ENV_PARAM EPICS_CAS_AUTO_BEACON_ADDR_LIST;
@@ -60,6 +65,9 @@ epicsShareExtern const ENV_PARAM EPICS_CAS_SERVER_PORT;
 epicsShareExtern const ENV_PARAM EPICS_CA_BEACON_PERIOD; /* deprecated */
 epicsShareExtern const ENV_PARAM EPICS_CAS_BEACON_PERIOD;
 epicsShareExtern const ENV_PARAM EPICS_CAS_BEACON_PORT;
+epicsShareExtern const ENV_PARAM EPICS_CAS_IO_THREADS;
+epicsShareExtern const ENV_PARAM EPICS_CAS_COMPRESS_THRESHOLD;
+epicsShareExtern const ENV_PARAM EPICS_CAS_LOCAL_RING_BYTES;
 epicsShareExtern const ENV_PARAM EPICS_BUILD_COMPILER_CLASS;
 epicsShareExtern const ENV_PARAM EPICS_BUILD_OS_CLASS;
 epicsShareExtern const ENV_PARAM EPICS_BUILD_TARGET_ARCH;
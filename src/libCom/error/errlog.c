@@ -27,6 +27,8 @@
 #include "epicsMutex.h"
 #include "epicsEvent.h"
 #include "epicsInterrupt.h"
+#include "epicsAtomic.h"
+#include "epicsTime.h"
 #include "errMdef.h"
 #include "error.h"
 #include "ellLib.h"
@@ -37,6 +39,7 @@
 
 #define BUFFER_SIZE 1280
 #define MAX_MESSAGE_SIZE 256
+#define REPEAT_INTERVAL 1.0
 
 /*Declare storage for errVerbose */
 epicsShareDef int errVerbose = 0;
@@ -48,6 +51,7 @@ static char *msgbufGetFree(int noConsoleMessage);
 static void msgbufSetSize(int size); /* Send 'size' chars plus trailing '\0' */
 static char *msgbufGetSend(int *noConsoleMessage);
 static void msgbufFreeSend(void);
+static void msgbufSweepRepeats(void);
 
 typedef struct listenerNode{
     ELLNODE node;
@@ -63,10 +67,29 @@ typedef struct msgNode {
     int noConsoleMessage;
 } msgNode;
 
+/*
+ * Each thread formats its messages into its own msgStage, so the queue
+ * lock is only held to copy them in. A message identical to the last one
+ * the thread queued less than repeatInterval seconds ago is just counted.
+ */
+typedef struct msgStage {
+    ELLNODE node;
+    char *message;          /* being formatted */
+    char *last;             /* last message queued */
+    char *name;             /* of the thread */
+    int lastLength;
+    int noConsoleMessage;
+    epicsTimeStamp lastTime;
+    size_t repeats;         /* copies of last not queued */
+    size_t seenRepeats;     /* repeats at errlogThread's last sweep */
+} msgStage;
+
 static struct {
     epicsEventId waitForWork; /*errlogThread waits for this*/
     epicsMutexId msgQueueLock;
     epicsMutexId listenerLock;
+    epicsMutexId stageLock;
+    epicsThreadPrivateId stageId;
     epicsEventId waitForFlush; /*errlogFlush waits for this*/
     epicsEventId flush; /*errlogFlush sets errlogThread does a Try*/
     epicsMutexId flushLock;
@@ -74,7 +97,7 @@ static struct {
     int          atExit;      /*TRUE when errlogExitHandler is active*/
     ELLLIST      listenerList;
     ELLLIST      msgQueue;
-    msgNode      *pnextSend;
+    ELLLIST      stageList;
     int          errlogInitFailed;
     int          buffersize;
     int          maxMsgSize;
@@ -83,6 +106,7 @@ static struct {
     int          toConsole;
     FILE         *console;
     int          missedMessages;
+    double       repeatInterval;
     char         *pbuffer;
 } pvtData;
 
@@ -389,6 +413,12 @@ epicsShareFunc int errlogSetConsole(FILE *stream)
     return 0;
 }
 
+epicsShareFunc void errlogSetRepeatInterval(double seconds)
+{
+    errlogInit(0);
+    pvtData.repeatInterval = seconds;
+}
+
 epicsShareFunc void errPrintf(long status, const char *pFileName, 
     int lineno, const char *pformat, ...)
 {
@@ -483,11 +513,15 @@ static void errlogInitPvt(void *arg)
         sizeof(msgNode));
     ellInit(&pvtData.listenerList);
     ellInit(&pvtData.msgQueue);
+    ellInit(&pvtData.stageList);
+    pvtData.repeatInterval = REPEAT_INTERVAL;
     pvtData.toConsole = TRUE;
     pvtData.console = NULL;
     pvtData.waitForWork = epicsEventMustCreate(epicsEventEmpty);
     pvtData.listenerLock = epicsMutexMustCreate();
     pvtData.msgQueueLock = epicsMutexMustCreate();
+    pvtData.stageLock = epicsMutexMustCreate();
+    pvtData.stageId = epicsThreadPrivateCreate();
     pvtData.waitForFlush = epicsEventMustCreate(epicsEventEmpty);
     pvtData.flush = epicsEventMustCreate(epicsEventEmpty);
     pvtData.flushLock = epicsMutexMustCreate();
@@ -563,10 +597,24 @@ static void errlogThread(void)
     listenerNode *plistenerNode;
     int noConsoleMessage;
     char *pmessage;
+    epicsTimeStamp lastSweep, now;
 
     epicsAtExit(errlogExitHandler,0);
+    epicsTimeGetCurrent(&lastSweep);
     while (TRUE) {
-        epicsEventMustWait(pvtData.waitForWork);
+        if (pvtData.repeatInterval > 0) {
+            /* Report repeats from threads that have gone quiet */
+            epicsEventWaitWithTimeout(pvtData.waitForWork,
+                pvtData.repeatInterval);
+            epicsTimeGetCurrent(&now);
+            if (epicsTimeDiffInSeconds(&now, &lastSweep) >=
+                    pvtData.repeatInterval) {
+                msgbufSweepRepeats();
+                lastSweep = now;
+            }
+        }
+        else
+            epicsEventMustWait(pvtData.waitForWork);
         while ((pmessage = msgbufGetSend(&noConsoleMessage))) {
             epicsMutexMustLock(pvtData.listenerLock);
             if (pvtData.toConsole && !noConsoleMessage) {
@@ -631,12 +679,13 @@ static msgNode *msgbufGetNode(void)
     return pnextSend;
 }
 
-static char *msgbufGetFree(int noConsoleMessage)
+/* Copy a message into the queue, or count it as missed if there's no room */
+static void msgbufQueue(const char *message, int length, int noConsoleMessage)
 {
     msgNode *pnextSend;
 
     if (epicsMutexLock(pvtData.msgQueueLock) != epicsMutexLockOK)
-        return 0;
+        return;
 
     if ((ellCount(&pvtData.msgQueue) == 0) && pvtData.missedMessages) {
         int nchar;
@@ -649,26 +698,143 @@ static char *msgbufGetFree(int noConsoleMessage)
         ellAdd(&pvtData.msgQueue, &pnextSend->node);
     }
 
-    pvtData.pnextSend = pnextSend = msgbufGetNode();
-    if (pnextSend) {
-        pnextSend->noConsoleMessage = noConsoleMessage;
-        pnextSend->length = 0;
-        return pnextSend->message;  /* NB: msgQueueLock is still locked */
+    pnextSend = msgbufGetNode();
+    if (!pnextSend) {
+        ++pvtData.missedMessages;
+        epicsMutexUnlock(pvtData.msgQueueLock);
+        return;
     }
-
-    ++pvtData.missedMessages;
+    memcpy(pnextSend->message, message, length);
+    pnextSend->message[length] = '\0';
+    pnextSend->length = length + 1;
+    pnextSend->noConsoleMessage = noConsoleMessage;
+    ellAdd(&pvtData.msgQueue, &pnextSend->node);
     epicsMutexUnlock(pvtData.msgQueueLock);
-    return 0;
+    epicsEventSignal(pvtData.waitForWork);
+}
+
+static size_t msgbufTakeRepeats(msgStage *pstage)
+{
+    size_t repeats;
+
+    do {
+        repeats = epicsAtomicGetSizeT(&pstage->repeats);
+    } while (repeats &&
+        epicsAtomicCmpAndSwapSizeT(&pstage->repeats, repeats, 0) != repeats);
+    return repeats;
+}
+
+static void msgbufQueueRepeats(msgStage *pstage, size_t repeats)
+{
+    char message[MAX_MESSAGE_SIZE];
+    int nchar = epicsSnprintf(message, sizeof message,
+        "errlog: last message from %s repeated %lu times\n",
+        pstage->name, (unsigned long) repeats);
+
+    if (nchar >= (int) sizeof message)
+        nchar = sizeof message - 1;
+    msgbufQueue(message, nchar, 0);
+}
+
+static void msgbufStageExit(void *arg)
+{
+    msgStage *pstage = (msgStage *) arg;
+    size_t repeats = msgbufTakeRepeats(pstage);
+
+    if (repeats && !pvtData.atExit)
+        msgbufQueueRepeats(pstage, repeats);
+    epicsMutexMustLock(pvtData.stageLock);
+    ellDelete(&pvtData.stageList, &pstage->node);
+    epicsMutexUnlock(pvtData.stageLock);
+    epicsThreadPrivateSet(pvtData.stageId, NULL);
+    free(pstage);
+}
+
+static msgStage *msgbufGetStage(void)
+{
+    msgStage *pstage = epicsThreadPrivateGet(pvtData.stageId);
+    const char *name;
+
+    if (pstage)
+        return pstage;
+
+    name = epicsThreadGetNameSelf();
+    pstage = calloc(1, sizeof(msgStage) + 2 * pvtData.maxMsgSize +
+        strlen(name) + 1);
+    if (!pstage)
+        return 0;
+    pstage->message = (char *)(pstage + 1);
+    pstage->last = pstage->message + pvtData.maxMsgSize;
+    pstage->name = pstage->last + pvtData.maxMsgSize;
+    strcpy(pstage->name, name);
+    pstage->lastLength = -1;
+    if (epicsAtThreadExit(msgbufStageExit, pstage)) {
+        free(pstage);
+        return 0;
+    }
+    epicsMutexMustLock(pvtData.stageLock);
+    ellAdd(&pvtData.stageList, &pstage->node);
+    epicsMutexUnlock(pvtData.stageLock);
+    epicsThreadPrivateSet(pvtData.stageId, pstage);
+    return pstage;
+}
+
+static char *msgbufGetFree(int noConsoleMessage)
+{
+    msgStage *pstage = msgbufGetStage();
+
+    if (!pstage)
+        return 0;
+    pstage->noConsoleMessage = noConsoleMessage;
+    return pstage->message;
 }
 
 static void msgbufSetSize(int size)
 {
-    msgNode *pnextSend = pvtData.pnextSend;
+    msgStage *pstage = epicsThreadPrivateGet(pvtData.stageId);
+    double repeatInterval = pvtData.repeatInterval;
+    size_t repeats;
+
+    if (repeatInterval > 0) {
+        epicsTimeStamp now;
+
+        epicsTimeGetCurrent(&now);
+        if (size == pstage->lastLength &&
+            memcmp(pstage->message, pstage->last, size) == 0 &&
+            epicsTimeDiffInSeconds(&now, &pstage->lastTime) < repeatInterval) {
+            epicsAtomicIncrSizeT(&pstage->repeats);
+            return;
+        }
+        pstage->lastTime = now;
+    }
 
-    pnextSend->length = size+1;
-    ellAdd(&pvtData.msgQueue, &pnextSend->node);
-    epicsMutexUnlock(pvtData.msgQueueLock);
-    epicsEventSignal(pvtData.waitForWork);
+    repeats = msgbufTakeRepeats(pstage);
+    if (repeats)
+        msgbufQueueRepeats(pstage, repeats);
+    msgbufQueue(pstage->message, size, pstage->noConsoleMessage);
+    memcpy(pstage->last, pstage->message, size);
+    pstage->lastLength = size;
+}
+
+/* Queue the repeat counts of threads that have stopped logging them */
+static void msgbufSweepRepeats(void)
+{
+    msgStage *pstage;
+
+    epicsMutexMustLock(pvtData.stageLock);
+    for (pstage = (msgStage *)ellFirst(&pvtData.stageList); pstage;
+         pstage = (msgStage *)ellNext(&pstage->node)) {
+        size_t repeats = epicsAtomicGetSizeT(&pstage->repeats);
+
+        if (repeats && repeats == pstage->seenRepeats) {
+            repeats = msgbufTakeRepeats(pstage);
+            if (repeats)
+                msgbufQueueRepeats(pstage, repeats);
+            repeats = 0;
+        }
+        pstage->seenRepeats = repeats;
+    }
+    epicsMutexUnlock(pvtData.stageLock);
 }
 
 
@@ -62,6 +62,9 @@ epicsShareFunc int epicsShareAPI errlogRemoveListeners(
 
 epicsShareFunc int epicsShareAPI eltc(int yesno);
 epicsShareFunc int errlogSetConsole(FILE *stream);
+/* Count rather than queue a message that repeats the last one its thread
+ * logged within this many seconds, 0 to disable */
+epicsShareFunc void errlogSetRepeatInterval(double seconds);
 
 epicsShareFunc int epicsShareAPI errlogInit(int bufsize);
 epicsShareFunc int epicsShareAPI errlogInit2(int bufsize, int maxMsgSize);
@@ -20,11 +20,15 @@ extern "C" {
 #endif
 
 epicsShareFunc void epicsShareAPI freeListInitPvt(void **ppvt,int size,int nmalloc);
+/* Also caches up to magazineSize free blocks in each thread that uses it */
+epicsShareFunc void epicsShareAPI freeListInitMagazine(void **ppvt,int size,
+    int nmalloc,int magazineSize);
 epicsShareFunc void * epicsShareAPI freeListCalloc(void *pvt);
 epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt);
 epicsShareFunc void epicsShareAPI freeListFree(void *pvt,void*pmem);
 epicsShareFunc void epicsShareAPI freeListCleanup(void *pvt);
 epicsShareFunc size_t epicsShareAPI freeListItemsAvail(void *pvt);
+epicsShareFunc size_t epicsShareAPI freeListItemsCached(void *pvt);
 
 #ifdef __cplusplus
 }
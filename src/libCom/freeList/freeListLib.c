@@ -25,6 +25,9 @@
 #define epicsExportSharedSymbols
 #include "cantProceed.h"
 #include "epicsMutex.h"
+#include "epicsThread.h"
+#include "epicsExit.h"
+#include "ellLib.h"
 #include "freeList.h"
 #include "adjustment.h"
 
@@ -39,10 +42,41 @@ typedef struct {
     allocMem	*mallochead;
     size_t	nBlocksAvailable;
     epicsMutexId lock;
+    int		magazineSize;
+    epicsThreadPrivateId magazineId;
+    ELLLIST	magazines;
 }FREELISTPVT;
 
+/*
+ * A magazine caches up to magazineSize free blocks for one thread, which
+ * it takes from and returns to the shared list in batches of half that.
+ * Only its own thread touches the blocks; the list of magazines and the
+ * counts are protected by pfl->lock.  The thread exit hook and
+ * freeListCleanup() serialize on magazineLock, as either may come first.
+ */
+typedef struct {
+    ELLNODE	node;
+    FREELISTPVT	*pfl;
+    void	*head;
+    int		count;
+}MAGAZINE;
+
+static epicsThreadOnceId magazineOnce = EPICS_THREAD_ONCE_INIT;
+static epicsMutexId magazineLock;
+
+static void magazineInitOnce(void *arg)
+{
+    magazineLock = epicsMutexMustCreate();
+}
+
 epicsShareFunc void epicsShareAPI 
 	freeListInitPvt(void **ppvt,int size,int nmalloc)
+{
+    freeListInitMagazine(ppvt, size, nmalloc, 0);
+}
+
+epicsShareFunc void epicsShareAPI
+	freeListInitMagazine(void **ppvt,int size,int nmalloc,int magazineSize)
 {
     FREELISTPVT	*pfl;
 
@@ -53,11 +87,141 @@ epicsShareFunc void epicsShareAPI
     pfl->mallochead = NULL;
     pfl->nBlocksAvailable = 0u;
     pfl->lock = epicsMutexMustCreate();
+    ellInit(&pfl->magazines);
+#   ifndef EPICS_FREELIST_DEBUG
+    if(magazineSize>0) {
+        epicsThreadOnce(&magazineOnce, magazineInitOnce, NULL);
+        pfl->magazineSize = magazineSize;
+        pfl->magazineId = epicsThreadPrivateCreate();
+    }
+#   endif
     *ppvt = (void *)pfl;
     VALGRIND_CREATE_MEMPOOL(pfl, REDZONE, 0);
     return;
 }
 
+/* Add nmalloc blocks to the shared list, pfl->lock must be held */
+static int growList(FREELISTPVT *pfl)
+{
+    void	*ptemp;
+    void	**ppnext;
+    allocMem	*pallocmem;
+    int		i;
+
+    /* layout of each block. nmalloc+1 REDZONEs for nmallocs.
+     * The first sizeof(void*) bytes are used to store a pointer
+     * to the next free block.
+     *
+     * | RED | size0 ------ | RED | size1 | ... | RED |
+     * |     | next | ----- |
+     */
+    ptemp = (void *)malloc(pfl->nmalloc*(pfl->size+REDZONE)+REDZONE);
+    if(ptemp==0) return(0);
+    pallocmem = (allocMem *)calloc(1,sizeof(allocMem));
+    if(pallocmem==0) {
+        free(ptemp);
+        return(0);
+    }
+    pallocmem->memory = ptemp; /* real allocation */
+    ptemp = REDZONE + (char *) ptemp; /* skip first REDZONE */
+    if(pfl->mallochead)
+        pallocmem->next = pfl->mallochead;
+    pfl->mallochead = pallocmem;
+    for(i=0; i<pfl->nmalloc; i++) {
+        ppnext = ptemp;
+        VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, sizeof(void*));
+        *ppnext = pfl->head;
+        pfl->head = ptemp;
+        ptemp = ((char *)ptemp) + pfl->size+REDZONE;
+    }
+    pfl->nBlocksAvailable += pfl->nmalloc;
+    return(1);
+}
+
+/* Return the first n blocks of a chain to the shared list */
+static void *returnBlocks(FREELISTPVT *pfl, void *head, int n)
+{
+    void	**ppnext = head;
+    void	*prest;
+    int		i;
+
+    for(i=1; i<n; i++) ppnext = *ppnext;
+    prest = *ppnext;
+    epicsMutexMustLock(pfl->lock);
+    *ppnext = pfl->head;
+    pfl->head = head;
+    pfl->nBlocksAvailable += n;
+    epicsMutexUnlock(pfl->lock);
+    return prest;
+}
+
+static void magazineExit(void *arg)
+{
+    MAGAZINE	*pmag = arg;
+    FREELISTPVT	*pfl;
+
+    epicsMutexMustLock(magazineLock);
+    pfl = pmag->pfl;
+    if(pfl) {
+        if(pmag->count) returnBlocks(pfl, pmag->head, pmag->count);
+        epicsMutexMustLock(pfl->lock);
+        ellDelete(&pfl->magazines, &pmag->node);
+        epicsMutexUnlock(pfl->lock);
+        epicsThreadPrivateSet(pfl->magazineId, NULL);
+    }
+    epicsMutexUnlock(magazineLock);
+    free(pmag);
+}
+
+static MAGAZINE *getMagazine(FREELISTPVT *pfl)
+{
+    MAGAZINE	*pmag = epicsThreadPrivateGet(pfl->magazineId);
+
+    if(pmag) return pmag;
+    pmag = calloc(1, sizeof(MAGAZINE));
+    if(!pmag) return NULL;
+    pmag->pfl = pfl;
+    if(epicsAtThreadExit(magazineExit, pmag)) {
+        free(pmag);
+        return NULL;
+    }
+    epicsMutexMustLock(pfl->lock);
+    ellAdd(&pfl->magazines, &pmag->node);
+    epicsMutexUnlock(pfl->lock);
+    epicsThreadPrivateSet(pfl->magazineId, pmag);
+    return pmag;
+}
+
+static void *magazineMalloc(FREELISTPVT *pfl, MAGAZINE *pmag)
+{
+    void	*ptemp;
+    void	**ppnext;
+
+    if(!pmag->head) {
+        int	n = pfl->magazineSize > 1 ? pfl->magazineSize / 2 : 1;
+
+        epicsMutexMustLock(pfl->lock);
+        while(pmag->count < n) {
+            if(!pfl->head && !growList(pfl)) break;
+            ppnext = pfl->head;
+            pfl->head = *ppnext;
+            *ppnext = pmag->head;
+            pmag->head = ppnext;
+            pmag->count++;
+        }
+        pfl->nBlocksAvailable -= pmag->count;
+        epicsMutexUnlock(pfl->lock);
+        if(!pmag->head) return(0);
+    }
+    ptemp = pmag->head;
+    ppnext = ptemp;
+    pmag->head = *ppnext;
+    pmag->count--;
+    VALGRIND_MEMPOOL_FREE(pfl, ptemp);
+    VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, pfl->size);
+    return(ptemp);
+}
+
 epicsShareFunc void * epicsShareAPI freeListCalloc(void *pvt)
 {
     FREELISTPVT *pfl = pvt;
@@ -80,45 +244,18 @@ epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt)
 #   else
     void	*ptemp;
     void	**ppnext;
-    allocMem	*pallocmem;
-    int		i;
+
+    if(pfl->magazineId) {
+        MAGAZINE *pmag = getMagazine(pfl);
+        if(pmag) return magazineMalloc(pfl, pmag);
+    }
 
     epicsMutexMustLock(pfl->lock);
-    ptemp = pfl->head;
-    if(ptemp==0) {
-        /* layout of each block. nmalloc+1 REDZONEs for nmallocs.
-         * The first sizeof(void*) bytes are used to store a pointer
-         * to the next free block.
-         *
-         * | RED | size0 ------ | RED | size1 | ... | RED |
-         * |     | next | ----- |
-         */
-        ptemp = (void *)malloc(pfl->nmalloc*(pfl->size+REDZONE)+REDZONE);
-        if(ptemp==0) {
-            epicsMutexUnlock(pfl->lock);
-            return(0);
-        }
-        pallocmem = (allocMem *)calloc(1,sizeof(allocMem));
-        if(pallocmem==0) {
-            epicsMutexUnlock(pfl->lock);
-            free(ptemp);
-            return(0);
-        }
-        pallocmem->memory = ptemp; /* real allocation */
-        ptemp = REDZONE + (char *) ptemp; /* skip first REDZONE */
-        if(pfl->mallochead)
-            pallocmem->next = pfl->mallochead;
-        pfl->mallochead = pallocmem;
-        for(i=0; i<pfl->nmalloc; i++) {
-            ppnext = ptemp;
-            VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, sizeof(void*));
-            *ppnext = pfl->head;
-            pfl->head = ptemp;
-            ptemp = ((char *)ptemp) + pfl->size+REDZONE;
-        }
-        ptemp = pfl->head;
-        pfl->nBlocksAvailable += pfl->nmalloc;
+    if(pfl->head==0 && !growList(pfl)) {
+        epicsMutexUnlock(pfl->lock);
+        return(0);
     }
+    ptemp = pfl->head;
     ppnext = pfl->head;
     pfl->head = *ppnext;
     pfl->nBlocksAvailable--;
@@ -141,6 +278,21 @@ epicsShareFunc void epicsShareAPI freeListFree(void *pvt,void*pmem)
     VALGRIND_MEMPOOL_FREE(pvt, pmem);
     VALGRIND_MEMPOOL_ALLOC(pvt, pmem, sizeof(void*));
 
+    if(pfl->magazineId) {
+        MAGAZINE *pmag = getMagazine(pfl);
+        if(pmag) {
+            ppnext = pmem;
+            *ppnext = pmag->head;
+            pmag->head = pmem;
+            if(++pmag->count >= pfl->magazineSize) {
+                int n = pfl->magazineSize > 1 ? pfl->magazineSize / 2 : 1;
+                pmag->head = returnBlocks(pfl, pmag->head, n);
+                pmag->count -= n;
+            }
+            return;
+        }
+    }
+
     epicsMutexMustLock(pfl->lock);
     ppnext = pmem;
     *ppnext = pfl->head;
@@ -158,6 +310,17 @@ epicsShareFunc void epicsShareAPI freeListCleanup(void *pvt)
 
     VALGRIND_DESTROY_MEMPOOL(pvt);
 
+    if(pfl->magazineId) {
+        MAGAZINE *pmag;
+
+        /* Orphan the magazines, their thread exit hooks free them */
+        epicsMutexMustLock(magazineLock);
+        while((pmag = (MAGAZINE *)ellGet(&pfl->magazines)))
+            pmag->pfl = NULL;
+        epicsMutexUnlock(magazineLock);
+        epicsThreadPrivateDelete(pfl->magazineId);
+    }
+
     phead = pfl->mallochead;
     while(phead) {
         pnext = phead->next;
@@ -176,6 +339,21 @@ epicsShareFunc size_t epicsShareAPI freeListItemsAvail(void *pvt)
     epicsMutexMustLock(pfl->lock);
     nBlocksAvailable = pfl->nBlocksAvailable;
     epicsMutexUnlock(pfl->lock);
-    return nBlocksAvailable;
+    return nBlocksAvailable + freeListItemsCached(pvt);
+}
+
+epicsShareFunc size_t epicsShareAPI freeListItemsCached(void *pvt)
+{
+    FREELISTPVT *pfl = pvt;
+    MAGAZINE	*pmag;
+    size_t	nBlocksCached = 0u;
+
+    /* The counts are changed by their threads without the lock */
+    epicsMutexMustLock(pfl->lock);
+    for(pmag = (MAGAZINE *)ellFirst(&pfl->magazines);
+        pmag; pmag = (MAGAZINE *)ellNext(&pmag->node))
+        nBlocksCached += pmag->count;
+    epicsMutexUnlock(pfl->lock);
+    return nBlocksCached;
 }
 
@@ -196,6 +196,17 @@ static void errlogInit2CallFunc(const iocshArgBuf *args)
     errlogInit2(args[0].ival, args[1].ival);
 }
 
+/* errlogSetRepeatInterval */
+static const iocshArg errlogSetRepeatIntervalArg0 = { "seconds",iocshArgDouble};
+static const iocshArg * const errlogSetRepeatIntervalArgs[1] =
+    {&errlogSetRepeatIntervalArg0};
+static const iocshFuncDef errlogSetRepeatIntervalFuncDef =
+    {"errlogSetRepeatInterval",1,errlogSetRepeatIntervalArgs};
+static void errlogSetRepeatIntervalCallFunc(const iocshArgBuf *args)
+{
+    errlogSetRepeatInterval(args[0].dval);
+}
+
 /* errlog */
 static const iocshArg errlogArg0 = { "message",iocshArgString};
 static const iocshArg * const errlogArgs[1] = {&errlogArg0};
@@ -378,6 +389,8 @@ void epicsShareAPI libComRegister(void)
     iocshRegister(&eltcFuncDef, eltcCallFunc);
     iocshRegister(&errlogInitFuncDef,errlogInitCallFunc);
     iocshRegister(&errlogInit2FuncDef,errlogInit2CallFunc);
+    iocshRegister(&errlogSetRepeatIntervalFuncDef,
+        errlogSetRepeatIntervalCallFunc);
     iocshRegister(&errlogFuncDef, errlogCallFunc);
     iocshRegister(&iocLogPrefixFuncDef, iocLogPrefixCallFunc);
 
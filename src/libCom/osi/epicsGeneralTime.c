@@ -14,6 +14,7 @@
 
 #define epicsExportSharedSymbols
 #include "epicsTypes.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsMessageQueue.h"
@@ -64,6 +65,8 @@ static struct {
     ELLLIST         timeProviders;
     gtProvider      *lastTimeProvider;
     epicsTimeStamp  lastProvidedTime;
+    gtProvider      *firstTimeProvider;
+    size_t          lastProvidedPacked;
 
     epicsMutexId    eventListLock;
     ELLLIST         eventProviders;
@@ -142,12 +145,114 @@ int generalTimeGetExceptPriority(epicsTimeStamp *pDest, int *pPrio, int ignore)
     return status;
 }
 
+/*
+ * Where size_t can hold a whole time stamp the monotonic check is done with
+ * a compare and swap of the packed last time, and epicsTimeGetCurrent()
+ * only takes timeListLock if the highest priority provider fails.
+ * Providers are never unregistered, so a published pointer stays valid.
+ */
+#define TIME_PACKABLE (sizeof(size_t) >= 8)
+
+static size_t packTime(const epicsTimeStamp *pts)
+{
+    /* Two shifts keep compilers with a 32-bit size_t quiet */
+    return ((size_t)pts->secPastEpoch << 16 << 16) | pts->nsec;
+}
+
+static void unpackTime(epicsTimeStamp *pts, size_t packed)
+{
+    pts->secPastEpoch = (epicsUInt32)(packed >> 16 >> 16);
+    pts->nsec = (epicsUInt32)(packed & 0xffffffffu);
+}
+
+/*
+ * Returns 0 if *pts is at least the last time provided, making it the
+ * last time, or else replaces *pts with the last time.  Without
+ * TIME_PACKABLE the caller must hold timeListLock.
+ */
+static int ratchetCurrent(epicsTimeStamp *pts)
+{
+    if (TIME_PACKABLE) {
+        size_t next = packTime(pts);
+        size_t last = epicsAtomicGetSizeT(&gtPvt.lastProvidedPacked);
+
+        while (next > last) {
+            size_t prev = epicsAtomicCmpAndSwapSizeT(&gtPvt.lastProvidedPacked,
+                last, next);
+            if (prev == last)
+                return 0;
+            last = prev;
+        }
+        if (next == last)
+            return 0;
+        unpackTime(pts, last);
+        return -1;
+    }
+
+    if (epicsTimeGreaterThanEqual(pts, &gtPvt.lastProvidedTime)) {
+        gtPvt.lastProvidedTime = *pts;
+        return 0;
+    }
+    *pts = gtPvt.lastProvidedTime;
+    return -1;
+}
+
+/*
+ * Apply the monotonic check to a time from ptp.  Another thread may have
+ * provided a slightly later time between the provider call and the check,
+ * so ask the provider again before counting the time as going backwards.
+ */
+static void checkCurrent(gtProvider *ptp, epicsTimeStamp *pDest,
+    epicsTimeStamp *pts)
+{
+    epicsTimeStamp again;
+
+    *pDest = *pts;
+    if (ratchetCurrent(pDest) == 0)
+        return;
+
+    if (ptp->get.Time(&again) == epicsTimeOK) {
+        *pDest = again;
+        if (ratchetCurrent(pDest) == 0)
+            return;
+    }
+
+    {
+        int key = epicsInterruptLock();
+        gtPvt.ErrorCounts++;
+        epicsInterruptUnlock(key);
+    }
+
+    IFDEBUG(10) {
+        char last[40], buff[40];
+
+        epicsTimeToStrftime(last, sizeof(last), tsfmt, pDest);
+        epicsTimeToStrftime(buff, sizeof(buff), tsfmt, pts);
+        printf("eTGC provider '%s' returned older time\n"
+            "    %s, using %s instead\n", ptp->name, buff, last);
+    }
+}
+
 int epicsShareAPI epicsTimeGetCurrent(epicsTimeStamp *pDest)
 {
     gtProvider *ptp;
     int status = S_time_noProvider;
     epicsTimeStamp ts;
 
+    if (TIME_PACKABLE) {
+        /* Non-NULL only after initialization */
+        ptp = (gtProvider *)epicsAtomicGetPtrT(
+            (EpicsAtomicPtrT *)&gtPvt.firstTimeProvider);
+        if (ptp && ptp->get.Time(&ts) == epicsTimeOK) {
+            checkCurrent(ptp, pDest, &ts);
+            if (gtPvt.lastTimeProvider != ptp)
+                gtPvt.lastTimeProvider = ptp;
+            IFDEBUG(20)
+                printf("eTGC fast path from provider '%s'\n", ptp->name);
+            return epicsTimeOK;
+        }
+    }
+
     generalTime_Init();
 
     IFDEBUG(20)
@@ -159,29 +264,8 @@ int epicsShareAPI epicsTimeGetCurrent(epicsTimeStamp *pDest)
 
         status = ptp->get.Time(&ts);
         if (status == epicsTimeOK) {
-            /* check time is monotonic */
-            if (epicsTimeGreaterThanEqual(&ts, &gtPvt.lastProvidedTime)) {
-                *pDest = ts;
-                gtPvt.lastProvidedTime = ts;
-                gtPvt.lastTimeProvider = ptp;
-            } else {
-                int key;
-
-                *pDest = gtPvt.lastProvidedTime;
-                key = epicsInterruptLock();
-                gtPvt.ErrorCounts++;
-                epicsInterruptUnlock(key);
-
-                IFDEBUG(10) {
-                    char last[40], buff[40];
-
-                    epicsTimeToStrftime(last, sizeof(last), tsfmt,
-                        &gtPvt.lastProvidedTime);
-                    epicsTimeToStrftime(buff, sizeof(buff), tsfmt, &ts);
-                    printf("eTGC provider '%s' returned older time\n"
-                        "    %s, using %s instead\n", ptp->name, buff, last);
-                }
-            }
+            checkCurrent(ptp, pDest, &ts);
+            gtPvt.lastTimeProvider = ptp;
             break;
         }
     }
@@ -193,7 +277,7 @@ int epicsShareAPI epicsTimeGetCurrent(epicsTimeStamp *pDest)
         if (ptp && status == epicsTimeOK) {
             char buff[40];
 
-            epicsTimeToStrftime(buff, sizeof(buff), tsfmt, &ts);
+            epicsTimeToStrftime(buff, sizeof(buff), tsfmt, pDest);
             printf("eTGC returning %s from provider '%s'\n",
                 buff, ptp->name);
         }
@@ -453,6 +537,13 @@ int generalTimeRegisterCurrentProvider(const char *name, int priority,
 
     insertProvider(ptp, &gtPvt.timeProviders, gtPvt.timeListLock);
 
+    /* Publish the highest priority provider for epicsTimeGetCurrent() */
+    epicsMutexMustLock(gtPvt.timeListLock);
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *)&gtPvt.firstTimeProvider,
+        ellFirst(&gtPvt.timeProviders));
+    epicsMutexUnlock(gtPvt.timeListLock);
+
     IFDEBUG(1)
         printf("Registered time provider '%s' at %d\n", name, priority);
 
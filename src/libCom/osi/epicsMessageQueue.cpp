@@ -68,6 +68,21 @@ epicsMessageQueue::receive(void *message, unsigned int size, double timeout)
     return epicsMessageQueueReceiveWithTimeout(id, message, size, timeout);
 }
 
+int
+epicsMessageQueue::sendMany(void *messages, unsigned int size,
+    unsigned int count, double timeout)
+{
+    return epicsMessageQueueSendMany(id, messages, size, count, timeout);
+}
+
+int
+epicsMessageQueue::receiveMany(void *messages, unsigned int size,
+    unsigned int count, unsigned int *sizes, double timeout)
+{
+    return epicsMessageQueueReceiveMany(id, messages, size, count, sizes,
+        timeout);
+}
+
 unsigned int
 epicsMessageQueue::pending()
 {
@@ -37,6 +37,11 @@ public:
     int tryReceive ( void *message, unsigned int size );
     int receive ( void *message, unsigned int size );
     int receive ( void *message, unsigned int size, double timeout );
+    int sendMany ( void *messages, unsigned int messageSize,
+                   unsigned int count, double timeout = -1.0 );
+    int receiveMany ( void *messages, unsigned int size,
+                      unsigned int count, unsigned int *sizes,
+                      double timeout = -1.0 );
     void show ( unsigned int level = 0 );
     unsigned int pending ();
 
@@ -83,6 +88,30 @@ epicsShareFunc int epicsShareAPI epicsMessageQueueReceiveWithTimeout(
     void *message,
     unsigned int size,
     double timeout);
+/*
+ * Send count messages of messageSize bytes each, stored one after the
+ * other at messages, waiting up to timeout seconds (forever if negative)
+ * for space.  Returns the number sent, or -1 if messageSize is too big.
+ */
+epicsShareFunc int epicsShareAPI epicsMessageQueueSendMany(
+    epicsMessageQueueId id,
+    void *messages,
+    unsigned int messageSize,
+    unsigned int count,
+    double timeout);
+/*
+ * Wait up to timeout seconds (forever if negative) for a message, then
+ * receive up to count of those queued into buffers of size bytes stored
+ * one after the other at messages.  The length of each is put in sizes;
+ * a message longer than size is discarded.  Returns the number received.
+ */
+epicsShareFunc int epicsShareAPI epicsMessageQueueReceiveMany(
+    epicsMessageQueueId id,
+    void *messages,
+    unsigned int size,
+    unsigned int count,
+    unsigned int *sizes,
+    double timeout);
 epicsShareFunc int epicsShareAPI epicsMessageQueuePending(
     epicsMessageQueueId id);
 epicsShareFunc void epicsShareAPI epicsMessageQueueShow(
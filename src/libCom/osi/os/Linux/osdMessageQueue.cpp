@@ -0,0 +1,395 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Linux message queue.  Messages are copied into and out of a ring of
+ * slots without a lock: each slot carries a sequence number that says
+ * which position of the ring it is ready to be filled or emptied for,
+ * and senders and receivers claim positions with a compare and swap.
+ * Threads that have to wait sleep on a futex that is bumped whenever
+ * messages are added or slots are freed, and are only woken by the
+ * other side when it has counted them as waiting.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define epicsExportSharedSymbols
+#include "epicsMessageQueue.h"
+#include "epicsAtomic.h"
+
+struct slotHeader {
+    volatile size_t seq;
+    unsigned long   size;
+};
+
+struct epicsMessageQueueOSD {
+    /* Written by senders */
+    size_t          sendPos;
+    char            pad1[64];
+    /* Written by receivers */
+    size_t          receivePos;
+    char            pad2[64];
+    int             messageSeq;     /* bumped after messages are added */
+    int             receiversWaiting;
+    int             slotSeq;        /* bumped after slots are freed */
+    int             sendersWaiting;
+
+    unsigned long   capacity;
+    unsigned long   maxMessageSize;
+    size_t          mask;           /* number of slots less one */
+    size_t          slotSize;
+    char           *slots;
+};
+
+static inline slotHeader *
+slotAt(epicsMessageQueueId pmsg, size_t pos)
+{
+    return (slotHeader *)(pmsg->slots + (pos & pmsg->mask) * pmsg->slotSize);
+}
+
+epicsShareFunc epicsMessageQueueId epicsShareAPI epicsMessageQueueCreate(
+    unsigned int capacity,
+    unsigned int maxMessageSize)
+{
+    epicsMessageQueueId pmsg;
+    size_t nslots, i;
+
+    if(capacity == 0)
+        return NULL;
+
+    pmsg = (epicsMessageQueueId)calloc(1, sizeof(*pmsg));
+    if(!pmsg)
+        return NULL;
+
+    /* A power of two number of slots keeps positions valid across
+     * wrap around, capacity still limits the messages queued */
+    for (nslots = 1; nslots < capacity; nslots <<= 1) {}
+    pmsg->capacity = capacity;
+    pmsg->maxMessageSize = maxMessageSize;
+    pmsg->mask = nslots - 1;
+    pmsg->slotSize = sizeof(slotHeader) +
+        ((maxMessageSize + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1));
+    pmsg->slots = (char *)malloc(nslots * pmsg->slotSize);
+    if (!pmsg->slots) {
+        free(pmsg);
+        return NULL;
+    }
+    for (i = 0; i < nslots; i++)
+        slotAt(pmsg, i)->seq = i;
+    return pmsg;
+}
+
+epicsShareFunc void epicsShareAPI
+epicsMessageQueueDestroy(epicsMessageQueueId pmsg)
+{
+    free(pmsg->slots);
+    free(pmsg);
+}
+
+/*
+ * Sleep until *pseq no longer holds seen, the deadline passes, or a
+ * signal arrives.  Returns false once the deadline has passed.
+ */
+static bool
+futexWait(int *pseq, int seen, const struct timespec *pdeadline)
+{
+    if (syscall(SYS_futex, pseq, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+            seen, pdeadline, NULL, FUTEX_BITSET_MATCH_ANY) == 0)
+        return true;
+    return errno != ETIMEDOUT;
+}
+
+static void
+futexWake(int *pseq, int *pwaiting, unsigned int count)
+{
+    epicsAtomicIncrIntT(pseq);
+    if (epicsAtomicGetIntT(pwaiting) > 0)
+        syscall(SYS_futex, pseq, FUTEX_WAKE_PRIVATE,
+            count < INT_MAX ? (int)count : INT_MAX, NULL, NULL, 0);
+}
+
+/*
+ * Claim up to count consecutive positions whose slots are ready for the
+ * sender (ready == 0) or receiver (ready == 1).  Returns the number
+ * claimed, starting at *ppos.
+ */
+static unsigned int
+claim(epicsMessageQueueId pmsg, size_t *pshared, size_t ready,
+    unsigned int count, size_t *ppos)
+{
+    size_t pos = epicsAtomicGetSizeT(pshared);
+
+    for (;;) {
+        unsigned int n = 0, max = count;
+
+        if (ready == 0) {
+            size_t used = pos - epicsAtomicGetSizeT(&pmsg->receivePos);
+            if (used >= pmsg->capacity)
+                max = 0;
+            else if (max > pmsg->capacity - used)
+                max = pmsg->capacity - used;
+        }
+        while (n < max && slotAt(pmsg, pos + n)->seq == pos + n + ready)
+            n++;
+        if (n == 0) {
+            /* Ready for an older position, someone else claimed it */
+            size_t now = epicsAtomicGetSizeT(pshared);
+            if (now == pos)
+                return 0;
+            pos = now;
+            continue;
+        }
+        size_t prev = epicsAtomicCmpAndSwapSizeT(pshared, pos, pos + n);
+        if (prev == pos) {
+            *ppos = pos;
+            return n;
+        }
+        pos = prev;
+    }
+}
+
+/* Copy up to count messages of size bytes each from messages */
+static unsigned int
+tryPut(epicsMessageQueueId pmsg, const char *messages, unsigned int size,
+    unsigned int count)
+{
+    size_t pos;
+    unsigned int i, n = claim(pmsg, &pmsg->sendPos, 0, count, &pos);
+
+    if (n == 0)
+        return 0;
+    /* The compare and swap in claim() ordered the slot reads */
+    for (i = 0; i < n; i++) {
+        slotHeader *pslot = slotAt(pmsg, pos + i);
+        pslot->size = size;
+        memcpy(pslot + 1, messages + i * size, size);
+    }
+    epicsAtomicWriteMemoryBarrier();
+    for (i = 0; i < n; i++)
+        slotAt(pmsg, pos + i)->seq = pos + i + 1;
+    futexWake(&pmsg->messageSeq, &pmsg->receiversWaiting, n);
+    return n;
+}
+
+/*
+ * Copy up to count messages into buffers of size bytes each.  A longer
+ * message is discarded and its length stored in sizes[i].
+ */
+static unsigned int
+tryGet(epicsMessageQueueId pmsg, char *messages, unsigned int size,
+    unsigned int count, unsigned int *sizes)
+{
+    size_t pos;
+    unsigned int i, n = claim(pmsg, &pmsg->receivePos, 1, count, &pos);
+
+    if (n == 0)
+        return 0;
+    for (i = 0; i < n; i++) {
+        slotHeader *pslot = slotAt(pmsg, pos + i);
+        unsigned long len = pslot->size;
+        if (len <= size)
+            memcpy(messages + i * size, pslot + 1, len);
+        sizes[i] = len;
+    }
+    epicsAtomicWriteMemoryBarrier();
+    for (i = 0; i < n; i++)
+        slotAt(pmsg, pos + i)->seq = pos + i + pmsg->mask + 1;
+    futexWake(&pmsg->slotSeq, &pmsg->sendersWaiting, n);
+    return n;
+}
+
+static void
+getDeadline(double timeout, struct timespec *pdeadline)
+{
+    clock_gettime(CLOCK_MONOTONIC, pdeadline);
+    if (timeout > 1e6)
+        timeout = 1e6;
+    pdeadline->tv_sec += (time_t) timeout;
+    pdeadline->tv_nsec += (long)((timeout - (time_t) timeout) * 1e9);
+    if (pdeadline->tv_nsec >= 1000000000L) {
+        pdeadline->tv_sec++;
+        pdeadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/*
+ * Send count messages, waiting up to timeout (forever if negative) for
+ * space.  Returns the number sent.
+ */
+static unsigned int
+sendMany(epicsMessageQueueId pmsg, const char *messages, unsigned int size,
+    unsigned int count, double timeout)
+{
+    struct timespec deadline, *pdeadline = NULL;
+    unsigned int sent = tryPut(pmsg, messages, size, count);
+
+    if (timeout > 0) {
+        getDeadline(timeout, &deadline);
+        pdeadline = &deadline;
+    }
+    while (sent < count && timeout != 0) {
+        int seen = epicsAtomicGetIntT(&pmsg->slotSeq);
+        unsigned int n;
+        bool waiting;
+
+        epicsAtomicIncrIntT(&pmsg->sendersWaiting);
+        n = tryPut(pmsg, messages + sent * size, size, count - sent);
+        waiting = n == 0 && futexWait(&pmsg->slotSeq, seen, pdeadline);
+        epicsAtomicDecrIntT(&pmsg->sendersWaiting);
+        if (n == 0)
+            n = tryPut(pmsg, messages + sent * size, size, count - sent);
+        sent += n;
+        if (!waiting && n == 0)
+            break;
+    }
+    return sent;
+}
+
+/*
+ * Receive up to count messages, waiting up to timeout (forever if
+ * negative) for the first.  Returns the number received.
+ */
+static unsigned int
+receiveMany(epicsMessageQueueId pmsg, char *messages, unsigned int size,
+    unsigned int count, unsigned int *sizes, double timeout)
+{
+    struct timespec deadline, *pdeadline = NULL;
+    unsigned int received = tryGet(pmsg, messages, size, count, sizes);
+
+    if (timeout > 0) {
+        getDeadline(timeout, &deadline);
+        pdeadline = &deadline;
+    }
+    while (received == 0 && timeout != 0) {
+        int seen = epicsAtomicGetIntT(&pmsg->messageSeq);
+        bool waiting;
+
+        epicsAtomicIncrIntT(&pmsg->receiversWaiting);
+        received = tryGet(pmsg, messages, size, count, sizes);
+        waiting = received == 0 && futexWait(&pmsg->messageSeq, seen, pdeadline);
+        epicsAtomicDecrIntT(&pmsg->receiversWaiting);
+        if (received == 0)
+            received = tryGet(pmsg, messages, size, count, sizes);
+        if (!waiting)
+            break;
+    }
+    return received;
+}
+
+static int
+mySend(epicsMessageQueueId pmsg, void *message, unsigned int size,
+    double timeout)
+{
+    if(size > pmsg->maxMessageSize)
+        return -1;
+    return sendMany(pmsg, (const char *)message, size, 1, timeout) ? 0 : -1;
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueTrySend(epicsMessageQueueId pmsg, void *message,
+    unsigned int size)
+{
+    return mySend(pmsg, message, size, 0);
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueSend(epicsMessageQueueId pmsg, void *message,
+    unsigned int size)
+{
+    return mySend(pmsg, message, size, -1);
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueSendWithTimeout(epicsMessageQueueId pmsg, void *message,
+    unsigned int size, double timeout)
+{
+    return mySend(pmsg, message, size, timeout);
+}
+
+static int
+myReceive(epicsMessageQueueId pmsg, void *message, unsigned int size,
+    double timeout)
+{
+    unsigned int len;
+
+    if (!receiveMany(pmsg, (char *)message, size, 1, &len, timeout) ||
+        len > size)
+        return -1;
+    return len;
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueTryReceive(epicsMessageQueueId pmsg, void *message,
+    unsigned int size)
+{
+    return myReceive(pmsg, message, size, 0);
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueReceive(epicsMessageQueueId pmsg, void *message,
+    unsigned int size)
+{
+    return myReceive(pmsg, message, size, -1);
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueReceiveWithTimeout(epicsMessageQueueId pmsg, void *message,
+    unsigned int size, double timeout)
+{
+    return myReceive(pmsg, message, size, timeout);
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueSendMany(epicsMessageQueueId pmsg, void *messages,
+    unsigned int messageSize, unsigned int count, double timeout)
+{
+    if (messageSize > pmsg->maxMessageSize)
+        return -1;
+    return sendMany(pmsg, (const char *)messages, messageSize, count,
+        timeout);
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueReceiveMany(epicsMessageQueueId pmsg, void *messages,
+    unsigned int size, unsigned int count, unsigned int *sizes,
+    double timeout)
+{
+    return receiveMany(pmsg, (char *)messages, size, count, sizes,
+        timeout);
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueuePending(epicsMessageQueueId pmsg)
+{
+    size_t receivePos = epicsAtomicGetSizeT(&pmsg->receivePos);
+    size_t used = epicsAtomicGetSizeT(&pmsg->sendPos) - receivePos;
+
+    /* Counts messages still being copied in or out */
+    if (used > pmsg->capacity)
+        used = pmsg->capacity;
+    return (int) used;
+}
+
+epicsShareFunc void epicsShareAPI
+epicsMessageQueueShow(epicsMessageQueueId pmsg, int level)
+{
+    printf("Message Queue Used:%d  Slots:%lu", epicsMessageQueuePending(pmsg), pmsg->capacity);
+    if (level >= 1)
+        printf("  Maximum size:%lu  Waiting senders:%d  receivers:%d",
+            pmsg->maxMessageSize,
+            epicsAtomicGetIntT(&pmsg->sendersWaiting),
+            epicsAtomicGetIntT(&pmsg->receiversWaiting));
+    printf("\n");
+}
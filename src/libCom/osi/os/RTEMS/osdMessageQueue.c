@@ -225,6 +225,56 @@ epicsShareFunc int epicsShareAPI epicsMessageQueueReceiveWithTimeout(
     return receiveMessage(id, message, size, wait, delay);
 }
 
+epicsShareFunc int epicsShareAPI epicsMessageQueueSendMany(
+    epicsMessageQueueId id,
+    void *messages,
+    unsigned int messageSize,
+    unsigned int count,
+    double timeout)
+{
+    char *message = messages;
+    unsigned int n;
+
+    if (messageSize > id->maxSize)
+        return -1;
+    for (n = 0 ; n < count ; n++, message += messageSize) {
+        int status;
+
+        if (timeout < 0.0)
+            status = epicsMessageQueueSend(id, message, messageSize);
+        else
+            status = epicsMessageQueueSendWithTimeout(id, message, messageSize, timeout);
+        if (status != 0)
+            break;
+    }
+    return n;
+}
+
+epicsShareFunc int epicsShareAPI epicsMessageQueueReceiveMany(
+    epicsMessageQueueId id,
+    void *messages,
+    unsigned int size,
+    unsigned int count,
+    unsigned int *sizes,
+    double timeout)
+{
+    char *message = messages;
+    unsigned int n;
+
+    for (n = 0 ; n < count ; n++, message += size) {
+        int length;
+
+        if (n == 0 && timeout < 0.0)
+            length = epicsMessageQueueReceive(id, message, size);
+        else
+            length = epicsMessageQueueReceiveWithTimeout(id, message, size, n ? 0.0 : timeout);
+        if (length < 0)
+            break;
+        sizes[n] = length;
+    }
+    return n;
+}
+
 epicsShareFunc int epicsShareAPI epicsMessageQueuePending(
             epicsMessageQueueId id)
 {
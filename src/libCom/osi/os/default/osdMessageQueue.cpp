@@ -264,7 +264,7 @@ epicsMessageQueueSendWithTimeout(epicsMessageQueueId pmsg, void *message,
 
 static int
 myReceive(epicsMessageQueueId pmsg, void *message, unsigned int size,
-    double timeout)
+    double timeout, unsigned int *plength = NULL)
 {
     char *myOutPtr;
     unsigned long l;
@@ -279,6 +279,8 @@ myReceive(epicsMessageQueueId pmsg, void *message, unsigned int size,
     if ((myOutPtr != pmsg->inPtr) || pmsg->full) {
         int ret;
         l = *(unsigned long *)myOutPtr;
+        if (plength)
+            *plength = l;
         if (l <= size) {
             memcpy(message, (unsigned long *)myOutPtr + 1, l);
             ret = l;
@@ -352,6 +354,8 @@ myReceive(epicsMessageQueueId pmsg, void *message, unsigned int size,
 
     epicsMutexUnlock(pmsg->mutex);
 
+    if (plength && threadNode.eventSent)
+        *plength = threadNode.size;
     if (threadNode.eventSent && (threadNode.size <= size) &&
         status == epicsEventOK)
         return threadNode.size;
@@ -379,6 +383,40 @@ epicsMessageQueueReceiveWithTimeout(epicsMessageQueueId pmsg, void *message,
     return myReceive(pmsg, message, size, timeout);
 }
 
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueSendMany(epicsMessageQueueId pmsg, void *messages,
+    unsigned int messageSize, unsigned int count, double timeout)
+{
+    char *message = (char *)messages;
+    unsigned int n;
+
+    if(messageSize > pmsg->maxMessageSize)
+        return -1;
+    for (n = 0; n < count; n++, message += messageSize) {
+        if (mySend(pmsg, message, messageSize, timeout))
+            break;
+    }
+    return n;
+}
+
+epicsShareFunc int epicsShareAPI
+epicsMessageQueueReceiveMany(epicsMessageQueueId pmsg, void *messages,
+    unsigned int size, unsigned int count, unsigned int *sizes,
+    double timeout)
+{
+    char *message = (char *)messages;
+    unsigned int n;
+
+    for (n = 0; n < count; n++, message += size) {
+        /* No message can be longer than this */
+        sizes[n] = pmsg->maxMessageSize + 1;
+        if (myReceive(pmsg, message, size, n ? 0 : timeout, &sizes[n]) < 0 &&
+            sizes[n] > pmsg->maxMessageSize)
+            break;
+    }
+    return n;
+}
+
 epicsShareFunc int epicsShareAPI
 epicsMessageQueuePending(epicsMessageQueueId pmsg)
 {
@@ -52,3 +52,53 @@ epicsShareFunc int epicsShareAPI epicsMessageQueueReceiveWithTimeout(
     }
     return msgQReceive((MSG_Q_ID)id, (char *)message, size, ticks);
 }
+
+epicsShareFunc int epicsShareAPI epicsMessageQueueSendMany(
+    epicsMessageQueueId id,
+    void *messages,
+    unsigned int messageSize,
+    unsigned int count,
+    double timeout)
+{
+    char *message = (char *)messages;
+    unsigned int n;
+
+    for (n = 0; n < count; n++, message += messageSize) {
+        int status;
+
+        if (timeout < 0.0)
+            status = epicsMessageQueueSend(id, message, messageSize);
+        else
+            status = epicsMessageQueueSendWithTimeout(id, message,
+                messageSize, timeout);
+        if (status != OK)
+            break;
+    }
+    return n;
+}
+
+epicsShareFunc int epicsShareAPI epicsMessageQueueReceiveMany(
+    epicsMessageQueueId id,
+    void *messages,
+    unsigned int size,
+    unsigned int count,
+    unsigned int *sizes,
+    double timeout)
+{
+    char *message = (char *)messages;
+    unsigned int n;
+
+    for (n = 0; n < count; n++, message += size) {
+        int length;
+
+        if (n == 0 && timeout < 0.0)
+            length = epicsMessageQueueReceive(id, message, size);
+        else
+            length = epicsMessageQueueReceiveWithTimeout(id, message, size,
+                n ? 0.0 : timeout);
+        if (length < 0)
+            break;
+        sizes[n] = length;
+    }
+    return n;
+}
@@ -22,6 +22,7 @@
 
 #define epicsExportSharedSymbols
 #include "epicsSpin.h"
+#include "epicsAtomic.h"
 #include "dbDefs.h"
 #include "epicsRingBytes.h"
 
@@ -35,6 +36,7 @@
 
 typedef struct ringPvt {
     epicsSpinId    lock;
+    int            ordered;  /* SPSC: barriers around the index updates */
     volatile int   nextPut;
     volatile int   nextGet;
     int            size;
@@ -50,6 +52,16 @@ epicsShareFunc epicsRingBytesId  epicsShareAPI epicsRingBytesCreate(int size)
     pring->nextGet = 0;
     pring->nextPut = 0;
     pring->lock    = 0;
+    pring->ordered = 0;
+    return((void *)pring);
+}
+
+epicsShareFunc epicsRingBytesId  epicsShareAPI epicsRingBytesSPSCCreate(int size)
+{
+    ringPvt *pring = (ringPvt *)epicsRingBytesCreate(size);
+    if(!pring)
+        return NULL;
+    pring->ordered = 1;
     return((void *)pring);
 }
 
@@ -80,6 +92,8 @@ epicsShareFunc int epicsShareAPI epicsRingBytesGet(
     nextGet = pring->nextGet;
     nextPut = pring->nextPut;
     size = pring->size;
+    if (pring->ordered)
+        epicsAtomicReadMemoryBarrier();
 
     if (nextGet <= nextPut) {
         count = nextPut - nextGet;
@@ -107,6 +121,8 @@ epicsShareFunc int epicsShareAPI epicsRingBytesGet(
             nbytes = count;
         }
     }
+    if (pring->ordered)
+        epicsAtomicWriteMemoryBarrier();
     pring->nextGet = nextGet;
 
     if (pring->lock) epicsSpinUnlock(pring->lock);
@@ -124,6 +140,8 @@ epicsShareFunc int epicsShareAPI epicsRingBytesPut(
     nextGet = pring->nextGet;
     nextPut = pring->nextPut;
     size = pring->size;
+    if (pring->ordered)
+        epicsAtomicReadMemoryBarrier();
 
     if (nextPut < nextGet) {
         freeCount = nextGet - nextPut - SLOP;
@@ -153,6 +171,8 @@ epicsShareFunc int epicsShareAPI epicsRingBytesPut(
             nextPut = nLeft;
         }
     }
+    if (pring->ordered)
+        epicsAtomicWriteMemoryBarrier();
     pring->nextPut = nextPut;
 
     if (pring->lock) epicsSpinUnlock(pring->lock);
@@ -164,7 +184,14 @@ epicsShareFunc void epicsShareAPI epicsRingBytesFlush(epicsRingBytesId id)
     ringPvt *pring = (ringPvt *)id;
 
     if (pring->lock) epicsSpinLock(pring->lock);
-    pring->nextGet = pring->nextPut;
+    if (pring->ordered) {
+        /* Only the consumer may flush an SPSC ring */
+        int nextPut = pring->nextPut;
+        epicsAtomicWriteMemoryBarrier();
+        pring->nextGet = nextPut;
+    }
+    else
+        pring->nextGet = pring->nextPut;
     if (pring->lock) epicsSpinUnlock(pring->lock);
 }
 
@@ -28,6 +28,8 @@ typedef void *epicsRingBytesId;
 epicsShareFunc epicsRingBytesId  epicsShareAPI epicsRingBytesCreate(int nbytes);
 /* Same, but secured by a spinlock */
 epicsShareFunc epicsRingBytesId  epicsShareAPI epicsRingBytesLockedCreate(int nbytes);
+/* Lock free, for one putting and one getting thread */
+epicsShareFunc epicsRingBytesId  epicsShareAPI epicsRingBytesSPSCCreate(int nbytes);
 epicsShareFunc void epicsShareAPI epicsRingBytesDelete(epicsRingBytesId id);
 epicsShareFunc int  epicsShareAPI epicsRingBytesGet(
     epicsRingBytesId id, char *value,int nbytes);
@@ -49,6 +51,12 @@ epicsShareFunc int  epicsShareAPI epicsRingBytesIsFull(epicsRingBytesId id);
     If there is a single reader it is not necessary to lock for puts
 
     epicsRingBytesLocked uses a spinlock.
+
+    The unlocked ring makes no promise about the order in which the other
+    thread sees the data and the index that covers it.  The SPSC ring adds
+    the memory barriers that make it safe for one putting and one getting
+    thread, which may each move any number of bytes in one call.  Only the
+    getting thread may flush it.
 */
 
 #endif /* INCepicsRingBytesh */
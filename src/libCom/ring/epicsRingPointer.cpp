@@ -37,6 +37,18 @@ epicsShareFunc epicsRingPointerId  epicsShareAPI epicsRingPointerLockedCreate(in
     return(reinterpret_cast<void *>(pvoidPointer));
 }
 
+epicsShareFunc epicsRingPointerId  epicsShareAPI epicsRingPointerSPSCCreate(int size)
+{
+    voidPointer *pvoidPointer = new voidPointer(size, voidPointer::spsc);
+    return(reinterpret_cast<void *>(pvoidPointer));
+}
+
+epicsShareFunc epicsRingPointerId  epicsShareAPI epicsRingPointerMPSCCreate(int size)
+{
+    voidPointer *pvoidPointer = new voidPointer(size, voidPointer::mpsc);
+    return(reinterpret_cast<void *>(pvoidPointer));
+}
+
 epicsShareFunc void epicsShareAPI epicsRingPointerDelete(epicsRingPointerId id)
 {
     voidPointer *pvoidPointer = reinterpret_cast<voidPointer*>(id);
@@ -55,6 +67,20 @@ epicsShareFunc int epicsShareAPI epicsRingPointerPush(epicsRingPointerId id, voi
     return((pvoidPointer->push(p) ? 1 : 0));
 }
 
+epicsShareFunc int epicsShareAPI epicsRingPointerPushMany(epicsRingPointerId id,
+    void * const *pp, int n)
+{
+    voidPointer *pvoidPointer = reinterpret_cast<voidPointer*>(id);
+    return pvoidPointer->pushMany(pp, n);
+}
+
+epicsShareFunc int epicsShareAPI epicsRingPointerPopMany(epicsRingPointerId id,
+    void **pp, int n)
+{
+    voidPointer *pvoidPointer = reinterpret_cast<voidPointer*>(id);
+    return pvoidPointer->popMany(pp, n);
+}
+
 epicsShareFunc void epicsShareAPI epicsRingPointerFlush(epicsRingPointerId id)
 {
     voidPointer *pvoidPointer = reinterpret_cast<voidPointer*>(id);
@@ -21,19 +21,32 @@
  *   If there is a single reader it is not necessary to lock pop
  *
  *   epicsRingPointerLocked uses a spinlock.
+ *
+ *   The unlocked ring makes no promise about the order in which another
+ *   thread sees the pushed pointer and the data it points to.  The SPSC
+ *   (single producer, single consumer) ring adds memory barriers so that
+ *   it does, and the MPSC (multiple producer, single consumer) ring also
+ *   lets any number of threads push without a lock.  An MPSC ring can not
+ *   hold NULL pointers.  Flush may only be called by the consumer of
+ *   either of these.
  */
 
 #include "epicsSpin.h"
+#include "epicsAtomic.h"
 #include "shareLib.h"
 
 #ifdef __cplusplus
 template <class T>
 class epicsRingPointer {
 public: /* Functions */
-    epicsRingPointer(int size, bool locked);
+    enum ringMode { unlocked, locked, spsc, mpsc };
+    epicsRingPointer(int size, bool isLocked);
+    epicsRingPointer(int size, ringMode mode);
     ~epicsRingPointer();
     bool push(T *p);
     T* pop();
+    int pushMany(T * const *pp, int n);
+    int popMany(T **pp, int n);
     void flush();
     int getFree() const;
     int getUsed() const;
@@ -49,6 +62,7 @@ private: /* Prevent compiler-generated member functions */
 
 private: /* Data */
     epicsSpinId lock;
+    ringMode mode;
     volatile int nextPush;
     volatile int nextPop;
     int size;
@@ -63,11 +77,20 @@ typedef void *epicsRingPointerId;
 epicsShareFunc epicsRingPointerId  epicsShareAPI epicsRingPointerCreate(int size);
 /* Same, but secured by a spinlock */
 epicsShareFunc epicsRingPointerId  epicsShareAPI epicsRingPointerLockedCreate(int size);
+/* Lock free, for one pushing and one popping thread */
+epicsShareFunc epicsRingPointerId  epicsShareAPI epicsRingPointerSPSCCreate(int size);
+/* Lock free, for any number of pushing threads and one popping thread */
+epicsShareFunc epicsRingPointerId  epicsShareAPI epicsRingPointerMPSCCreate(int size);
 epicsShareFunc void epicsShareAPI epicsRingPointerDelete(epicsRingPointerId id);
 /*ringPointerPush returns (0,1) if p (was not, was) put on ring*/
 epicsShareFunc int  epicsShareAPI epicsRingPointerPush(epicsRingPointerId id,void *p);
 /*ringPointerPop returns 0 if ring is empty*/
 epicsShareFunc void* epicsShareAPI epicsRingPointerPop(epicsRingPointerId id) ;
+/*PushMany and PopMany return the number of pointers moved, up to n*/
+epicsShareFunc int  epicsShareAPI epicsRingPointerPushMany(epicsRingPointerId id,
+    void * const *pp, int n);
+epicsShareFunc int  epicsShareAPI epicsRingPointerPopMany(epicsRingPointerId id,
+    void **pp, int n);
 epicsShareFunc void epicsShareAPI epicsRingPointerFlush(epicsRingPointerId id);
 epicsShareFunc int  epicsShareAPI epicsRingPointerGetFree(epicsRingPointerId id);
 epicsShareFunc int  epicsShareAPI epicsRingPointerGetUsed(epicsRingPointerId id);
@@ -90,15 +113,33 @@ epicsShareFunc int  epicsShareAPI epicsRingPointerIsFull(epicsRingPointerId id);
  *  A put request is rejected if the it would cause nextPush to equal nextPop
  *  The algorithm does not require locking puts for a single writer
  *      or locking of gets for a single reader
+ *
+ *  The lock free modes read the other side's index before a read barrier
+ *  (acquire) and update their own index after a write barrier (release).
+ *  MPSC producers reserve space by a compare and swap of nextPush and then
+ *  fill their slots; the consumer stops at a slot that is still NULL and
+ *  clears each slot before releasing it.
  */
 #ifdef __cplusplus
 
 template <class T>
-inline epicsRingPointer<T>::epicsRingPointer(int sz, bool locked) :
-    lock(0), nextPush(0), nextPop(0), size(sz+1), buffer(new T* [sz+1])
+inline epicsRingPointer<T>::epicsRingPointer(int sz, bool isLocked) :
+    lock(0), mode(isLocked ? locked : unlocked),
+    nextPush(0), nextPop(0), size(sz+1), buffer(new T* [sz+1])
+{
+    if (isLocked)
+        lock = epicsSpinCreate();
+}
+
+template <class T>
+inline epicsRingPointer<T>::epicsRingPointer(int sz, ringMode mod) :
+    lock(0), mode(mod), nextPush(0), nextPop(0), size(sz+1),
+    buffer(new T* [sz+1])
 {
-    if (locked)
+    if (mode == locked)
         lock = epicsSpinCreate();
+    for (int i = 0; i < size; i++)
+        buffer[i] = 0;
 }
 
 template <class T>
@@ -111,6 +152,8 @@ inline epicsRingPointer<T>::~epicsRingPointer()
 template <class T>
 inline bool epicsRingPointer<T>::push(T *p)
 {
+    if (mode == spsc || mode == mpsc)
+        return pushMany(&p, 1) == 1;
     if (lock) epicsSpinLock(lock);
     int next = nextPush;
     int newNext = next + 1;
@@ -128,6 +171,10 @@ inline bool epicsRingPointer<T>::push(T *p)
 template <class T>
 inline T* epicsRingPointer<T>::pop()
 {
+    if (mode == spsc || mode == mpsc) {
+        T *p;
+        return popMany(&p, 1) ? p : 0;
+    }
     if (lock) epicsSpinLock(lock);
     int next = nextPop;
     if (next == nextPush) {
@@ -142,9 +189,112 @@ inline T* epicsRingPointer<T>::pop()
     return(p);
 }
 
+template <class T>
+inline int epicsRingPointer<T>::pushMany(T * const *pp, int n)
+{
+    int next, count, i;
+
+    if (mode == mpsc) {
+        for (i = 0; i < n; i++)
+            if (!pp[i]) n = i;
+        do {
+            next = nextPush;
+            count = nextPop;
+            epicsAtomicReadMemoryBarrier();
+            count -= next + 1;
+            if (count < 0) count += size;
+            if (count > n) count = n;
+            if (count == 0)
+                return 0;
+        } while (epicsAtomicCmpAndSwapIntT(const_cast<int *>(&nextPush),
+                     next, (next + count) % size) != next);
+        /* the compare and swap is a full barrier */
+        for (i = 0; i < count; i++) {
+            buffer[next] = pp[i];
+            if (++next >= size) next = 0;
+        }
+        return count;
+    }
+
+    if (lock) epicsSpinLock(lock);
+    next = nextPush;
+    count = nextPop;
+    if (mode == spsc)
+        epicsAtomicReadMemoryBarrier();
+    count -= next + 1;
+    if (count < 0) count += size;
+    if (count > n) count = n;
+    for (i = 0; i < count; i++) {
+        buffer[next] = pp[i];
+        if (++next >= size) next = 0;
+    }
+    if (mode == spsc)
+        epicsAtomicWriteMemoryBarrier();
+    nextPush = next;
+    if (lock) epicsSpinUnlock(lock);
+    return count;
+}
+
+template <class T>
+inline int epicsRingPointer<T>::popMany(T **pp, int n)
+{
+    int next, count, i;
+
+    if (mode == mpsc) {
+        next = nextPop;
+        for (count = 0; count < n; count++) {
+            T *p = buffer[next];
+            if (!p)
+                break;
+            pp[count] = p;
+            if (++next >= size) next = 0;
+        }
+        if (count == 0)
+            return 0;
+        epicsAtomicReadMemoryBarrier();
+        next = nextPop;
+        for (i = 0; i < count; i++) {
+            buffer[next] = 0;
+            if (++next >= size) next = 0;
+        }
+        epicsAtomicWriteMemoryBarrier();
+        nextPop = next;
+        return count;
+    }
+
+    if (lock) epicsSpinLock(lock);
+    next = nextPop;
+    count = nextPush;
+    if (mode == spsc)
+        epicsAtomicReadMemoryBarrier();
+    count -= next;
+    if (count < 0) count += size;
+    if (count > n) count = n;
+    for (i = 0; i < count; i++) {
+        pp[i] = buffer[next];
+        if (++next >= size) next = 0;
+    }
+    if (mode == spsc)
+        epicsAtomicWriteMemoryBarrier();
+    nextPop = next;
+    if (lock) epicsSpinUnlock(lock);
+    return count;
+}
+
 template <class T>
 inline void epicsRingPointer<T>::flush()
 {
+    if (mode == mpsc) {
+        T *p[16];
+        while (popMany(p, 16)) {}
+        return;
+    }
+    if (mode == spsc) {
+        int next = nextPush;
+        epicsAtomicWriteMemoryBarrier();
+        nextPop = next;
+        return;
+    }
     if (lock) epicsSpinLock(lock);
     nextPop = 0;
     nextPush = 0;
@@ -81,6 +81,7 @@ typedef struct {
 } clientPvt;
 
 static void testLogPrefix(void);
+static void testRepeats(void);
 static void acceptNewClient( void *pParam );
 static void readFromClient( void *pParam );
 static void testPrefixLogandCompare( const char* logmessage);
@@ -169,11 +170,13 @@ MAIN(epicsErrlogTest)
     char msg[256];
     clientPvt pvt, pvt2;
 
-    testPlan(32);
+    testPlan(37);
 
     strcpy(msg, truncmsg);
 
     errlogInit2(LOGBUFSIZE, 256);
+    /* The capacity tests below log the same message many times */
+    errlogSetRepeatInterval(0.0);
 
     pvt.count = 0;
     pvt2.count = 0;
@@ -347,10 +350,76 @@ MAIN(epicsErrlogTest)
     testOk(1 == errlogRemoveListeners(&logClient, &pvt),
         "Removed 1 listener");
 
+    testRepeats();
     testLogPrefix();
 
     return testDone();
 }
+
+typedef struct {
+    unsigned int count;
+    char last[2][128];
+} repeatPvt;
+
+static
+void repeatClient(void* raw, const char* msg)
+{
+    repeatPvt *pvt = raw;
+
+    strcpy(pvt->last[0], pvt->last[1]);
+    strncpy(pvt->last[1], msg, sizeof pvt->last[1] - 1);
+    pvt->count++;
+}
+
+/*
+ * Tests that a message repeated by one thread is counted rather than
+ * logged again, and that the count is reported when the thread logs
+ * something else or goes quiet.
+ */
+static void testRepeats(void)
+{
+    repeatPvt pvt;
+    char expect[128];
+    int i;
+
+    testDiag("Check repeated messages");
+
+    /* Clear "errlog: <n> messages were discarded" status */
+    errlogPrintfNoConsole(".");
+    errlogFlush();
+
+    memset(&pvt, 0, sizeof pvt);
+    errlogAddListener(&repeatClient, &pvt);
+    errlogSetRepeatInterval(10.0);
+
+    for (i = 0; i < 5; i++)
+        errlogPrintfNoConsole("Repeated\n");
+    errlogFlush();
+    testEqInt(pvt.count, 1);
+
+    errlogPrintfNoConsole("Different\n");
+    errlogFlush();
+    testEqInt(pvt.count, 3);
+    sprintf(expect, "errlog: last message from %s repeated 4 times\n",
+        epicsThreadGetNameSelf());
+    testOk(strcmp(pvt.last[0], expect) == 0 &&
+           strcmp(pvt.last[1], "Different\n") == 0,
+        "Repeat count came before the next message");
+
+    /* errlogThread reports repeats once the thread goes quiet */
+    errlogSetRepeatInterval(0.2);
+    for (i = 0; i < 3; i++)
+        errlogPrintfNoConsole("Quiet\n");
+    epicsThreadSleep(1.0);
+    testEqInt(pvt.count, 5);
+    sprintf(expect, "errlog: last message from %s repeated 2 times\n",
+        epicsThreadGetNameSelf());
+    testOk(strcmp(pvt.last[1], expect) == 0,
+        "Repeat count reported after the thread went quiet");
+
+    errlogSetRepeatInterval(0.0);
+    errlogRemoveListeners(&repeatClient, &pvt);
+}
 /*
  * Tests the log prefix code
  * The prefix is only applied to log messages as they go out to the socket,
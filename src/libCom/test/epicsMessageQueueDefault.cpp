@@ -0,0 +1,30 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* epicsMessageQueueDefault.cpp */
+
+/*
+ * Builds the default message queue implementation under other names so
+ * that epicsMessageQueuePerform can compare it with the one this target
+ * actually uses.
+ */
+
+#define epicsMessageQueueOSD defaultMessageQueueOSD
+#define epicsMessageQueueId defaultMessageQueueId
+#define epicsMessageQueueCreate defaultMessageQueueCreate
+#define epicsMessageQueueDestroy defaultMessageQueueDestroy
+#define epicsMessageQueueTrySend defaultMessageQueueTrySend
+#define epicsMessageQueueSend defaultMessageQueueSend
+#define epicsMessageQueueSendWithTimeout defaultMessageQueueSendWithTimeout
+#define epicsMessageQueueTryReceive defaultMessageQueueTryReceive
+#define epicsMessageQueueReceive defaultMessageQueueReceive
+#define epicsMessageQueueReceiveWithTimeout defaultMessageQueueReceiveWithTimeout
+#define epicsMessageQueueSendMany defaultMessageQueueSendMany
+#define epicsMessageQueueReceiveMany defaultMessageQueueReceiveMany
+#define epicsMessageQueuePending defaultMessageQueuePending
+#define epicsMessageQueueShow defaultMessageQueueShow
+
+#include "../osi/os/default/osdMessageQueue.cpp"
@@ -0,0 +1,225 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* epicsMessageQueuePerform.cpp */
+
+/*
+ * Measures the messages per second that producer threads can pass to a
+ * consumer through the default message queue implementation and through
+ * the one this target uses, one message per call and in batches, and the
+ * round trip time of a message passed to an echo thread and back.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "epicsMessageQueue.h"
+#include "epicsThread.h"
+#include "epicsEvent.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+/* Built from os/default by epicsMessageQueueDefault.cpp */
+extern "C" {
+typedef struct defaultMessageQueueOSD *defaultMessageQueueId;
+defaultMessageQueueId defaultMessageQueueCreate(unsigned int capacity,
+    unsigned int maximumMessageSize);
+void defaultMessageQueueDestroy(defaultMessageQueueId id);
+int defaultMessageQueueSend(defaultMessageQueueId id, void *message,
+    unsigned int messageSize);
+int defaultMessageQueueReceive(defaultMessageQueueId id, void *message,
+    unsigned int size);
+int defaultMessageQueueSendMany(defaultMessageQueueId id, void *messages,
+    unsigned int messageSize, unsigned int count, double timeout);
+int defaultMessageQueueReceiveMany(defaultMessageQueueId id,
+    void *messages, unsigned int size, unsigned int count,
+    unsigned int *sizes, double timeout);
+}
+
+static const unsigned queueCapacity = 1024u;
+static const unsigned messageSize = 16u;
+static const unsigned maxBatch = 32u;
+static const unsigned messagesPerTest = 1000000u;
+static const unsigned roundTrips = 20000u;
+
+/* The calls used, so either implementation can be measured */
+struct queueOps {
+    const char * name;
+    void * ( * create ) ( unsigned int, unsigned int );
+    void ( * destroy ) ( void * );
+    int ( * send ) ( void *, void *, unsigned int );
+    int ( * receive ) ( void *, void *, unsigned int );
+    int ( * sendMany ) ( void *, void *, unsigned int, unsigned int, double );
+    int ( * receiveMany ) ( void *, void *, unsigned int, unsigned int,
+        unsigned int *, double );
+};
+
+#define QUEUE_OPS(name, prefix) { name, \
+    (void * (*) ( unsigned int, unsigned int )) prefix ## Create, \
+    (void (*) ( void * )) prefix ## Destroy, \
+    (int (*) ( void *, void *, unsigned int )) prefix ## Send, \
+    (int (*) ( void *, void *, unsigned int )) prefix ## Receive, \
+    (int (*) ( void *, void *, unsigned int, unsigned int, double )) \
+        prefix ## SendMany, \
+    (int (*) ( void *, void *, unsigned int, unsigned int, \
+        unsigned int *, double )) prefix ## ReceiveMany }
+
+static const queueOps implementations[] = {
+    QUEUE_OPS ( "default", defaultMessageQueue ),
+    QUEUE_OPS ( "native", epicsMessageQueue )
+};
+
+struct perfPvt {
+    const queueOps * ops;
+    void * queue;
+    void * back;
+    epicsEventId done;
+    unsigned batch;
+    unsigned count;
+};
+
+extern "C" void producer ( void * pArg )
+{
+    perfPvt * pPvt = static_cast < perfPvt * > ( pArg );
+    char messages[maxBatch][messageSize];
+    unsigned sent = 0u;
+
+    memset ( messages, 0, sizeof ( messages ) );
+    while ( sent < pPvt->count ) {
+        unsigned n = pPvt->count - sent;
+        if ( n > pPvt->batch ) {
+            n = pPvt->batch;
+        }
+        if ( pPvt->batch == 1u ) {
+            pPvt->ops->send ( pPvt->queue, messages[0], messageSize );
+        }
+        else {
+            n = pPvt->ops->sendMany ( pPvt->queue, messages, messageSize,
+                n, -1.0 );
+        }
+        sent += n;
+    }
+    epicsEventMustTrigger ( pPvt->done );
+}
+
+static void measureThroughput ( const queueOps * pOps,
+    unsigned nProducers, unsigned batch )
+{
+    perfPvt * pPvts = new perfPvt [ nProducers ];
+    char messages[maxBatch][messageSize];
+    unsigned sizes[maxBatch];
+    unsigned total = ( messagesPerTest / nProducers ) * nProducers;
+    unsigned received = 0u;
+    unsigned i;
+
+    void * queue = pOps->create ( queueCapacity, messageSize );
+    epicsTime begin = epicsTime::getCurrent ();
+    for ( i = 0u; i < nProducers; i++ ) {
+        pPvts[i].ops = pOps;
+        pPvts[i].queue = queue;
+        pPvts[i].done = epicsEventMustCreate ( epicsEventEmpty );
+        pPvts[i].batch = batch;
+        pPvts[i].count = total / nProducers;
+        epicsThreadMustCreate ( "producer", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize ( epicsThreadStackSmall ),
+            producer, & pPvts[i] );
+    }
+    while ( received < total ) {
+        if ( batch == 1u ) {
+            pOps->receive ( queue, messages[0], messageSize );
+            received++;
+        }
+        else {
+            int n = pOps->receiveMany ( queue, messages, messageSize,
+                batch, sizes, -1.0 );
+            if ( n > 0 ) {
+                received += n;
+            }
+        }
+    }
+    double seconds = epicsTime::getCurrent () - begin;
+    for ( i = 0u; i < nProducers; i++ ) {
+        epicsEventMustWait ( pPvts[i].done );
+        epicsEventDestroy ( pPvts[i].done );
+    }
+
+    testDiag ( "%-7s %u producers batch %2u %12.0f messages/sec",
+        pOps->name, nProducers, batch, total / seconds );
+    pOps->destroy ( queue );
+    delete [] pPvts;
+}
+
+extern "C" void echo ( void * pArg )
+{
+    perfPvt * pPvt = static_cast < perfPvt * > ( pArg );
+    char message[messageSize];
+
+    for ( unsigned n = 0u; n < roundTrips; n++ ) {
+        pPvt->ops->receive ( pPvt->queue, message, messageSize );
+        pPvt->ops->send ( pPvt->back, message, messageSize );
+    }
+    epicsEventMustTrigger ( pPvt->done );
+}
+
+static void measureLatency ( const queueOps * pOps )
+{
+    perfPvt pvt;
+    char message[messageSize];
+    unsigned n, bad = 0u;
+
+    pvt.ops = pOps;
+    pvt.queue = pOps->create ( queueCapacity, messageSize );
+    pvt.back = pOps->create ( queueCapacity, messageSize );
+    pvt.done = epicsEventMustCreate ( epicsEventEmpty );
+
+    epicsThreadMustCreate ( "echo", epicsThreadPriorityMedium,
+        epicsThreadGetStackSize ( epicsThreadStackSmall ),
+        echo, & pvt );
+    epicsTime begin = epicsTime::getCurrent ();
+    for ( n = 0u; n < roundTrips; n++ ) {
+        memcpy ( message, & n, sizeof ( n ) );
+        pOps->send ( pvt.queue, message, messageSize );
+        pOps->receive ( pvt.back, message, messageSize );
+        if ( memcmp ( message, & n, sizeof ( n ) ) ) {
+            bad++;
+        }
+    }
+    double seconds = epicsTime::getCurrent () - begin;
+    epicsEventMustWait ( pvt.done );
+
+    testDiag ( "%-7s round trip %8.3f usec", pOps->name,
+        seconds * 1e6 / roundTrips );
+    testOk ( bad == 0u, "%u messages came back out of order", bad );
+
+    epicsEventDestroy ( pvt.done );
+    pOps->destroy ( pvt.queue );
+    pOps->destroy ( pvt.back );
+}
+
+MAIN(epicsMessageQueuePerform)
+{
+    unsigned maxProducers = epicsThreadGetCPUs ();
+    unsigned i, n;
+
+    if ( maxProducers < 4u ) {
+        maxProducers = 4u;
+    }
+    testPlan ( 0 );
+    testDiag ( "%u byte messages through a queue of %u, %d CPUs",
+        messageSize, queueCapacity, epicsThreadGetCPUs () );
+    for ( i = 0u; i < 2u; i++ ) {
+        for ( n = 1u; n <= maxProducers; n *= 2u ) {
+            measureThroughput ( & implementations[i], n, 1u );
+            measureThroughput ( & implementations[i], n, maxBatch );
+        }
+    }
+    for ( i = 0u; i < 2u; i++ ) {
+        measureLatency ( & implementations[i] );
+    }
+    return testDone ();
+}
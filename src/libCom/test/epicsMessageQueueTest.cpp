@@ -137,6 +137,8 @@ extern "C" void messageQueueTest(void *parm)
     epicsThreadId myThreadId = epicsThreadGetIdSelf();
     unsigned int i;
     char cbuf[80];
+    char mbuf[6][20], rbuf[6][20];
+    unsigned int sizes[6];
     int len;
     int pass;
     int want;
@@ -242,6 +244,25 @@ extern "C" void messageQueueTest(void *parm)
     testOk1(q1->receive((void *)cbuf, sizeof cbuf, 1.0) < 0);
     testOk1(q1->pending() == 0);
 
+    testDiag("Test bulk send and receive:");
+    for (i = 0 ; i < 6 ; i++)
+        memcpy(mbuf[i], msg1 + i, sizeof mbuf[i]);
+    testOk1(q1->sendMany((void *)mbuf, 20, 6, 0.0) == 4);
+    testOk1(q1->pending() == 4);
+    testOk1(q1->sendMany((void *)mbuf, 21, 1, 0.0) < 0);
+    testOk1(q1->receiveMany((void *)rbuf, 20, 3, sizes, 1.0) == 3);
+    for (i = 0, pass = 1 ; i < 3 ; i++)
+        if (sizes[i] != 20 || memcmp(rbuf[i], mbuf[i], 20) != 0)
+            pass = 0;
+    testOk(pass, "Messages received in order");
+    testOk1(q1->receiveMany((void *)rbuf, 20, 6, sizes, 1.0) == 1 &&
+        memcmp(rbuf[0], mbuf[3], 20) == 0);
+    testOk1(q1->receiveMany((void *)rbuf, 20, 6, sizes, 0.1) == 0);
+    q1->send((void *)msg1, 10);
+    testOk(q1->receiveMany((void *)rbuf, 5, 1, sizes, 1.0) == 1 &&
+        sizes[0] == 10, "Long message discarded, length %u", sizes[0]);
+    testOk1(q1->pending() == 0);
+
     testDiag("Single receiver with invalid size, single sender tests:");
     epicsThreadCreate("Bad Receiver", epicsThreadPriorityMedium,
         mediumStack, badReceiver, q1);
@@ -312,7 +333,7 @@ extern "C" void messageQueueTest(void *parm)
 
 MAIN(epicsMessageQueueTest)
 {
-    testPlan(62);
+    testPlan(71);
 
     finished = epicsEventMustCreate(epicsEventEmpty);
     mediumStack = epicsThreadGetStackSize(epicsThreadStackMedium);
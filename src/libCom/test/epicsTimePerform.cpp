@@ -0,0 +1,122 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* epicsTimePerform.cpp */
+
+/*
+ * Measures how many time stamps per second epicsTimeGetCurrent() returns
+ * as the number of threads calling it grows, and compares this with
+ * generalTimeGetExceptPriority(), which always walks the provider list
+ * with its lock held.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "epicsThread.h"
+#include "epicsEvent.h"
+#include "epicsTime.h"
+#include "epicsGeneralTime.h"
+#include "generalTimeSup.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+static const unsigned callsPerCheck = 1000u;
+static const double measureSeconds = 0.5;
+
+struct timeThread {
+    epicsEventId done;
+    bool locked;
+    volatile bool * pStop;
+    unsigned long calls;
+    unsigned long backwards;
+};
+
+extern "C" void timeThreadMain ( void * pArg )
+{
+    timeThread * pThread = static_cast < timeThread * > ( pArg );
+    epicsTimeStamp last, now;
+    int prio;
+
+    epicsTimeGetCurrent ( & last );
+    while ( ! * pThread->pStop ) {
+        for ( unsigned i = 0u; i < callsPerCheck; i++ ) {
+            if ( pThread->locked ) {
+                generalTimeGetExceptPriority ( & now, & prio, 0 );
+            }
+            else {
+                epicsTimeGetCurrent ( & now );
+                if ( epicsTimeLessThan ( & now, & last ) ) {
+                    pThread->backwards++;
+                }
+                last = now;
+            }
+        }
+        pThread->calls += callsPerCheck;
+    }
+    epicsEventSignal ( pThread->done );
+}
+
+static void measure ( unsigned nThreads, bool locked )
+{
+    timeThread * pThreads = new timeThread [ nThreads ];
+    volatile bool stop = false;
+    unsigned i;
+
+    for ( i = 0u; i < nThreads; i++ ) {
+        pThreads[i].done = epicsEventMustCreate ( epicsEventEmpty );
+        pThreads[i].locked = locked;
+        pThreads[i].pStop = & stop;
+        pThreads[i].calls = 0u;
+        pThreads[i].backwards = 0u;
+    }
+
+    epicsTime begin = epicsTime::getCurrent ();
+    for ( i = 0u; i < nThreads; i++ ) {
+        epicsThreadMustCreate ( "timePerform", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize ( epicsThreadStackSmall ),
+            timeThreadMain, & pThreads[i] );
+    }
+    epicsThreadSleep ( measureSeconds );
+    stop = true;
+
+    unsigned long calls = 0u;
+    unsigned long backwards = 0u;
+    for ( i = 0u; i < nThreads; i++ ) {
+        epicsEventMustWait ( pThreads[i].done );
+        epicsEventDestroy ( pThreads[i].done );
+        calls += pThreads[i].calls;
+        backwards += pThreads[i].backwards;
+    }
+    double period = epicsTime::getCurrent () - begin;
+
+    testDiag ( "%-28s %3u threads %12.0f stamps/sec",
+        locked ? "generalTimeGetExceptPriority" : "epicsTimeGetCurrent",
+        nThreads, calls / period );
+    if ( ! locked ) {
+        testOk ( backwards == 0u,
+            "%lu time stamps older than the previous one", backwards );
+    }
+    delete [] pThreads;
+}
+
+MAIN(epicsTimePerform)
+{
+    unsigned maxThreads = 2u * epicsThreadGetCPUs ();
+    unsigned n;
+
+    if ( maxThreads < 4u ) {
+        maxThreads = 4u;
+    }
+    testPlan ( 0 );
+    testDiag ( "Time provider \"%s\", %d CPUs",
+        generalTimeHighestCurrentName (), epicsThreadGetCPUs () );
+    for ( n = 1u; n <= maxThreads; n *= 2u ) {
+        measure ( n, false );
+        measure ( n, true );
+    }
+    return testDone ();
+}
@@ -0,0 +1,127 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* epicsTimerPerform.cpp */
+
+/*
+ * Compares the cost of starting, restarting, canceling and expiring
+ * a large number of timers in list and heap ordered timer queues.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "epicsTimer.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+static const unsigned nActive = 100000u;
+static const unsigned nProbe = 1000u;
+
+class perfNotify : public epicsTimerQueueNotify {
+public:
+    void reschedule () {}
+    double quantum () { return 0.0; }
+};
+
+class perfTimer : public epicsTimerNotify {
+public:
+    perfTimer ( epicsTimerQueue & queue ) :
+        timer ( queue.createTimer () ) {}
+    ~perfTimer () { this->timer.destroy (); }
+    void start ( const epicsTime & expireTime )
+        { this->timer.start ( *this, expireTime ); }
+    void cancel () { this->timer.cancel (); }
+    static unsigned expireCount;
+private:
+    epicsTimer & timer;
+    expireStatus expire ( const epicsTime & )
+    {
+        perfTimer::expireCount++;
+        return noRestart;
+    }
+    perfTimer ( const perfTimer & );
+    perfTimer & operator = ( const perfTimer & );
+};
+
+unsigned perfTimer::expireCount;
+
+static double randomDelay ()
+{
+    return ( rand () % 1000000 ) * 1e-6;
+}
+
+//
+// Starts, restarts and cancels timers with random delays while
+// nActive other timers are pending, then expires them all.
+//
+static void measure ( epicsTimerQueueType type )
+{
+    perfNotify notify;
+    epicsTimerQueuePassive & queue =
+        epicsTimerQueuePassive::create ( notify, type );
+    perfTimer ** pActive = new perfTimer * [nActive];
+    perfTimer ** pProbe = new perfTimer * [nProbe];
+    epicsTime base = epicsTime::getCurrent ();
+    unsigned i;
+
+    for ( i = 0u; i < nActive; i++ ) {
+        pActive[i] = new perfTimer ( queue );
+    }
+    for ( i = 0u; i < nProbe; i++ ) {
+        pProbe[i] = new perfTimer ( queue );
+    }
+    perfTimer::expireCount = 0u;
+    srand ( 1u );
+
+    epicsTime t0 = epicsTime::getCurrent ();
+    for ( i = 0u; i < nActive; i++ ) {
+        pActive[i]->start ( base + 1.0 + i * 1e-5 );
+    }
+    epicsTime t1 = epicsTime::getCurrent ();
+    for ( i = 0u; i < nProbe; i++ ) {
+        pProbe[i]->start ( base + 1.0 + randomDelay () );
+    }
+    epicsTime t2 = epicsTime::getCurrent ();
+    for ( i = 0u; i < nProbe; i++ ) {
+        pProbe[i]->start ( base + 1.0 + randomDelay () );
+    }
+    epicsTime t3 = epicsTime::getCurrent ();
+    for ( i = 0u; i < nProbe; i += 2u ) {
+        pProbe[i]->cancel ();
+    }
+    epicsTime t4 = epicsTime::getCurrent ();
+    queue.process ( base + 3.0 );
+    epicsTime t5 = epicsTime::getCurrent ();
+
+    testDiag ( "%s queue with %u active timers, usec per operation:",
+        type == epicsTimerQueueHeap ? "heap" : "list", nActive );
+    testDiag ( "    start in order %8.3f  random start %8.3f  "
+        "restart %8.3f  cancel %8.3f  expire %8.3f",
+        ( t1 - t0 ) * 1e6 / nActive,
+        ( t2 - t1 ) * 1e6 / nProbe,
+        ( t3 - t2 ) * 1e6 / nProbe,
+        ( t4 - t3 ) * 1e6 / ( nProbe / 2u ),
+        ( t5 - t4 ) * 1e6 / perfTimer::expireCount );
+
+    for ( i = 0u; i < nActive; i++ ) {
+        delete pActive[i];
+    }
+    for ( i = 0u; i < nProbe; i++ ) {
+        delete pProbe[i];
+    }
+    delete [] pActive;
+    delete [] pProbe;
+    delete & queue;
+}
+
+MAIN(epicsTimerPerform)
+{
+    testPlan ( 0 );
+    measure ( epicsTimerQueueList );
+    measure ( epicsTimerQueueHeap );
+    return testDone ();
+}
@@ -58,6 +58,13 @@ void testRefCount()
     T2->destroy();
     Q2->release();
 
+    Q2 = &epicsTimerQueueActive::allocate ( true, epicsThreadPriorityMin,
+        epicsTimerQueueHeap );
+
+    testOk(Q1!=Q2, "Heap and list queues are not shared");
+
+    Q2->release();
+
     T1->destroy();
     Q1->release();
 }
@@ -450,10 +457,135 @@ void testPeriodic ()
     queue.release ();
 }
 
+class orderNotify : public epicsTimerQueueNotify {
+public:
+    void reschedule () {}
+    double quantum () { return 0.0; }
+};
+
+class orderVerify : public epicsTimerNotify {
+public:
+    orderVerify ( epicsTimerQueue & );
+    ~orderVerify ();
+    void start ( const epicsTime & expireTime, unsigned order );
+    void cancel ();
+    static unsigned expireCount;
+    static bool outOfOrder;
+    static bool canceledExpired;
+private:
+    epicsTimer & timer;
+    epicsTime expireTime;
+    unsigned order;
+    bool canceled;
+    static epicsTime lastExpireTime;
+    static unsigned lastOrder;
+    expireStatus expire ( const epicsTime & );
+    orderVerify ( const orderVerify & );
+    orderVerify & operator = ( const orderVerify & );
+};
+
+unsigned orderVerify::expireCount;
+bool orderVerify::outOfOrder;
+bool orderVerify::canceledExpired;
+epicsTime orderVerify::lastExpireTime;
+unsigned orderVerify::lastOrder;
+
+orderVerify::orderVerify ( epicsTimerQueue & queueIn ) :
+    timer ( queueIn.createTimer () ), order ( 0u ), canceled ( false )
+{
+}
+
+orderVerify::~orderVerify ()
+{
+    this->timer.destroy ();
+}
+
+void orderVerify::start ( const epicsTime & expireTimeIn, unsigned orderIn )
+{
+    this->expireTime = expireTimeIn;
+    this->order = orderIn;
+    this->canceled = false;
+    this->timer.start ( *this, expireTimeIn );
+}
+
+void orderVerify::cancel ()
+{
+    this->canceled = true;
+    this->timer.cancel ();
+}
+
+epicsTimerNotify::expireStatus orderVerify::expire ( const epicsTime & )
+{
+    if ( this->canceled ) {
+        orderVerify::canceledExpired = true;
+    }
+    if ( orderVerify::expireCount > 0u ) {
+        if ( this->expireTime < orderVerify::lastExpireTime ||
+                ( this->expireTime == orderVerify::lastExpireTime &&
+                    this->order < orderVerify::lastOrder ) ) {
+            orderVerify::outOfOrder = true;
+        }
+    }
+    orderVerify::lastExpireTime = this->expireTime;
+    orderVerify::lastOrder = this->order;
+    orderVerify::expireCount++;
+    return noRestart;
+}
+
+//
+// verify that timers expire in time order, and in the order
+// they were started when their expiration times are equal
+//
+void testOrder ( epicsTimerQueueType type )
+{
+    static const unsigned nTimers = 2000u;
+    orderNotify notify;
+    epicsTimerQueuePassive & queue =
+        epicsTimerQueuePassive::create ( notify, type );
+    orderVerify *pTimers[nTimers];
+    epicsTime base = epicsTime::getCurrent ();
+    unsigned i, order = 0u, nCanceled = 0u;
+
+    testDiag ( "Testing expiration order using a %s",
+        type == epicsTimerQueueHeap ? "heap" : "list" );
+
+    orderVerify::expireCount = 0u;
+    orderVerify::outOfOrder = false;
+    orderVerify::canceledExpired = false;
+
+    srand ( 1u );
+    for ( i = 0u; i < nTimers; i++ ) {
+        pTimers[i] = new orderVerify ( queue );
+        pTimers[i]->start ( base + ( rand () % 100 ) * 0.01, order++ );
+    }
+    for ( i = 0u; i < nTimers; i += 5u ) {
+        pTimers[i]->start ( base + ( rand () % 100 ) * 0.01, order++ );
+    }
+    for ( i = 3u; i < nTimers; i += 7u ) {
+        pTimers[i]->cancel ();
+        nCanceled++;
+    }
+
+    queue.process ( base + 2.0 );
+
+    testOk ( ! orderVerify::outOfOrder && ! orderVerify::canceledExpired,
+        "Timers expired in order" );
+    testOk ( orderVerify::expireCount == nTimers - nCanceled,
+        "%u timers expired, %u expected",
+        orderVerify::expireCount, nTimers - nCanceled );
+
+    for ( i = 0u; i < nTimers; i++ ) {
+        delete pTimers[i];
+    }
+    delete & queue;
+}
+
 MAIN(epicsTimerTest)
 {
-    testPlan(41);
+    testPlan(46);
     testRefCount();
+    testOrder ( epicsTimerQueueList );
+    testOrder ( epicsTimerQueueHeap );
     testAccuracy ();
     testCancel ();
     testExpireDestroy ();
@@ -0,0 +1,115 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* freeListPerform.cpp */
+
+/*
+ * Measures freeListMalloc() and freeListFree() operations per second as
+ * the number of threads sharing one free list grows, with and without
+ * per-thread magazines.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "epicsThread.h"
+#include "epicsEvent.h"
+#include "epicsTime.h"
+#include "freeList.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+static const unsigned blocksPerThread = 16u;
+static const int blockSize = 64;
+static const int magazineSize = 64;
+static const double measureSeconds = 0.5;
+
+struct listThread {
+    epicsEventId done;
+    void * pList;
+    volatile bool * pStop;
+    unsigned long ops;
+};
+
+extern "C" void listThreadMain ( void * pArg )
+{
+    listThread * pThread = static_cast < listThread * > ( pArg );
+    void * pBlocks[blocksPerThread];
+    unsigned i;
+
+    while ( ! * pThread->pStop ) {
+        for ( i = 0u; i < blocksPerThread; i++ ) {
+            pBlocks[i] = freeListMalloc ( pThread->pList );
+        }
+        for ( i = 0u; i < blocksPerThread; i++ ) {
+            freeListFree ( pThread->pList, pBlocks[i] );
+        }
+        pThread->ops += 2u * blocksPerThread;
+    }
+    epicsEventSignal ( pThread->done );
+}
+
+static void measure ( unsigned nThreads, int magazine )
+{
+    listThread * pThreads = new listThread [ nThreads ];
+    volatile bool stop = false;
+    void * pList;
+    unsigned i;
+
+    freeListInitMagazine ( & pList, blockSize, 256, magazine );
+    for ( i = 0u; i < nThreads; i++ ) {
+        pThreads[i].done = epicsEventMustCreate ( epicsEventEmpty );
+        pThreads[i].pList = pList;
+        pThreads[i].pStop = & stop;
+        pThreads[i].ops = 0u;
+    }
+
+    epicsTime begin = epicsTime::getCurrent ();
+    for ( i = 0u; i < nThreads; i++ ) {
+        epicsThreadMustCreate ( "listPerform", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize ( epicsThreadStackSmall ),
+            listThreadMain, & pThreads[i] );
+    }
+    epicsThreadSleep ( measureSeconds );
+    stop = true;
+
+    unsigned long ops = 0u;
+    for ( i = 0u; i < nThreads; i++ ) {
+        epicsEventMustWait ( pThreads[i].done );
+        epicsEventDestroy ( pThreads[i].done );
+        ops += pThreads[i].ops;
+    }
+    double period = epicsTime::getCurrent () - begin;
+
+    testDiag ( "magazine %3d %3u threads %12.0f ops/sec",
+        magazine, nThreads, ops / period );
+
+    // let the exiting threads return their magazines
+    epicsThreadSleep ( 0.1 );
+    testOk ( freeListItemsCached ( pList ) == 0u,
+        "%u blocks still cached after the threads exited",
+        (unsigned) freeListItemsCached ( pList ) );
+    freeListCleanup ( pList );
+    delete [] pThreads;
+}
+
+MAIN(freeListPerform)
+{
+    unsigned maxThreads = 2u * epicsThreadGetCPUs ();
+    unsigned n;
+
+    if ( maxThreads < 4u ) {
+        maxThreads = 4u;
+    }
+    testPlan ( 0 );
+    testDiag ( "%u blocks allocated then freed per round, %d CPUs",
+        blocksPerThread, epicsThreadGetCPUs () );
+    for ( n = 1u; n <= maxThreads; n *= 2u ) {
+        measure ( n, 0 );
+        measure ( n, magazineSize );
+    }
+    return testDone ();
+}
@@ -46,6 +46,63 @@ static void check(epicsRingBytesId ring, int expectedFree)
     testOk(isFull == expectedFull, "Full: %d == %d", isFull, expectedFull);
 }
     
+#define STREAMBYTES 1000000
+
+typedef struct streamInfo {
+    epicsRingBytesId ring;
+    epicsEventId done;
+}streamInfo;
+
+static void streamProducer(void *arg)
+{
+    streamInfo *pstream = arg;
+    char chunk[37];
+    int sent = 0;
+
+    while (sent < STREAMBYTES) {
+        int i, n = sizeof(chunk);
+        if (n > STREAMBYTES - sent)
+            n = STREAMBYTES - sent;
+        for (i = 0 ; i < n ; i++)
+            chunk[i] = (char)(sent + i);
+        if (epicsRingBytesPut(pstream->ring, chunk, n) == n)
+            sent += n;
+        else
+            epicsThreadSleep(0.0);
+    }
+    epicsEventMustTrigger(pstream->done);
+}
+
+static void testStream(void)
+{
+    streamInfo stream;
+    char chunk[64];
+    int received = 0, ok = 1;
+
+    stream.ring = epicsRingBytesSPSCCreate(1000);
+    stream.done = epicsEventMustCreate(epicsEventEmpty);
+    epicsThreadMustCreate("stream", epicsThreadPriorityMedium,
+        epicsThreadGetStackSize(epicsThreadStackSmall),
+        streamProducer, &stream);
+
+    while (received < STREAMBYTES && ok) {
+        int i, n = epicsRingBytesGet(stream.ring, chunk, sizeof(chunk));
+        if (n == 0) {
+            epicsThreadSleep(0.0);
+            continue;
+        }
+        for (i = 0 ; i < n ; i++)
+            ok &= chunk[i] == (char)(received + i);
+        received += n;
+    }
+    testOk(ok && received == STREAMBYTES,
+        "SPSC ring passed %d bytes between threads in order", received);
+
+    epicsEventMustWait(stream.done);
+    epicsEventDestroy(stream.done);
+    epicsRingBytesDelete(stream.ring);
+}
+
 MAIN(ringBytesTest)
 {
     int i, n;
@@ -55,7 +112,7 @@ MAIN(ringBytesTest)
     char get[RINGSIZE+1];
     epicsRingBytesId ring;
 
-    testPlan(245);
+    testPlan(246);
 
     pinfo = calloc(1,sizeof(info));
     if (!pinfo) {
@@ -119,5 +176,7 @@ MAIN(ringBytesTest)
     epicsEventDestroy(consumerEvent);
     free(pinfo);
 
+    testStream();
+
     return testDone();
 }
@@ -0,0 +1,174 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+/* ringPointerPerform.c */
+
+/*
+ * Measures the throughput of a producer and a consumer thread passing
+ * pointers through locked, SPSC and MPSC rings, one at a time and in
+ * batches, and the round trip latency of a pointer passed to an echo
+ * thread and back through a pair of rings.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "epicsThread.h"
+#include "epicsEvent.h"
+#include "epicsTime.h"
+#include "epicsRingPointer.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define RINGSIZE 1024
+#define NITEMS 2000000
+#define NROUNDTRIPS 20000
+
+static const char * const modeName[] = {"locked", "SPSC", "MPSC"};
+
+static epicsRingPointerId createRing(int mode)
+{
+    switch(mode) {
+    case 1: return epicsRingPointerSPSCCreate(RINGSIZE);
+    case 2: return epicsRingPointerMPSCCreate(RINGSIZE);
+    default: return epicsRingPointerLockedCreate(RINGSIZE);
+    }
+}
+
+typedef struct {
+    epicsRingPointerId ring;
+    epicsRingPointerId back;
+    epicsEventId done;
+    int batch;
+} perfPvt;
+
+static void producer(void *raw)
+{
+    perfPvt *pvt = raw;
+    char *zero = 0;
+    void *items[64];
+    size_t sent = 0;
+    int i;
+
+    while(sent < NITEMS) {
+        int n;
+        for(i=0; i<pvt->batch; i++)
+            items[i] = zero + sent + i + 1;
+        if(pvt->batch==1)
+            n = epicsRingPointerPush(pvt->ring, items[0]);
+        else
+            n = epicsRingPointerPushMany(pvt->ring, items, pvt->batch);
+        if(n)
+            sent += n;
+        else
+            epicsThreadSleep(0.0);
+    }
+    epicsEventMustTrigger(pvt->done);
+}
+
+static void measureThroughput(int mode, int batch)
+{
+    perfPvt pvt;
+    void *items[64];
+    size_t received = 0;
+    epicsTimeStamp begin, end;
+    double seconds;
+
+    pvt.ring = createRing(mode);
+    pvt.done = epicsEventMustCreate(epicsEventEmpty);
+    pvt.batch = batch;
+
+    epicsTimeGetCurrent(&begin);
+    epicsThreadMustCreate("producer", epicsThreadPriorityMedium,
+                          epicsThreadGetStackSize(epicsThreadStackSmall),
+                          &producer, &pvt);
+    while(received < NITEMS) {
+        int n;
+        if(batch==1)
+            n = (items[0] = epicsRingPointerPop(pvt.ring)) != NULL;
+        else
+            n = epicsRingPointerPopMany(pvt.ring, items, batch);
+        if(n)
+            received += n;
+        else
+            epicsThreadSleep(0.0);
+    }
+    epicsTimeGetCurrent(&end);
+    epicsEventMustWait(pvt.done);
+    seconds = epicsTimeDiffInSeconds(&end, &begin);
+
+    testDiag("%-6s batch %2d %12.0f pointers/sec", modeName[mode], batch,
+             NITEMS / seconds);
+
+    epicsEventDestroy(pvt.done);
+    epicsRingPointerDelete(pvt.ring);
+}
+
+static void echo(void *raw)
+{
+    perfPvt *pvt = raw;
+    int n = 0;
+
+    while(n < NROUNDTRIPS) {
+        void *p = epicsRingPointerPop(pvt->ring);
+        if(!p) {
+            epicsThreadSleep(0.0);
+            continue;
+        }
+        while(!epicsRingPointerPush(pvt->back, p))
+            epicsThreadSleep(0.0);
+        n++;
+    }
+    epicsEventMustTrigger(pvt->done);
+}
+
+static void measureLatency(int mode)
+{
+    perfPvt pvt;
+    char *zero = 0;
+    epicsTimeStamp begin, end;
+    int n;
+
+    pvt.ring = createRing(mode);
+    pvt.back = createRing(mode);
+    pvt.done = epicsEventMustCreate(epicsEventEmpty);
+
+    epicsThreadMustCreate("echo", epicsThreadPriorityMedium,
+                          epicsThreadGetStackSize(epicsThreadStackSmall),
+                          &echo, &pvt);
+    epicsTimeGetCurrent(&begin);
+    for(n=0; n<NROUNDTRIPS; n++) {
+        epicsRingPointerPush(pvt.ring, zero + n + 1);
+        while(!epicsRingPointerPop(pvt.back))
+            epicsThreadSleep(0.0);
+    }
+    epicsTimeGetCurrent(&end);
+    epicsEventMustWait(pvt.done);
+
+    testDiag("%-6s round trip %8.3f usec", modeName[mode],
+             epicsTimeDiffInSeconds(&end, &begin) * 1e6 / NROUNDTRIPS);
+
+    epicsEventDestroy(pvt.done);
+    epicsRingPointerDelete(pvt.ring);
+    epicsRingPointerDelete(pvt.back);
+}
+
+MAIN(ringPointerPerform)
+{
+    int mode;
+
+    testPlan(0);
+    testDiag("%d pointers through a ring of %d, %d CPUs",
+             NITEMS, RINGSIZE, epicsThreadGetCPUs());
+    for(mode=0; mode<3; mode++) {
+        measureThroughput(mode, 1);
+        measureThroughput(mode, 16);
+    }
+    for(mode=0; mode<3; mode++)
+        measureLatency(mode);
+    return testDone();
+}
@@ -166,17 +166,25 @@ static void pairConsumer(void *raw)
     epicsEventMustTrigger(pvt->sync);
 }
 
-static void testPair(int locked)
+static const char * const modeName[] = {"unlocked", "locked", "SPSC", "MPSC"};
+
+static epicsRingPointerId createRing(int mode, int size)
+{
+    switch(mode) {
+    case 1: return epicsRingPointerLockedCreate(size);
+    case 2: return epicsRingPointerSPSCCreate(size);
+    case 3: return epicsRingPointerMPSCCreate(size);
+    default: return epicsRingPointerCreate(size);
+    }
+}
+
+static void testPair(int mode)
 {
     unsigned int myprio = epicsThreadGetPrioritySelf(), consumerprio;
     pairPvt pvt;
     const int rsize = 100;
     int i, expect;
-    epicsRingPointerId ring;
-    if(locked)
-        ring = epicsRingPointerLockedCreate(rsize);
-    else
-        ring = epicsRingPointerCreate(rsize);
+    epicsRingPointerId ring = createRing(mode, rsize);
 
     pvt.ring = ring;
     pvt.sync = epicsEventCreate(epicsEventEmpty);
@@ -186,7 +194,7 @@ static void testPair(int locked)
 
     foundCorruption = 0;
 
-    testDiag("single producer, single consumer with%s locking", locked?"":"out");
+    testDiag("single producer, single consumer, %s ring", modeName[mode]);
 
     /* give the consumer thread a slightly higher priority so that
      * it can preempt us on RTOS targets.  On non-RTOS targets
@@ -232,15 +240,132 @@ static void testPair(int locked)
     epicsRingPointerDelete(ring);
 }
 
+static void testMany(int mode)
+{
+    const int rsize = 100;
+    void *in[150], *out[200];
+    epicsRingPointerId ring = createRing(mode, rsize);
+    int i, n, ok;
+
+    testDiag("PushMany and PopMany, %s ring", modeName[mode]);
+    foundCorruption = 0;
+    for(i=0; i<150; i++)
+        in[i] = int2ptr(i+1);
+
+    n = epicsRingPointerPushMany(ring, in, 150);
+    testOk(n==rsize, "pushed %d of 150 into %d", n, rsize);
+    n = epicsRingPointerPopMany(ring, out, 30);
+    testOk(n==30, "popped %d of 30", n);
+    n = epicsRingPointerPushMany(ring, in+rsize, 50);
+    testOk(n==30, "pushed %d of 50 after the ring wrapped", n);
+    n = epicsRingPointerPopMany(ring, out+30, 170);
+    testOk(n==rsize, "popped %d of 170", n);
+    for(i=0, ok=1; i<130; i++)
+        ok &= ptr2int(out[i])==(size_t)(i+1);
+    testOk(ok && !foundCorruption, "pointers came out in order");
+    testOk1(epicsRingPointerIsEmpty(ring));
+
+    epicsRingPointerDelete(ring);
+}
+
+#define NPRODUCERS 4
+#define NPERPRODUCER 20000
+
+typedef struct {
+    epicsRingPointerId ring;
+    epicsEventId done;
+    size_t id;
+} producerPvt;
+
+static void mpscProducer(void *raw)
+{
+    producerPvt *pvt = raw;
+    char *zero = 0;
+    void *batch[7];
+    size_t seq = 0;
+
+    while(seq < NPERPRODUCER) {
+        int i, n = 0;
+        for(i=0; i<7 && seq+i<NPERPRODUCER; i++)
+            batch[n++] = zero + ((pvt->id<<20) | (seq+i+1));
+        n = epicsRingPointerPushMany(pvt->ring, batch, n);
+        seq += n;
+        if(n==0)
+            epicsThreadSleep(0.0);
+    }
+    epicsEventMustTrigger(pvt->done);
+}
+
+static void testMPSC(void)
+{
+    producerPvt prod[NPRODUCERS];
+    size_t last[NPRODUCERS];
+    epicsRingPointerId ring = epicsRingPointerMPSCCreate(64);
+    char *zero = 0;
+    void *out[16];
+    unsigned long total = 0;
+    int i, ordered = 1;
+
+    testDiag("%d producers pushing %d pointers each into an MPSC ring",
+        NPRODUCERS, NPERPRODUCER);
+
+    for(i=0; i<NPRODUCERS; i++) {
+        prod[i].ring = ring;
+        prod[i].done = epicsEventMustCreate(epicsEventEmpty);
+        prod[i].id = i;
+        last[i] = 0;
+        epicsThreadMustCreate("mpsc", epicsThreadPriorityMedium,
+                              epicsThreadGetStackSize(epicsThreadStackSmall),
+                              &mpscProducer, &prod[i]);
+    }
+
+    while(total < NPRODUCERS*NPERPRODUCER) {
+        int n = epicsRingPointerPopMany(ring, out, 16);
+        if(n==0) {
+            epicsThreadSleep(0.0);
+            continue;
+        }
+        for(i=0; i<n; i++) {
+            size_t v = (char *)out[i] - zero;
+            size_t id = v>>20;
+            if(id>=NPRODUCERS || (v&0xfffff)!=last[id]+1) {
+                ordered = 0;
+                break;
+            }
+            last[id]++;
+        }
+        if(!ordered)
+            break;
+        total += n;
+    }
+
+    testOk(ordered, "each producer's pointers arrived in order");
+    testOk(total==NPRODUCERS*NPERPRODUCER, "received %lu of %d",
+           total, NPRODUCERS*NPERPRODUCER);
+
+    for(i=0; i<NPRODUCERS; i++) {
+        if(ordered)
+            epicsEventMustWait(prod[i].done);
+        epicsEventDestroy(prod[i].done);
+    }
+    if(ordered)
+        epicsRingPointerDelete(ring);
+}
+
 MAIN(ringPointerTest)
 {
     int prio = epicsThreadGetPrioritySelf();
+    int mode;
 
-    testPlan(37);
+    testPlan(66);
     testSingle();
+    for(mode=0; mode<4; mode++)
+        testMany(mode);
+    testMPSC();
     epicsThreadSetPriority(epicsThreadGetIdSelf(), epicsThreadPriorityScanLow);
     testPair(0);
     testPair(1);
+    testPair(2);
     epicsThreadSetPriority(epicsThreadGetIdSelf(), prio);
     return testDone();
 }
@@ -64,8 +64,8 @@ epicsTimerNotify::expireStatus epicsTimerForC::expire ( const epicsTime & )
 
 epicsTimerQueueActiveForC ::
     epicsTimerQueueActiveForC ( RefMgr & refMgr, 
-        bool okToShare, unsigned priority ) :
-    timerQueueActive ( refMgr, okToShare, priority )
+        bool okToShare, unsigned priority, epicsTimerQueueType type ) :
+    timerQueueActive ( refMgr, okToShare, priority, type )
 {
     timerQueueActive::start();
 }
@@ -218,6 +218,23 @@ extern "C" epicsTimerQueueId epicsShareAPI
     }
 }
 
+extern "C" epicsTimerQueueId epicsShareAPI
+    epicsTimerQueueAllocateType ( int okToShare, unsigned int threadPriority,
+        epicsTimerQueueType type )
+{
+    try {
+        epicsSingleton < timerQueueActiveMgr > :: reference ref = 
+            timerQueueMgrEPICS.getReference ();
+        epicsTimerQueueActiveForC & tmr = 
+            ref->allocate ( ref, okToShare ? true : false, threadPriority,
+                type );
+        return &tmr;
+    }
+    catch ( ... ) {
+        return 0;
+    }
+}
+
 extern "C" void epicsShareAPI epicsTimerQueueRelease ( epicsTimerQueueId pQueue )
 {
     pQueue->release ();
@@ -20,6 +20,12 @@
 #include "epicsTime.h"
 #include "epicsThread.h"
 
+/* How a timer queue orders its pending timers, chosen at creation */
+typedef enum {
+    epicsTimerQueueList,    /* time sorted list, O(n) timer start */
+    epicsTimerQueueHeap     /* binary heap, O(log n) timer start and cancel */
+} epicsTimerQueueType;
+
 #ifdef __cplusplus
 
 /*
@@ -83,6 +89,8 @@ class epicsTimerQueueActive
 public:
     static epicsShareFunc epicsTimerQueueActive & allocate (
         bool okToShare, unsigned threadPriority = epicsThreadPriorityMin + 10 );
+    static epicsShareFunc epicsTimerQueueActive & allocate (
+        bool okToShare, unsigned threadPriority, epicsTimerQueueType );
     virtual void release () = 0; 
 protected:
     epicsShareFunc virtual ~epicsTimerQueueActive () = 0;
@@ -104,6 +112,8 @@ class epicsTimerQueuePassive
     : public epicsTimerQueue {
 public:
     static epicsShareFunc epicsTimerQueuePassive & create ( epicsTimerQueueNotify & );
+    static epicsShareFunc epicsTimerQueuePassive & create ( epicsTimerQueueNotify &,
+        epicsTimerQueueType );
     epicsShareFunc virtual ~epicsTimerQueuePassive () = 0; /* ok to call delete */
     virtual double process ( const epicsTime & currentTime ) = 0; /* returns delay to next expire */
 };
@@ -137,6 +147,9 @@ typedef void ( *epicsTimerCallback ) ( void *pPrivate );
 typedef struct epicsTimerQueueActiveForC * epicsTimerQueueId;
 epicsShareFunc epicsTimerQueueId epicsShareAPI
     epicsTimerQueueAllocate ( int okToShare, unsigned int threadPriority );
+epicsShareFunc epicsTimerQueueId epicsShareAPI
+    epicsTimerQueueAllocateType ( int okToShare, unsigned int threadPriority,
+        epicsTimerQueueType type );
 epicsShareFunc void epicsShareAPI 
     epicsTimerQueueRelease ( epicsTimerQueueId );
 epicsShareFunc epicsTimerId epicsShareAPI 
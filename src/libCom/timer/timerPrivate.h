@@ -50,7 +50,10 @@ private:
     epicsTime exp; // experation time 
     state curState; // current state 
     epicsTimerNotify * pNotify; // callback
+    unsigned heapIndex; // position in the queue's heap
+    unsigned long startSeq; // orders timers with the same expiration time
     void privateStart ( epicsTimerNotify & notify, const epicsTime & );
+    bool expiresBefore ( const timer & ) const;
     timer & operator = ( const timer & );
     // Visual C++ .net appears to require operator delete if
     // placement operator delete is defined? I smell a ms rat
@@ -87,8 +90,10 @@ using std :: type_info;
 
 class timerQueue : public epicsTimerQueue {
 public:
-    timerQueue ( epicsTimerQueueNotify &notify );
+    timerQueue ( epicsTimerQueueNotify &notify,
+        epicsTimerQueueType type = epicsTimerQueueList );
     virtual ~timerQueue ();
+    epicsTimerQueueType type () const;
     epicsTimer & createTimer ();
     epicsTimerForC & createTimerForC ( epicsTimerCallback pCallback, void *pArg );
     double process ( const epicsTime & currentTime );
@@ -99,6 +104,11 @@ private:
     mutable epicsMutex mutex;
     epicsEvent cancelBlockingEvent;
     tsDLList < timer > timerList;
+    timer ** heap;
+    unsigned heapCount;
+    unsigned heapCapacity;
+    unsigned long startCount;
+    const epicsTimerQueueType queueType;
     epicsTimerQueueNotify & notify;
     timer * pExpireTmr;
     epicsThreadId processThread;
@@ -107,6 +117,12 @@ private:
     static const double exceptMsgMinPeriod;
     void printExceptMsg ( const char * pName,
                 const type_info & type );
+    timer * firstPending () const;
+    unsigned pendingCount () const;
+    bool insertPending ( timer & );
+    void removePending ( timer & );
+    void heapSiftUp ( unsigned index );
+    void heapSiftDown ( unsigned index );
 	timerQueue ( const timerQueue & );
     timerQueue & operator = ( const timerQueue & );
     friend class timer;
@@ -130,13 +146,15 @@ class timerQueueActive : public epicsTimerQueueActive,
     public timerQueueActiveMgrPrivate {
 public:
     typedef epicsSingleton < timerQueueActiveMgr > :: reference RefMgr;
-    timerQueueActive ( RefMgr &, bool okToShare, unsigned priority );
+    timerQueueActive ( RefMgr &, bool okToShare, unsigned priority,
+        epicsTimerQueueType );
     void start ();
     epicsTimer & createTimer ();
     epicsTimerForC & createTimerForC ( epicsTimerCallback pCallback, void *pArg );
     void show ( unsigned int level ) const;
     bool sharingOK () const;
     unsigned threadPriority () const;
+    epicsTimerQueueType queueType () const;
 protected:
     ~timerQueueActive ();
     RefMgr _refMgr;
@@ -166,7 +184,8 @@ public:
 	timerQueueActiveMgr ();
     ~timerQueueActiveMgr ();
     epicsTimerQueueActiveForC & allocate ( RefThis &, bool okToShare, 
-        unsigned threadPriority = epicsThreadPriorityMin + 10 );
+        unsigned threadPriority = epicsThreadPriorityMin + 10,
+        epicsTimerQueueType type = epicsTimerQueueList );
     void release ( epicsTimerQueueActiveForC & );
 private:
     epicsMutex mutex;
@@ -179,7 +198,8 @@ extern epicsSingleton < timerQueueActiveMgr > timerQueueMgrEPICS;
 
 class timerQueuePassive : public epicsTimerQueuePassive {
 public:
-    timerQueuePassive ( epicsTimerQueueNotify & );
+    timerQueuePassive ( epicsTimerQueueNotify &,
+        epicsTimerQueueType type = epicsTimerQueueList );
     epicsTimer & createTimer ();
     epicsTimerForC & createTimerForC ( epicsTimerCallback pCallback, void *pArg );
     void show ( unsigned int level ) const;
@@ -214,7 +234,8 @@ private:
 struct epicsTimerQueueActiveForC : public timerQueueActive, 
     public tsDLNode < epicsTimerQueueActiveForC > {
 public:
-    epicsTimerQueueActiveForC ( RefMgr &, bool okToShare, unsigned priority );
+    epicsTimerQueueActiveForC ( RefMgr &, bool okToShare, unsigned priority,
+        epicsTimerQueueType type = epicsTimerQueueList );
     void release ();
     void * operator new ( size_t );
     void operator delete ( void * );
@@ -235,6 +256,41 @@ inline unsigned timerQueueActive::threadPriority () const
     return thread.getPriority ();
 }
 
+inline epicsTimerQueueType timerQueueActive::queueType () const
+{
+    return this->queue.type ();
+}
+
+inline epicsTimerQueueType timerQueue::type () const
+{
+    return this->queueType;
+}
+
+inline timer * timerQueue::firstPending () const
+{
+    if ( this->queueType == epicsTimerQueueHeap ) {
+        return this->heapCount ? this->heap[0] : 0;
+    }
+    return this->timerList.first ();
+}
+
+inline unsigned timerQueue::pendingCount () const
+{
+    if ( this->queueType == epicsTimerQueueHeap ) {
+        return this->heapCount;
+    }
+    return this->timerList.count ();
+}
+
+// timers with the same expiration time expire in the order started
+inline bool timer::expiresBefore ( const timer & other ) const
+{
+    if ( this->exp != other.exp ) {
+        return this->exp < other.exp;
+    }
+    return static_cast < long > ( this->startSeq - other.startSeq ) < 0;
+}
+
 inline void * timer::operator new ( size_t size, 
                      tsFreeList < timer, 0x20 > & freeList ) 
 {
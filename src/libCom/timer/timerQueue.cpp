@@ -24,7 +24,13 @@ const double timerQueue :: exceptMsgMinPeriod = 60.0 * 5.0; // seconds
 
 epicsTimerQueue::~epicsTimerQueue () {}
 
-timerQueue::timerQueue ( epicsTimerQueueNotify & notifyIn ) :
+timerQueue::timerQueue ( epicsTimerQueueNotify & notifyIn,
+        epicsTimerQueueType typeIn ) :
+    heap ( 0 ),
+    heapCount ( 0u ),
+    heapCapacity ( 0u ),
+    startCount ( 0ul ),
+    queueType ( typeIn ),
     notify ( notifyIn ), 
     pExpireTmr ( 0 ),  
     processThread ( 0 ), 
@@ -40,6 +46,120 @@ timerQueue::~timerQueue ()
     while ( ( pTmr = this->timerList.get () ) ) {    
         pTmr->curState = timer::stateLimbo;
     }
+    for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+        this->heap[i]->curState = timer::stateLimbo;
+    }
+    delete [] this->heap;
+}
+
+//
+// Returns true if the timer is now the first to expire
+//
+bool timerQueue::insertPending ( timer & tmr )
+{
+    tmr.startSeq = this->startCount++;
+
+    if ( this->queueType == epicsTimerQueueHeap ) {
+        if ( this->heapCount >= this->heapCapacity ) {
+            unsigned newCapacity = this->heapCapacity ?
+                2u * this->heapCapacity : 0x40;
+            timer ** pNewHeap = new timer * [newCapacity];
+            for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+                pNewHeap[i] = this->heap[i];
+            }
+            delete [] this->heap;
+            this->heap = pNewHeap;
+            this->heapCapacity = newCapacity;
+        }
+        tmr.heapIndex = this->heapCount;
+        this->heap[this->heapCount++] = & tmr;
+        this->heapSiftUp ( tmr.heapIndex );
+        return tmr.heapIndex == 0u;
+    }
+
+    //
+    // Finds proper time sorted location using a linear search
+    // starting from the end of the list.
+    //
+    tsDLIter < timer > pTmr = this->timerList.lastIter ();
+    while ( pTmr.valid () ) {
+        if ( ! tmr.expiresBefore ( *pTmr ) ) {
+            //
+            // add after the item found that expires earlier
+            //
+            this->timerList.insertAfter ( tmr, *pTmr );
+            return false;
+        }
+        --pTmr;
+    }
+    //
+    // add to the beginning of the list
+    //
+    this->timerList.push ( tmr );
+    return true;
+}
+
+void timerQueue::removePending ( timer & tmr )
+{
+    if ( this->queueType == epicsTimerQueueHeap ) {
+        unsigned index = tmr.heapIndex;
+        assert ( index < this->heapCount && this->heap[index] == & tmr );
+        this->heapCount--;
+        if ( index < this->heapCount ) {
+            timer * pLast = this->heap[this->heapCount];
+            this->heap[index] = pLast;
+            pLast->heapIndex = index;
+            if ( index > 0u && 
+                    pLast->expiresBefore ( *this->heap[(index - 1u) / 2u] ) ) {
+                this->heapSiftUp ( index );
+            }
+            else {
+                this->heapSiftDown ( index );
+            }
+        }
+    }
+    else {
+        this->timerList.remove ( tmr );
+    }
+}
+
+void timerQueue::heapSiftUp ( unsigned index )
+{
+    timer * pTmr = this->heap[index];
+    while ( index > 0u ) {
+        unsigned parent = ( index - 1u ) / 2u;
+        if ( ! pTmr->expiresBefore ( *this->heap[parent] ) ) {
+            break;
+        }
+        this->heap[index] = this->heap[parent];
+        this->heap[index]->heapIndex = index;
+        index = parent;
+    }
+    this->heap[index] = pTmr;
+    pTmr->heapIndex = index;
+}
+
+void timerQueue::heapSiftDown ( unsigned index )
+{
+    timer * pTmr = this->heap[index];
+    while ( true ) {
+        unsigned child = 2u * index + 1u;
+        if ( child >= this->heapCount ) {
+            break;
+        }
+        if ( child + 1u < this->heapCount && 
+                this->heap[child + 1u]->expiresBefore ( *this->heap[child] ) ) {
+            child++;
+        }
+        if ( ! this->heap[child]->expiresBefore ( *pTmr ) ) {
+            break;
+        }
+        this->heap[index] = this->heap[child];
+        this->heap[index]->heapIndex = index;
+        index = child;
+    }
+    this->heap[index] = pTmr;
+    pTmr->heapIndex = index;
 }
 
 void timerQueue ::
@@ -82,7 +202,7 @@ double timerQueue::process ( const epicsTime & currentTime )
     if ( this->pExpireTmr ) {
         // if some other thread is processing the queue
         // (or if this is a recursive call)
-        timer * pTmr = this->timerList.first ();
+        timer * pTmr = this->firstPending ();
         if ( pTmr ) {
             double delay = pTmr->exp - currentTime;
             if ( delay < 0.0 ) {
@@ -99,10 +219,10 @@ double timerQueue::process ( const epicsTime & currentTime )
     // Tag current epired tmr so that we can detect if call back
     // is in progress when canceling the timer.
     //
-    if ( this->timerList.first () ) {
-        if ( currentTime >= this->timerList.first ()->exp ) {
-            this->pExpireTmr = this->timerList.first ();
-            this->timerList.remove ( *this->pExpireTmr ); 
+    if ( this->firstPending () ) {
+        if ( currentTime >= this->firstPending ()->exp ) {
+            this->pExpireTmr = this->firstPending ();
+            this->removePending ( *this->pExpireTmr ); 
             this->pExpireTmr->curState = timer::stateActive;
             this->processThread = epicsThreadGetIdSelf ();
 #           ifdef DEBUG
@@ -110,7 +230,7 @@ double timerQueue::process ( const epicsTime & currentTime )
 #           endif 
         }
         else {
-            double delay = this->timerList.first ()->exp - currentTime;
+            double delay = this->firstPending ()->exp - currentTime;
             debugPrintf ( ( "no activity process %f to next\n", delay ) );
             return delay;
         }
@@ -177,17 +297,17 @@ double timerQueue::process ( const epicsTime & currentTime )
         }
         this->pExpireTmr = 0;
 
-        if ( this->timerList.first () ) {
-            if ( currentTime >= this->timerList.first ()->exp ) {
-                this->pExpireTmr = this->timerList.first ();
-                this->timerList.remove ( *this->pExpireTmr ); 
+        if ( this->firstPending () ) {
+            if ( currentTime >= this->firstPending ()->exp ) {
+                this->pExpireTmr = this->firstPending ();
+                this->removePending ( *this->pExpireTmr ); 
                 this->pExpireTmr->curState = timer::stateActive;
 #               ifdef DEBUG
                     this->pExpireTmr->show ( 0u );
 #               endif 
             }
             else {
-                delay = this->timerList.first ()->exp - currentTime;
+                delay = this->firstPending ()->exp - currentTime;
                 this->processThread = 0;
                 break;
             }
@@ -214,12 +334,21 @@ epicsTimerForC & timerQueue::createTimerForC ( epicsTimerCallback pCallback, voi
 void timerQueue::show ( unsigned level ) const
 {
     epicsGuard < epicsMutex > locker ( this->mutex );
-    printf ( "epicsTimerQueue with %u items pending\n", this->timerList.count () );
+    printf ( "epicsTimerQueue with %u items pending in a %s\n",
+        this->pendingCount (),
+        this->queueType == epicsTimerQueueHeap ? "heap" : "list" );
     if ( level >= 1u ) {
-        tsDLIterConst < timer > iter = this->timerList.firstIter ();
-        while ( iter.valid () ) {   
-            iter->show ( level - 1u );
-            ++iter;
+        if ( this->queueType == epicsTimerQueueHeap ) {
+            for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+                this->heap[i]->show ( level - 1u );
+            }
+        }
+        else {
+            tsDLIterConst < timer > iter = this->timerList.firstIter ();
+            while ( iter.valid () ) {   
+                iter->show ( level - 1u );
+                ++iter;
+            }
         }
     }
 }
@@ -40,10 +40,18 @@ epicsTimerQueueActive & epicsTimerQueueActive::allocate ( bool okToShare, unsign
     return pMgr->allocate ( pMgr, okToShare, threadPriority );
 }
 
+epicsTimerQueueActive & epicsTimerQueueActive::allocate ( bool okToShare,
+    unsigned threadPriority, epicsTimerQueueType type )
+{
+    epicsSingleton < timerQueueActiveMgr >::reference pMgr = 
+        timerQueueMgrEPICS.getReference ();
+    return pMgr->allocate ( pMgr, okToShare, threadPriority, type );
+}
+
 timerQueueActive ::
     timerQueueActive ( RefMgr & refMgr, 
-        bool okToShareIn, unsigned priority ) :
-    _refMgr ( refMgr ), queue ( *this ), thread ( *this, "timerQueue", 
+        bool okToShareIn, unsigned priority, epicsTimerQueueType type ) :
+    _refMgr ( refMgr ), queue ( *this, type ), thread ( *this, "timerQueue", 
         epicsThreadGetStackSize ( epicsThreadStackMedium ), priority ),
     sleepQuantum ( epicsThreadSleepQuantum() ), okToShare ( okToShareIn ), 
     exitFlag ( false ), terminateFlag ( false )
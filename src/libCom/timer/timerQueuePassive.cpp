@@ -33,8 +33,15 @@ epicsTimerQueuePassive & epicsTimerQueuePassive::create ( epicsTimerQueueNotify
     return * new timerQueuePassive ( notify );
 }
 
-timerQueuePassive::timerQueuePassive ( epicsTimerQueueNotify &notifyIn ) :
-    queue ( notifyIn ) {}
+epicsTimerQueuePassive & epicsTimerQueuePassive::create ( 
+    epicsTimerQueueNotify &notify, epicsTimerQueueType type )
+{
+    return * new timerQueuePassive ( notify, type );
+}
+
+timerQueuePassive::timerQueuePassive ( epicsTimerQueueNotify &notifyIn,
+    epicsTimerQueueType type ) :
+    queue ( notifyIn, type ) {}
 
 timerQueuePassive::~timerQueuePassive () {}
 
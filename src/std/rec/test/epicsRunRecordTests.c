@@ -20,6 +20,7 @@ int asTest(void);
 int linkRetargetLinkTest(void);
 int linkInitTest(void);
 int asyncSoftTest(void);
+int parallelFwdTest(void);
 
 void epicsRunRecordTests(void)
 {
@@ -41,5 +42,7 @@ void epicsRunRecordTests(void)
 
     runTest(asyncSoftTest);
 
+    runTest(parallelFwdTest);
+
     epicsExit(0);   /* Trigger test harness */
 }
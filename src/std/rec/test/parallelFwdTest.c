@@ -0,0 +1,176 @@
+/*************************************************************************\
+* Copyright (c) 2017 UChicago Argonne LLC, as Operator of Argonne
+*     National Laboratory.
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Fans out into records with their own lock sets, which must run
+ * concurrently on the dbFwd threads and be complete when the put
+ * that processed the fanout record returns.
+ */
+
+#include "dbAccess.h"
+#include "dbLock.h"
+#include "dbParallelFwd.h"
+#include "dbUnitTest.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "registryFunction.h"
+#include "subRecord.h"
+
+#include "testMain.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static int running, maxRunning;
+
+/* Holds each branch until a second one is running, or 1 second passed */
+static long parallelFwdWait(subRecord *prec)
+{
+    epicsTimeStamp start, now;
+    int n = epicsAtomicIncrIntT(&running);
+    int max;
+
+    while ((max = epicsAtomicGetIntT(&maxRunning)) < n)
+        epicsAtomicCmpAndSwapIntT(&maxRunning, max, n);
+
+    epicsTimeGetCurrent(&start);
+    do {
+        epicsThreadSleep(0.001);
+        epicsTimeGetCurrent(&now);
+    } while (epicsAtomicGetIntT(&maxRunning) < 2 &&
+             epicsTimeDiffInSeconds(&now, &start) < 1.0);
+
+    epicsAtomicDecrIntT(&running);
+    prec->val += 1;
+    return 0;
+}
+
+static long parallelFwdCount(subRecord *prec)
+{
+    prec->val += 1;
+    return 0;
+}
+
+static unsigned long lockId(const char *name)
+{
+    return dbLockGetLockId(testdbRecordPtr(name));
+}
+
+typedef struct processor {
+    const char *name;
+    epicsEventId done;
+} processor;
+
+static void processRepeatedly(void *arg)
+{
+    processor *pproc = arg;
+    DBADDR addr;
+    epicsInt32 one = 1;
+    int i;
+
+    if (!dbNameToAddr(pproc->name, &addr)) {
+        for (i = 0; i < 500; i++)
+            dbPutField(&addr, DBR_LONG, &one, 1);
+    }
+    epicsEventMustTrigger(pproc->done);
+}
+
+/* Processes both records from two threads at once, which deadlocks
+ * if each thread holds the lock that the other waits for.
+ */
+static void testBothEntries(const char *name1, const char *name2)
+{
+    processor procs[2] = {{NULL}};
+    int i, ok = 1;
+
+    procs[0].name = name1;
+    procs[1].name = name2;
+    for (i = 0; i < 2; i++) {
+        procs[i].done = epicsEventMustCreate(epicsEventEmpty);
+        epicsThreadMustCreate(procs[i].name, epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackSmall),
+            processRepeatedly, &procs[i]);
+    }
+    for (i = 0; i < 2; i++)
+        ok &= epicsEventWaitWithTimeout(procs[i].done, 20.0) ==
+            epicsEventWaitOK;
+    if (!ok)
+        testAbort("Processing %s and %s concurrently deadlocked",
+            name1, name2);
+    testPass("Processed %s and %s concurrently", name1, name2);
+    for (i = 0; i < 2; i++)
+        epicsEventDestroy(procs[i].done);
+}
+
+MAIN(parallelFwdTest)
+{
+    testPlan(29);
+
+    testOk1(dbParallelFwdThreads(2) == 0);
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    registryFunctionAdd("parallelFwdWait", (REGISTRYFUNCTION) parallelFwdWait);
+    registryFunctionAdd("parallelFwdCount", (REGISTRYFUNCTION) parallelFwdCount);
+    testdbReadDatabase("parallelFwdTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOk(dbParallelFwdThreads(1) != 0, "Can't reconfigure after iocInit");
+
+    testOk1(lockId("fan") != lockId("b1"));
+    testOk1(lockId("b1") != lockId("b2"));
+    testOk1(lockId("b1") != lockId("c1"));
+
+    testDiag("Fan out to four branches");
+    testdbPutFieldOk("fan.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("b1", DBF_LONG, 1);
+    testdbGetFieldEqual("b2", DBF_LONG, 1);
+    testdbGetFieldEqual("b3", DBF_LONG, 1);
+    testdbGetFieldEqual("b4", DBF_LONG, 1);
+    testdbGetFieldEqual("c1", DBF_LONG, 1);
+    testOk(epicsAtomicGetIntT(&maxRunning) >= 2,
+        "%d branches ran concurrently", epicsAtomicGetIntT(&maxRunning));
+
+    testDiag("Loop back to the record being processed");
+    testOk(lockId("loop1") == lockId("loop2"), "Loop merged into one lock set");
+    testdbPutFieldOk("loop1.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("loop1", DBF_LONG, 1);
+    testdbGetFieldEqual("loop2", DBF_LONG, 1);
+    testBothEntries("loop1", "loop2");
+
+    testOk1(lockId("ring1") == lockId("ring2"));
+    testOk1(lockId("ring2") == lockId("ring3"));
+
+    testDiag("Close a loop at run-time");
+    testdbPutFieldOk("late2.FLNK", DBF_STRING, "late1");
+    testOk1(lockId("late1") != lockId("late2"));
+    testdbPutFieldOk("late1.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("late1", DBF_LONG, 1);
+    testdbGetFieldEqual("late2", DBF_LONG, 1);
+    testBothEntries("late1", "late2");
+
+    testDiag("Retarget a forward link at run-time");
+    testdbPutFieldOk("loop2.FLNK", DBF_STRING, "c1");
+    testOk1(lockId("loop2") != lockId("c1"));
+    testdbPutFieldOk("loop1.PROC", DBF_LONG, 1);
+    testdbGetFieldEqual("c1", DBF_LONG, 2);
+
+    dbParallelFwdShow(0);
+
+    testIocShutdownOk();
+    testdbCleanup();
+
+    dbParallelFwdThreads(0);
+
+    return testDone();
+}